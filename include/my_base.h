@@ -206,7 +206,14 @@ enum ha_extra_function {
   */
   HA_EXTRA_EXPORT,
   /** Do secondary sort by handler::ref (rowid) after key sort. */
-  HA_EXTRA_SECONDARY_SORT_ROWID
+  HA_EXTRA_SECONDARY_SORT_ROWID,
+  /**
+    The coming scan will read a large part of the table (full table scan
+    or a range covering many rows), so the engine should avoid letting
+    its pages displace frequently used ones from the cache.
+    In effect until the end of the statement (handler::reset()).
+  */
+  HA_EXTRA_LARGE_SCAN
 };
 
 /* Compatible option, to be deleted in 6.0 */
@@ -6934,6 +6934,9 @@ void ha_partition::get_dynamic_partition_info(PARTITION_STATS *stat_info,
   HA_EXTRA_EXPORT:
     Prepare table for export
     (e.g. quiesce the table and write table metadata).
+  HA_EXTRA_LARGE_SCAN:
+    The coming scan reads a large part of the table; do not let it
+    displace frequently used pages from the buffer pool.
 
   11) Operations only used by partitioning
   ------------------------------
@@ -7082,6 +7085,7 @@ int ha_partition::extra(enum ha_extra_function operation)
     DBUG_RETURN(ER_UNSUPORTED_LOG_ENGINE);
     /* Category 10), used by InnoDB handlers */
   case HA_EXTRA_EXPORT:
+  case HA_EXTRA_LARGE_SCAN:
     DBUG_RETURN(loop_extra(operation));
     /* Category 11) Operations only used by partitioning. */
   case HA_EXTRA_SECONDARY_SORT_ROWID:
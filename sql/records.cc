@@ -29,6 +29,12 @@
 #include "sql_class.h"                          // THD
 #include "sql_select.h"          // JOIN_TAB
 
+/**
+  A range scan expected to return at least 1/LARGE_SCAN_FRACTION of the
+  rows of the table is announced to the handler with HA_EXTRA_LARGE_SCAN.
+*/
+#define LARGE_SCAN_FRACTION 10
+
 
 static int rr_quick(READ_RECORD *info);
 int rr_sequential(READ_RECORD *info);
@@ -268,6 +274,15 @@ bool init_read_record(READ_RECORD *info,THD *thd, TABLE *table,
   {
     DBUG_PRINT("info",("using rr_quick"));
     info->read_record=rr_quick;
+    /*
+      A range that covers a sizeable part of the table is read much like
+      a table scan: tell the engine so that it can keep the pages it reads
+      from displacing the frequently used ones.
+    */
+    if (table->file->stats.records > 0 &&
+        select->quick->records >=
+        table->file->stats.records / LARGE_SCAN_FRACTION)
+      (void) table->file->extra(HA_EXTRA_LARGE_SCAN);
   }
   else if (table->sort.record_pointers)
   {
@@ -286,6 +301,11 @@ bool init_read_record(READ_RECORD *info,THD *thd, TABLE *table,
     info->read_record=rr_sequential;
     if ((error= table->file->ha_rnd_init(1)))
       goto err;
+    /*
+      The engine knows whether the table is large compared to its cache,
+      and ignores the hint if it is not.
+    */
+    (void) table->file->extra(HA_EXTRA_LARGE_SCAN);
     /* We can use record cache if we don't update dynamic length tables */
     if (!table->no_cache &&
 	(use_record_cache > 0 ||
@@ -0,0 +1,643 @@
+/*****************************************************************************
+
+Copyright (c) 2014, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/********************************************************************//**
+@file btr/btr0bulk.cc
+Bottom-up loading of a B-tree from sorted input
+
+Each leaf page is filled in a single mini-transaction that keeps it
+x-latched, and its records are logged as one MLOG_LIST_END_COPY_CREATED
+record, in the same short form that page_copy_rec_list_end() uses when
+a page is split. The node pointers are appended to the last page of the
+level above in mini-transactions of their own. The first records go to
+the root page; when it is full, they are moved to a new leaf page, and
+the top level of the tree is copied to the root page at the end.
+*************************************************************************/
+
+#include "btr0bulk.h"
+
+#include "btr0btr.h"
+#include "btr0cur.h"
+#include "dict0dict.h"
+#include "fsp0fsp.h"
+#include "ibuf0ibuf.h"
+#include "log0log.h"
+#include "mtr0mtr.h"
+#include "page0cur.h"
+#include "page0page.h"
+#include "rem0cmp.h"
+#include "srv0srv.h"
+
+/** Bottom-up loader of a B-tree */
+struct btr_bulk_t {
+	dict_index_t*	index;		/*!< index being loaded */
+	trx_id_t	trx_id;		/*!< PAGE_MAX_TRX_ID of the leaf
+					pages of a secondary index */
+	ulint		reserve;	/*!< number of bytes to leave free
+					on each page, from
+					innodb_fill_factor */
+	mem_heap_t*	heap;		/*!< heap for node pointers */
+	ulint		n_levels;	/*!< number of levels that have
+					been started */
+	ulint		page_no[BTR_MAX_LEVELS];
+					/*!< last page of each level */
+	buf_block_t*	block;		/*!< leaf page being filled, or
+					NULL */
+	mtr_t		mtr;		/*!< mini-transaction of block */
+	page_append_t	app;		/*!< appends the records to block */
+	bool		full;		/*!< true if no more records
+					should be appended to block */
+};
+
+/*********************************************************************//**
+Checks if an index can be loaded with btr_bulk_insert().
+@return	true if the index can be bulk loaded */
+UNIV_INTERN
+bool
+btr_bulk_is_supported(
+/*==================*/
+	const dict_index_t*	index)	/*!< in: index */
+{
+	/* Compressed pages would have to be compressed and possibly
+	split when they are full, which is what the regular insert
+	path does anyway. */
+	return(!dict_table_zip_size(index->table)
+	       && !dict_index_is_ibuf(index));
+}
+
+/*********************************************************************//**
+Creates a bulk loader for an empty index. Nobody else may modify the
+index until btr_bulk_finish() has been called.
+@return	own: bulk loader */
+UNIV_INTERN
+btr_bulk_t*
+btr_bulk_create(
+/*============*/
+	dict_index_t*	index,	/*!< in: empty index */
+	trx_id_t	trx_id)	/*!< in: transaction identifier, for
+				PAGE_MAX_TRX_ID of secondary indexes */
+{
+	btr_bulk_t*	bulk;
+
+	ut_ad(btr_bulk_is_supported(index));
+
+	bulk = static_cast<btr_bulk_t*>(mem_alloc(sizeof *bulk));
+
+	bulk->index = index;
+	bulk->trx_id = trx_id;
+	bulk->heap = mem_heap_create(1024);
+	bulk->n_levels = 0;
+	bulk->block = NULL;
+	bulk->full = false;
+
+	if (srv_fill_factor == 100 && dict_index_is_clust(index)) {
+		/* Leave the space that btr_cur_optimistic_insert()
+		leaves free when the clustered index is filled in
+		ascending order. */
+		bulk->reserve = dict_index_get_space_reserve();
+	} else {
+		bulk->reserve = UNIV_PAGE_SIZE * (100 - srv_fill_factor) / 100;
+	}
+
+	return(bulk);
+}
+
+/*********************************************************************//**
+Allocates and creates a page at the end of a level of the tree.
+@return	x-latched new page, or NULL if the tablespace is full */
+static __attribute__((nonnull(1,4), warn_unused_result))
+buf_block_t*
+btr_bulk_page_alloc(
+/*================*/
+	btr_bulk_t*	bulk,		/*!< in/out: bulk loader */
+	ulint		level,		/*!< in: level of the page */
+	buf_block_t*	prev_block,	/*!< in/out: last page of the
+					level, or NULL */
+	mtr_t*		mtr)		/*!< in/out: mini-transaction */
+{
+	dict_index_t*	index = bulk->index;
+	buf_block_t*	block;
+	page_t*		page;
+	ulint		n_reserved;
+	ulint		hint_page_no;
+
+	if (!fsp_reserve_free_extents(&n_reserved, index->space, 1,
+				      FSP_NORMAL, mtr)) {
+		return(NULL);
+	}
+
+	hint_page_no = prev_block
+		? buf_block_get_page_no(prev_block) + 1
+		: dict_index_get_page(index) + 1;
+
+	block = btr_page_alloc(index, hint_page_no, FSP_UP, level, mtr, mtr);
+
+	fil_space_release_free_extents(index->space, n_reserved);
+
+	if (block == NULL) {
+		return(NULL);
+	}
+
+	btr_page_create(block, NULL, index, level, mtr);
+
+	page = buf_block_get_frame(block);
+
+	btr_page_set_next(page, NULL, FIL_NULL, mtr);
+
+	if (prev_block != NULL) {
+		btr_page_set_prev(page, NULL,
+				  buf_block_get_page_no(prev_block), mtr);
+		btr_page_set_next(buf_block_get_frame(prev_block), NULL,
+				  buf_block_get_page_no(block), mtr);
+	} else {
+		btr_page_set_prev(page, NULL, FIL_NULL, mtr);
+	}
+
+	return(block);
+}
+
+/*********************************************************************//**
+Appends a node pointer to a non-leaf level of the tree. When the last
+page of the level is full, a new page is started, and its node pointer
+is appended to the level above.
+@return	DB_SUCCESS or error code */
+static __attribute__((nonnull, warn_unused_result))
+dberr_t
+btr_bulk_insert_node_ptr(
+/*=====================*/
+	btr_bulk_t*	bulk,		/*!< in/out: bulk loader */
+	const dtuple_t*	node_ptr,	/*!< in: node pointer */
+	ulint		level)		/*!< in: level, > 0 */
+{
+	dict_index_t*	index		= bulk->index;
+	dtuple_t*	first_ptr	= NULL;
+	dtuple_t*	new_ptr		= NULL;
+	mem_heap_t*	heap		= NULL;
+	ulint*		offsets		= NULL;
+	buf_block_t*	block;
+	page_t*		page;
+	page_cur_t	cur;
+	rec_t*		rec;
+	mtr_t		mtr;
+	dberr_t		err		= DB_SUCCESS;
+
+	ut_ad(level > 0);
+	ut_ad(level <= bulk->n_levels);
+
+	if (level >= BTR_MAX_LEVELS) {
+		return(DB_CORRUPTION);
+	}
+
+	mtr_start(&mtr);
+	mtr_x_lock(dict_index_get_lock(index), &mtr);
+
+	if (level == bulk->n_levels) {
+		/* Start a new level. */
+		block = btr_bulk_page_alloc(bulk, level, NULL, &mtr);
+
+		if (block == NULL) {
+			err = DB_OUT_OF_FILE_SPACE;
+			goto func_exit;
+		}
+
+		bulk->page_no[level] = buf_block_get_page_no(block);
+		bulk->n_levels++;
+	} else {
+		ulint	rec_size = rec_get_converted_size(index, node_ptr, 0);
+
+		block = btr_block_get(index->space, 0, bulk->page_no[level],
+				      RW_X_LATCH, index, &mtr);
+
+		page = buf_block_get_frame(block);
+
+		if (page_get_n_recs(page) > 0
+		    && rec_size + bulk->reserve
+		    > page_get_max_insert_size(page, 1)) {
+
+			buf_block_t*	new_block = btr_bulk_page_alloc(
+				bulk, level, block, &mtr);
+
+			if (new_block == NULL) {
+				err = DB_OUT_OF_FILE_SPACE;
+				goto func_exit;
+			}
+
+			if (btr_page_get_prev(page, &mtr) == FIL_NULL) {
+				/* This was the only page of the level.
+				Now that the level has two pages, the
+				level above needs a node pointer to the
+				first page, too. */
+				first_ptr = dict_index_build_node_ptr(
+					index, page_rec_get_next(
+						page_get_infimum_rec(page)),
+					buf_block_get_page_no(block),
+					bulk->heap, level);
+			}
+
+			block = new_block;
+			bulk->page_no[level] = buf_block_get_page_no(block);
+		}
+	}
+
+	page = buf_block_get_frame(block);
+
+	page_cur_position(page_rec_get_prev(page_get_supremum_rec(page)),
+			  block, &cur);
+
+	rec = page_cur_tuple_insert(&cur, node_ptr, index,
+				    &offsets, &heap, 0, &mtr);
+
+	if (rec == NULL) {
+		err = DB_CORRUPTION;
+		goto func_exit;
+	}
+
+	if (page_get_n_recs(page) == 1) {
+		if (btr_page_get_prev(page, &mtr) == FIL_NULL) {
+			/* The leftmost node pointer of each non-leaf
+			level must be marked. */
+			btr_set_min_rec_mark(rec, &mtr);
+		} else {
+			new_ptr = dict_index_build_node_ptr(
+				index, rec, buf_block_get_page_no(block),
+				bulk->heap, level);
+		}
+	}
+
+func_exit:
+	mtr_commit(&mtr);
+
+	if (heap != NULL) {
+		mem_heap_free(heap);
+	}
+
+	if (err == DB_SUCCESS && first_ptr != NULL) {
+		err = btr_bulk_insert_node_ptr(bulk, first_ptr, level + 1);
+	}
+
+	if (err == DB_SUCCESS && new_ptr != NULL) {
+		err = btr_bulk_insert_node_ptr(bulk, new_ptr, level + 1);
+	}
+
+	return(err);
+}
+
+/*********************************************************************//**
+Writes the page directory of the leaf page being filled, and updates
+the page header fields that depend on the kind of the index. */
+static
+void
+btr_bulk_leaf_end(
+/*==============*/
+	btr_bulk_t*	bulk)	/*!< in/out: bulk loader */
+{
+	page_cur_append_end(&bulk->app);
+
+	if (!dict_index_is_clust(bulk->index)) {
+		page_update_max_trx_id(bulk->block, NULL, bulk->trx_id,
+				       &bulk->mtr);
+	}
+}
+
+/*********************************************************************//**
+Starts filling a leaf page that has been created by an earlier
+mini-transaction. */
+static
+void
+btr_bulk_leaf_start(
+/*================*/
+	btr_bulk_t*	bulk,	/*!< in/out: bulk loader */
+	ulint		page_no)/*!< in: page number */
+{
+	dict_index_t*	index = bulk->index;
+
+	/* No page latches are being held, and the page will
+	stay latched until it is full. */
+	log_free_check();
+
+	mtr_start(&bulk->mtr);
+	mtr_x_lock(dict_index_get_lock(index), &bulk->mtr);
+
+	bulk->block = btr_block_get(index->space, 0, page_no,
+				    RW_X_LATCH, index, &bulk->mtr);
+	bulk->full = false;
+
+	page_cur_append_start(&bulk->app, buf_block_get_frame(bulk->block),
+			      index, &bulk->mtr);
+}
+
+/*********************************************************************//**
+Completes the leaf page being filled, starts the next one, and appends
+the node pointer of the completed page to the level above.
+@return	DB_SUCCESS or error code */
+static __attribute__((nonnull, warn_unused_result))
+dberr_t
+btr_bulk_leaf_next(
+/*===============*/
+	btr_bulk_t*	bulk)	/*!< in/out: bulk loader */
+{
+	dict_index_t*	index	= bulk->index;
+	buf_block_t*	block	= bulk->block;
+	buf_block_t*	new_block;
+	dtuple_t*	node_ptr;
+	ulint		new_page_no;
+	dberr_t		err;
+
+	btr_bulk_leaf_end(bulk);
+
+	if (buf_block_get_page_no(block) == dict_index_get_page(index)) {
+		/* The records were appended to the root page, in
+		case they would all fit in it. Move them to a new
+		page, as btr_root_raise_and_insert() does. The root
+		page will receive the top level of the tree in
+		btr_bulk_finish(). */
+		buf_block_t*	root_block = block;
+
+		block = btr_bulk_page_alloc(bulk, 0, NULL, &bulk->mtr);
+
+		if (block == NULL) {
+			mtr_commit(&bulk->mtr);
+			bulk->block = NULL;
+			return(DB_OUT_OF_FILE_SPACE);
+		}
+
+		if (!page_copy_rec_list_end(
+			    block, root_block,
+			    page_get_infimum_rec(
+				    buf_block_get_frame(root_block)),
+			    index, &bulk->mtr)) {
+			ut_error;
+		}
+
+		btr_page_empty(root_block, NULL, index, 0, &bulk->mtr);
+	}
+
+	new_block = btr_bulk_page_alloc(bulk, 0, block, &bulk->mtr);
+
+	if (!dict_index_is_clust(index)) {
+		/* The ibuf bitmap page must be latched after the
+		pages that were latched for the allocation. */
+		ibuf_update_free_bits_low(
+			block, page_get_free_space_of_empty(
+				dict_table_is_comp(index->table)),
+			&bulk->mtr);
+	}
+
+	if (new_block == NULL) {
+		mtr_commit(&bulk->mtr);
+		bulk->block = NULL;
+		return(DB_OUT_OF_FILE_SPACE);
+	}
+
+	new_page_no = buf_block_get_page_no(new_block);
+	bulk->page_no[0] = new_page_no;
+
+	node_ptr = dict_index_build_node_ptr(
+		index, page_rec_get_next(
+			page_get_infimum_rec(buf_block_get_frame(block))),
+		buf_block_get_page_no(block), bulk->heap, 0);
+
+	mtr_commit(&bulk->mtr);
+	bulk->block = NULL;
+
+	err = btr_bulk_insert_node_ptr(bulk, node_ptr, 1);
+
+	mem_heap_empty(bulk->heap);
+
+	if (err == DB_SUCCESS) {
+		btr_bulk_leaf_start(bulk, new_page_no);
+	}
+
+	return(err);
+}
+
+/*********************************************************************//**
+Appends a tuple to the index. The tuples must be inserted in ascending
+order, and they must not contain externally stored columns.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_insert(
+/*============*/
+	btr_bulk_t*	bulk,	/*!< in/out: bulk loader */
+	dtuple_t*	tuple)	/*!< in/out: tuple to insert; fields may
+				be moved off-page */
+{
+	dict_index_t*	index	= bulk->index;
+	big_rec_t*	big_rec	= NULL;
+	ulint		n_ext	= 0;
+	ulint		rec_size;
+	rec_t*		rec;
+	mem_heap_t*	heap	= NULL;
+	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*		offsets	= offsets_;
+	dberr_t		err	= DB_SUCCESS;
+	rec_offs_init(offsets_);
+
+	ut_ad(dtuple_check_typed(tuple));
+
+	rec_size = rec_get_converted_size(index, tuple, 0);
+
+	if (page_zip_rec_needs_ext(rec_size, dict_table_is_comp(index->table),
+				   dtuple_get_n_fields(tuple), 0)) {
+
+		/* The record is so big that we have to store some fields
+		externally on separate database pages */
+		big_rec = dtuple_convert_big_rec(index, tuple, &n_ext);
+
+		if (big_rec == NULL) {
+			return(DB_TOO_BIG_RECORD);
+		}
+
+		rec_size = rec_get_converted_size(index, tuple, n_ext);
+	}
+
+	if (bulk->block == NULL) {
+		ut_ad(bulk->n_levels == 0);
+
+		/* Start with the empty root page, so that an index
+		that fits in one page is built in place. */
+		bulk->page_no[0] = dict_index_get_page(index);
+		bulk->n_levels = 1;
+
+		btr_bulk_leaf_start(bulk, bulk->page_no[0]);
+	} else if (bulk->full
+		   || rec_size + bulk->reserve
+		   > page_cur_append_get_max_insert_size(&bulk->app)) {
+
+		err = btr_bulk_leaf_next(bulk);
+
+		if (err != DB_SUCCESS) {
+			goto func_exit;
+		}
+	}
+
+	ut_ad(rec_size <= page_cur_append_get_max_insert_size(&bulk->app));
+
+#ifdef UNIV_DEBUG
+	/* Check that the records are inserted in order. */
+	if (bulk->app.n_recs > 0) {
+		offsets = rec_get_offsets(bulk->app.prev_rec, index, offsets,
+					  ULINT_UNDEFINED, &heap);
+		ut_ad(cmp_dtuple_rec(tuple, bulk->app.prev_rec, offsets) > 0);
+	}
+#endif /* UNIV_DEBUG */
+
+	rec = page_cur_append_tuple(&bulk->app, tuple, n_ext,
+				    &offsets, &heap);
+
+	if (big_rec != NULL) {
+		ut_ad(dict_index_is_clust(index));
+
+		/* The BLOB pages are written in mini-transactions of
+		their own, but the BLOB pointers and the allocation of
+		the BLOB pages are logged in bulk->mtr, after the
+		records that have been appended so far. */
+		page_cur_append_close_log(&bulk->app);
+
+		err = btr_store_big_rec_extern_fields(
+			index, bulk->block, rec, offsets, big_rec,
+			&bulk->mtr, BTR_STORE_INSERT_BULK);
+
+		/* Writing the BLOB pages may have generated a lot of
+		redo log. Let btr_bulk_leaf_start() wait for a log
+		checkpoint before the next record, if needed. */
+		if (log_sys->check_flush_or_checkpoint) {
+			bulk->full = true;
+		}
+	}
+
+func_exit:
+	if (big_rec != NULL) {
+		dtuple_convert_back_big_rec(index, tuple, big_rec);
+	}
+
+	if (heap != NULL) {
+		mem_heap_free(heap);
+	}
+
+	return(err);
+}
+
+/*********************************************************************//**
+Copies the only page of the highest level of the tree to the root
+page, and frees it. */
+static
+void
+btr_bulk_copy_to_root(
+/*==================*/
+	btr_bulk_t*	bulk)	/*!< in/out: bulk loader */
+{
+	dict_index_t*	index	= bulk->index;
+	ulint		level	= bulk->n_levels - 1;
+	buf_block_t*	root_block;
+	buf_block_t*	block;
+	page_t*		page;
+	mtr_t		mtr;
+
+	mtr_start(&mtr);
+	mtr_x_lock(dict_index_get_lock(index), &mtr);
+
+	root_block = btr_block_get(index->space, 0, dict_index_get_page(index),
+				   RW_X_LATCH, index, &mtr);
+	block = btr_block_get(index->space, 0, bulk->page_no[level],
+			      RW_X_LATCH, index, &mtr);
+	page = buf_block_get_frame(block);
+
+	ut_ad(page_get_n_recs(buf_block_get_frame(root_block)) == 0);
+	ut_ad(btr_page_get_prev(page, &mtr) == FIL_NULL);
+	ut_ad(btr_page_get_next(page, &mtr) == FIL_NULL);
+
+	btr_page_set_level(buf_block_get_frame(root_block), NULL, level, &mtr);
+
+	if (!page_copy_rec_list_end(root_block, block,
+				    page_get_infimum_rec(page),
+				    index, &mtr)) {
+		ut_error;
+	}
+
+	btr_blob_dbg_remove(page, index, "btr_bulk_copy_to_root");
+
+	btr_page_free(index, block, &mtr);
+
+	/* We play it safe and reset the free bits for the root */
+	if (!dict_index_is_clust(index)) {
+		ibuf_reset_free_bits(root_block);
+	}
+
+	ut_ad(page_validate(buf_block_get_frame(root_block), index));
+
+	mtr_commit(&mtr);
+}
+
+/*********************************************************************//**
+Completes the loading of an index and frees the bulk loader. On
+failure, the pages loaded so far are left to be freed with the index.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_finish(
+/*============*/
+	btr_bulk_t*	bulk,	/*!< in,own: bulk loader */
+	dberr_t		err)	/*!< in: error from btr_bulk_insert(), or
+				DB_SUCCESS if the load should be
+				completed */
+{
+	if (bulk->block != NULL) {
+		buf_block_t*	block	= bulk->block;
+		page_t*		page	= buf_block_get_frame(block);
+		dtuple_t*	node_ptr = NULL;
+
+		/* A leaf page is only started for a record that
+		is appended to it right away. */
+		ut_ad(bulk->app.n_recs > 0);
+
+		btr_bulk_leaf_end(bulk);
+
+		if (!dict_index_is_clust(bulk->index)) {
+			ibuf_update_free_bits_low(
+				block, page_get_free_space_of_empty(
+					page_is_comp(page)),
+				&bulk->mtr);
+		}
+
+		if (err == DB_SUCCESS
+		    && btr_page_get_prev(page, &bulk->mtr) != FIL_NULL) {
+			node_ptr = dict_index_build_node_ptr(
+				bulk->index,
+				page_rec_get_next(page_get_infimum_rec(page)),
+				buf_block_get_page_no(block), bulk->heap, 0);
+		}
+
+		mtr_commit(&bulk->mtr);
+		bulk->block = NULL;
+
+		if (node_ptr != NULL) {
+			err = btr_bulk_insert_node_ptr(bulk, node_ptr, 1);
+		}
+	}
+
+	if (err == DB_SUCCESS && bulk->n_levels > 1) {
+		btr_bulk_copy_to_root(bulk);
+	}
+
+	mem_heap_free(bulk->heap);
+	mem_free(bulk);
+
+	return(err);
+}
@@ -487,7 +487,8 @@ btr_cur_search_to_nth_level(
 # ifdef UNIV_SEARCH_PERF_STAT
 	info->n_searches++;
 # endif
-	if (rw_lock_get_writer(&btr_search_latch) == RW_LOCK_NOT_LOCKED
+	if (rw_lock_get_writer(btr_search_get_latch(index))
+	    == RW_LOCK_NOT_LOCKED
 	    && latch_mode <= BTR_MODIFY_LEAF
 	    && info->last_hash_succ
 	    && !estimate
@@ -523,7 +524,7 @@ btr_cur_search_to_nth_level(
 
 	if (has_search_latch) {
 		/* Release possible search latch to obey latching order */
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(btr_search_get_latch(index));
 	}
 
 	/* Store the position of the tree latch we push to mtr so that we
@@ -819,7 +820,7 @@ func_exit:
 
 	if (has_search_latch) {
 
-		rw_lock_s_lock(&btr_search_latch);
+		rw_lock_s_lock(btr_search_get_latch(index));
 	}
 }
 
@@ -1070,6 +1071,79 @@ btr_cur_open_at_rnd_pos_func(
 	}
 }
 
+/**********************************************************************//**
+Looks up the leaf page that a search tuple belongs to, without accessing
+the leaf page itself. The index tree is s-latched in mtr.
+@return	leaf page number, or FIL_NULL if the root page is a leaf page */
+UNIV_INTERN
+ulint
+btr_cur_get_leaf_page_no(
+/*=====================*/
+	dict_index_t*	index,	/*!< in: index */
+	const dtuple_t*	tuple,	/*!< in: search tuple */
+	mtr_t*		mtr)	/*!< in/out: mini-transaction */
+{
+	page_cur_t	page_cursor;
+	ulint		page_no;
+	ulint		space;
+	ulint		zip_size;
+	mem_heap_t*	heap		= NULL;
+	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*		offsets		= offsets_;
+	rec_offs_init(offsets_);
+
+	ut_ad(!dict_index_is_ibuf(index));
+
+	/* The non-leaf pages cannot be modified while the tree is
+	s-latched, see btr_cur_search_to_nth_level(). */
+	mtr_s_lock(dict_index_get_lock(index), mtr);
+
+	space = dict_index_get_space(index);
+	zip_size = dict_table_zip_size(index->table);
+	page_no = dict_index_get_page(index);
+
+	for (;;) {
+		buf_block_t*	block;
+		const rec_t*	node_ptr;
+		ulint		height;
+
+		block = buf_page_get_gen(space, zip_size, page_no,
+					 RW_NO_LATCH, NULL, BUF_GET,
+					 __FILE__, __LINE__, mtr);
+
+		ut_ad(fil_page_get_type(buf_block_get_frame(block))
+		      == FIL_PAGE_INDEX);
+		ut_ad(index->id
+		      == btr_page_get_index_id(buf_block_get_frame(block)));
+
+		height = btr_page_get_level(buf_block_get_frame(block), mtr);
+
+		if (height == 0) {
+			/* The root page is the only page. */
+			page_no = FIL_NULL;
+			break;
+		}
+
+		page_cur_search(block, index, tuple, PAGE_CUR_LE,
+				&page_cursor);
+
+		node_ptr = page_cur_get_rec(&page_cursor);
+		offsets = rec_get_offsets(node_ptr, index, offsets,
+					  ULINT_UNDEFINED, &heap);
+		page_no = btr_node_ptr_get_child_page_no(node_ptr, offsets);
+
+		if (height == 1) {
+			break;
+		}
+	}
+
+	if (UNIV_LIKELY_NULL(heap)) {
+		mem_heap_free(heap);
+	}
+
+	return(page_no);
+}
+
 /*==================== B-TREE INSERT =========================*/
 
 /*************************************************************//**
@@ -2038,13 +2112,13 @@ btr_cur_update_in_place(
 			btr_search_update_hash_on_delete(cursor);
 		}
 
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(btr_search_get_latch(index));
 	}
 
 	row_upd_rec_in_place(rec, index, offsets, update, page_zip);
 
 	if (is_hashed) {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(btr_search_get_latch(index));
 	}
 
 	btr_cur_update_in_place_log(flags, rec, index, update,
@@ -4451,7 +4525,7 @@ btr_store_big_rec_extern_fields(
 	}
 
 	if (total_blob_len > redo_10p) {
-		ut_ad(op == BTR_STORE_INSERT);
+		ut_ad(op == BTR_STORE_INSERT || op == BTR_STORE_INSERT_BULK);
 		ib_logf(IB_LOG_LEVEL_ERROR, "The total blob data length"
 			" (" ULINTPF ") is greater than 10%% of the"
 			" redo log file size (" UINT64PF "). Please"
@@ -4508,6 +4582,12 @@ btr_store_big_rec_extern_fields(
 		only be written to btr_mtr, which is committed after
 		mtr.) */
 		alloc_mtr = btr_mtr;
+	} else if (op == BTR_STORE_INSERT_BULK) {
+		/* The record has been logged in btr_mtr, which will
+		be committed after mtr. The BLOB pointers must be
+		logged after the record, or recovery would overwrite
+		them with the zero pointers of the inserted record. */
+		alloc_mtr = btr_mtr;
 	} else {
 		/* Use the local mtr for allocations. */
 		alloc_mtr = &mtr;
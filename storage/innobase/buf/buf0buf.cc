@@ -46,8 +46,10 @@ Created 11/5/1995 Heikki Tuuri
 #include "ibuf0ibuf.h"
 #include "trx0undo.h"
 #include "log0log.h"
+#include "ha_prototypes.h"
 #endif /* !UNIV_HOTBACKUP */
 #include "srv0srv.h"
+#include "srv0start.h"
 #include "dict0dict.h"
 #include "log0recv.h"
 #include "page0zip.h"
@@ -436,6 +438,34 @@ buf_get_total_stat(
 	}
 }
 
+/********************************************************************//**
+Maps a round-robin sequence number to a buffer pool instance that is
+bound to the NUMA node of the calling thread. Instance i is bound to
+node i % n_nodes, so the instances of a node are node, node + n_nodes,
+node + 2 * n_nodes and so on.
+@return index of a node-local instance, or seq if the calling thread
+runs on a node that has no instance */
+static
+ulint
+buf_pool_get_numa_local_index(
+/*==========================*/
+	ulint	seq)	/*!< in: round-robin sequence number */
+{
+	ulint	n_nodes = os_numa_get_n_nodes();
+	ulint	node = os_numa_get_curr_node();
+
+	if (node >= n_nodes || node >= srv_buf_pool_instances) {
+		return(seq);
+	}
+
+	/* Number of instances i < srv_buf_pool_instances
+	with i % n_nodes == node */
+	ulint	n_local = (srv_buf_pool_instances - node + n_nodes - 1)
+		/ n_nodes;
+
+	return(node + (seq % n_local) * n_nodes);
+}
+
 /********************************************************************//**
 Allocates a buffer block.
 @return own: the allocated block, in state BUF_BLOCK_MEMORY */
@@ -454,8 +484,14 @@ buf_block_alloc(
 	if (buf_pool == NULL) {
 		/* We are allocating memory from any buffer pool, ensure
 		we spread the grace on all buffer pool instances. */
-		index = buf_pool_index++ % srv_buf_pool_instances;
-		buf_pool = buf_pool_from_array(index);
+		index = buf_pool_index++;
+
+		if (srv_numa_aware) {
+			index = buf_pool_get_numa_local_index(index);
+		}
+
+		buf_pool = buf_pool_from_array(
+			index % srv_buf_pool_instances);
 	}
 
 	block = buf_LRU_get_free_block(buf_pool);
@@ -1033,6 +1069,22 @@ buf_block_init(
 	ut_ad(rw_lock_validate(&(block->lock)));
 }
 
+/** Frames of one buffer pool chunk, as seen by buf_block_align() */
+struct buf_chunk_map_entry_t{
+	const byte*	frame;		/*!< frame of the first block */
+	buf_block_t*	blocks;		/*!< array of buffer control blocks */
+	ulint		size;		/*!< number of blocks */
+};
+
+/** The chunks of a buffer pool instance sorted by the address of
+their frames. buf_block_align() binary searches it without holding
+buf_pool->mutex, so a resize creates a new map and publishes it with
+buf_chunk_map_publish() instead of modifying the one in use. */
+struct buf_chunk_map_t{
+	ulint			n;	/*!< number of chunks */
+	buf_chunk_map_entry_t*	entries;/*!< chunks, ordered by frame */
+};
+
 /********************************************************************//**
 Allocates a chunk of buffer frames.
 @return	chunk, or NULL on failure */
@@ -1063,6 +1115,15 @@ buf_chunk_init(
 		return(NULL);
 	}
 
+	if (buf_pool->numa_node != ULINT_UNDEFINED) {
+		/* Bind the memory before the block descriptors
+		below touch it, so that it is faulted in on the
+		node. Failure is not fatal: the pages then stay
+		wherever the default policy puts them. */
+		os_mem_bind_to_numa_node(chunk->mem, chunk->mem_size,
+					 buf_pool->numa_node);
+	}
+
 	/* Allocate the block descriptors from
 	the start of the memory block. */
 	chunk->blocks = (buf_block_t*) chunk->mem;
@@ -1099,12 +1160,6 @@ buf_chunk_init(
 		buf_block_init(buf_pool, block, frame);
 		UNIV_MEM_INVALID(block->frame, UNIV_PAGE_SIZE);
 
-		/* Add the block to the free list */
-		UT_LIST_ADD_LAST(list, buf_pool->free, (&block->page));
-
-		ut_d(block->page.in_free_list = TRUE);
-		ut_ad(buf_pool_from_block(block) == buf_pool);
-
 		block++;
 		frame += UNIV_PAGE_SIZE;
 	}
@@ -1115,6 +1170,122 @@ buf_chunk_init(
 	return(chunk);
 }
 
+/********************************************************************//**
+Adds the blocks of a chunk initialized by buf_chunk_init() to the
+free list. */
+static
+void
+buf_chunk_add_to_free(
+/*==================*/
+	buf_pool_t*	buf_pool,	/*!< in/out: buffer pool instance */
+	buf_chunk_t*	chunk)		/*!< in: chunk of buffers */
+{
+	buf_block_t*	block = chunk->blocks;
+	ulint		i;
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	for (i = chunk->size; i--; block++) {
+
+		UT_LIST_ADD_LAST(list, buf_pool->free, (&block->page));
+
+		ut_d(block->page.in_free_list = TRUE);
+		ut_ad(buf_pool_from_block(block) == buf_pool);
+	}
+}
+
+/********************************************************************//**
+Frees the mutex and the rw-locks of the blocks of a chunk, before the
+memory of the chunk is released by a shrink of the buffer pool. */
+static
+void
+buf_chunk_free_latches(
+/*===================*/
+	buf_chunk_t*	chunk)		/*!< in: chunk of buffers */
+{
+	buf_block_t*	block = chunk->blocks;
+	ulint		i;
+
+	for (i = chunk->size; i--; block++) {
+
+		ut_ad(buf_block_get_state(block) == BUF_BLOCK_NOT_USED);
+
+		mutex_free(&block->mutex);
+		rw_lock_free(&block->lock);
+#ifdef UNIV_SYNC_DEBUG
+		rw_lock_free(&block->debug_latch);
+#endif /* UNIV_SYNC_DEBUG */
+	}
+}
+
+/********************************************************************//**
+Creates the map that buf_block_align() searches from the current
+chunks of a buffer pool instance.
+@return	own: chunk map, sorted by frame address */
+static
+buf_chunk_map_t*
+buf_chunk_map_create(
+/*=================*/
+	const buf_pool_t*	buf_pool)	/*!< in: buffer pool instance */
+{
+	buf_chunk_map_t*	map;
+	ulint			i;
+
+	map = static_cast<buf_chunk_map_t*>(
+		mem_alloc(sizeof *map
+			  + buf_pool->n_chunks * sizeof *map->entries));
+
+	map->n = buf_pool->n_chunks;
+	map->entries = reinterpret_cast<buf_chunk_map_entry_t*>(map + 1);
+
+	/* Insertion sort: there are few chunks and this is only
+	done when the buffer pool is created or resized. */
+	for (i = 0; i < map->n; i++) {
+		const buf_chunk_t*	chunk = &buf_pool->chunks[i];
+		ulint			j;
+
+		for (j = i;
+		     j > 0 && map->entries[j - 1].frame
+		     > chunk->blocks->frame;
+		     j--) {
+			map->entries[j] = map->entries[j - 1];
+		}
+
+		map->entries[j].frame = chunk->blocks->frame;
+		map->entries[j].blocks = chunk->blocks;
+		map->entries[j].size = chunk->size;
+	}
+
+	return(map);
+}
+
+/********************************************************************//**
+Replaces the chunk map of a buffer pool instance. The map that is
+being replaced may still be searched by a thread in buf_block_align(),
+so it is only freed by the next replacement. Resizes are rare and
+take at least seconds, while a lookup takes nanoseconds. */
+static
+void
+buf_chunk_map_publish(
+/*==================*/
+	buf_pool_t*		buf_pool,	/*!< in/out: buffer pool
+						instance */
+	buf_chunk_map_t*	map)		/*!< in, own: new map */
+{
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	if (buf_pool->chunk_map_old != NULL) {
+		mem_free(buf_pool->chunk_map_old);
+	}
+
+	buf_pool->chunk_map_old = buf_pool->chunk_map;
+
+	/* The entries must be visible before the pointer is. */
+	os_wmb;
+
+	buf_pool->chunk_map = map;
+}
+
 #ifdef UNIV_DEBUG
 /*********************************************************************//**
 Finds a block in the given buffer chunk that points to a
@@ -1259,6 +1430,8 @@ buf_pool_init_instance(
 	ulint		i;
 	buf_chunk_t*	chunk;
 
+	ut_ad(buf_pool_size % srv_buf_pool_chunk_size == 0);
+
 	/* 1. Initialize general fields
 	------------------------------- */
 	mutex_create(buf_pool_mutex_key,
@@ -1268,26 +1441,49 @@ buf_pool_init_instance(
 
 	buf_pool_mutex_enter(buf_pool);
 
+	buf_pool->numa_node = srv_numa_aware
+		? instance_no % os_numa_get_n_nodes()
+		: ULINT_UNDEFINED;
+
 	if (buf_pool_size > 0) {
-		buf_pool->n_chunks = 1;
+		buf_pool->n_chunks = buf_pool_size / srv_buf_pool_chunk_size;
+		buf_pool->n_chunks_new = buf_pool->n_chunks;
 
-		buf_pool->chunks = chunk =
-			(buf_chunk_t*) mem_zalloc(sizeof *chunk);
+		buf_pool->chunks = chunk = (buf_chunk_t*) mem_zalloc(
+			buf_pool->n_chunks * sizeof *chunk);
 
 		UT_LIST_INIT(buf_pool->free);
+		UT_LIST_INIT(buf_pool->withdraw);
 
-		if (!buf_chunk_init(buf_pool, chunk, buf_pool_size)) {
-			mem_free(chunk);
-			mem_free(buf_pool);
+		buf_pool->curr_size = 0;
 
-			buf_pool_mutex_exit(buf_pool);
+		for (i = 0; i < buf_pool->n_chunks; i++, chunk++) {
 
-			return(DB_ERROR);
+			if (!buf_chunk_init(buf_pool, chunk,
+					    srv_buf_pool_chunk_size)) {
+
+				while (--chunk >= buf_pool->chunks) {
+					os_mem_free_large(chunk->mem,
+							  chunk->mem_size);
+				}
+
+				mem_free(buf_pool->chunks);
+				mem_free(buf_pool);
+
+				buf_pool_mutex_exit(buf_pool);
+
+				return(DB_ERROR);
+			}
+
+			buf_chunk_add_to_free(buf_pool, chunk);
+
+			buf_pool->curr_size += chunk->size;
 		}
 
+		buf_pool->chunk_map = buf_chunk_map_create(buf_pool);
+
 		buf_pool->instance_no = instance_no;
 		buf_pool->old_pool_size = buf_pool_size;
-		buf_pool->curr_size = chunk->size;
 		buf_pool->curr_pool_size = buf_pool->curr_size * UNIV_PAGE_SIZE;
 
 		/* Number of locks protecting page_hash must be a
@@ -1371,6 +1567,12 @@ buf_pool_free_instance(
 	}
 
 	mem_free(buf_pool->chunks);
+	mem_free(buf_pool->chunk_map);
+
+	if (buf_pool->chunk_map_old != NULL) {
+		mem_free(buf_pool->chunk_map_old);
+	}
+
 	ha_clear(buf_pool->page_hash);
 	hash_table_free(buf_pool->page_hash);
 	hash_table_free(buf_pool->zip_hash);
@@ -1393,6 +1595,22 @@ buf_pool_init(
 	ut_ad(n_instances <= MAX_BUFFER_POOLS);
 	ut_ad(n_instances == srv_buf_pool_instances);
 
+	if (srv_numa_aware) {
+		ulint	n_nodes = os_numa_get_n_nodes();
+
+		if (n_nodes == 0) {
+			ib_logf(IB_LOG_LEVEL_WARN,
+				"innodb_numa_aware is set but NUMA is not"
+				" supported on this system; ignoring it.");
+			srv_numa_aware = FALSE;
+		} else {
+			ib_logf(IB_LOG_LEVEL_INFO,
+				"Binding %lu buffer pool instances to"
+				" %lu NUMA nodes",
+				(ulong) n_instances, (ulong) n_nodes);
+		}
+	}
+
 	buf_pool_ptr = (buf_pool_t*) mem_zalloc(
 		n_instances * sizeof *buf_pool_ptr);
 
@@ -1435,6 +1653,620 @@ buf_pool_free(
 	buf_pool_ptr = NULL;
 }
 
+/********************************************************************//**
+Rounds a buffer pool size up to a whole number of chunks in every
+instance.
+@return	size in bytes, a multiple of
+innodb_buffer_pool_chunk_size * innodb_buffer_pool_instances */
+UNIV_INTERN
+ulint
+buf_pool_size_align(
+/*================*/
+	ulint	size)	/*!< in: size in bytes */
+{
+	const ulint	unit = srv_buf_pool_chunk_size
+		* srv_buf_pool_instances;
+
+	if (size < unit) {
+		return(unit);
+	}
+
+	/* The unit need not be a power of two. */
+	return((size + unit - 1) / unit * unit);
+}
+
+/********************************************************************//**
+Checks whether a frame belongs to one of the chunks that an ongoing
+shrink of its buffer pool instance is going to free.
+@return	true if the frame will be withdrawn */
+static
+bool
+buf_frame_will_withdrawn(
+/*=====================*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	const byte*	ptr)		/*!< in: pointer into a frame */
+{
+	ulint	i;
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	for (i = buf_pool->n_chunks_new; i < buf_pool->n_chunks; i++) {
+		const buf_chunk_t*	chunk = &buf_pool->chunks[i];
+
+		if (ptr >= chunk->blocks->frame
+		    && ptr < chunk->blocks->frame
+		    + chunk->size * UNIV_PAGE_SIZE) {
+
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/********************************************************************//**
+Checks whether a block belongs to one of the chunks that an ongoing
+shrink of its buffer pool instance is going to free.
+@return	true if the block will be withdrawn */
+UNIV_INTERN
+bool
+buf_block_will_withdrawn(
+/*=====================*/
+	buf_pool_t*		buf_pool,	/*!< in: buffer pool instance */
+	const buf_block_t*	block)		/*!< in: block, not
+						dereferenced */
+{
+	ulint	i;
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	for (i = buf_pool->n_chunks_new; i < buf_pool->n_chunks; i++) {
+		const buf_chunk_t*	chunk = &buf_pool->chunks[i];
+
+		if (block >= chunk->blocks
+		    && block < chunk->blocks + chunk->size) {
+
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/********************************************************************//**
+Checks whether a page in the LRU list occupies memory of the chunks
+that an ongoing shrink is going to free, either with its uncompressed
+frame or with its compressed page.
+@return	true if the page has to be evicted */
+static
+bool
+buf_page_will_withdrawn(
+/*====================*/
+	buf_pool_t*		buf_pool,	/*!< in: buffer pool instance */
+	const buf_page_t*	bpage)		/*!< in: page in the LRU */
+{
+	if (buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE
+	    && buf_block_will_withdrawn(
+		    buf_pool, reinterpret_cast<const buf_block_t*>(bpage))) {
+
+		return(true);
+	}
+
+	return(bpage->zip.data != NULL
+	       && buf_frame_will_withdrawn(buf_pool, bpage->zip.data));
+}
+
+/********************************************************************//**
+Makes one pass towards emptying the chunks that an ongoing shrink of a
+buffer pool instance is going to free: moves their free blocks to the
+withdraw list, evicts the clean pages that occupy them and writes out
+the dirty ones, so that a later pass can evict those. Pages that are
+buffer-fixed or under I/O are left for a later pass as well.
+@return	true if all blocks of the chunks are in the withdraw list */
+static
+bool
+buf_pool_withdraw_blocks(
+/*=====================*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
+{
+	buf_page_t*	bpage;
+	bool		done;
+
+	buf_pool_mutex_enter(buf_pool);
+
+	for (bpage = UT_LIST_GET_FIRST(buf_pool->free);
+	     bpage != NULL
+	     && UT_LIST_GET_LEN(buf_pool->withdraw)
+	     < buf_pool->withdraw_target; ) {
+
+		buf_page_t*	next = UT_LIST_GET_NEXT(list, bpage);
+
+		ut_ad(bpage->in_free_list);
+
+		if (buf_block_will_withdrawn(
+			    buf_pool, reinterpret_cast<buf_block_t*>(bpage))) {
+
+			UT_LIST_REMOVE(list, buf_pool->free, bpage);
+			ut_d(bpage->in_free_list = FALSE);
+
+			UT_LIST_ADD_LAST(list, buf_pool->withdraw, bpage);
+		}
+
+		bpage = next;
+	}
+
+	done = UT_LIST_GET_LEN(buf_pool->withdraw)
+		>= buf_pool->withdraw_target;
+
+	for (bpage = UT_LIST_GET_LAST(buf_pool->LRU);
+	     bpage != NULL && !done; ) {
+
+		buf_page_t*	prev = UT_LIST_GET_PREV(LRU, bpage);
+		ib_mutex_t*	block_mutex;
+		ulint		space = ULINT_UNDEFINED;
+		ulint		offset = ULINT_UNDEFINED;
+		bool		released;
+
+		if (!buf_page_will_withdrawn(buf_pool, bpage)) {
+			bpage = prev;
+			continue;
+		}
+
+		/* Remember the previous page: both eviction and
+		flushing may release buf_pool->mutex. */
+		if (prev != NULL) {
+			space = prev->space;
+			offset = prev->offset;
+		}
+
+		block_mutex = buf_page_get_mutex(bpage);
+
+		mutex_enter(block_mutex);
+
+		if (buf_flush_ready_for_replace(bpage)) {
+			mutex_exit(block_mutex);
+
+			/* The freed block goes to the withdraw list,
+			see buf_LRU_block_free_non_file_page(). */
+			released = buf_LRU_free_page(bpage, true);
+
+		} else if (buf_flush_ready_for_flush(
+				   bpage, BUF_FLUSH_SINGLE_PAGE)) {
+
+			/* Write the page synchronously; it will be
+			evicted by the next pass. This releases both
+			mutexes when it returns true. */
+			released = buf_flush_page(
+				buf_pool, bpage, BUF_FLUSH_SINGLE_PAGE, true);
+
+			if (released) {
+				buf_pool_mutex_enter(buf_pool);
+			} else {
+				mutex_exit(block_mutex);
+			}
+		} else {
+			mutex_exit(block_mutex);
+			released = false;
+		}
+
+		if (released && prev != NULL) {
+			prev = buf_page_hash_get(buf_pool, space, offset);
+		}
+
+		bpage = prev;
+	}
+
+	done = UT_LIST_GET_LEN(buf_pool->withdraw)
+		>= buf_pool->withdraw_target;
+
+	buf_pool_mutex_exit(buf_pool);
+
+	return(done);
+}
+
+/********************************************************************//**
+Cancels the shrink of a buffer pool instance and returns the blocks
+that had been withdrawn to the free list. */
+static
+void
+buf_pool_withdraw_cancel(
+/*=====================*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
+{
+	buf_page_t*	bpage;
+
+	buf_pool_mutex_enter(buf_pool);
+
+	while ((bpage = UT_LIST_GET_FIRST(buf_pool->withdraw)) != NULL) {
+
+		UT_LIST_REMOVE(list, buf_pool->withdraw, bpage);
+
+		UT_LIST_ADD_LAST(list, buf_pool->free, bpage);
+		ut_d(bpage->in_free_list = TRUE);
+	}
+
+	buf_pool->withdraw_target = 0;
+	buf_pool->n_chunks_new = buf_pool->n_chunks;
+
+	buf_pool_mutex_exit(buf_pool);
+}
+
+/********************************************************************//**
+Frees the chunks of a buffer pool instance whose blocks have all been
+withdrawn. */
+static
+void
+buf_pool_shrink_instance(
+/*=====================*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
+{
+	buf_chunk_t*	removed;
+	ulint		n_removed;
+	ulint		i;
+
+	buf_pool_mutex_enter(buf_pool);
+
+	ut_a(UT_LIST_GET_LEN(buf_pool->withdraw)
+	     == buf_pool->withdraw_target);
+
+	n_removed = buf_pool->n_chunks - buf_pool->n_chunks_new;
+
+	removed = static_cast<buf_chunk_t*>(
+		mem_alloc(n_removed * sizeof *removed));
+
+	memcpy(removed, buf_pool->chunks + buf_pool->n_chunks_new,
+	       n_removed * sizeof *removed);
+
+	/* None of the withdrawn blocks is reachable any more: they
+	are neither in the free list nor in the LRU list. */
+	UT_LIST_INIT(buf_pool->withdraw);
+
+	buf_pool->curr_size -= buf_pool->withdraw_target;
+	buf_pool->withdraw_target = 0;
+	buf_pool->n_chunks = buf_pool->n_chunks_new;
+
+	buf_pool->old_pool_size = buf_pool->curr_pool_size;
+	buf_pool->curr_pool_size = buf_pool->curr_size * UNIV_PAGE_SIZE;
+
+	buf_chunk_map_publish(buf_pool, buf_chunk_map_create(buf_pool));
+
+	buf_pool_mutex_exit(buf_pool);
+
+	for (i = 0; i < n_removed; i++) {
+		buf_chunk_free_latches(&removed[i]);
+
+		os_mem_free_large(removed[i].mem, removed[i].mem_size);
+	}
+
+	mem_free(removed);
+}
+
+/********************************************************************//**
+Adds chunks to a buffer pool instance. The chunks are allocated and
+initialized before buf_pool->mutex is acquired.
+@return	true on success, false if the memory could not be allocated */
+static
+bool
+buf_pool_grow_instance(
+/*===================*/
+	buf_pool_t*	buf_pool,	/*!< in/out: buffer pool instance */
+	ulint		n_chunks)	/*!< in: new number of chunks */
+{
+	buf_chunk_t*	chunks;
+	buf_chunk_t*	old_chunks;
+	ulint		n_old	= buf_pool->n_chunks;
+	ulint		n_new;
+
+	ut_ad(n_chunks > n_old);
+
+	/* Only the resize thread modifies the chunk array, so it
+	can be read here without buf_pool->mutex. */
+	chunks = static_cast<buf_chunk_t*>(
+		mem_zalloc(n_chunks * sizeof *chunks));
+
+	memcpy(chunks, buf_pool->chunks, n_old * sizeof *chunks);
+
+	for (n_new = n_old; n_new < n_chunks; n_new++) {
+		bool	fail = false;
+
+		/* Let only the first new chunk be allocated. */
+		DBUG_EXECUTE_IF("ib_buf_pool_grow_fail",
+				fail = n_new > n_old;);
+
+		if (fail
+		    || !buf_chunk_init(buf_pool, &chunks[n_new],
+				       srv_buf_pool_chunk_size)) {
+			break;
+		}
+	}
+
+	buf_pool_mutex_enter(buf_pool);
+
+	old_chunks = buf_pool->chunks;
+	buf_pool->chunks = chunks;
+
+	for (ulint i = n_old; i < n_new; i++) {
+		buf_chunk_add_to_free(buf_pool, &chunks[i]);
+
+		buf_pool->curr_size += chunks[i].size;
+	}
+
+	buf_pool->n_chunks = n_new;
+	buf_pool->n_chunks_new = n_new;
+
+	buf_pool->old_pool_size = buf_pool->curr_pool_size;
+	buf_pool->curr_pool_size = buf_pool->curr_size * UNIV_PAGE_SIZE;
+
+	buf_chunk_map_publish(buf_pool, buf_chunk_map_create(buf_pool));
+
+	/* Let the threads that are waiting for a free block
+	scan the LRU list again. */
+	buf_pool->try_LRU_scan = TRUE;
+
+	buf_pool_mutex_exit(buf_pool);
+
+	mem_free(old_chunks);
+
+	return(n_new == n_chunks);
+}
+
+/*****************************************************************//**
+Sets the global variable that feeds MySQL's
+innodb_buffer_pool_resize_status and writes it to the error log. */
+static __attribute__((nonnull, format(printf, 1, 2)))
+void
+buf_resize_status(
+/*==============*/
+	const char*	fmt,	/*!< in: format */
+	...)			/*!< in: extra parameters according
+				to fmt */
+{
+	va_list	ap;
+
+	va_start(ap, fmt);
+
+	ut_vsnprintf(
+		export_vars.innodb_buffer_pool_resize_status,
+		sizeof(export_vars.innodb_buffer_pool_resize_status),
+		fmt, ap);
+
+	va_end(ap);
+
+	ib_logf(IB_LOG_LEVEL_INFO, "%s",
+		export_vars.innodb_buffer_pool_resize_status);
+}
+
+/********************************************************************//**
+Resizes the buffer pool to srv_buf_pool_size, adding or removing
+whole chunks in every instance while the server keeps running.
+Progress is reported in innodb_buffer_pool_resize_status. */
+UNIV_INTERN
+void
+buf_pool_resize(void)
+/*=================*/
+{
+	const ulint	new_size	= srv_buf_pool_size;
+	const ulint	n_chunks	= new_size / srv_buf_pool_instances
+		/ srv_buf_pool_chunk_size;
+	ulint		withdraw_target	= 0;
+	bool		ahi_disabled	= false;
+	bool		success		= true;
+	ulint		i;
+
+	ut_a(n_chunks > 0);
+	ut_ad(!srv_read_only_mode);
+
+	buf_resize_status("Resizing buffer pool from %lu to %lu bytes,"
+			  " in chunks of %lu bytes.",
+			  (ulong) srv_buf_pool_old_size, (ulong) new_size,
+			  (ulong) srv_buf_pool_chunk_size);
+
+	/* 1. Shrink: keep the blocks of the chunks that go away
+	from being allocated again, and empty them. */
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+		buf_pool_mutex_enter(buf_pool);
+
+		if (buf_pool->n_chunks > n_chunks) {
+			ulint	j;
+
+			buf_pool->n_chunks_new = n_chunks;
+
+			for (j = n_chunks; j < buf_pool->n_chunks; j++) {
+				buf_pool->withdraw_target
+					+= buf_pool->chunks[j].size;
+			}
+
+			withdraw_target += buf_pool->withdraw_target;
+		}
+
+		buf_pool_mutex_exit(buf_pool);
+	}
+
+	if (withdraw_target > 0) {
+		ib_time_t	last_report = ut_time();
+
+		/* The adaptive hash index keeps its memory in blocks
+		of the buffer pool that are never evicted. Dropping
+		it releases them, and new ones will not be allocated
+		from the chunks that are being withdrawn. */
+		if (btr_search_enabled) {
+			buf_resize_status("Disabling the adaptive hash"
+					  " index.");
+			btr_search_disable();
+			ahi_disabled = true;
+		}
+
+		buf_resize_status("Withdrawing %lu blocks.",
+				  (ulong) withdraw_target);
+
+		for (;;) {
+			bool	done		= true;
+			ulint	withdrawn	= 0;
+
+			for (i = 0; i < srv_buf_pool_instances; i++) {
+				buf_pool_t*	buf_pool
+					= buf_pool_from_array(i);
+
+				if (buf_pool->withdraw_target > 0
+				    && !buf_pool_withdraw_blocks(buf_pool)) {
+					done = false;
+				}
+
+				withdrawn += UT_LIST_GET_LEN(
+					buf_pool->withdraw);
+			}
+
+			if (done) {
+				break;
+			}
+
+			ut_snprintf(
+				export_vars.innodb_buffer_pool_resize_status,
+				sizeof(export_vars
+				       .innodb_buffer_pool_resize_status),
+				"Withdrawing blocks (%lu/%lu).",
+				(ulong) withdrawn, (ulong) withdraw_target);
+
+			if (srv_shutdown_state != SRV_SHUTDOWN_NONE) {
+				for (i = 0; i < srv_buf_pool_instances; i++) {
+					buf_pool_withdraw_cancel(
+						buf_pool_from_array(i));
+				}
+
+				buf_resize_status("Resizing the buffer pool"
+						  " was interrupted by"
+						  " shutdown.");
+				success = false;
+
+				goto func_exit;
+			}
+
+			if (ut_time() - last_report >= 15) {
+				/* Pages that stay buffer-fixed hold
+				up the shrink; tell why it is slow. */
+				ib_logf(IB_LOG_LEVEL_INFO,
+					"Still withdrawing blocks to shrink"
+					" the buffer pool: %lu of %lu done.",
+					(ulong) withdrawn,
+					(ulong) withdraw_target);
+
+				last_report = ut_time();
+			}
+
+			os_thread_sleep(100000);
+		}
+
+		for (i = 0; i < srv_buf_pool_instances; i++) {
+			buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+			if (buf_pool->withdraw_target > 0) {
+				buf_pool_shrink_instance(buf_pool);
+			}
+		}
+	}
+
+	/* 2. Grow: add the missing chunks. */
+
+	for (i = 0; i < srv_buf_pool_instances && success; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+		if (buf_pool->n_chunks < n_chunks) {
+			ut_snprintf(
+				export_vars.innodb_buffer_pool_resize_status,
+				sizeof(export_vars
+				       .innodb_buffer_pool_resize_status),
+				"Adding chunks to buffer pool instance"
+				" %lu of %lu.",
+				(ulong) i + 1, (ulong) srv_buf_pool_instances);
+
+			success = buf_pool_grow_instance(buf_pool, n_chunks);
+		}
+	}
+
+	if (!success) {
+		buf_resize_status("Cannot allocate memory for the buffer"
+				  " pool; it was only partially grown.");
+	}
+
+	buf_pool_set_sizes();
+
+	/* The change buffer is limited to a share of the buffer
+	pool. */
+	ibuf_max_size_update(srv_change_buffer_max_size);
+
+func_exit:
+	if (!success) {
+		ulint	in_use = 0;
+
+		/* Show the size that is in use instead of the one
+		that could not be reached, and do not retry it; a new
+		request will start a new resize. */
+		for (i = 0; i < srv_buf_pool_instances; i++) {
+			in_use += buf_pool_from_array(i)->n_chunks
+				* srv_buf_pool_chunk_size;
+		}
+
+		srv_buf_pool_size = in_use;
+		innobase_set_buffer_pool_size(in_use);
+	}
+
+	srv_buf_pool_old_size = srv_buf_pool_size;
+
+	if (ahi_disabled) {
+		btr_search_enable();
+	}
+
+	if (success) {
+		buf_resize_status("Completed resizing the buffer pool to"
+				  " %lu bytes.",
+				  (ulong) buf_pool_get_curr_size());
+	}
+}
+
+/*****************************************************************//**
+This is the thread that resizes the buffer pool whenever
+innodb_buffer_pool_size is changed.
+@return this function does not return, it calls os_thread_exit() */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_resize_thread)(
+/*==============================*/
+	void*	arg __attribute__((unused)))	/*!< in: a dummy parameter
+						required by os_thread_create */
+{
+	ut_ad(!srv_read_only_mode);
+
+	/* Let the debug keywords of SET GLOBAL debug reach this thread. */
+	my_thread_init();
+
+	srv_buf_resize_thread_active = TRUE;
+
+	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+
+		os_event_wait(srv_buf_resize_event);
+		os_event_reset(srv_buf_resize_event);
+
+		while (srv_shutdown_state == SRV_SHUTDOWN_NONE
+		       && srv_buf_pool_old_size != srv_buf_pool_size) {
+
+			buf_pool_resize();
+		}
+	}
+
+	srv_buf_resize_thread_active = FALSE;
+
+	my_thread_end();
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /********************************************************************//**
 Clears the adaptive hash index on all pages in the buffer pool. */
 UNIV_INTERN
@@ -1445,12 +2277,16 @@ buf_pool_clear_hash_index(void)
 	ulint	p;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(btr_search_own_all(RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 	ut_ad(!btr_search_enabled);
 
 	for (p = 0; p < srv_buf_pool_instances; p++) {
 		buf_pool_t*	buf_pool = buf_pool_from_array(p);
+
+		/* buf_pool_resize() may replace buf_pool->chunks. */
+		buf_pool_mutex_enter(buf_pool);
+
 		buf_chunk_t*	chunks	= buf_pool->chunks;
 		buf_chunk_t*	chunk	= chunks + buf_pool->n_chunks;
 
@@ -1462,7 +2298,8 @@ buf_pool_clear_hash_index(void)
 				dict_index_t*	index	= block->index;
 
 				/* We can set block->index = NULL
-				when we have an x-latch on btr_search_latch;
+				when we have x-latched all the adaptive
+				hash index partitions;
 				see the comment in buf0buf.h */
 
 				if (!index) {
@@ -1476,6 +2313,8 @@ buf_pool_clear_hash_index(void)
 # endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
 			}
 		}
+
+		buf_pool_mutex_exit(buf_pool);
 	}
 }
 
@@ -2157,6 +2996,8 @@ buf_block_init_low(
 	block->n_fields		= 1;
 	block->n_bytes		= 0;
 	block->left_side	= TRUE;
+
+	block->unzip_usec	= 0;
 }
 #endif /* !UNIV_HOTBACKUP */
 
@@ -2172,6 +3013,7 @@ buf_zip_decompress(
 {
 	const byte*	frame = block->page.zip.data;
 	ulint		size = page_zip_get_size(&block->page.zip);
+	ullint		start_time;
 
 	ut_ad(buf_block_get_zip_size(block));
 	ut_a(buf_block_get_space(block) != 0);
@@ -2196,8 +3038,16 @@ buf_zip_decompress(
 
 	switch (fil_page_get_type(frame)) {
 	case FIL_PAGE_INDEX:
+		start_time = ut_time_us(NULL);
+
 		if (page_zip_decompress(&block->page.zip,
 					block->frame, TRUE)) {
+#ifndef UNIV_HOTBACKUP
+			/* Remember what the frame costs to rebuild,
+			for buf_LRU_free_from_unzip_LRU_list() */
+			block->unzip_usec = static_cast<ulint>(
+				ut_time_us(NULL) - start_time);
+#endif /* !UNIV_HOTBACKUP */
 			return(TRUE);
 		}
 
@@ -2241,21 +3091,31 @@ buf_block_align_instance(
 					resides */
 	const byte*	ptr)		/*!< in: pointer to a frame */
 {
-	buf_chunk_t*	chunk;
-	ulint		i;
+	const buf_chunk_map_t*	map = buf_pool->chunk_map;
+	ulint			low = 0;
+	ulint			high;
 
-	/* TODO: protect buf_pool->chunks with a mutex (it will
-	currently remain constant after buf_pool_init()) */
-	for (chunk = buf_pool->chunks, i = buf_pool->n_chunks; i--; chunk++) {
-		ulint	offs;
+	/* The map is never modified after it has been published,
+	see buf_chunk_map_publish(). */
+	os_rmb;
 
-		if (UNIV_UNLIKELY(ptr < chunk->blocks->frame)) {
+	/* Find the number of chunks whose frames start at or
+	below ptr; the last of them is the only candidate. */
+	for (high = map->n; low < high; ) {
+		ulint	mid = (low + high) / 2;
 
-			continue;
+		if (map->entries[mid].frame <= ptr) {
+			low = mid + 1;
+		} else {
+			high = mid;
 		}
-		/* else */
+	}
 
-		offs = ptr - chunk->blocks->frame;
+	if (low > 0) {
+		const buf_chunk_map_entry_t*	chunk = &map->entries[low - 1];
+		ulint				offs;
+
+		offs = ptr - chunk->frame;
 
 		offs >>= UNIV_PAGE_SIZE_SHIFT;
 
@@ -2358,19 +3218,19 @@ buf_pointer_is_block_field_instance(
 	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
 	const void*	ptr)		/*!< in: pointer not dereferenced */
 {
-	const buf_chunk_t*		chunk	= buf_pool->chunks;
-	const buf_chunk_t* const	echunk	= chunk + buf_pool->n_chunks;
+	const buf_chunk_map_t*	map = buf_pool->chunk_map;
+	ulint			i;
+
+	os_rmb;
+
+	for (i = 0; i < map->n; i++) {
+		const buf_chunk_map_entry_t*	chunk = &map->entries[i];
 
-	/* TODO: protect buf_pool->chunks with a mutex (it will
-	currently remain constant after buf_pool_init()) */
-	while (chunk < echunk) {
 		if (ptr >= (void*) chunk->blocks
 		    && ptr < (void*) (chunk->blocks + chunk->size)) {
 
 			return(TRUE);
 		}
-
-		chunk++;
 	}
 
 	return(FALSE);
@@ -2980,7 +3840,8 @@ got_block:
 		buf_block_mutex_exit(fix_block);
 	}
 
-	if (mode != BUF_PEEK_IF_IN_POOL) {
+	/* A large scan must not promote the pages it passes over. */
+	if (mode != BUF_PEEK_IF_IN_POOL && mtr->scan_ring == NULL) {
 		buf_page_make_young_if_needed(&fix_block->page);
 	}
 
@@ -3024,6 +3885,17 @@ got_block:
 	mtr_memo_push(mtr, fix_block, fix_type);
 
 	if (mode != BUF_PEEK_IF_IN_POOL && !access_time) {
+		/* The page was brought in for this access. A large
+		scan keeps it in its own ring, except for the non-leaf
+		pages of the index, which it is going to need again. */
+
+		if (mtr->scan_ring != NULL
+		    && (fil_page_get_type(fix_block->frame) != FIL_PAGE_INDEX
+			|| page_is_leaf(fix_block->frame))) {
+
+			buf_scan_ring_add(mtr->scan_ring, space, offset);
+		}
+
 		/* In the case of a first access, try to apply linear
 		read-ahead */
 
@@ -4618,7 +5490,10 @@ assert_s_latched:
 	}
 
 	ut_a(UT_LIST_GET_LEN(buf_pool->LRU) == n_lru);
-	if (UT_LIST_GET_LEN(buf_pool->free) != n_free) {
+	/* Blocks withdrawn by buf_pool_resize() are not in use
+	either, but they are kept off the free list. */
+	if (UT_LIST_GET_LEN(buf_pool->free)
+	    + UT_LIST_GET_LEN(buf_pool->withdraw) != n_free) {
 		fprintf(stderr, "Free list len %lu, free blocks %lu\n",
 			(ulong) UT_LIST_GET_LEN(buf_pool->free),
 			(ulong) n_free);
@@ -5011,6 +5886,10 @@ buf_stats_aggregate_pool_info(
 	total_info->io_cur += pool_info->io_cur;
 	total_info->unzip_sum += pool_info->unzip_sum;
 	total_info->unzip_cur += pool_info->unzip_cur;
+	total_info->io_usec_sum += pool_info->io_usec_sum;
+	total_info->io_usec_cur += pool_info->io_usec_cur;
+	total_info->unzip_usec_sum += pool_info->unzip_usec_sum;
+	total_info->unzip_usec_cur += pool_info->unzip_usec_cur;
 }
 /*******************************************************************//**
 Collect buffer pool stats information for a buffer pool. Also
@@ -5145,6 +6024,14 @@ buf_stats_get_pool_info(
 
 	pool_info->unzip_cur = buf_LRU_stat_cur.unzip;
 
+	pool_info->io_usec_sum = buf_LRU_stat_sum.io_usec;
+
+	pool_info->io_usec_cur = buf_LRU_stat_cur.io_usec;
+
+	pool_info->unzip_usec_sum = buf_LRU_stat_sum.unzip_usec;
+
+	pool_info->unzip_usec_cur = buf_LRU_stat_cur.unzip_usec;
+
 	buf_refresh_io_stats(buf_pool);
 	buf_pool_mutex_exit(buf_pool);
 }
@@ -5222,10 +6109,14 @@ buf_print_io_instance(
 	happening with LRU eviction. */
 	fprintf(file,
 		"LRU len: %lu, unzip_LRU len: %lu\n"
-		"I/O sum[%lu]:cur[%lu], unzip sum[%lu]:cur[%lu]\n",
+		"I/O sum[%lu]:cur[%lu], unzip sum[%lu]:cur[%lu]\n"
+		"I/O wait usec sum[%lu]:cur[%lu],"
+		" unzip usec sum[%lu]:cur[%lu]\n",
 		pool_info->lru_len, pool_info->unzip_lru_len,
 		pool_info->io_sum, pool_info->io_cur,
-		pool_info->unzip_sum, pool_info->unzip_cur);
+		pool_info->unzip_sum, pool_info->unzip_cur,
+		pool_info->io_usec_sum, pool_info->io_usec_cur,
+		pool_info->unzip_usec_sum, pool_info->unzip_usec_cur);
 }
 
 /*********************************************************************//**
@@ -119,6 +119,115 @@ buf_dblwr_sync_datafiles()
 	fil_flush_file_spaces(FIL_TABLESPACE);
 }
 
+/****************************************************************//**
+Builds the name of the doublewrite file of a buffer pool instance. */
+static
+void
+buf_dblwr_file_name(
+/*================*/
+	char*	name,		/*!< out: file name */
+	ulint	len,		/*!< in: size of name in bytes */
+	ulint	instance)	/*!< in: buffer pool instance number */
+{
+	ulint	dirnamelen = strlen(srv_data_home);
+
+	if (dirnamelen
+	    && srv_data_home[dirnamelen - 1] != SRV_PATH_SEPARATOR) {
+
+		ut_snprintf(name, len, "%s%cib_doublewrite%lu",
+			    srv_data_home, SRV_PATH_SEPARATOR,
+			    (ulong) instance);
+	} else {
+		ut_snprintf(name, len, "%sib_doublewrite%lu",
+			    srv_data_home, (ulong) instance);
+	}
+}
+
+/****************************************************************//**
+Closes the doublewrite files and frees their names. */
+static
+void
+buf_dblwr_files_close(void)
+/*=======================*/
+{
+	for (ulint i = 0; i < buf_dblwr->n_files; i++) {
+		os_file_close(buf_dblwr->files[i]);
+		mem_free(buf_dblwr->file_names[i]);
+	}
+
+	mem_free(buf_dblwr->files);
+	buf_dblwr->files = NULL;
+
+	mem_free(buf_dblwr->file_names);
+	buf_dblwr->file_names = NULL;
+
+	buf_dblwr->n_files = 0;
+}
+
+/****************************************************************//**
+Opens the doublewrite files, one per buffer pool instance, creating
+the missing ones. The contents of existing files are left alone because
+crash recovery may still need the pages in them.
+@return true if all the files were opened */
+static
+bool
+buf_dblwr_files_open(void)
+/*======================*/
+{
+	ulint		n_files = srv_buf_pool_instances;
+	os_offset_t	size = (os_offset_t) 2 * srv_doublewrite_pages
+		* UNIV_PAGE_SIZE;
+
+	buf_dblwr->files = static_cast<os_file_t*>(
+		mem_zalloc(n_files * sizeof(os_file_t)));
+
+	buf_dblwr->file_names = static_cast<char**>(
+		mem_zalloc(n_files * sizeof(char*)));
+
+	for (ulint i = 0; i < n_files; i++) {
+		char		name[OS_FILE_MAX_PATH];
+		os_file_t	file;
+		ibool		success;
+
+		buf_dblwr_file_name(name, sizeof(name), i);
+
+		file = os_file_create(
+			innodb_file_data_key, name,
+			OS_FILE_OPEN | OS_FILE_ON_ERROR_NO_EXIT
+			| OS_FILE_ON_ERROR_SILENT,
+			OS_FILE_NORMAL, OS_DATA_FILE, &success);
+
+		if (!success) {
+			file = os_file_create(
+				innodb_file_data_key, name, OS_FILE_CREATE,
+				OS_FILE_NORMAL, OS_DATA_FILE, &success);
+
+			if (success && !os_file_set_size(name, file, size)) {
+				os_file_close(file);
+				success = FALSE;
+			}
+		}
+
+		if (!success) {
+			ib_logf(IB_LOG_LEVEL_ERROR,
+				"Cannot open or create the doublewrite file"
+				" %s. Using the doublewrite buffer in the"
+				" system tablespace for batch flushes.",
+				name);
+
+			buf_dblwr_files_close();
+
+			return(false);
+		}
+
+		buf_dblwr->files[i] = file;
+		buf_dblwr->file_names[i] = mem_strdup(name);
+		buf_dblwr->n_files++;
+	}
+
+	return(true);
+}
+
 /****************************************************************//**
 Creates or initialializes the doublewrite buffer at a database start. */
 static
@@ -145,11 +254,8 @@ buf_dblwr_init(
 	mutex_create(buf_dblwr_mutex_key,
 		     &buf_dblwr->mutex, SYNC_DOUBLEWRITE);
 
-	buf_dblwr->b_event = os_event_create();
 	buf_dblwr->s_event = os_event_create();
-	buf_dblwr->first_free = 0;
 	buf_dblwr->s_reserved = 0;
-	buf_dblwr->b_reserved = 0;
 
 	buf_dblwr->block1 = mach_read_from_4(
 		doublewrite + TRX_SYS_DOUBLEWRITE_BLOCK1);
@@ -168,6 +274,87 @@ buf_dblwr_init(
 
 	buf_dblwr->buf_block_arr = static_cast<buf_page_t**>(
 		mem_zalloc(buf_size * sizeof(void*)));
+
+	if (srv_doublewrite_pages > 0
+	    && srv_use_doublewrite_buf
+	    && !srv_read_only_mode
+	    && buf_dblwr_files_open()) {
+
+		/* Batch flushes go to the doublewrite files: the whole
+		doublewrite buffer in the system tablespace is left to
+		single page flushes. */
+		buf_dblwr->s_first = 0;
+		buf_dblwr->n_batches = 2 * buf_dblwr->n_files;
+	} else {
+		buf_dblwr->s_first = srv_doublewrite_batch_size;
+		buf_dblwr->n_batches = 1;
+	}
+
+	buf_dblwr->batches = static_cast<buf_dblwr_batch_t*>(
+		mem_zalloc(buf_dblwr->n_batches * sizeof(buf_dblwr_batch_t)));
+
+	for (ulint i = 0; i < buf_dblwr->n_batches; i++) {
+		buf_dblwr_batch_t*	batch = &buf_dblwr->batches[i];
+
+		mutex_create(buf_dblwr_mutex_key,
+			     &batch->mutex, SYNC_DOUBLEWRITE);
+
+		batch->b_event = os_event_create();
+
+		if (buf_dblwr->n_files == 0) {
+			/* The only batch uses the first slots of the
+			system tablespace doublewrite buffer. */
+			batch->size = srv_doublewrite_batch_size;
+			batch->write_buf = buf_dblwr->write_buf;
+			batch->buf_block_arr = buf_dblwr->buf_block_arr;
+			continue;
+		}
+
+		/* Each doublewrite file holds the LRU batch followed
+		by the flush_list batch of its buffer pool instance. */
+		batch->size = srv_doublewrite_pages;
+
+		batch->write_buf_unaligned = static_cast<byte*>(
+			ut_malloc((1 + batch->size) * UNIV_PAGE_SIZE));
+
+		batch->write_buf = static_cast<byte*>(
+			ut_align(batch->write_buf_unaligned,
+				 UNIV_PAGE_SIZE));
+
+		batch->buf_block_arr = static_cast<buf_page_t**>(
+			mem_zalloc(batch->size * sizeof(void*)));
+
+		batch->file_name = buf_dblwr->file_names[i / 2];
+		batch->file = buf_dblwr->files[i / 2];
+		batch->file_offset = (os_offset_t) (i % 2) * batch->size
+			* UNIV_PAGE_SIZE;
+	}
+}
+
+/********************************************************************//**
+Gets the doublewrite batch used by the batch flushes of the given type
+in a buffer pool instance.
+@return doublewrite batch */
+UNIV_INLINE
+buf_dblwr_batch_t*
+buf_dblwr_get_batch(
+/*================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	buf_flush_t		flush_type)	/*!< in: BUF_FLUSH_LRU or
+						BUF_FLUSH_LIST */
+{
+	ulint	i;
+
+	ut_ad(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
+
+	if (buf_dblwr->n_files == 0) {
+		return(buf_dblwr->batches);
+	}
+
+	i = buf_pool_index(buf_pool) * 2 + flush_type;
+	ut_ad(i < buf_dblwr->n_batches);
+
+	return(&buf_dblwr->batches[i]);
 }
 
 /****************************************************************//**
@@ -346,6 +533,86 @@ start_again:
 	goto start_again;
 }
 
+/****************************************************************//**
+Reads the pages in the doublewrite files to memory and adds them to
+the pages restored from the doublewrite buffer. The files of all
+possible buffer pool instances are read, because the number of buffer
+pool instances may have changed since the server was killed. The
+buffer is freed together with the page list at the end of crash
+recovery. */
+static
+void
+buf_dblwr_load_files(void)
+/*======================*/
+{
+	os_file_t	files[MAX_BUFFER_POOLS];
+	ulint		n_pages[MAX_BUFFER_POOLS];
+	ulint		n_total = 0;
+	byte*		page;
+	recv_dblwr_t&	recv_dblwr = recv_sys->dblwr;
+
+	for (ulint i = 0; i < MAX_BUFFER_POOLS; i++) {
+		char		name[OS_FILE_MAX_PATH];
+		ibool		success;
+		os_offset_t	size;
+
+		buf_dblwr_file_name(name, sizeof(name), i);
+
+		n_pages[i] = ULINT_UNDEFINED;
+
+		files[i] = os_file_create_simple_no_error_handling(
+			innodb_file_data_key, name, OS_FILE_OPEN,
+			OS_FILE_READ_ONLY, &success);
+
+		if (!success) {
+			continue;
+		}
+
+		size = os_file_get_size(files[i]);
+
+		n_pages[i] = size == (os_offset_t) -1
+			? 0 : (ulint) (size / UNIV_PAGE_SIZE);
+
+		n_total += n_pages[i];
+	}
+
+	if (n_total == 0) {
+		page = NULL;
+	} else {
+		ut_ad(recv_dblwr.files_buf == NULL);
+
+		recv_dblwr.files_buf = static_cast<byte*>(
+			ut_malloc((1 + n_total) * UNIV_PAGE_SIZE));
+
+		page = static_cast<byte*>(
+			ut_align(recv_dblwr.files_buf, UNIV_PAGE_SIZE));
+	}
+
+	for (ulint i = 0; i < MAX_BUFFER_POOLS; i++) {
+
+		if (n_pages[i] == ULINT_UNDEFINED) {
+			continue;
+		}
+
+		if (n_pages[i] > 0
+		    && os_file_read(files[i], page, 0,
+				    n_pages[i] * UNIV_PAGE_SIZE)) {
+
+			for (ulint j = 0; j < n_pages[i]; j++) {
+				byte*	p = page + j * UNIV_PAGE_SIZE;
+
+				if (!buf_page_is_zeroes(p, 0)) {
+					recv_dblwr.add(p);
+				}
+			}
+		}
+
+		page += n_pages[i] * UNIV_PAGE_SIZE;
+
+		os_file_close(files[i]);
+	}
+}
+
 /****************************************************************//**
 At a database startup initializes the doublewrite buffer memory structure if
 we already have a doublewrite buffer created in the data files. If we are
@@ -464,6 +731,13 @@ buf_dblwr_init_or_load_pages(
 		os_file_flush(file);
 	}
 
+	if (load_corrupt_pages) {
+		/* The first page of a data file may have to be restored
+		before buf_dblwr_process() runs, so the copies in the
+		doublewrite files must be available as well. */
+		buf_dblwr_load_files();
+	}
+
 leave_func:
 	ut_free(unaligned_read_buf);
 }
@@ -516,6 +790,14 @@ buf_dblwr_process()
 			       zip_size ? zip_size : UNIV_PAGE_SIZE,
 			       read_buf, NULL);
 
+			if (buf_page_is_corrupted(true, read_buf, zip_size)
+			    || buf_page_is_zeroes(read_buf, zip_size)) {
+				/* The page may have been written in
+				several doublewrite batches: restore the
+				newest copy of it. */
+				page = recv_dblwr.find_page(space_id, page_no);
+			}
+
 			/* Check if the page is corrupt */
 
 			if (buf_page_is_corrupted(true, read_buf, zip_size)) {
@@ -606,9 +888,28 @@ buf_dblwr_free(void)
 	/* Free the double write data structures. */
 	ut_a(buf_dblwr != NULL);
 	ut_ad(buf_dblwr->s_reserved == 0);
-	ut_ad(buf_dblwr->b_reserved == 0);
 
-	os_event_free(buf_dblwr->b_event);
+	for (ulint i = 0; i < buf_dblwr->n_batches; i++) {
+		buf_dblwr_batch_t*	batch = &buf_dblwr->batches[i];
+
+		ut_ad(batch->b_reserved == 0);
+
+		os_event_free(batch->b_event);
+		mutex_free(&batch->mutex);
+
+		if (batch->write_buf_unaligned != NULL) {
+			ut_free(batch->write_buf_unaligned);
+			mem_free(batch->buf_block_arr);
+		}
+	}
+
+	mem_free(buf_dblwr->batches);
+	buf_dblwr->batches = NULL;
+
+	if (buf_dblwr->n_files > 0) {
+		buf_dblwr_files_close();
+	}
+
 	os_event_free(buf_dblwr->s_event);
 	ut_free(buf_dblwr->write_buf_unaligned);
 	buf_dblwr->write_buf_unaligned = NULL;
@@ -633,42 +934,51 @@ buf_dblwr_update(
 	const buf_page_t*	bpage,	/*!< in: buffer block descriptor */
 	buf_flush_t		flush_type)/*!< in: flush type */
 {
-	if (!srv_use_doublewrite_buf || buf_dblwr == NULL) {
+	if (!srv_use_doublewrite_buf || buf_dblwr == NULL
+	    || srv_use_atomic_writes) {
+		/* The page was not written through the doublewrite
+		buffer, see buf_flush_write_block_low(). */
 		return;
 	}
 
 	switch (flush_type) {
 	case BUF_FLUSH_LIST:
 	case BUF_FLUSH_LRU:
-		mutex_enter(&buf_dblwr->mutex);
+		{
+			buf_dblwr_batch_t*	batch = buf_dblwr_get_batch(
+				buf_pool_from_bpage(bpage), flush_type);
 
-		ut_ad(buf_dblwr->batch_running);
-		ut_ad(buf_dblwr->b_reserved > 0);
-		ut_ad(buf_dblwr->b_reserved <= buf_dblwr->first_free);
+			mutex_enter(&batch->mutex);
 
-		buf_dblwr->b_reserved--;
+			ut_ad(batch->batch_running);
+			ut_ad(batch->b_reserved > 0);
+			ut_ad(batch->b_reserved <= batch->first_free);
 
-		if (buf_dblwr->b_reserved == 0) {
-			mutex_exit(&buf_dblwr->mutex);
-			/* This will finish the batch. Sync data files
-			to the disk. */
-			fil_flush_file_spaces(FIL_TABLESPACE);
-			mutex_enter(&buf_dblwr->mutex);
+			batch->b_reserved--;
 
-			/* We can now reuse the doublewrite memory buffer: */
-			buf_dblwr->first_free = 0;
-			buf_dblwr->batch_running = false;
-			os_event_set(buf_dblwr->b_event);
-		}
+			if (batch->b_reserved == 0) {
+				mutex_exit(&batch->mutex);
+				/* This will finish the batch. Sync data
+				files to the disk. */
+				fil_flush_file_spaces(FIL_TABLESPACE);
+				mutex_enter(&batch->mutex);
 
-		mutex_exit(&buf_dblwr->mutex);
+				/* We can now reuse the doublewrite memory
+				buffer: */
+				batch->first_free = 0;
+				batch->batch_running = false;
+				os_event_set(batch->b_event);
+			}
+
+			mutex_exit(&batch->mutex);
+		}
 		break;
 	case BUF_FLUSH_SINGLE_PAGE:
 		{
 			const ulint size = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
 			ulint i;
 			mutex_enter(&buf_dblwr->mutex);
-			for (i = srv_doublewrite_batch_size; i < size; ++i) {
+			for (i = buf_dblwr->s_first; i < size; ++i) {
 				if (buf_dblwr->buf_block_arr[i] == bpage) {
 					buf_dblwr->s_reserved--;
 					buf_dblwr->buf_block_arr[i] = NULL;
@@ -814,6 +1124,61 @@ buf_dblwr_write_block_to_datafile(
 
 }
 
+/********************************************************************//**
+Writes the pages of a doublewrite batch to the doublewrite area on disk
+and syncs it. */
+static
+void
+buf_dblwr_write_batch(
+/*==================*/
+	const buf_dblwr_batch_t*	batch,		/*!< in: batch */
+	ulint				first_free)	/*!< in: number of
+							pages in the batch */
+{
+	ulint	len;
+
+	if (batch->file_name != NULL) {
+		/* Write the batch to its region of the doublewrite file
+		of the buffer pool instance. */
+		if (!os_file_write(batch->file_name, batch->file,
+				   batch->write_buf, batch->file_offset,
+				   first_free * UNIV_PAGE_SIZE)) {
+
+			ib_logf(IB_LOG_LEVEL_FATAL,
+				"Cannot write to the doublewrite file %s",
+				batch->file_name);
+		}
+
+		os_file_flush(batch->file);
+
+		return;
+	}
+
+	/* Write out the first block of the doublewrite buffer */
+	len = ut_min(TRX_SYS_DOUBLEWRITE_BLOCK_SIZE, first_free)
+		* UNIV_PAGE_SIZE;
+
+	fil_io(OS_FILE_WRITE, true, TRX_SYS_SPACE, 0,
+	       buf_dblwr->block1, 0, len,
+	       (void*) batch->write_buf, NULL);
+
+	if (first_free > TRX_SYS_DOUBLEWRITE_BLOCK_SIZE) {
+		/* Write out the second block of the doublewrite
+		buffer. */
+		len = (first_free - TRX_SYS_DOUBLEWRITE_BLOCK_SIZE)
+		       * UNIV_PAGE_SIZE;
+
+		fil_io(OS_FILE_WRITE, true, TRX_SYS_SPACE, 0,
+		       buf_dblwr->block2, 0, len,
+		       (void*) (batch->write_buf
+				+ TRX_SYS_DOUBLEWRITE_BLOCK_SIZE
+				* UNIV_PAGE_SIZE), NULL);
+	}
+
+	/* Now flush the doublewrite buffer data to disk */
+	fil_flush(TRX_SYS_SPACE);
+}
+
 /********************************************************************//**
 Flushes possible buffered writes from the doublewrite memory buffer to disk,
 and also wakes up the aio thread if simulated aio is used. It is very
@@ -822,12 +1187,16 @@ and also when we may have to wait for a page latch! Otherwise a deadlock
 of threads can occur. */
 UNIV_INTERN
 void
-buf_dblwr_flush_buffered_writes(void)
-/*=================================*/
+buf_dblwr_flush_buffered_writes(
+/*============================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance
+						whose batch to flush */
+	buf_flush_t		flush_type)	/*!< in: BUF_FLUSH_LRU or
+						BUF_FLUSH_LIST */
 {
-	byte*		write_buf;
-	ulint		first_free;
-	ulint		len;
+	buf_dblwr_batch_t*	batch;
+	byte*			write_buf;
+	ulint			first_free;
 
 	if (!srv_use_doublewrite_buf || buf_dblwr == NULL) {
 		/* Sync the writes to the disk. */
@@ -835,53 +1204,60 @@ buf_dblwr_flush_buffered_writes(void)
 		return;
 	}
 
+	batch = buf_dblwr_get_batch(buf_pool, flush_type);
+
 try_again:
-	mutex_enter(&buf_dblwr->mutex);
+	mutex_enter(&batch->mutex);
 
 	/* Write first to doublewrite buffer blocks. We use synchronous
 	aio and thus know that file write has been completed when the
 	control returns. */
 
-	if (buf_dblwr->first_free == 0) {
+	if (batch->first_free == 0) {
 
-		mutex_exit(&buf_dblwr->mutex);
+		mutex_exit(&batch->mutex);
+
+		/* Pages of tablespaces that are written atomically
+		may have been posted directly: wake the simulated aio
+		threads for them. */
+		os_aio_simulated_wake_handler_threads();
 
 		return;
 	}
 
-	if (buf_dblwr->batch_running) {
+	if (batch->batch_running) {
 		/* Another thread is running the batch right now. Wait
 		for it to finish. */
-		ib_int64_t	sig_count = os_event_reset(buf_dblwr->b_event);
-		mutex_exit(&buf_dblwr->mutex);
+		ib_int64_t	sig_count = os_event_reset(batch->b_event);
+		mutex_exit(&batch->mutex);
 
-		os_event_wait_low(buf_dblwr->b_event, sig_count);
+		os_event_wait_low(batch->b_event, sig_count);
 		goto try_again;
 	}
 
-	ut_a(!buf_dblwr->batch_running);
-	ut_ad(buf_dblwr->first_free == buf_dblwr->b_reserved);
+	ut_a(!batch->batch_running);
+	ut_ad(batch->first_free == batch->b_reserved);
 
 	/* Disallow anyone else to post to doublewrite buffer or to
 	start another batch of flushing. */
-	buf_dblwr->batch_running = true;
-	first_free = buf_dblwr->first_free;
+	batch->batch_running = true;
+	first_free = batch->first_free;
 
 	/* Now safe to release the mutex. Note that though no other
 	thread is allowed to post to the doublewrite batch flushing
 	but any threads working on single page flushes are allowed
 	to proceed. */
-	mutex_exit(&buf_dblwr->mutex);
+	mutex_exit(&batch->mutex);
 
-	write_buf = buf_dblwr->write_buf;
+	write_buf = batch->write_buf;
 
 	for (ulint len2 = 0, i = 0;
-	     i < buf_dblwr->first_free;
+	     i < first_free;
 	     len2 += UNIV_PAGE_SIZE, i++) {
 
 		const buf_block_t*	block;
 
-		block = (buf_block_t*) buf_dblwr->buf_block_arr[i];
+		block = (buf_block_t*) batch->buf_block_arr[i];
 
 		if (buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE
 		    || block->page.zip.data) {
@@ -899,57 +1275,31 @@ try_again:
 		buf_dblwr_check_page_lsn(write_buf + len2);
 	}
 
-	/* Write out the first block of the doublewrite buffer */
-	len = ut_min(TRX_SYS_DOUBLEWRITE_BLOCK_SIZE,
-		     buf_dblwr->first_free) * UNIV_PAGE_SIZE;
-
-	fil_io(OS_FILE_WRITE, true, TRX_SYS_SPACE, 0,
-	       buf_dblwr->block1, 0, len,
-	       (void*) write_buf, NULL);
-
-	if (buf_dblwr->first_free <= TRX_SYS_DOUBLEWRITE_BLOCK_SIZE) {
-		/* No unwritten pages in the second block. */
-		goto flush;
-	}
-
-	/* Write out the second block of the doublewrite buffer. */
-	len = (buf_dblwr->first_free - TRX_SYS_DOUBLEWRITE_BLOCK_SIZE)
-	       * UNIV_PAGE_SIZE;
-
-	write_buf = buf_dblwr->write_buf
-		    + TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE;
-
-	fil_io(OS_FILE_WRITE, true, TRX_SYS_SPACE, 0,
-	       buf_dblwr->block2, 0, len,
-	       (void*) write_buf, NULL);
+	buf_dblwr_write_batch(batch, first_free);
 
-flush:
 	/* increment the doublewrite flushed pages counter */
-	srv_stats.dblwr_pages_written.add(buf_dblwr->first_free);
+	srv_stats.dblwr_pages_written.add(first_free);
 	srv_stats.dblwr_writes.inc();
 
-	/* Now flush the doublewrite buffer data to disk */
-	fil_flush(TRX_SYS_SPACE);
-
 	/* We know that the writes have been flushed to disk now
 	and in recovery we will find them in the doublewrite buffer
 	blocks. Next do the writes to the intended positions. */
 
-	/* Up to this point first_free and buf_dblwr->first_free are
-	same because we have set the buf_dblwr->batch_running flag
+	/* Up to this point first_free and batch->first_free are
+	same because we have set the batch->batch_running flag
 	disallowing any other thread to post any request but we
-	can't safely access buf_dblwr->first_free in the loop below.
+	can't safely access batch->first_free in the loop below.
 	This is so because it is possible that after we are done with
 	the last iteration and before we terminate the loop, the batch
 	gets finished in the IO helper thread and another thread posts
-	a new batch setting buf_dblwr->first_free to a higher value.
-	If this happens and we are using buf_dblwr->first_free in the
+	a new batch setting batch->first_free to a higher value.
+	If this happens and we are using batch->first_free in the
 	loop termination condition then we'll end up dispatching
 	the same block twice from two different threads. */
-	ut_ad(first_free == buf_dblwr->first_free);
+	ut_ad(first_free == batch->first_free);
 	for (ulint i = 0; i < first_free; i++) {
 		buf_dblwr_write_block_to_datafile(
-			buf_dblwr->buf_block_arr[i], false);
+			batch->buf_block_arr[i], false);
 	}
 
 	/* Wake possible simulated aio thread to actually post the
@@ -969,34 +1319,39 @@ buf_dblwr_add_to_batch(
 /*====================*/
 	buf_page_t*	bpage)	/*!< in: buffer block to write */
 {
-	ulint	zip_size;
+	ulint			zip_size;
+	const buf_pool_t*	buf_pool = buf_pool_from_bpage(bpage);
+	buf_flush_t		flush_type = buf_page_get_flush_type(bpage);
+	buf_dblwr_batch_t*	batch;
 
 	ut_a(buf_page_in_file(bpage));
 
+	batch = buf_dblwr_get_batch(buf_pool, flush_type);
+
 try_again:
-	mutex_enter(&buf_dblwr->mutex);
+	mutex_enter(&batch->mutex);
 
-	ut_a(buf_dblwr->first_free <= srv_doublewrite_batch_size);
+	ut_a(batch->first_free <= batch->size);
 
-	if (buf_dblwr->batch_running) {
+	if (batch->batch_running) {
 
-		/* This not nearly as bad as it looks. There is only
-		page_cleaner thread which does background flushing
-		in batches therefore it is unlikely to be a contention
-		point. The only exception is when a user thread is
-		forced to do a flush batch because of a sync
-		checkpoint. */
-		ib_int64_t	sig_count = os_event_reset(buf_dblwr->b_event);
-		mutex_exit(&buf_dblwr->mutex);
+		/* This not nearly as bad as it looks. Every buffer
+		pool instance has its own batches, and only one
+		thread at a time runs a flush batch of a given type
+		in an instance. The only exception is when a user
+		thread is forced to do a flush batch because of a
+		sync checkpoint. */
+		ib_int64_t	sig_count = os_event_reset(batch->b_event);
+		mutex_exit(&batch->mutex);
 
-		os_event_wait_low(buf_dblwr->b_event, sig_count);
+		os_event_wait_low(batch->b_event, sig_count);
 		goto try_again;
 	}
 
-	if (buf_dblwr->first_free == srv_doublewrite_batch_size) {
-		mutex_exit(&(buf_dblwr->mutex));
+	if (batch->first_free == batch->size) {
+		mutex_exit(&batch->mutex);
 
-		buf_dblwr_flush_buffered_writes();
+		buf_dblwr_flush_buffered_writes(buf_pool, flush_type);
 
 		goto try_again;
 	}
@@ -1006,40 +1361,40 @@ try_again:
 	if (zip_size) {
 		UNIV_MEM_ASSERT_RW(bpage->zip.data, zip_size);
 		/* Copy the compressed page and clear the rest. */
-		memcpy(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free,
+		memcpy(batch->write_buf
+		       + UNIV_PAGE_SIZE * batch->first_free,
 		       bpage->zip.data, zip_size);
-		memset(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free
+		memset(batch->write_buf
+		       + UNIV_PAGE_SIZE * batch->first_free
 		       + zip_size, 0, UNIV_PAGE_SIZE - zip_size);
 	} else {
 		ut_a(buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE);
 		UNIV_MEM_ASSERT_RW(((buf_block_t*) bpage)->frame,
 				   UNIV_PAGE_SIZE);
 
-		memcpy(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free,
+		memcpy(batch->write_buf
+		       + UNIV_PAGE_SIZE * batch->first_free,
 		       ((buf_block_t*) bpage)->frame, UNIV_PAGE_SIZE);
 	}
 
-	buf_dblwr->buf_block_arr[buf_dblwr->first_free] = bpage;
+	batch->buf_block_arr[batch->first_free] = bpage;
 
-	buf_dblwr->first_free++;
-	buf_dblwr->b_reserved++;
+	batch->first_free++;
+	batch->b_reserved++;
 
-	ut_ad(!buf_dblwr->batch_running);
-	ut_ad(buf_dblwr->first_free == buf_dblwr->b_reserved);
-	ut_ad(buf_dblwr->b_reserved <= srv_doublewrite_batch_size);
+	ut_ad(!batch->batch_running);
+	ut_ad(batch->first_free == batch->b_reserved);
+	ut_ad(batch->b_reserved <= batch->size);
 
-	if (buf_dblwr->first_free == srv_doublewrite_batch_size) {
-		mutex_exit(&(buf_dblwr->mutex));
+	if (batch->first_free == batch->size) {
+		mutex_exit(&batch->mutex);
 
-		buf_dblwr_flush_buffered_writes();
+		buf_dblwr_flush_buffered_writes(buf_pool, flush_type);
 
 		return;
 	}
 
-	mutex_exit(&(buf_dblwr->mutex));
+	mutex_exit(&batch->mutex);
 }
 
 /********************************************************************//**
@@ -1068,11 +1423,10 @@ buf_dblwr_write_single_page(
 	ut_a(buf_dblwr != NULL);
 
 	/* total number of slots available for single page flushes
-	starts from srv_doublewrite_batch_size to the end of the
-	buffer. */
+	starts from buf_dblwr->s_first to the end of the buffer. */
 	size = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
-	ut_a(size > srv_doublewrite_batch_size);
-	n_slots = size - srv_doublewrite_batch_size;
+	ut_a(size > buf_dblwr->s_first);
+	n_slots = size - buf_dblwr->s_first;
 
 	if (buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE) {
 
@@ -1101,7 +1455,7 @@ retry:
 		goto retry;
 	}
 
-	for (i = srv_doublewrite_batch_size; i < size; ++i) {
+	for (i = buf_dblwr->s_first; i < size; ++i) {
 
 		if (!buf_dblwr->in_use[i]) {
 			break;
@@ -68,6 +68,14 @@ typedef ib_uint64_t	buf_dump_t;
 #define BUF_DUMP_SPACE(a)		((ulint) ((a) >> 32))
 #define BUF_DUMP_PAGE(a)		((ulint) ((a) & 0xFFFFFFFFUL))
 
+/* Number of pages read or created in the buffer pool(s) as of the last
+successful dump, or ULINT_UNDEFINED if there has been none */
+static ulint	buf_dump_n_pages_in = ULINT_UNDEFINED;
+
+/* Number of pages per read i/o thread that buf_load() submits before
+waking up the i/o threads */
+#define BUF_LOAD_BATCH_PER_THREAD	64
+
 /*****************************************************************//**
 Wakes up the buffer pool dump/load thread and instructs it to start
 a dump. This function is called by MySQL code via buffer_pool_dump_now()
@@ -167,27 +175,71 @@ buf_load_status(
 	va_end(ap);
 }
 
+/*****************************************************************//**
+Frees the copies of the LRU lists made by buf_dump(). */
+static
+void
+buf_dump_free(
+/*==========*/
+	buf_dump_t**	dumps,	/*!< in, own: copy of each LRU list,
+				or NULL */
+	ulint*		dumps_n)/*!< in, own: number of pages in
+				each copy */
+{
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		ut_free(dumps[i]);
+	}
+
+	ut_free(dumps);
+	ut_free(dumps_n);
+}
+
 /*****************************************************************//**
 Perform a buffer pool dump into the file specified by
 innodb_buffer_pool_filename. If any errors occur then the value of
 innodb_buffer_pool_dump_status will be set accordingly, see buf_dump_status().
 The dump filename can be specified by (relative to srv_data_home):
-SET GLOBAL innodb_buffer_pool_filename='filename'; */
+SET GLOBAL innodb_buffer_pool_filename='filename';
+The pages are listed from the hottest to the coldest, taking the pages of
+all buffer pool instances in turn, so that buf_load() can read the pages
+that matter most first. The file is synced to disk and then renamed over
+the previous dump, so that a crash leaves either dump complete. */
 static
 void
 buf_dump(
 /*=====*/
-	ibool	obey_shutdown)	/*!< in: quit if we are in a shutting down
+	ibool	obey_shutdown,	/*!< in: quit if we are in a shutting down
 				state */
+	ibool	periodic)	/*!< in: TRUE if this is a periodic dump
+				(innodb_buffer_pool_dump_interval), which
+				is skipped when no page has entered the
+				buffer pool since the previous dump */
 {
 #define SHOULD_QUIT()	(SHUTTING_DOWN() && obey_shutdown)
 
-	char	full_filename[OS_FILE_MAX_PATH];
-	char	tmp_filename[OS_FILE_MAX_PATH];
-	char	now[32];
-	FILE*	f;
-	ulint	i;
-	int	ret;
+	char		full_filename[OS_FILE_MAX_PATH];
+	char		tmp_filename[OS_FILE_MAX_PATH];
+	char		now[32];
+	FILE*		f;
+	buf_dump_t**	dumps;
+	ulint*		dumps_n;
+	ulint		max_n = 0;
+	ulint		total_n = 0;
+	ulint		written = 0;
+	ulint		n_pages_in;
+	buf_pool_stat_t	stat;
+	ulint		i;
+	ulint		j;
+	int		ret;
+
+	/* The buffer pool holds the same pages as at the previous dump
+	unless some page has been read or created since then. */
+	buf_get_total_stat(&stat);
+	n_pages_in = stat.n_pages_read + stat.n_pages_created;
+
+	if (periodic && n_pages_in == buf_dump_n_pages_in) {
+		return;
+	}
 
 	ut_snprintf(full_filename, sizeof(full_filename),
 		    "%s%c%s", srv_data_home, SRV_PATH_SEPARATOR,
@@ -196,8 +248,8 @@ buf_dump(
 	ut_snprintf(tmp_filename, sizeof(tmp_filename),
 		    "%s.incomplete", full_filename);
 
-	buf_dump_status(STATUS_NOTICE, "Dumping buffer pool(s) to %s",
-			full_filename);
+	buf_dump_status(periodic ? STATUS_INFO : STATUS_NOTICE,
+			"Dumping buffer pool(s) to %s", full_filename);
 
 	f = fopen(tmp_filename, "w");
 	if (f == NULL) {
@@ -208,13 +260,34 @@ buf_dump(
 	}
 	/* else */
 
-	/* walk through each buffer pool */
+	dumps = static_cast<buf_dump_t**>(
+		ut_malloc(srv_buf_pool_instances * sizeof(*dumps)));
+	dumps_n = static_cast<ulint*>(
+		ut_malloc(srv_buf_pool_instances * sizeof(*dumps_n)));
+
+	if (dumps == NULL || dumps_n == NULL) {
+		ut_free(dumps);
+		ut_free(dumps_n);
+		fclose(f);
+		buf_dump_status(STATUS_ERR,
+				"Cannot allocate " ULINTPF " bytes: %s",
+				(ulint) (srv_buf_pool_instances
+					 * (sizeof(*dumps) + sizeof(*dumps_n))),
+				strerror(errno));
+		/* leave tmp_filename to exist */
+		return;
+	}
+
+	memset(dumps, 0, srv_buf_pool_instances * sizeof(*dumps));
+	memset(dumps_n, 0, srv_buf_pool_instances * sizeof(*dumps_n));
+
+	/* copy the LRU list of each buffer pool, from the most recently
+	used page to the least recently used one */
 	for (i = 0; i < srv_buf_pool_instances && !SHOULD_QUIT(); i++) {
 		buf_pool_t*		buf_pool;
 		const buf_page_t*	bpage;
 		buf_dump_t*		dump;
 		ulint			n_pages;
-		ulint			j;
 
 		buf_pool = buf_pool_from_array(i);
 
@@ -235,6 +308,7 @@ buf_dump(
 
 		if (dump == NULL) {
 			buf_pool_mutex_exit(buf_pool);
+			buf_dump_free(dumps, dumps_n);
 			fclose(f);
 			buf_dump_status(STATUS_ERR,
 					"Cannot allocate " ULINTPF " bytes: %s",
@@ -244,9 +318,9 @@ buf_dump(
 			return;
 		}
 
-		for (bpage = UT_LIST_GET_LAST(buf_pool->LRU), j = 0;
+		for (bpage = UT_LIST_GET_FIRST(buf_pool->LRU), j = 0;
 		     bpage != NULL;
-		     bpage = UT_LIST_GET_PREV(LRU, bpage), j++) {
+		     bpage = UT_LIST_GET_NEXT(LRU, bpage), j++) {
 
 			ut_a(buf_page_in_file(bpage));
 
@@ -258,12 +332,25 @@ buf_dump(
 
 		buf_pool_mutex_exit(buf_pool);
 
-		for (j = 0; j < n_pages && !SHOULD_QUIT(); j++) {
+		dumps[i] = dump;
+		dumps_n[i] = n_pages;
+		max_n = ut_max(max_n, n_pages);
+		total_n += n_pages;
+	}
+
+	/* write the pages of the same rank in each buffer pool together */
+	for (j = 0; j < max_n && !SHOULD_QUIT(); j++) {
+		for (i = 0; i < srv_buf_pool_instances; i++) {
+
+			if (j >= dumps_n[i]) {
+				continue;
+			}
+
 			ret = fprintf(f, ULINTPF "," ULINTPF "\n",
-				      BUF_DUMP_SPACE(dump[j]),
-				      BUF_DUMP_PAGE(dump[j]));
+				      BUF_DUMP_SPACE(dumps[i][j]),
+				      BUF_DUMP_PAGE(dumps[i][j]));
 			if (ret < 0) {
-				ut_free(dump);
+				buf_dump_free(dumps, dumps_n);
 				fclose(f);
 				buf_dump_status(STATUS_ERR,
 						"Cannot write to '%s': %s",
@@ -272,20 +359,40 @@ buf_dump(
 				return;
 			}
 
-			if (j % 128 == 0) {
+			if (written++ % 128 == 0) {
 				buf_dump_status(
 					STATUS_INFO,
-					"Dumping buffer pool "
-					ULINTPF "/" ULINTPF ", "
+					"Dumping buffer pool(s), "
 					"page " ULINTPF "/" ULINTPF,
-					i + 1, srv_buf_pool_instances,
-					j + 1, n_pages);
+					written, total_n);
 			}
 		}
+	}
 
-		ut_free(dump);
+	buf_dump_free(dumps, dumps_n);
+
+	if (SHOULD_QUIT()) {
+		/* Keep the previous dump rather than replace it with an
+		incomplete one. */
+		fclose(f);
+		return;
 	}
 
+#ifdef __WIN__
+	ret = fflush(f) || _commit(_fileno(f));
+#else
+	ret = fflush(f) || fsync(fileno(f));
+#endif /* __WIN__ */
+	if (ret != 0) {
+		fclose(f);
+		buf_dump_status(STATUS_ERR,
+				"Cannot flush '%s': %s",
+				tmp_filename, strerror(errno));
+		/* leave tmp_filename to exist */
+		return;
+	}
+	/* else */
+
 	ret = fclose(f);
 	if (ret != 0) {
 		buf_dump_status(STATUS_ERR,
@@ -295,6 +402,9 @@ buf_dump(
 	}
 	/* else */
 
+	/* rename() replaces full_filename atomically, but on Windows it
+	fails if the target exists */
+#ifdef __WIN__
 	ret = unlink(full_filename);
 	if (ret != 0 && errno != ENOENT) {
 		buf_dump_status(STATUS_ERR,
@@ -304,6 +414,7 @@ buf_dump(
 		return;
 	}
 	/* else */
+#endif /* __WIN__ */
 
 	ret = rename(tmp_filename, full_filename);
 	if (ret != 0) {
@@ -318,15 +429,17 @@ buf_dump(
 
 	/* success */
 
+	buf_dump_n_pages_in = n_pages_in;
+
 	ut_sprintf_timestamp(now);
 
-	buf_dump_status(STATUS_NOTICE,
+	buf_dump_status(periodic ? STATUS_INFO : STATUS_NOTICE,
 			"Buffer pool(s) dump completed at %s", now);
 }
 
 /*****************************************************************//**
-Compare two buffer pool dump entries, used to sort the dump on
-space_no,page_no before loading in order to increase the chance for
+Compare two buffer pool dump entries, used to sort each batch of the dump
+on space_no,page_no before loading in order to increase the chance for
 sequential IO.
 @return -1/0/1 if entry 1 is smaller/equal/bigger than entry 2 */
 static
@@ -365,7 +478,9 @@ Perform a buffer pool load from the file specified by
 innodb_buffer_pool_filename. If any errors occur then the value of
 innodb_buffer_pool_load_status will be set accordingly, see buf_load_status().
 The dump filename can be specified by (relative to srv_data_home):
-SET GLOBAL innodb_buffer_pool_filename='filename'; */
+SET GLOBAL innodb_buffer_pool_filename='filename';
+The pages are read in the order of the dump, hottest first, in batches of
+asynchronous reads that keep all the read i/o threads busy. */
 static
 void
 buf_load()
@@ -378,7 +493,10 @@ buf_load()
 	buf_dump_t*	dump_tmp;
 	ulint		dump_n;
 	ulint		total_buffer_pools_pages;
+	ulint		batch_size;
+	ulint		batch_n;
 	ulint		i;
+	ulint		j;
 	ulint		space_id;
 	ulint		page_no;
 	int		fscanf_ret;
@@ -427,8 +545,9 @@ buf_load()
 	}
 
 	/* If dump is larger than the buffer pool(s), then we ignore the
-	extra trailing. This could happen if a dump is made, then buffer
-	pool is shrunk and then load it attempted. */
+	extra trailing, which holds the coldest pages. This could happen
+	if a dump is made, then buffer pool is shrunk and then load it
+	attempted. */
 	total_buffer_pools_pages = buf_pool_get_n_pages()
 		* srv_buf_pool_instances;
 	if (dump_n > total_buffer_pools_pages) {
@@ -446,15 +565,18 @@ buf_load()
 		return;
 	}
 
+	batch_size = ut_min(dump_n,
+			    srv_n_read_io_threads * BUF_LOAD_BATCH_PER_THREAD);
+
 	dump_tmp = static_cast<buf_dump_t*>(
-		ut_malloc(dump_n * sizeof(*dump_tmp)));
+		ut_malloc(batch_size * sizeof(*dump_tmp)));
 
 	if (dump_tmp == NULL) {
 		ut_free(dump);
 		fclose(f);
 		buf_load_status(STATUS_ERR,
 				"Cannot allocate " ULINTPF " bytes: %s",
-				(ulint) (dump_n * sizeof(*dump_tmp)),
+				(ulint) (batch_size * sizeof(*dump_tmp)),
 				strerror(errno));
 		return;
 	}
@@ -508,6 +630,7 @@ buf_load()
 
 	if (dump_n == 0) {
 		ut_free(dump);
+		ut_free(dump_tmp);
 		ut_sprintf_timestamp(now);
 		buf_load_status(STATUS_NOTICE,
 				"Buffer pool(s) load completed at %s "
@@ -515,30 +638,35 @@ buf_load()
 		return;
 	}
 
-	if (!SHUTTING_DOWN()) {
-		buf_dump_sort(dump, dump_tmp, 0, dump_n);
-	}
-
-	ut_free(dump_tmp);
+	/* The dump lists the hottest pages first. Submit the reads in
+	that order, one batch at a time, so that the pages that matter most
+	are the first to arrive. Within a batch, read the pages in the
+	order of space_no,page_no, which makes neighbouring pages go to the
+	same i/o thread one after the other, and the pages of different
+	extents to all the i/o threads. */
+	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i += batch_n) {
 
-	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i++) {
+		batch_n = ut_min(batch_size, dump_n - i);
 
-		buf_read_page_async(BUF_DUMP_SPACE(dump[i]),
-				    BUF_DUMP_PAGE(dump[i]));
+		buf_dump_sort(dump + i, dump_tmp, 0, batch_n);
 
-		if (i % 64 == 63) {
-			os_aio_simulated_wake_handler_threads();
+		for (j = i; j < i + batch_n; j++) {
+			buf_read_page_async(BUF_DUMP_SPACE(dump[j]),
+					    BUF_DUMP_PAGE(dump[j]));
 		}
 
-		if (i % 128 == 0) {
-			buf_load_status(STATUS_INFO,
-					"Loaded " ULINTPF "/" ULINTPF " pages",
-					i + 1, dump_n);
-		}
+		/* In simulated aio, wake up the i/o threads now that
+		the whole batch is queued */
+		os_aio_simulated_wake_handler_threads();
+
+		buf_load_status(STATUS_INFO,
+				"Loaded " ULINTPF "/" ULINTPF " pages",
+				i + batch_n, dump_n);
 
 		if (buf_load_abort_flag) {
 			buf_load_abort_flag = FALSE;
 			ut_free(dump);
+			ut_free(dump_tmp);
 			buf_load_status(
 				STATUS_NOTICE,
 				"Buffer pool(s) load aborted on request");
@@ -546,6 +674,7 @@ buf_load()
 		}
 	}
 
+	ut_free(dump_tmp);
 	ut_free(dump);
 
 	ut_sprintf_timestamp(now);
@@ -591,11 +720,19 @@ DECLARE_THREAD(buf_dump_thread)(
 
 	while (!SHUTTING_DOWN()) {
 
-		os_event_wait(srv_buf_dump_event);
+		if (srv_buf_dump_interval == 0) {
+			os_event_wait(srv_buf_dump_event);
+		} else if (os_event_wait_time(
+				   srv_buf_dump_event,
+				   (ulint) srv_buf_dump_interval * 1000000)
+			   == OS_SYNC_TIME_EXCEEDED) {
+			buf_dump(TRUE /* quit on shutdown */,
+				 TRUE /* periodic */);
+		}
 
 		if (buf_dump_should_start) {
 			buf_dump_should_start = FALSE;
-			buf_dump(TRUE /* quit on shutdown */);
+			buf_dump(TRUE /* quit on shutdown */, FALSE);
 		}
 
 		if (buf_load_should_start) {
@@ -608,7 +745,7 @@ DECLARE_THREAD(buf_dump_thread)(
 
 	if (srv_buffer_pool_dump_at_shutdown && srv_fast_shutdown != 2) {
 		buf_dump(FALSE /* ignore shutdown down flag,
-		keep going even if we are in a shutdown state */);
+		keep going even if we are in a shutdown state */, FALSE);
 	}
 
 	srv_buf_dump_thread_active = FALSE;
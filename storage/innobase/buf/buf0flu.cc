@@ -73,6 +73,103 @@ the blocks on free list. If LRU list is very small then we can end up
 in thrashing. */
 #define BUF_LRU_MIN_LEN		256
 
+#ifdef UNIV_PFS_THREAD
+UNIV_INTERN mysql_pfs_key_t buf_page_cleaner_worker_thread_key;
+#endif /* UNIV_PFS_THREAD */
+
+#ifdef UNIV_PFS_MUTEX
+UNIV_INTERN mysql_pfs_key_t page_cleaner_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
+/** State of a page cleaner slot. A slot is assigned to each buffer
+pool instance and goes through the states below once per flush round
+requested by the page cleaner coordinator. */
+enum page_cleaner_state_t {
+	PAGE_CLEANER_STATE_NONE = 0,	/*!< no request made yet */
+	PAGE_CLEANER_STATE_REQUESTED,	/*!< flushing of the instance
+					has been requested */
+	PAGE_CLEANER_STATE_FLUSHING,	/*!< a page cleaner thread is
+					flushing the instance */
+	PAGE_CLEANER_STATE_FINISHED	/*!< flushing of the instance
+					is finished */
+};
+
+/** Page cleaner request and result for one buffer pool instance */
+struct page_cleaner_slot_t {
+	page_cleaner_state_t	state;	/*!< state of the request.
+					protected by page_cleaner_t::mutex */
+	ulint			n_pages_requested;
+					/*!< number of flush_list pages
+					requested for this instance */
+	ulint			n_flushed_lru;
+					/*!< number of pages flushed from
+					the LRU list in the last round */
+	ulint			n_flushed_list;
+					/*!< number of pages flushed from
+					the flush_list in the last round */
+	bool			succeeded_list;
+					/*!< true if the flush_list batch
+					could be started */
+	ulint			flush_lru_time;
+					/*!< accumulated time (ms) spent
+					on LRU flushing */
+	ulint			flush_list_time;
+					/*!< accumulated time (ms) spent
+					on flush_list flushing */
+	ulint			flush_lru_pass;
+					/*!< number of LRU flush passes */
+	ulint			flush_list_pass;
+					/*!< number of flush_list passes */
+};
+
+/** Page cleaner state shared by the coordinator and the workers */
+struct page_cleaner_t {
+	ib_mutex_t		mutex;		/*!< mutex to protect
+						the fields below and the
+						slot states */
+	os_event_t		is_requested;	/*!< set when the
+						coordinator has requested
+						a flush round */
+	os_event_t		is_finished;	/*!< set when all slots
+						of the round are finished */
+	volatile ulint		n_workers;	/*!< number of worker
+						threads in existence */
+	bool			requested;	/*!< true if flush_list
+						flushing was requested in
+						this round */
+	lsn_t			lsn_limit;	/*!< upper limit of LSN to
+						be flushed from flush_list */
+	ulint			n_slots;	/*!< total number of slots,
+						equal to the number of
+						buffer pool instances */
+	ulint			n_slots_requested;
+						/*!< number of slots in
+						the state
+						PAGE_CLEANER_STATE_REQUESTED */
+	ulint			n_slots_flushing;
+						/*!< number of slots in
+						the state
+						PAGE_CLEANER_STATE_FLUSHING */
+	ulint			n_slots_finished;
+						/*!< number of slots in
+						the state
+						PAGE_CLEANER_STATE_FINISHED */
+	ulint			flush_time;	/*!< accumulated time (ms)
+						of the flush rounds */
+	ulint			flush_pass;	/*!< number of flush
+						rounds */
+	ulint			wait_time;	/*!< accumulated time (ms)
+						the coordinator waited for
+						the workers */
+	page_cleaner_slot_t*	slots;		/*!< one slot per buffer
+						pool instance */
+	bool			is_running;	/*!< false when the
+						workers must exit */
+};
+
+/** The page cleaner state, created by buf_flush_page_cleaner_init() */
+static page_cleaner_t*	page_cleaner = NULL;
+
 /* @} */
 
 /******************************************************************//**
@@ -953,7 +1050,7 @@ buf_flush_write_block_low(
 		break;
 	}
 
-	if (!srv_use_doublewrite_buf || !buf_dblwr) {
+	if (!srv_use_doublewrite_buf || !buf_dblwr || srv_use_atomic_writes) {
 		fil_io(OS_FILE_WRITE | OS_AIO_SIMULATED_WAKE_LATER,
 		       sync, buf_page_get_space(bpage), zip_size,
 		       buf_page_get_page_no(bpage), 0,
@@ -1061,7 +1158,7 @@ buf_flush_page(
 			/* avoiding deadlock possibility involves doublewrite
 			buffer, should flush it, because it might hold the
 			another block->lock. */
-			buf_dblwr_flush_buffered_writes();
+			buf_dblwr_flush_buffered_writes(buf_pool, flush_type);
 
 			rw_lock_s_lock_gen(rw_lock, BUF_IO_WRITE);
                 }
@@ -1395,7 +1492,8 @@ buf_free_from_unzip_LRU_list_batch(
 	block = UT_LIST_GET_LAST(buf_pool->unzip_LRU);
 	while (block != NULL && count < max
 	       && free_len < srv_LRU_scan_depth
-	       && lru_len > UT_LIST_GET_LEN(buf_pool->LRU) / 10) {
+	       && (lru_len > UT_LIST_GET_LEN(buf_pool->LRU) / 10
+		   || buf_LRU_unzip_over_budget(buf_pool))) {
 
 		++scanned;
 		if (buf_LRU_free_page(&block->page, false)) {
@@ -1727,10 +1825,12 @@ static
 void
 buf_flush_common(
 /*=============*/
-	buf_flush_t	flush_type,	/*!< in: type of flush */
-	ulint		page_count)	/*!< in: number of pages flushed */
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	buf_flush_t		flush_type,	/*!< in: type of flush */
+	ulint			page_count)	/*!< in: number of pages
+						flushed */
 {
-	buf_dblwr_flush_buffered_writes();
+	buf_dblwr_flush_buffered_writes(buf_pool, flush_type);
 
 	ut_a(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
 
@@ -1865,7 +1965,7 @@ buf_flush_LRU(
 
 	buf_flush_end(buf_pool, BUF_FLUSH_LRU);
 
-	buf_flush_common(BUF_FLUSH_LRU, page_count);
+	buf_flush_common(buf_pool, BUF_FLUSH_LRU, page_count);
 
 	if (n_processed) {
 		*n_processed = page_count;
@@ -1874,6 +1974,55 @@ buf_flush_LRU(
 	return(true);
 }
 
+/*******************************************************************//**
+This utility flushes dirty blocks from the end of the flush list of
+a single buffer pool instance.
+NOTE: The calling thread is not allowed to own any latches on pages!
+@return true if a batch was queued successfully. false if another batch
+of same type was already running in the buffer pool instance */
+static
+bool
+buf_flush_list_instance(
+/*====================*/
+	buf_pool_t*	buf_pool,	/*!< in/out: buffer pool instance */
+	ulint		min_n,		/*!< in: wished minimum mumber of blocks
+					flushed (it is not guaranteed that the
+					actual number is that big, though) */
+	lsn_t		lsn_limit,	/*!< in: all blocks whose
+					oldest_modification is smaller than
+					this should be flushed (if their number
+					does not exceed min_n) */
+	ulint*		n_processed)	/*!< out: the number of pages
+					which were processed */
+{
+	ulint	page_count;
+
+	*n_processed = 0;
+
+	if (!buf_flush_start(buf_pool, BUF_FLUSH_LIST)) {
+		return(false);
+	}
+
+	page_count = buf_flush_batch(
+		buf_pool, BUF_FLUSH_LIST, min_n, lsn_limit);
+
+	buf_flush_end(buf_pool, BUF_FLUSH_LIST);
+
+	buf_flush_common(buf_pool, BUF_FLUSH_LIST, page_count);
+
+	*n_processed = page_count;
+
+	if (page_count) {
+		MONITOR_INC_VALUE_CUMULATIVE(
+			MONITOR_FLUSH_BATCH_TOTAL_PAGE,
+			MONITOR_FLUSH_BATCH_COUNT,
+			MONITOR_FLUSH_BATCH_PAGES,
+			page_count);
+	}
+
+	return(true);
+}
+
 /*******************************************************************//**
 This utility flushes dirty blocks from the end of the flush list of
 all buffer pool instances.
@@ -1916,12 +2065,10 @@ buf_flush_list(
 
 	/* Flush to lsn_limit in all buffer pool instances */
 	for (i = 0; i < srv_buf_pool_instances; i++) {
-		buf_pool_t*	buf_pool;
-		ulint		page_count = 0;
+		ulint	page_count = 0;
 
-		buf_pool = buf_pool_from_array(i);
-
-		if (!buf_flush_start(buf_pool, BUF_FLUSH_LIST)) {
+		if (!buf_flush_list_instance(buf_pool_from_array(i),
+					     min_n, lsn_limit, &page_count)) {
 			/* We have two choices here. If lsn_limit was
 			specified then skipping an instance of buffer
 			pool means we cannot guarantee that all pages
@@ -1937,24 +2084,9 @@ buf_flush_list(
 			continue;
 		}
 
-		page_count = buf_flush_batch(
-			buf_pool, BUF_FLUSH_LIST, min_n, lsn_limit);
-
-		buf_flush_end(buf_pool, BUF_FLUSH_LIST);
-
-		buf_flush_common(BUF_FLUSH_LIST, page_count);
-
 		if (n_processed) {
 			*n_processed += page_count;
 		}
-
-		if (page_count) {
-			MONITOR_INC_VALUE_CUMULATIVE(
-				MONITOR_FLUSH_BATCH_TOTAL_PAGE,
-				MONITOR_FLUSH_BATCH_COUNT,
-				MONITOR_FLUSH_BATCH_PAGES,
-				page_count);
-		}
 	}
 
 	return(success);
@@ -2057,6 +2189,64 @@ buf_flush_single_page_from_LRU(
 	return(freed);
 }
 
+/*********************************************************************//**
+Clears up tail of the LRU list of a single buffer pool instance:
+* Put replaceable pages at the tail of LRU to the free list
+* Flush dirty pages at the tail of LRU to the disk
+The depth to which we scan the buffer pool is controlled by dynamic
+config parameter innodb_LRU_scan_depth.
+@return number of pages flushed */
+static
+ulint
+buf_flush_LRU_list(
+/*===============*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
+{
+	ulint	total_flushed = 0;
+	ulint	scan_depth;
+
+	/* srv_LRU_scan_depth can be arbitrarily large value.
+	We cap it with current LRU size. */
+	buf_pool_mutex_enter(buf_pool);
+	scan_depth = UT_LIST_GET_LEN(buf_pool->LRU);
+	buf_pool_mutex_exit(buf_pool);
+
+	scan_depth = ut_min(srv_LRU_scan_depth, scan_depth);
+
+	/* We divide LRU flush into smaller chunks because
+	there may be user threads waiting for the flush to
+	end in buf_LRU_get_free_block(). */
+	for (ulint j = 0;
+	     j < scan_depth;
+	     j += PAGE_CLEANER_LRU_BATCH_CHUNK_SIZE) {
+
+		ulint	n_flushed = 0;
+
+		/* Currently page_cleaner is the only thread
+		that can trigger an LRU flush. It is possible
+		that a batch triggered during last iteration is
+		still running, */
+		if (buf_flush_LRU(buf_pool,
+				  PAGE_CLEANER_LRU_BATCH_CHUNK_SIZE,
+				  &n_flushed)) {
+
+			/* Allowed only one batch per
+			buffer pool instance. */
+			buf_flush_wait_batch_end(
+				buf_pool, BUF_FLUSH_LRU);
+		}
+
+		if (n_flushed) {
+			total_flushed += n_flushed;
+		} else {
+			/* Nothing to flush */
+			break;
+		}
+	}
+
+	return(total_flushed);
+}
+
 /*********************************************************************//**
 Clears up tail of the LRU lists:
 * Put replaceable pages at the tail of LRU to the free list
@@ -2073,47 +2263,7 @@ buf_flush_LRU_tail(void)
 
 	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
 
-		buf_pool_t*	buf_pool = buf_pool_from_array(i);
-		ulint		scan_depth;
-
-		/* srv_LRU_scan_depth can be arbitrarily large value.
-		We cap it with current LRU size. */
-		buf_pool_mutex_enter(buf_pool);
-		scan_depth = UT_LIST_GET_LEN(buf_pool->LRU);
-		buf_pool_mutex_exit(buf_pool);
-
-		scan_depth = ut_min(srv_LRU_scan_depth, scan_depth);
-
-		/* We divide LRU flush into smaller chunks because
-		there may be user threads waiting for the flush to
-		end in buf_LRU_get_free_block(). */
-		for (ulint j = 0;
-		     j < scan_depth;
-		     j += PAGE_CLEANER_LRU_BATCH_CHUNK_SIZE) {
-
-			ulint	n_flushed = 0;
-
-			/* Currently page_cleaner is the only thread
-			that can trigger an LRU flush. It is possible
-			that a batch triggered during last iteration is
-			still running, */
-			if (buf_flush_LRU(buf_pool,
-					  PAGE_CLEANER_LRU_BATCH_CHUNK_SIZE,
-					  &n_flushed)) {
-
-				/* Allowed only one batch per
-				buffer pool instance. */
-				buf_flush_wait_batch_end(
-					buf_pool, BUF_FLUSH_LRU);
-			}
-
-			if (n_flushed) {
-				total_flushed += n_flushed;
-			} else {
-				/* Nothing to flush */
-				break;
-			}
-		}
+		total_flushed += buf_flush_LRU_list(buf_pool_from_array(i));
 	}
 
 	if (total_flushed) {
@@ -2152,26 +2302,6 @@ buf_flush_wait_LRU_batch_end(void)
 	}
 }
 
-/*********************************************************************//**
-Flush a batch of dirty pages from the flush list
-@return number of pages flushed, 0 if no page is flushed or if another
-flush_list type batch is running */
-static
-ulint
-page_cleaner_do_flush_batch(
-/*========================*/
-	ulint		n_to_flush,	/*!< in: number of pages that
-					we should attempt to flush. */
-	lsn_t		lsn_limit)	/*!< in: LSN up to which flushing
-					must happen */
-{
-	ulint n_flushed;
-
-	buf_flush_list(n_to_flush, lsn_limit, &n_flushed);
-
-	return(n_flushed);
-}
-
 /*********************************************************************//**
 Calculates if flushing is required based on number of dirty pages in
 the buffer pool.
@@ -2250,20 +2380,23 @@ af_get_pct_for_lsn(
 
 /*********************************************************************//**
 This function is called approximately once every second by the
-page_cleaner thread. Based on various factors it decides if there is a
-need to do flushing. If flushing is needed it is performed and the
-number of pages flushed is returned.
-@return number of pages flushed */
+page_cleaner coordinator. Based on various factors it decides if there
+is a need to do flushing and how many pages should be flushed from the
+flush_list by the page cleaner threads in this round.
+@return number of pages recommended to be flushed */
 static
 ulint
-page_cleaner_flush_pages_if_needed(void)
+page_cleaner_flush_pages_recommendation(
 /*====================================*/
+	lsn_t*	lsn_limit,	/*!< out: LSN up to which the flush_list
+				should be flushed */
+	ulint	last_pages_in)	/*!< in: number of pages flushed in the
+				last adaptive flushing round */
 {
 	static	lsn_t		lsn_avg_rate = 0;
 	static	lsn_t		prev_lsn = 0;
 	static	lsn_t		last_lsn = 0;
 	static	ulint		sum_pages = 0;
-	static	ulint		last_pages = 0;
 	static	ulint		prev_pages = 0;
 	static	ulint		avg_page_rate = 0;
 	static	ulint		n_iterations = 0;
@@ -2277,6 +2410,8 @@ page_cleaner_flush_pages_if_needed(void)
 	ulint			pct_total = 0;
 	int			age_factor = 0;
 
+	sum_pages += last_pages_in;
+
 	cur_lsn = log_get_lsn();
 
 	if (prev_lsn == 0) {
@@ -2301,6 +2436,68 @@ page_cleaner_flush_pages_if_needed(void)
 
 		lsn_avg_rate = (lsn_avg_rate + lsn_rate) / 2;
 
+		/* Aggregate the timing statistics of the page cleaner
+		threads over the averaging period. */
+		mutex_enter(&page_cleaner->mutex);
+
+		ulint	flush_tm = page_cleaner->flush_time;
+		ulint	flush_pass = page_cleaner->flush_pass;
+		ulint	wait_tm = page_cleaner->wait_time;
+
+		page_cleaner->flush_time = 0;
+		page_cleaner->flush_pass = 0;
+		page_cleaner->wait_time = 0;
+
+		ulint	lru_tm = 0;
+		ulint	list_tm = 0;
+		ulint	lru_pass = 0;
+		ulint	list_pass = 0;
+
+		for (ulint i = 0; i < page_cleaner->n_slots; i++) {
+			page_cleaner_slot_t*	slot;
+
+			slot = &page_cleaner->slots[i];
+
+			lru_tm    += slot->flush_lru_time;
+			lru_pass  += slot->flush_lru_pass;
+			list_tm   += slot->flush_list_time;
+			list_pass += slot->flush_list_pass;
+
+			slot->flush_lru_time  = 0;
+			slot->flush_lru_pass  = 0;
+			slot->flush_list_time = 0;
+			slot->flush_list_pass = 0;
+		}
+
+		mutex_exit(&page_cleaner->mutex);
+
+		/* Minimum values are 1, to avoid dividing by zero. */
+		lru_tm = ut_max(lru_tm, 1);
+		list_tm = ut_max(list_tm, 1);
+		flush_tm = ut_max(flush_tm, 1);
+		lru_pass = ut_max(lru_pass, 1);
+		list_pass = ut_max(list_pass, 1);
+		flush_pass = ut_max(flush_pass, 1);
+
+		MONITOR_SET(MONITOR_FLUSH_ADAPTIVE_AVG_TIME_SLOT,
+			    list_tm / list_pass);
+		MONITOR_SET(MONITOR_LRU_BATCH_FLUSH_AVG_TIME_SLOT,
+			    lru_tm / lru_pass);
+
+		MONITOR_SET(MONITOR_FLUSH_ADAPTIVE_AVG_TIME_THREAD,
+			    list_tm / (srv_n_page_cleaners * flush_pass));
+		MONITOR_SET(MONITOR_LRU_BATCH_FLUSH_AVG_TIME_THREAD,
+			    lru_tm / (srv_n_page_cleaners * flush_pass));
+
+		MONITOR_SET(MONITOR_FLUSH_AVG_TIME, flush_tm / flush_pass);
+		MONITOR_SET(MONITOR_FLUSH_AVG_WAIT_TIME, wait_tm / flush_pass);
+
+		MONITOR_SET(MONITOR_FLUSH_ADAPTIVE_AVG_PASS,
+			    list_pass / page_cleaner->n_slots);
+		MONITOR_SET(MONITOR_LRU_BATCH_FLUSH_AVG_PASS,
+			    lru_pass / page_cleaner->n_slots);
+		MONITOR_SET(MONITOR_FLUSH_AVG_PASS, flush_pass);
+
 		prev_lsn = cur_lsn;
 
 		n_iterations = 0;
@@ -2327,34 +2524,23 @@ page_cleaner_flush_pages_if_needed(void)
 		n_pages = srv_max_io_capacity;
 	}
 
-	if (last_pages && cur_lsn - last_lsn > lsn_avg_rate / 2) {
-		age_factor = static_cast<int>(prev_pages / last_pages);
+	if (last_pages_in && cur_lsn - last_lsn > lsn_avg_rate / 2) {
+		age_factor = static_cast<int>(prev_pages / last_pages_in);
 	}
 
 	MONITOR_SET(MONITOR_FLUSH_N_TO_FLUSH_REQUESTED, n_pages);
 
 	prev_pages = n_pages;
-	n_pages = page_cleaner_do_flush_batch(
-		n_pages, oldest_lsn + lsn_avg_rate * (age_factor + 1));
 
-	last_lsn= cur_lsn;
-	last_pages= n_pages + 1;
+	*lsn_limit = oldest_lsn + lsn_avg_rate * (age_factor + 1);
+
+	last_lsn = cur_lsn;
 
 	MONITOR_SET(MONITOR_FLUSH_AVG_PAGE_RATE, avg_page_rate);
 	MONITOR_SET(MONITOR_FLUSH_LSN_AVG_RATE, lsn_avg_rate);
 	MONITOR_SET(MONITOR_FLUSH_PCT_FOR_DIRTY, pct_for_dirty);
 	MONITOR_SET(MONITOR_FLUSH_PCT_FOR_LSN, pct_for_lsn);
 
-	if (n_pages) {
-		MONITOR_INC_VALUE_CUMULATIVE(
-			MONITOR_FLUSH_ADAPTIVE_TOTAL_PAGE,
-			MONITOR_FLUSH_ADAPTIVE_COUNT,
-			MONITOR_FLUSH_ADAPTIVE_PAGES,
-			n_pages);
-
-		sum_pages += n_pages;
-	}
-
 	return(n_pages);
 }
 
@@ -2381,19 +2567,336 @@ page_cleaner_sleep_if_needed(
 }
 
 /******************************************************************//**
-page_cleaner thread tasked with flushing dirty pages from the buffer
-pools. As of now we'll have only one instance of this thread.
+Initialize the page cleaner state shared by the coordinator and the
+worker threads. Must be called before the page cleaner threads are
+created. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_init(void)
+/*=============================*/
+{
+	ut_ad(page_cleaner == NULL);
+
+	page_cleaner = static_cast<page_cleaner_t*>(
+		mem_zalloc(sizeof(*page_cleaner)));
+
+	mutex_create(page_cleaner_mutex_key,
+		     &page_cleaner->mutex, SYNC_PAGE_CLEANER);
+
+	page_cleaner->is_requested = os_event_create();
+	page_cleaner->is_finished = os_event_create();
+
+	page_cleaner->n_slots = srv_buf_pool_instances;
+
+	page_cleaner->slots = static_cast<page_cleaner_slot_t*>(
+		mem_zalloc(page_cleaner->n_slots
+			   * sizeof(*page_cleaner->slots)));
+
+	page_cleaner->is_running = true;
+}
+
+/******************************************************************//**
+Free the page cleaner state. Called by the coordinator after all the
+worker threads have exited. */
+static
+void
+buf_flush_page_cleaner_close(void)
+/*==============================*/
+{
+	ut_ad(page_cleaner->n_workers == 0);
+
+	mutex_free(&page_cleaner->mutex);
+
+	os_event_free(page_cleaner->is_finished);
+	os_event_free(page_cleaner->is_requested);
+
+	mem_free(page_cleaner->slots);
+	mem_free(page_cleaner);
+
+	page_cleaner = NULL;
+}
+
+/******************************************************************//**
+Requests a flush round from the page cleaner threads. Every buffer
+pool instance gets one slot: the LRU tail of each instance is always
+cleaned, and the flush_list is flushed if min_n is non-zero. */
+static
+void
+pc_request(
+/*=======*/
+	ulint		min_n,		/*!< in: wished minimum number of
+					blocks flushed from the flush_list
+					of all instances together */
+	lsn_t		lsn_limit)	/*!< in: all blocks whose
+					oldest_modification is smaller than
+					this should be flushed */
+{
+	if (min_n != ULINT_MAX) {
+		/* Ensure that flushing is spread evenly amongst the
+		buffer pool instances. When min_n is ULINT_MAX
+		we need to flush everything up to the lsn limit
+		so no limit here. */
+		min_n = (min_n + srv_buf_pool_instances - 1)
+			/ srv_buf_pool_instances;
+	}
+
+	mutex_enter(&page_cleaner->mutex);
+
+	ut_ad(page_cleaner->n_slots_requested == 0);
+	ut_ad(page_cleaner->n_slots_flushing == 0);
+
+	page_cleaner->requested = (min_n > 0);
+	page_cleaner->lsn_limit = lsn_limit;
+
+	for (ulint i = 0; i < page_cleaner->n_slots; i++) {
+		page_cleaner_slot_t*	slot = &page_cleaner->slots[i];
+
+		ut_ad(slot->state == PAGE_CLEANER_STATE_NONE
+		      || slot->state == PAGE_CLEANER_STATE_FINISHED);
+
+		slot->state = PAGE_CLEANER_STATE_REQUESTED;
+		slot->n_pages_requested = min_n;
+	}
+
+	page_cleaner->n_slots_requested = page_cleaner->n_slots;
+	page_cleaner->n_slots_flushing = 0;
+	page_cleaner->n_slots_finished = 0;
+
+	os_event_reset(page_cleaner->is_finished);
+	os_event_set(page_cleaner->is_requested);
+
+	mutex_exit(&page_cleaner->mutex);
+}
+
+/******************************************************************//**
+Takes one requested slot, if any, and flushes the corresponding buffer
+pool instance. Called by the coordinator and by the worker threads.
+A thread bound to a NUMA node takes the slots of the instances on that
+node first.
+@return number of slots that are still in the requested state */
+static
+ulint
+pc_flush_slot(
+/*==========*/
+	ulint	numa_node)	/*!< in: NUMA node of the calling thread,
+				or ULINT_UNDEFINED */
+{
+	ulint	ret;
+
+	mutex_enter(&page_cleaner->mutex);
+
+	if (page_cleaner->n_slots_requested > 0) {
+		page_cleaner_slot_t*	slot = NULL;
+		ulint			i = page_cleaner->n_slots;
+
+		if (numa_node != ULINT_UNDEFINED) {
+			for (i = 0; i < page_cleaner->n_slots; i++) {
+				slot = &page_cleaner->slots[i];
+
+				if (slot->state
+				    == PAGE_CLEANER_STATE_REQUESTED
+				    && buf_pool_from_array(i)->numa_node
+				    == numa_node) {
+					break;
+				}
+			}
+		}
+
+		if (i == page_cleaner->n_slots) {
+			for (i = 0; i < page_cleaner->n_slots; i++) {
+				slot = &page_cleaner->slots[i];
+
+				if (slot->state
+				    == PAGE_CLEANER_STATE_REQUESTED) {
+					break;
+				}
+			}
+		}
+
+		/* The counter and the slot states are protected by
+		the same mutex, so a requested slot must exist. */
+		ut_a(i < page_cleaner->n_slots);
+
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+		page_cleaner->n_slots_requested--;
+		page_cleaner->n_slots_flushing++;
+		slot->state = PAGE_CLEANER_STATE_FLUSHING;
+
+		if (page_cleaner->n_slots_requested == 0) {
+			os_event_reset(page_cleaner->is_requested);
+		}
+
+		bool	requested = page_cleaner->requested;
+		lsn_t	lsn_limit = page_cleaner->lsn_limit;
+
+		mutex_exit(&page_cleaner->mutex);
+
+		ulint	lru_tm = ut_time_ms();
+
+		/* Flush pages from end of LRU if required */
+		slot->n_flushed_lru = buf_flush_LRU_list(buf_pool);
+
+		lru_tm = ut_time_ms() - lru_tm;
+
+		ulint	list_tm = 0;
+
+		/* Flush pages from flush_list if required */
+		if (requested) {
+			list_tm = ut_time_ms();
+
+			slot->succeeded_list = buf_flush_list_instance(
+				buf_pool, slot->n_pages_requested,
+				lsn_limit, &slot->n_flushed_list);
+
+			list_tm = ut_time_ms() - list_tm;
+		} else {
+			slot->n_flushed_list = 0;
+			slot->succeeded_list = true;
+		}
+
+		mutex_enter(&page_cleaner->mutex);
+
+		page_cleaner->n_slots_flushing--;
+		page_cleaner->n_slots_finished++;
+		slot->state = PAGE_CLEANER_STATE_FINISHED;
+
+		slot->flush_lru_time += lru_tm;
+		slot->flush_lru_pass++;
+
+		if (requested) {
+			slot->flush_list_time += list_tm;
+			slot->flush_list_pass++;
+		}
+
+		if (page_cleaner->n_slots_requested == 0
+		    && page_cleaner->n_slots_flushing == 0) {
+			os_event_set(page_cleaner->is_finished);
+		}
+	}
+
+	ret = page_cleaner->n_slots_requested;
+
+	mutex_exit(&page_cleaner->mutex);
+
+	return(ret);
+}
+
+/******************************************************************//**
+Waits until all the slots of the flush round requested by pc_request()
+have been processed, and sums up the results.
+@return false if the flush_list batch could not be started in at least
+one of the buffer pool instances */
+static
+bool
+pc_wait_finished(
+/*=============*/
+	ulint*	n_flushed_lru,	/*!< out: number of pages flushed from
+				the LRU lists */
+	ulint*	n_flushed_list)	/*!< out: number of pages flushed from
+				the flush_lists */
+{
+	bool	all_succeeded = true;
+	ulint	wait_tm = ut_time_ms();
+
+	*n_flushed_lru = 0;
+	*n_flushed_list = 0;
+
+	os_event_wait(page_cleaner->is_finished);
+
+	wait_tm = ut_time_ms() - wait_tm;
+
+	mutex_enter(&page_cleaner->mutex);
+
+	ut_ad(page_cleaner->n_slots_requested == 0);
+	ut_ad(page_cleaner->n_slots_flushing == 0);
+	ut_ad(page_cleaner->n_slots_finished == page_cleaner->n_slots);
+
+	for (ulint i = 0; i < page_cleaner->n_slots; i++) {
+		page_cleaner_slot_t*	slot = &page_cleaner->slots[i];
+
+		ut_ad(slot->state == PAGE_CLEANER_STATE_FINISHED);
+
+		*n_flushed_lru += slot->n_flushed_lru;
+		*n_flushed_list += slot->n_flushed_list;
+		all_succeeded &= slot->succeeded_list;
+
+		slot->state = PAGE_CLEANER_STATE_NONE;
+	}
+
+	page_cleaner->n_slots_finished = 0;
+	page_cleaner->wait_time += wait_tm;
+
+	mutex_exit(&page_cleaner->mutex);
+
+	return(all_succeeded);
+}
+
+/******************************************************************//**
+Requests a flush round, takes part in it and waits for the worker
+threads to finish their slots.
+@return false if the flush_list batch could not be started in at least
+one of the buffer pool instances */
+static
+bool
+pc_flush_round(
+/*===========*/
+	ulint		min_n,		/*!< in: wished minimum number of
+					blocks flushed from the flush_lists */
+	lsn_t		lsn_limit,	/*!< in: all blocks whose
+					oldest_modification is smaller than
+					this should be flushed */
+	ulint*		n_flushed_lru,	/*!< out: number of pages flushed
+					from the LRU lists */
+	ulint*		n_flushed_list)	/*!< out: number of pages flushed
+					from the flush_lists */
+{
+	ulint	flush_tm = ut_time_ms();
+
+	pc_request(min_n, lsn_limit);
+
+	/* The coordinator flushes slots as well. */
+	while (pc_flush_slot(ULINT_UNDEFINED) > 0) {}
+
+	bool	success = pc_wait_finished(n_flushed_lru, n_flushed_list);
+
+	flush_tm = ut_time_ms() - flush_tm;
+
+	mutex_enter(&page_cleaner->mutex);
+	page_cleaner->flush_time += flush_tm;
+	page_cleaner->flush_pass++;
+	mutex_exit(&page_cleaner->mutex);
+
+	if (*n_flushed_lru) {
+		MONITOR_INC_VALUE_CUMULATIVE(
+			MONITOR_LRU_BATCH_TOTAL_PAGE,
+			MONITOR_LRU_BATCH_COUNT,
+			MONITOR_LRU_BATCH_PAGES,
+			*n_flushed_lru);
+	}
+
+	return(success);
+}
+
+/******************************************************************//**
+page_cleaner coordinator thread tasked with deciding how much to flush
+from the buffer pools. The flushing itself is done in parallel by the
+coordinator and the page cleaner worker threads, one buffer pool
+instance at a time.
 @return a dummy parameter */
 extern "C" UNIV_INTERN
 os_thread_ret_t
-DECLARE_THREAD(buf_flush_page_cleaner_thread)(
-/*==========================================*/
+DECLARE_THREAD(buf_flush_page_cleaner_coordinator)(
+/*===============================================*/
 	void*	arg __attribute__((unused)))
 			/*!< in: a dummy parameter required by
 			os_thread_create */
 {
 	ulint	next_loop_time = ut_time_ms() + 1000;
 	ulint	n_flushed = 0;
+	ulint	n_flushed_lru = 0;
+	ulint	n_flushed_list = 0;
+	ulint	last_pages = 0;
 	ulint	last_activity = srv_get_activity_count();
 
 	ut_ad(!srv_read_only_mode);
@@ -2403,12 +2906,18 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 #endif /* UNIV_PFS_THREAD */
 
 #ifdef UNIV_DEBUG_THREAD_CREATION
-	fprintf(stderr, "InnoDB: page_cleaner thread running, id %lu\n",
+	fprintf(stderr, "InnoDB: page_cleaner coordinator running, id %lu\n",
 		os_thread_pf(os_thread_get_curr_id()));
 #endif /* UNIV_DEBUG_THREAD_CREATION */
 
 	buf_page_cleaner_is_active = TRUE;
 
+	/* Wait for the worker threads to register themselves, so that
+	they can be told to exit when we do. */
+	while (page_cleaner->n_workers < srv_n_page_cleaners - 1) {
+		os_thread_sleep(10000);
+	}
+
 	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
 
 		/* The page_cleaner skips sleep if the server is
@@ -2423,25 +2932,44 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 		next_loop_time = ut_time_ms() + 1000;
 
 		if (srv_check_activity(last_activity)) {
+			ulint	n_to_flush;
+			lsn_t	lsn_limit = 0;
+
 			last_activity = srv_get_activity_count();
 
-			/* Flush pages from end of LRU if required */
-			n_flushed = buf_flush_LRU_tail();
+			/* Estimate pages from flush_list to be flushed */
+			n_to_flush = page_cleaner_flush_pages_recommendation(
+				&lsn_limit, last_pages);
 
-			/* Flush pages from flush_list if required */
-			n_flushed += page_cleaner_flush_pages_if_needed();
+			/* Flush pages from end of LRU and from
+			flush_list of all instances in parallel */
+			pc_flush_round(n_to_flush, lsn_limit,
+				       &n_flushed_lru, &n_flushed_list);
+
+			if (n_flushed_list) {
+				MONITOR_INC_VALUE_CUMULATIVE(
+					MONITOR_FLUSH_ADAPTIVE_TOTAL_PAGE,
+					MONITOR_FLUSH_ADAPTIVE_COUNT,
+					MONITOR_FLUSH_ADAPTIVE_PAGES,
+					n_flushed_list);
+			}
+
+			last_pages = n_flushed_list;
+			n_flushed = n_flushed_lru + n_flushed_list;
 		} else {
-			n_flushed = page_cleaner_do_flush_batch(
-							PCT_IO(100),
-							LSN_MAX);
+			pc_flush_round(PCT_IO(100), LSN_MAX,
+				       &n_flushed_lru, &n_flushed_list);
 
-			if (n_flushed) {
+			if (n_flushed_list) {
 				MONITOR_INC_VALUE_CUMULATIVE(
 					MONITOR_FLUSH_BACKGROUND_TOTAL_PAGE,
 					MONITOR_FLUSH_BACKGROUND_COUNT,
 					MONITOR_FLUSH_BACKGROUND_PAGES,
-					n_flushed);
+					n_flushed_list);
 			}
+
+			last_pages = 0;
+			n_flushed = n_flushed_list;
 		}
 	}
 
@@ -2465,7 +2993,10 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 	dirtied until we enter SRV_SHUTDOWN_FLUSH_PHASE phase. */
 
 	do {
-		n_flushed = page_cleaner_do_flush_batch(PCT_IO(100), LSN_MAX);
+		pc_flush_round(PCT_IO(100), LSN_MAX,
+			       &n_flushed_lru, &n_flushed_list);
+
+		n_flushed = n_flushed_list;
 
 		/* We sleep only if there are no pages to flush */
 		if (n_flushed == 0) {
@@ -2491,8 +3022,11 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 	bool	success;
 
 	do {
+		success = pc_flush_round(PCT_IO(100), LSN_MAX,
+					 &n_flushed_lru, &n_flushed_list);
+
+		n_flushed = n_flushed_list;
 
-		success = buf_flush_list(PCT_IO(100), LSN_MAX, &n_flushed);
 		buf_flush_wait_batch_end(NULL, BUF_FLUSH_LIST);
 
 	} while (!success || n_flushed > 0);
@@ -2508,6 +3042,19 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 	/* We have lived our life. Time to die. */
 
 thread_exit:
+	/* Tell the worker threads to exit and wait for them. */
+	mutex_enter(&page_cleaner->mutex);
+	page_cleaner->is_running = false;
+	os_event_set(page_cleaner->is_requested);
+	mutex_exit(&page_cleaner->mutex);
+
+	while (page_cleaner->n_workers > 0) {
+		os_event_set(page_cleaner->is_requested);
+		os_thread_sleep(10000);
+	}
+
+	buf_flush_page_cleaner_close();
+
 	buf_page_cleaner_is_active = FALSE;
 
 	/* We count the number of threads in os_thread_exit(). A created
@@ -2517,6 +3064,66 @@ thread_exit:
 	OS_THREAD_DUMMY_RETURN;
 }
 
+/******************************************************************//**
+Worker thread of page_cleaner. Flushes the buffer pool instances whose
+slots have been requested by the coordinator.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_flush_page_cleaner_worker)(
+/*==========================================*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	ut_ad(!srv_read_only_mode);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(buf_page_cleaner_worker_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "InnoDB: page_cleaner worker running, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
+	ulint	numa_node = ULINT_UNDEFINED;
+
+	mutex_enter(&page_cleaner->mutex);
+
+	if (srv_numa_aware) {
+		/* Spread the workers round-robin over the nodes, in
+		the same way as the buffer pool instances. */
+		numa_node = page_cleaner->n_workers % os_numa_get_n_nodes();
+	}
+
+	page_cleaner->n_workers++;
+	mutex_exit(&page_cleaner->mutex);
+
+	if (numa_node != ULINT_UNDEFINED
+	    && !os_thread_bind_to_numa_node(numa_node)) {
+		numa_node = ULINT_UNDEFINED;
+	}
+
+	for (;;) {
+		os_event_wait(page_cleaner->is_requested);
+
+		if (!page_cleaner->is_running) {
+			break;
+		}
+
+		pc_flush_slot(numa_node);
+	}
+
+	mutex_enter(&page_cleaner->mutex);
+	page_cleaner->n_workers--;
+	mutex_exit(&page_cleaner->mutex);
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 
 /** Functor to validate the flush list. */
@@ -87,12 +87,13 @@ static ibool	buf_lru_switched_on_innodb_mon	= FALSE;
 
 /******************************************************************//**
 These statistics are not 'of' LRU but 'for' LRU.  We keep count of I/O
-and page_zip_decompress() operations.  Based on the statistics,
-buf_LRU_evict_from_unzip_LRU() decides if we want to evict from
-unzip_LRU or the regular LRU.  From unzip_LRU, we will only evict the
-uncompressed frame (meaning we can evict dirty blocks as well).  From
-the regular LRU, we will evict the entire block (i.e.: both the
-uncompressed and compressed data), which must be clean. */
+and page_zip_decompress() operations, and of the time that they take.
+Based on the statistics, buf_LRU_evict_from_unzip_LRU() decides if we
+want to evict from unzip_LRU or the regular LRU.  From unzip_LRU, we
+will only evict the uncompressed frame (meaning we can evict dirty
+blocks as well).  From the regular LRU, we will evict the entire block
+(i.e.: both the uncompressed and compressed data), which must be
+clean. */
 
 /* @{ */
 
@@ -102,9 +103,15 @@ srv_error_monitor_thread() calls buf_LRU_stat_update(). */
 #define BUF_LRU_STAT_N_INTERVAL 50
 
 /** Co-efficient with which we multiply I/O operations to equate them
-with page_zip_decompress() operations. */
+with page_zip_decompress() operations, as long as the time that they
+take has not been measured. */
 #define BUF_LRU_IO_TO_UNZIP_FACTOR 50
 
+/** Number of blocks at the tail of unzip_LRU among which
+buf_LRU_free_from_unzip_LRU_list() first evicts the uncompressed frame
+that is the cheapest to decompress again. */
+#define BUF_LRU_UNZIP_N_CANDIDATES 8
+
 /** Sampled values buf_LRU_stat_cur.
 Not protected by any mutex.  Updated by buf_LRU_stat_update(). */
 static buf_LRU_stat_t		buf_LRU_stat_arr[BUF_LRU_STAT_N_INTERVAL];
@@ -176,6 +183,22 @@ incr_LRU_size_in_bytes(
 	ut_ad(buf_pool->stat.LRU_bytes <= buf_pool->curr_pool_size);
 }
 
+/******************************************************************//**
+Determines if the uncompressed frames of compressed pages take more of
+the buffer pool than innodb_unzip_lru_max_pct allows.
+@return	true if frames should be evicted from unzip_LRU */
+UNIV_INTERN
+bool
+buf_LRU_unzip_over_budget(
+/*======================*/
+	const buf_pool_t*	buf_pool)	/*!< in: buffer pool instance */
+{
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	return(UT_LIST_GET_LEN(buf_pool->unzip_LRU) * 100
+	       > buf_pool->curr_size * srv_unzip_LRU_max_pct);
+}
+
 /******************************************************************//**
 Determines if the unzip_LRU list should be used for evicting a victim
 instead of the general LRU list.
@@ -188,6 +211,8 @@ buf_LRU_evict_from_unzip_LRU(
 {
 	ulint	io_avg;
 	ulint	unzip_avg;
+	ulint	io_usec_avg;
+	ulint	unzip_usec_avg;
 
 	ut_ad(buf_pool_mutex_own(buf_pool));
 
@@ -196,6 +221,12 @@ buf_LRU_evict_from_unzip_LRU(
 		return(FALSE);
 	}
 
+	/* Keep the uncompressed frames within their share of the
+	buffer pool, whatever they cost to decompress again. */
+	if (buf_LRU_unzip_over_budget(buf_pool)) {
+		return(TRUE);
+	}
+
 	/* If unzip_LRU is at most 10% of the size of the LRU list,
 	then use the LRU.  This slack allows us to keep hot
 	decompressed pages in the buffer pool. */
@@ -216,12 +247,27 @@ buf_LRU_evict_from_unzip_LRU(
 		+ buf_LRU_stat_cur.io;
 	unzip_avg = buf_LRU_stat_sum.unzip / BUF_LRU_STAT_N_INTERVAL
 		+ buf_LRU_stat_cur.unzip;
-
-	/* Decide based on our formula.  If the load is I/O bound
-	(unzip_avg is smaller than the weighted io_avg), evict an
-	uncompressed frame from unzip_LRU.  Otherwise we assume that
-	the load is CPU bound and evict from the regular LRU. */
-	return(unzip_avg <= io_avg * BUF_LRU_IO_TO_UNZIP_FACTOR);
+	io_usec_avg = buf_LRU_stat_sum.io_usec / BUF_LRU_STAT_N_INTERVAL
+		+ buf_LRU_stat_cur.io_usec;
+	unzip_usec_avg = buf_LRU_stat_sum.unzip_usec / BUF_LRU_STAT_N_INTERVAL
+		+ buf_LRU_stat_cur.unzip_usec;
+
+	if (io_usec_avg == 0 || unzip_usec_avg == 0) {
+		/* Until both have been timed, decide based on our
+		formula.  If the load is I/O bound (unzip_avg is smaller
+		than the weighted io_avg), evict an uncompressed frame
+		from unzip_LRU.  Otherwise we assume that the load is
+		CPU bound and evict from the regular LRU. */
+		return(unzip_avg <= io_avg * BUF_LRU_IO_TO_UNZIP_FACTOR);
+	}
+
+	/* Decide based on the time that the load spends on each.  If
+	threads wait longer for page reads than page_zip_decompress()
+	takes, the load is I/O bound: evict an uncompressed frame, so
+	that more pages fit in the buffer pool.  Otherwise the load is
+	CPU bound: evict from the regular LRU, so that the frames of
+	the pages that stay need not be decompressed again. */
+	return(unzip_usec_avg <= io_usec_avg);
 }
 
 /******************************************************************//**
@@ -846,7 +892,6 @@ buf_LRU_remove_pages(
 		break;
 
 	case BUF_REMOVE_FLUSH_WRITE:
-		ut_a(trx != 0);
 		buf_flush_dirty_pages(buf_pool, id, true, trx);
 		/* Ensure that all asynchronous IO is completed. */
 		os_aio_wait_until_no_pending_writes();
@@ -867,7 +912,8 @@ buf_LRU_flush_or_remove_pages(
 	ulint		id,		/*!< in: space id */
 	buf_remove_t	buf_remove,	/*!< in: remove or flush strategy */
 	const trx_t*	trx)		/*!< to check if the operation must
-					be interrupted */
+					be interrupted, or NULL if it must
+					not be interrupted */
 {
 	ulint		i;
 
@@ -951,8 +997,12 @@ buf_LRU_free_from_unzip_LRU_list(
 					srv_LRU_scan_depth / 2 blocks. */
 {
 	buf_block_t*	block;
+	buf_block_t*	cheapest = NULL;
+	ulint		cheapest_usec = ULINT_UNDEFINED;
+	ulint		unknown_usec;
 	ibool 		freed;
 	ulint		scanned;
+	ulint		evicted;
 
 	ut_ad(buf_pool_mutex_own(buf_pool));
 
@@ -960,8 +1010,33 @@ buf_LRU_free_from_unzip_LRU_list(
 		return(FALSE);
 	}
 
+	/* Frames whose decompression was not timed are assumed to
+	take the average time. */
+	unknown_usec = (buf_LRU_stat_sum.unzip_usec
+			+ buf_LRU_stat_cur.unzip_usec)
+		/ ut_max(buf_LRU_stat_sum.unzip + buf_LRU_stat_cur.unzip, 1);
+
+	/* First try the frame near the tail that is the cheapest to
+	decompress again, and then fall back to plain LRU order. */
+	for (block = UT_LIST_GET_LAST(buf_pool->unzip_LRU), scanned = 0;
+	     block != NULL && scanned < BUF_LRU_UNZIP_N_CANDIDATES;
+	     block = UT_LIST_GET_PREV(unzip_LRU, block), ++scanned) {
+
+		ulint	usec = block->unzip_usec
+			? block->unzip_usec : unknown_usec;
+
+		if (usec < cheapest_usec) {
+			cheapest = block;
+			cheapest_usec = usec;
+		}
+	}
+
+	freed = cheapest != NULL
+		&& cheapest != UT_LIST_GET_LAST(buf_pool->unzip_LRU)
+		&& buf_LRU_free_page(&cheapest->page, false);
+
 	for (block = UT_LIST_GET_LAST(buf_pool->unzip_LRU),
-	     scanned = 1, freed = FALSE;
+	     scanned = 1;
 	     block != NULL && !freed
 	     && (scan_all || scanned < srv_LRU_scan_depth);
 	     ++scanned) {
@@ -978,6 +1053,21 @@ buf_LRU_free_from_unzip_LRU_list(
 		block = prev_block;
 	}
 
+	/* Above the budget, evict a few more frames than are being
+	allocated, so that their number goes down. */
+	for (block = UT_LIST_GET_LAST(buf_pool->unzip_LRU), evicted = 0;
+	     freed && block != NULL && evicted < BUF_LRU_UNZIP_N_CANDIDATES
+	     && buf_LRU_unzip_over_budget(buf_pool);
+	     ++evicted) {
+
+		buf_block_t*	prev_block = UT_LIST_GET_PREV(unzip_LRU,
+						block);
+
+		block = buf_LRU_free_page(&block->page, false)
+			? UT_LIST_GET_LAST(buf_pool->unzip_LRU)
+			: prev_block;
+	}
+
 	MONITOR_INC_VALUE_CUMULATIVE(
 		MONITOR_LRU_UNZIP_SEARCH_SCANNED,
 		MONITOR_LRU_UNZIP_SEARCH_SCANNED_NUM_CALL,
@@ -1077,8 +1167,10 @@ buf_LRU_buf_pool_running_out(void)
 
 		buf_pool_mutex_enter(buf_pool);
 
+		/* Blocks withdrawn by a shrink are not in use. */
 		if (!recv_recovery_on
 		    && UT_LIST_GET_LEN(buf_pool->free)
+		       + UT_LIST_GET_LEN(buf_pool->withdraw)
 		       + UT_LIST_GET_LEN(buf_pool->LRU)
 		       < buf_pool->curr_size / 4) {
 
@@ -1107,7 +1199,7 @@ buf_LRU_get_free_only(
 
 	block = (buf_block_t*) UT_LIST_GET_FIRST(buf_pool->free);
 
-	if (block) {
+	while (block != NULL) {
 
 		ut_ad(block->page.in_free_list);
 		ut_d(block->page.in_free_list = FALSE);
@@ -1116,6 +1208,18 @@ buf_LRU_get_free_only(
 		ut_a(!buf_page_in_file(&block->page));
 		UT_LIST_REMOVE(list, buf_pool->free, (&block->page));
 
+		if (buf_pool->withdraw_target > 0
+		    && buf_block_will_withdrawn(buf_pool, block)) {
+			/* The chunk of the block is being removed
+			by buf_pool_resize(). */
+			UT_LIST_ADD_LAST(list, buf_pool->withdraw,
+					 (&block->page));
+
+			block = (buf_block_t*) UT_LIST_GET_FIRST(
+				buf_pool->free);
+			continue;
+		}
+
 		mutex_enter(&block->mutex);
 
 		buf_block_set_state(block, BUF_BLOCK_READY_FOR_USE);
@@ -1124,6 +1228,7 @@ buf_LRU_get_free_only(
 		ut_ad(buf_pool_from_block(block) == buf_pool);
 
 		mutex_exit(&block->mutex);
+		break;
 	}
 
 	return(block);
@@ -1142,7 +1247,10 @@ buf_LRU_check_size_of_non_data_objects(
 {
 	ut_ad(buf_pool_mutex_own(buf_pool));
 
+	/* Blocks withdrawn by a shrink of the buffer pool are not
+	occupied by anything. */
 	if (!recv_recovery_on && UT_LIST_GET_LEN(buf_pool->free)
+	    + UT_LIST_GET_LEN(buf_pool->withdraw)
 	    + UT_LIST_GET_LEN(buf_pool->LRU) < buf_pool->curr_size / 20) {
 		ut_print_timestamp(stderr);
 
@@ -1165,6 +1273,7 @@ buf_LRU_check_size_of_non_data_objects(
 
 	} else if (!recv_recovery_on
 		   && (UT_LIST_GET_LEN(buf_pool->free)
+		       + UT_LIST_GET_LEN(buf_pool->withdraw)
 		       + UT_LIST_GET_LEN(buf_pool->LRU))
 		   < buf_pool->curr_size / 3) {
 
@@ -1252,6 +1361,13 @@ loop:
 
 	buf_LRU_check_size_of_non_data_objects(buf_pool);
 
+	/* Keep the uncompressed frames of compressed pages within
+	innodb_unzip_lru_max_pct even while the free list is not empty;
+	otherwise each decompression would add a frame unchecked. */
+	if (buf_LRU_unzip_over_budget(buf_pool)) {
+		buf_LRU_free_from_unzip_LRU_list(buf_pool, FALSE);
+	}
+
 	/* If there is a block in the free list, take it */
 	block = buf_LRU_get_free_only(buf_pool);
 
@@ -2104,8 +2220,15 @@ buf_LRU_block_free_non_file_page(
 		page_zip_set_size(&block->page.zip, 0);
 	}
 
-	UT_LIST_ADD_FIRST(list, buf_pool->free, (&block->page));
-	ut_d(block->page.in_free_list = TRUE);
+	if (buf_pool->withdraw_target > 0
+	    && buf_block_will_withdrawn(buf_pool, block)) {
+		/* The chunk of the block is being removed by
+		buf_pool_resize(). */
+		UT_LIST_ADD_LAST(list, buf_pool->withdraw, (&block->page));
+	} else {
+		UT_LIST_ADD_FIRST(list, buf_pool->free, (&block->page));
+		ut_d(block->page.in_free_list = TRUE);
+	}
 
 	UNIV_MEM_ASSERT_AND_FREE(block->frame, UNIV_PAGE_SIZE);
 }
@@ -2526,6 +2649,8 @@ buf_LRU_stat_update(void)
 
 	buf_LRU_stat_sum.io += cur_stat.io - item->io;
 	buf_LRU_stat_sum.unzip += cur_stat.unzip - item->unzip;
+	buf_LRU_stat_sum.io_usec += cur_stat.io_usec - item->io_usec;
+	buf_LRU_stat_sum.unzip_usec += cur_stat.unzip_usec - item->unzip_usec;
 
 	/* Put current entry in the array. */
 	memcpy(item, &cur_stat, sizeof *item);
@@ -2535,6 +2660,144 @@ func_exit:
 	memset(&buf_LRU_stat_cur, 0, sizeof buf_LRU_stat_cur);
 }
 
+/** Private ring of the pages that a large scan has read into the buffer
+pool. Owned by a single row_prebuilt_t, so not protected by any mutex. */
+struct buf_scan_ring_t {
+	ulint		size;	/*!< number of slots */
+	ulint		next;	/*!< slot to fill next; the slot
+				that was filled longest ago once
+				the ring is full */
+	ulint		n_used;	/*!< number of slots filled */
+	ulint*		space;	/*!< space id of the page in each slot */
+	ulint*		offset;	/*!< page number of the page in each slot */
+};
+
+/******************************************************************//**
+Creates a scan ring. A table scan or a large range scan registers in the
+ring each page that it reads into the buffer pool, and once the ring is
+full, evicts the page that it registered longest ago, so that the scan
+recycles a few buffer frames instead of filling the LRU list.
+@return	own: scan ring */
+UNIV_INTERN
+buf_scan_ring_t*
+buf_scan_ring_create(
+/*=================*/
+	ulint		size)	/*!< in: number of pages to keep, > 0 */
+{
+	buf_scan_ring_t*	ring;
+
+	ut_ad(size > 0);
+
+	ring = static_cast<buf_scan_ring_t*>(
+		ut_malloc(sizeof(*ring) + 2 * size * sizeof(ulint)));
+
+	ring->size = size;
+	ring->next = 0;
+	ring->n_used = 0;
+	ring->space = reinterpret_cast<ulint*>(ring + 1);
+	ring->offset = ring->space + size;
+
+	return(ring);
+}
+
+/******************************************************************//**
+Frees a scan ring. The pages registered in it stay in the buffer pool. */
+UNIV_INTERN
+void
+buf_scan_ring_free(
+/*===============*/
+	buf_scan_ring_t*	ring)	/*!< in, own: scan ring */
+{
+	ut_free(ring);
+}
+
+/******************************************************************//**
+Gets the number of pages that a scan ring keeps.
+@return	ring size in pages */
+UNIV_INTERN
+ulint
+buf_scan_ring_get_size(
+/*===================*/
+	const buf_scan_ring_t*	ring)	/*!< in: scan ring */
+{
+	return(ring->size);
+}
+
+/******************************************************************//**
+Evicts a page that a large scan has finished with, unless it is in use,
+dirty, or was made young by some other access after the scan read it.
+Nothing is evicted while the buffer pool instance has at least
+innodb_lru_scan_depth free blocks: the scan then displaces no other page.
+Below that, the page cleaner would free blocks from the tail of the LRU
+list, and the blocks freed here spare those pages. */
+static
+void
+buf_scan_ring_evict(
+/*================*/
+	ulint	space,	/*!< in: space id */
+	ulint	offset)	/*!< in: page number */
+{
+	buf_pool_t*	buf_pool = buf_pool_get(space, offset);
+	buf_page_t*	bpage;
+	rw_lock_t*	hash_lock;
+
+	/* This is a dirty read: at worst a page is evicted, or kept,
+	one block too early. */
+	if (UT_LIST_GET_LEN(buf_pool->free) >= srv_LRU_scan_depth) {
+		return;
+	}
+
+	buf_pool_mutex_enter(buf_pool);
+
+	bpage = buf_page_hash_get_s_locked(buf_pool, space, offset,
+					   &hash_lock);
+
+	if (bpage != NULL) {
+		/* While the LRU list is too short to have an old
+		sublist, no page is flagged old and none can be told
+		apart from the others. */
+		bool	evict = buf_page_in_file(bpage)
+			&& (buf_page_is_old(bpage)
+			    || buf_pool->LRU_old == NULL);
+
+		rw_lock_s_unlock(hash_lock);
+
+		/* We are holding buf_pool->mutex, so the block cannot
+		be relocated or leave the buffer pool meanwhile.
+		buf_LRU_free_page() leaves fixed and dirty blocks alone. */
+		if (evict) {
+			buf_LRU_free_page(bpage, true);
+		}
+	}
+
+	buf_pool_mutex_exit(buf_pool);
+}
+
+/******************************************************************//**
+Registers a page that a large scan read into the buffer pool, and
+evicts the page registered longest ago if the ring is full. That page is
+left alone if it is in use, dirty, or has been made young meanwhile. */
+UNIV_INTERN
+void
+buf_scan_ring_add(
+/*==============*/
+	buf_scan_ring_t*	ring,	/*!< in/out: scan ring */
+	ulint			space,	/*!< in: space id */
+	ulint			offset)	/*!< in: page number */
+{
+	ulint	slot = ring->next;
+
+	if (ring->n_used == ring->size) {
+		buf_scan_ring_evict(ring->space[slot], ring->offset[slot]);
+	} else {
+		ring->n_used++;
+	}
+
+	ring->space[slot] = space;
+	ring->offset[slot] = offset;
+	ring->next = (slot + 1) % ring->size;
+}
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /**********************************************************************//**
 Validates the LRU list for one buffer pool instance. */
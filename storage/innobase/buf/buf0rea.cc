@@ -124,6 +124,7 @@ buf_read_page_low(
 	buf_page_t*	bpage;
 	ulint		wake_later;
 	ibool		ignore_nonexistent_pages;
+	ullint		start_time = 0;
 
 	*err = DB_SUCCESS;
 
@@ -178,6 +179,7 @@ buf_read_page_low(
 
 	if (sync) {
 		thd_wait_begin(NULL, THD_WAIT_DISKIO);
+		start_time = ut_time_us(NULL);
 	}
 
 	if (zip_size) {
@@ -195,6 +197,9 @@ buf_read_page_low(
 	}
 
 	if (sync) {
+		/* The time that the thread waited is what evicting
+		the page cost, for buf_LRU_evict_from_unzip_LRU() */
+		buf_LRU_stat_inc_io_time(ut_time_us(NULL) - start_time);
 		thd_wait_end(NULL);
 	}
 
@@ -360,8 +365,8 @@ read_ahead:
 	}
 
 	/* In simulated aio we wake the aio handler threads only after
-	queuing all aio requests, in native aio the following call does
-	nothing: */
+	queuing all aio requests, in native aio the following call submits
+	the requests to the kernel: */
 
 	os_aio_simulated_wake_handler_threads();
 
@@ -469,6 +474,67 @@ buf_read_page_async(
 	return(count > 0);
 }
 
+/********************************************************************//**
+Reads a batch of pages of a tablespace asynchronously to the buffer pool,
+for example the leaf pages that a scan is going to access next. The reads
+are submitted together, and the pages that are already in the buffer
+pool are skipped. NOTE: the calling thread may own latches on pages:
+this function does not wait for the reads to complete.
+@return	number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_pages_async(
+/*=================*/
+	ulint		space,		/*!< in: space id */
+	ulint		zip_size,	/*!< in: compressed page size in
+					bytes, or 0 */
+	const ulint*	page_nos,	/*!< in: page numbers */
+	ulint		n_pages)	/*!< in: number of pages */
+{
+	ib_int64_t	tablespace_version;
+	ulint		count = 0;
+
+	if (!n_pages || srv_startup_is_before_trx_rollback_phase) {
+		/* No read-ahead to avoid thread deadlocks */
+		return(0);
+	}
+
+	tablespace_version = fil_space_get_version(space);
+
+	for (ulint i = 0; i < n_pages; i++) {
+		buf_pool_t*	buf_pool = buf_pool_get(space, page_nos[i]);
+		dberr_t		err;
+		ulint		n;
+
+		if (buf_page_peek(space, page_nos[i])) {
+			continue;
+		}
+
+		n = buf_read_page_low(&err, false, BUF_READ_ANY_PAGE
+				      | OS_AIO_SIMULATED_WAKE_LATER
+				      | BUF_READ_IGNORE_NONEXISTENT_PAGES,
+				      space, zip_size, FALSE,
+				      tablespace_version, page_nos[i]);
+
+		if (err == DB_TABLESPACE_DELETED) {
+			break;
+		}
+
+		buf_pool->stat.n_ra_pages_read += n;
+		count += n;
+	}
+
+	/* In simulated aio we wake the aio handler threads only after
+	queuing all aio requests, in native aio the following call submits
+	the requests to the kernel: */
+
+	os_aio_simulated_wake_handler_threads();
+
+	srv_stats.buf_pool_reads.add(count);
+
+	return(count);
+}
+
 /********************************************************************//**
 Applies linear read-ahead if in the buf_pool the page is a border page of
 a linear read-ahead area and all the pages in the area have been accessed.
@@ -730,8 +796,8 @@ buf_read_ahead_linear(
 	}
 
 	/* In simulated aio we wake the aio handler threads only after
-	queuing all aio requests, in native aio the following call does
-	nothing: */
+	queuing all aio requests, in native aio the following call submits
+	the requests to the kernel: */
 
 	os_aio_simulated_wake_handler_threads();
 
@@ -222,6 +222,10 @@ struct fil_space_t {
 	ulint		flags;	/*!< tablespace flags; see
 				fsp_flags_is_valid(),
 				fsp_flags_get_zip_size() */
+	os_file_compress_t compress;
+				/*!< transparent page compression of
+				the data file; the algorithm is the
+				PAGE_COMPRESSION field of flags */
 	ulint		n_reserved_extents;
 				/*!< number of reserved free extents for
 				ongoing operations like B-tree page split */
@@ -1316,6 +1320,9 @@ fil_space_create(
 	space->purpose = purpose;
 	space->flags = flags;
 
+	space->compress.algorithm = FSP_FLAGS_GET_PAGE_COMPRESSION(flags);
+	space->compress.punch_hole = true;
+
 	space->magic_n = FIL_SPACE_MAGIC_N;
 
 	rw_lock_create(fil_space_latch_key, &space->latch, SYNC_FSP);
@@ -5117,7 +5124,7 @@ retry:
 		success = os_aio(OS_FILE_WRITE, OS_AIO_SYNC,
 				 node->name, node->handle, buf,
 				 offset, page_size * n_pages,
-				 NULL, NULL);
+				 NULL, NULL, NULL);
 #endif /* UNIV_HOTBACKUP */
 		if (success) {
 			os_has_said_disk_full = FALSE;
@@ -5176,6 +5183,82 @@ retry:
 	return(success);
 }
 
+#ifndef UNIV_HOTBACKUP
+/**********************************************************************//**
+Truncates the data file of a single-file tablespace to the given size. The
+pages of the tablespace are evicted from the buffer pool without writing
+them, so the caller must make sure that no other thread accesses the
+tablespace and that its pages need not be recovered from the redo log.
+@return	TRUE if success */
+UNIV_INTERN
+ibool
+fil_truncate_tablespace(
+/*====================*/
+	ulint	space_id,	/*!< in: space id */
+	ulint	size)		/*!< in: new size in pages */
+{
+	fil_node_t*	node;
+	fil_space_t*	space;
+	ibool		success;
+
+	ut_ad(!srv_read_only_mode);
+
+	buf_LRU_flush_or_remove_pages(space_id, BUF_REMOVE_ALL_NO_WRITE, 0);
+
+retry:
+	fil_mutex_enter_and_prepare_for_io(space_id);
+
+	space = fil_space_get_by_id(space_id);
+	ut_a(space);
+	ut_a(fsp_flags_get_zip_size(space->flags) == 0);
+	ut_a(UT_LIST_GET_LEN(space->chain) == 1);
+
+	node = UT_LIST_GET_FIRST(space->chain);
+
+	if (node->n_pending > 0 || node->being_extended) {
+		/* Wait for the reads issued before the pages were
+		evicted, such as read-ahead, to complete. */
+		mutex_exit(&fil_system->mutex);
+		os_thread_sleep(20000);
+		goto retry;
+	}
+
+	if (!fil_node_prepare_for_io(node, fil_system, space)) {
+		mutex_exit(&fil_system->mutex);
+
+		return(FALSE);
+	}
+
+	/* As in fil_extend_space_to_desired_size(), the flag keeps other
+	threads from closing or extending the file while we do not hold
+	the fil_system mutex. */
+	node->being_extended = TRUE;
+
+	mutex_exit(&fil_system->mutex);
+
+	success = os_file_truncate(
+		node->name, node->handle, (os_offset_t) size * UNIV_PAGE_SIZE);
+
+	if (success) {
+		success = os_file_flush(node->handle);
+	}
+
+	mutex_enter(&fil_system->mutex);
+
+	if (success) {
+		space->size = node->size = size;
+	}
+
+	node->being_extended = FALSE;
+
+	fil_node_complete_io(node, fil_system, OS_FILE_WRITE);
+
+	mutex_exit(&fil_system->mutex);
+
+	return(success);
+}
+#endif /* !UNIV_HOTBACKUP */
+
 #ifdef UNIV_HOTBACKUP
 /********************************************************************//**
 Extends all tablespaces to the size stored in the space header. During the
@@ -5687,9 +5770,13 @@ fil_io(
 				    offset, len);
 	}
 #else
-	/* Queue the aio request */
+	/* Queue the aio request. The pages of uncompressed tablespaces
+	may have been written with transparent page compression. */
 	ret = os_aio(type, mode | wake_later, node->name, node->handle, buf,
-		     offset, len, node, message);
+		     offset, len,
+		     space->purpose == FIL_TABLESPACE && !is_log && !zip_size
+		     ? &space->compress : NULL,
+		     node, message);
 #endif /* UNIV_HOTBACKUP */
 	ut_a(ret);
 
@@ -6243,6 +6330,14 @@ fil_iterate(
 
 			dberr_t	err;
 
+			if (callback.get_zip_size() == 0) {
+				/* The page may have been written with
+				transparent page compression. If it
+				cannot be decompressed, the callback
+				will find it corrupted. */
+				os_file_decompress_page(NULL, block->frame);
+			}
+
 			if ((err = callback(page_off, block)) != DB_SUCCESS) {
 
 				return(err);
@@ -6505,6 +6600,50 @@ fil_get_space_names(
 	return(err);
 }
 
+/*******************************************************************//**
+Takes a snapshot of the page compression counters of the tablespaces
+that are compressed or that have compressed or decompressed any pages.
+@return	number of entries in *stats */
+UNIV_INTERN
+ulint
+fil_space_get_compress_stats(
+/*=========================*/
+	fil_space_compress_stats_t**	stats)	/*!< out: array of entries,
+						to be freed with ut_free() */
+{
+	fil_space_t*	space;
+	ulint		n = 0;
+
+	mutex_enter(&fil_system->mutex);
+
+	*stats = static_cast<fil_space_compress_stats_t*>(
+		ut_malloc(UT_LIST_GET_LEN(fil_system->space_list)
+			  * sizeof **stats));
+
+	for (space = UT_LIST_GET_FIRST(fil_system->space_list);
+	     space != NULL;
+	     space = UT_LIST_GET_NEXT(space_list, space)) {
+
+		if (space->purpose != FIL_TABLESPACE
+		    || (space->compress.algorithm == OS_FILE_COMPRESSION_NONE
+			&& space->compress.compress_ops == 0
+			&& space->compress.uncompress_ops == 0)) {
+
+			continue;
+		}
+
+		fil_space_compress_stats_t*	entry = &(*stats)[n++];
+
+		entry->id = space->id;
+		ut_strlcpy(entry->name, space->name, sizeof entry->name);
+		entry->compress = space->compress;
+	}
+
+	mutex_exit(&fil_system->mutex);
+
+	return(n);
+}
+
 /****************************************************************//**
 Generate redo logs for swapping two .ibd files */
 UNIV_INTERN
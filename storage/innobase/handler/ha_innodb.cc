@@ -139,10 +139,6 @@ static long long innobase_buffer_pool_size, innobase_log_file_size;
 Connected to buf_LRU_old_ratio. */
 static uint innobase_old_blocks_pct;
 
-/** Maximum on-disk size of change buffer in terms of percentage
-of the buffer pool. */
-static uint innobase_change_buffer_max_size = CHANGE_BUFFER_DEFAULT_SIZE;
-
 /* The default values for the following char* start-up parameters
 are determined in innobase_init below: */
 
@@ -207,6 +203,40 @@ static TYPELIB innodb_stats_method_typelib = {
 	NULL
 };
 
+/** Possible values for system variable "innodb_deadlock_detect". */
+static const char* innodb_deadlock_detect_names[] = {
+	"off",
+	"on",
+	"background",
+	NullS
+};
+
+/** Used to define an enumerate type of the system variable
+innodb_deadlock_detect. */
+static TYPELIB innodb_deadlock_detect_typelib = {
+	array_elements(innodb_deadlock_detect_names) - 1,
+	"innodb_deadlock_detect_typelib",
+	innodb_deadlock_detect_names,
+	NULL
+};
+
+/** Possible values for system variable "innodb_lock_schedule_algorithm". */
+static const char* innodb_lock_schedule_algorithm_names[] = {
+	"fcfs",
+	"oldest",
+	"most_locks",
+	NullS
+};
+
+/** Used to define an enumerate type of the system variable
+innodb_lock_schedule_algorithm. */
+static TYPELIB innodb_lock_schedule_algorithm_typelib = {
+	array_elements(innodb_lock_schedule_algorithm_names) - 1,
+	"innodb_lock_schedule_algorithm_typelib",
+	innodb_lock_schedule_algorithm_names,
+	NULL
+};
+
 /** Possible values for system variable "innodb_checksum_algorithm". */
 static const char* innodb_checksum_algorithm_names[] = {
 	"crc32",
@@ -313,10 +343,12 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 #  endif /* UNIV_MEM_DEBUG */
 	{&mem_pool_mutex_key, "mem_pool_mutex", 0},
 	{&mutex_list_mutex_key, "mutex_list_mutex", 0},
+	{&page_cleaner_mutex_key, "page_cleaner_mutex", 0},
 	{&page_zip_stat_per_index_mutex_key, "page_zip_stat_per_index_mutex", 0},
 	{&purge_sys_bh_mutex_key, "purge_sys_bh_mutex", 0},
 	{&recv_sys_mutex_key, "recv_sys_mutex", 0},
 	{&recv_writer_mutex_key, "recv_writer_mutex", 0},
+	{&row_merge_pll_mutex_key, "row_merge_pll_mutex", 0},
 	{&rseg_mutex_key, "rseg_mutex", 0},
 #  ifdef UNIV_SYNC_DEBUG
 	{&rw_lock_debug_mutex_key, "rw_lock_debug_mutex", 0},
@@ -335,6 +367,7 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&srv_sys_mutex_key, "srv_sys_mutex", 0},
 	{&lock_sys_mutex_key, "lock_mutex", 0},
 	{&lock_sys_wait_mutex_key, "lock_wait_mutex", 0},
+	{&lock_rec_shard_mutex_key, "lock_rec_shard_mutex", 0},
 	{&trx_mutex_key, "trx_mutex", 0},
 	{&srv_sys_tasks_mutex_key, "srv_threads_mutex", 0},
 	/* mutex with os_fast_mutex_ interfaces */
@@ -342,9 +375,7 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&event_os_mutex_key, "event_os_mutex", 0},
 #  endif /* PFS_SKIP_EVENT_MUTEX */
 	{&os_mutex_key, "os_mutex", 0},
-#ifndef HAVE_ATOMIC_BUILTINS
 	{&srv_conc_mutex_key, "srv_conc_mutex", 0},
-#endif /* !HAVE_ATOMIC_BUILTINS */
 #ifndef HAVE_ATOMIC_BUILTINS_64
 	{&monitor_mutex_key, "monitor_mutex", 0},
 #endif /* !HAVE_ATOMIC_BUILTINS_64 */
@@ -396,7 +427,11 @@ static PSI_thread_info	all_innodb_threads[] = {
 	{&srv_master_thread_key, "srv_master_thread", 0},
 	{&srv_purge_thread_key, "srv_purge_thread", 0},
 	{&buf_page_cleaner_thread_key, "page_cleaner_thread", 0},
-	{&recv_writer_thread_key, "recv_writer_thread", 0}
+	{&buf_page_cleaner_worker_thread_key, "page_cleaner_worker_thread", 0},
+	{&log_writer_thread_key, "log_writer_thread", 0},
+	{&log_flusher_thread_key, "log_flusher_thread", 0},
+	{&recv_writer_thread_key, "recv_writer_thread", 0},
+	{&recv_apply_thread_key, "recv_apply_thread", 0}
 };
 # endif /* UNIV_PFS_THREAD */
 
@@ -543,11 +578,36 @@ static MYSQL_THDVAR_STR(ft_user_stopword_table,
   "User supplied stopword table name, effective in the session level.",
   innodb_stopword_table_validate, NULL, NULL);
 
+/** Names of the OS_FILE_COMPRESSION_ values, for innodb_page_compression */
+static const char* innodb_page_compression_names[] = {
+	"none",
+	"zlib",
+	"lz4",
+	NullS
+};
+
+/** Enumeration of innodb_page_compression */
+static TYPELIB innodb_page_compression_typelib = {
+	array_elements(innodb_page_compression_names) - 1,
+	"innodb_page_compression_typelib",
+	innodb_page_compression_names,
+	NULL
+};
+
+static MYSQL_THDVAR_ENUM(page_compression, PLUGIN_VAR_RQCMDARG,
+  "Algorithm with which the pages of the tables that are created or rebuilt"
+  " in their own tablespace are compressed when they are written to the data"
+  " file: none, zlib or lz4 (if InnoDB was built with it). The space that"
+  " compression saves is freed by punching holes into the file.",
+  NULL, NULL, OS_FILE_COMPRESSION_NONE, &innodb_page_compression_typelib);
+
 static SHOW_VAR innodb_status_variables[]= {
   {"buffer_pool_dump_status",
   (char*) &export_vars.innodb_buffer_pool_dump_status,	  SHOW_CHAR},
   {"buffer_pool_load_status",
   (char*) &export_vars.innodb_buffer_pool_load_status,	  SHOW_CHAR},
+  {"buffer_pool_resize_status",
+  (char*) &export_vars.innodb_buffer_pool_resize_status,  SHOW_CHAR},
   {"buffer_pool_pages_data",
   (char*) &export_vars.innodb_buffer_pool_pages_data,	  SHOW_LONG},
   {"buffer_pool_bytes_data",
@@ -3284,13 +3344,17 @@ innobase_change_buffering_inited_ok:
 		goto mem_free_and_error;
 	}
 
+	/* The buffer pool size may have been rounded up to whole
+	chunks */
+	innobase_buffer_pool_size = static_cast<long long>(srv_buf_pool_size);
+
 	/* Adjust the innodb_undo_logs config object */
 	innobase_undo_logs_init_default_max();
 
 	innobase_old_blocks_pct = static_cast<uint>(
 		buf_LRU_old_ratio_update(innobase_old_blocks_pct, TRUE));
 
-	ibuf_max_size_update(innobase_change_buffer_max_size);
+	ibuf_max_size_update(srv_change_buffer_max_size);
 
 	innobase_open_tables = hash_create(200);
 	mysql_mutex_init(innobase_share_mutex_key,
@@ -9040,6 +9104,40 @@ create_options_are_invalid(
 		break;
 	}
 
+	/* Page compression only works on a tablespace of the table's own,
+	and the pages of ROW_FORMAT=COMPRESSED are compressed already. */
+	if (THDVAR(thd, page_compression) != OS_FILE_COMPRESSION_NONE) {
+		if (!use_tablespace) {
+			push_warning(
+				thd, Sql_condition::WARN_LEVEL_WARN,
+				ER_ILLEGAL_HA_CREATE_OPTION,
+				"InnoDB: innodb_page_compression requires"
+				" innodb_file_per_table.");
+			ret = "innodb_page_compression";
+		}
+
+		if (row_format == ROW_TYPE_COMPRESSED || kbs_specified) {
+			push_warning(
+				thd, Sql_condition::WARN_LEVEL_WARN,
+				ER_ILLEGAL_HA_CREATE_OPTION,
+				"InnoDB: innodb_page_compression cannot be"
+				" used with ROW_FORMAT=COMPRESSED.");
+			ret = "innodb_page_compression";
+		}
+
+		if (!os_file_compression_is_supported(
+			    THDVAR(thd, page_compression))) {
+			push_warning_printf(
+				thd, Sql_condition::WARN_LEVEL_WARN,
+				ER_ILLEGAL_HA_CREATE_OPTION,
+				"InnoDB: innodb_page_compression=%s is not"
+				" supported by this build.",
+				innodb_page_compression_names[
+					THDVAR(thd, page_compression)]);
+			ret = "innodb_page_compression";
+		}
+	}
+
 	/* Use DATA DIRECTORY only with file-per-table. */
 	if (create_info->data_file_name && !use_tablespace) {
 		push_warning(
@@ -9239,6 +9337,7 @@ innobase_table_flags(
 	enum row_type	row_format;
 	rec_format_t	innodb_row_format = REC_FORMAT_COMPACT;
 	bool		use_data_dir;
+	ulint		page_compression;
 
 	/* Cache the value of innodb_file_format, in case it is
 	modified by another thread while the table is being created. */
@@ -9425,7 +9524,35 @@ index_bad:
 		       && ((create_info->data_file_name != NULL)
 		       && !(create_info->options & HA_LEX_CREATE_TMP_TABLE));
 
-	dict_tf_set(flags, innodb_row_format, zip_ssize, use_data_dir);
+	page_compression = THDVAR(thd, page_compression);
+
+	if (page_compression == OS_FILE_COMPRESSION_NONE) {
+	} else if (!use_tablespace) {
+		push_warning(
+			thd, Sql_condition::WARN_LEVEL_WARN,
+			ER_ILLEGAL_HA_CREATE_OPTION,
+			"InnoDB: innodb_page_compression requires"
+			" innodb_file_per_table.");
+		page_compression = OS_FILE_COMPRESSION_NONE;
+	} else if (zip_ssize) {
+		push_warning(
+			thd, Sql_condition::WARN_LEVEL_WARN,
+			ER_ILLEGAL_HA_CREATE_OPTION,
+			"InnoDB: ignoring innodb_page_compression"
+			" for ROW_FORMAT=COMPRESSED.");
+		page_compression = OS_FILE_COMPRESSION_NONE;
+	} else if (!os_file_compression_is_supported(page_compression)) {
+		push_warning_printf(
+			thd, Sql_condition::WARN_LEVEL_WARN,
+			ER_ILLEGAL_HA_CREATE_OPTION,
+			"InnoDB: innodb_page_compression=%s is not"
+			" supported by this build.",
+			innodb_page_compression_names[page_compression]);
+		page_compression = OS_FILE_COMPRESSION_NONE;
+	}
+
+	dict_tf_set(flags, innodb_row_format, zip_ssize, use_data_dir,
+		    page_compression);
 
 	if (create_info->options & HA_LEX_CREATE_TMP_TABLE) {
 		*flags2 |= DICT_TF2_TEMPORARY;
@@ -11902,6 +12029,19 @@ ha_innobase::extra(
 	case HA_EXTRA_KEYREAD_PRESERVE_FIELDS:
 		prebuilt->keep_other_fields_on_keyread = 1;
 		break;
+	case HA_EXTRA_LARGE_SCAN:
+		/* Until the end of the statement, let the pages that
+		the scan reads recycle a few buffer frames of their own
+		instead of filling the buffer pool. A table smaller than
+		a quarter of the buffer pool cannot flush it, and its
+		pages are better kept. */
+		if (prebuilt->scan_ring == NULL && srv_scan_ring_size > 0
+		    && stats.data_file_length
+		    > buf_pool_get_curr_size() / 4) {
+			prebuilt->scan_ring = buf_scan_ring_create(
+				srv_scan_ring_size);
+		}
+		break;
 
 		/* IMPORTANT: prebuilt->trx can be obsolete in
 		this method, because it is not sure that MySQL
@@ -11948,6 +12088,12 @@ ha_innobase::reset()
 	/* This is a statement level counter. */
 	prebuilt->autoinc_last_value = 0;
 
+	/* So is the large scan hint. */
+	if (prebuilt->scan_ring) {
+		buf_scan_ring_free(prebuilt->scan_ring);
+		prebuilt->scan_ring = NULL;
+	}
+
 	return(0);
 }
 
@@ -14372,9 +14518,120 @@ innodb_change_buffer_max_size_update(
 	const void*			save)	/*!< in: immediate result
 						from check function */
 {
-	innobase_change_buffer_max_size =
+	srv_change_buffer_max_size =
 			(*static_cast<const uint*>(save));
-	ibuf_max_size_update(innobase_change_buffer_max_size);
+	ibuf_max_size_update(srv_change_buffer_max_size);
+}
+
+/*************************************************************//**
+Check whether the buffer pool can be resized to the new value of
+innodb_buffer_pool_size, and round the value up to a whole number of
+chunks in every buffer pool instance.
+@return	0 if the buffer pool can be resized */
+static
+int
+innodb_buffer_pool_size_validate(
+/*=============================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to system
+						variable */
+	void*				save,	/*!< out: immediate result
+						for update function */
+	struct st_mysql_value*		value)	/*!< in: incoming value */
+{
+	longlong	intbuf;
+	ulint		requested;
+
+	value->val_int(value, &intbuf);
+
+	if (srv_read_only_mode) {
+		push_warning_printf(thd, Sql_condition::WARN_LEVEL_WARN,
+				    ER_WRONG_ARGUMENTS,
+				    "InnoDB: the buffer pool cannot be"
+				    " resized in read-only mode.");
+		return(1);
+	}
+
+	if (srv_buf_pool_old_size != srv_buf_pool_size) {
+		push_warning_printf(thd, Sql_condition::WARN_LEVEL_WARN,
+				    ER_WRONG_ARGUMENTS,
+				    "InnoDB: another resize of the buffer"
+				    " pool is in progress.");
+		return(1);
+	}
+
+	if (intbuf < 0
+	    || (sizeof(ulint) == 4 && intbuf > (longlong) UINT_MAX32)) {
+		push_warning_printf(thd, Sql_condition::WARN_LEVEL_WARN,
+				    ER_WRONG_ARGUMENTS,
+				    "InnoDB: innodb_buffer_pool_size is out"
+				    " of range.");
+		return(1);
+	}
+
+	requested = buf_pool_size_align(static_cast<ulint>(intbuf));
+
+	if (requested != static_cast<ulint>(intbuf)) {
+		push_warning_printf(thd, Sql_condition::WARN_LEVEL_WARN,
+				    ER_WRONG_ARGUMENTS,
+				    "InnoDB: innodb_buffer_pool_size is"
+				    " rounded up to %lu, a multiple of"
+				    " innodb_buffer_pool_chunk_size *"
+				    " innodb_buffer_pool_instances.",
+				    (ulong) requested);
+	}
+
+	*static_cast<longlong*>(save) = static_cast<longlong>(requested);
+
+	return(0);
+}
+
+/********************************************************************//**
+Sets innodb_buffer_pool_size to the size of the buffer pool that is in
+use, after the buffer pool could not be resized to the requested size.
+Only the buffer pool resize thread calls this, while innodb_buffer_pool_size
+cannot be changed. */
+UNIV_INTERN
+void
+innobase_set_buffer_pool_size(
+/*==========================*/
+	ulint	buf_pool_size)	/*!< in: size of the buffer pool in use */
+{
+	innobase_buffer_pool_size = static_cast<long long>(buf_pool_size);
+}
+
+/****************************************************************//**
+Update the system variable innodb_buffer_pool_size using the "saved"
+value, and wake up the thread that resizes the buffer pool. This
+function is registered as a callback with MySQL. */
+static
+void
+innodb_buffer_pool_size_update(
+/*===========================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to
+						system variable */
+	void*				var_ptr,/*!< out: where the
+						formal string goes */
+	const void*			save)	/*!< in: immediate result
+						from check function */
+{
+	longlong	in_val = *static_cast<const longlong*>(save);
+
+	*static_cast<longlong*>(var_ptr) = in_val;
+
+	if (static_cast<ulint>(in_val) == srv_buf_pool_size) {
+		return;
+	}
+
+	ut_snprintf(export_vars.innodb_buffer_pool_resize_status,
+		    sizeof(export_vars.innodb_buffer_pool_resize_status),
+		    "Requested to resize the buffer pool to %lu bytes.",
+		    (ulong) in_val);
+
+	srv_buf_pool_size = static_cast<ulint>(in_val);
+
+	os_event_set(srv_buf_resize_event);
 }
 
 #ifdef UNIV_DEBUG
@@ -15408,11 +15665,11 @@ checkpoint_now_set(
 						check function */
 {
 	if (*(my_bool*) save) {
-		while (log_sys->last_checkpoint_lsn < log_sys->lsn) {
+		while (log_sys->last_checkpoint_lsn < log_get_lsn()) {
 			log_make_checkpoint_at(LSN_MAX, TRUE);
 			fil_flush_file_spaces(FIL_LOG);
 		}
-		fil_write_flushed_lsn_to_data_files(log_sys->lsn, 0);
+		fil_write_flushed_lsn_to_data_files(log_get_lsn(), 0);
 		fil_flush_file_spaces(FIL_TABLESPACE);
 	}
 }
@@ -15542,6 +15799,32 @@ buffer_pool_dump_now(
 	}
 }
 
+/****************************************************************//**
+Update the system variable innodb_buffer_pool_dump_interval and wake up
+the buffer pool dump/load thread, so that the next periodic dump is
+scheduled according to the new value. */
+static
+void
+buffer_pool_dump_interval_update(
+/*=============================*/
+	THD*				thd	/*!< in: thread handle */
+					__attribute__((unused)),
+	struct st_mysql_sys_var*	var	/*!< in: pointer to system
+						variable */
+					__attribute__((unused)),
+	void*				var_ptr	/*!< out: where the formal
+						string goes */
+					__attribute__((unused)),
+	const void*			save)	/*!< in: immediate result from
+						check function */
+{
+	srv_buf_dump_interval = *static_cast<const ulong*>(save);
+
+	if (!srv_read_only_mode) {
+		os_event_set(srv_buf_dump_event);
+	}
+}
+
 /****************************************************************//**
 Trigger a load of the buffer pool if innodb_buffer_pool_load_now is set
 to ON. This function is registered as a callback with MySQL. */
@@ -15661,6 +15944,21 @@ static MYSQL_SYSVAR_BOOL(doublewrite, innobase_use_doublewrite,
   "Disable with --skip-innodb-doublewrite.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_ULONG(doublewrite_pages, srv_doublewrite_pages,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of pages in each doublewrite batch. Every buffer pool instance "
+  "has its own doublewrite file holding one batch for LRU flushing and "
+  "one for flush list flushing. 0 uses the doublewrite buffer in the "
+  "system tablespace for all flushing.",
+  NULL, NULL, 128, 0, 1024, 0);
+
+static MYSQL_SYSVAR_BOOL(use_atomic_writes, srv_use_atomic_writes,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Assume that the devices of all data files write a page at a time"
+  " atomically, and do not write the pages through the doublewrite buffer"
+  " (disabled by default).",
+  NULL, NULL, FALSE);
+
 static MYSQL_SYSVAR_ULONG(io_capacity, srv_io_capacity,
   PLUGIN_VAR_RQCMDARG,
   "Number of IOPs the server can do. Tunes the background IO rate",
@@ -15703,6 +16001,16 @@ static MYSQL_SYSVAR_ULONG(purge_batch_size, srv_purge_batch_size,
   1,			/* Minimum value */
   5000, 0);		/* Maximum value */
 
+static MYSQL_SYSVAR_ULONG(purge_rseg_truncate_frequency,
+  srv_purge_rseg_truncate_frequency,
+  PLUGIN_VAR_OPCMDARG,
+  "Number of purge batches after which the history list is truncated and "
+  "the undo tablespaces are checked for truncation.",
+  NULL, NULL,
+  128,			/* Default setting */
+  1,			/* Minimum value */
+  128, 0);		/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(purge_threads, srv_n_purge_threads,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
   "Purge threads can be from 1 to 32. Default is 1.",
@@ -15711,6 +16019,25 @@ static MYSQL_SYSVAR_ULONG(purge_threads, srv_n_purge_threads,
   1,			/* Minimum value */
   32, 0);		/* Maximum value */
 
+static MYSQL_SYSVAR_ULONG(page_cleaners, srv_n_page_cleaners,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Page cleaner threads can be from 1 to 64, including the coordinator. "
+  "It is capped at innodb_buffer_pool_instances. Default is 1.",
+  NULL, NULL,
+  1,			/* Default setting */
+  1,			/* Minimum value */
+  64, 0);		/* Maximum value */
+
+static MYSQL_SYSVAR_ULONG(recovery_apply_threads,
+  srv_n_recovery_apply_threads,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of threads applying redo log records to the pages during crash "
+  "recovery, from 1 to 64. Default is 4.",
+  NULL, NULL,
+  4,			/* Default setting */
+  1,			/* Minimum value */
+  64, 0);		/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(sync_array_size, srv_sync_array_size,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
   "Size of the mutex/lock wait array.",
@@ -15852,6 +16179,12 @@ static MYSQL_SYSVAR_ULONG(max_purge_lag_delay, srv_max_purge_lag_delay,
    0L,			/* Minimum value */
    10000000UL, 0);	/* Maximum value */
 
+static MYSQL_SYSVAR_ULONG(purge_read_ahead_pages, srv_purge_read_ahead_pages,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum number of undo log pages that purge reads ahead when it moves "
+  "on to the next undo log; 0 disables the read ahead.",
+  NULL, NULL, 8, 0, 64, 0);
+
 static MYSQL_SYSVAR_BOOL(rollback_on_timeout, innobase_rollback_on_timeout,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
   "Roll back the complete transaction on lock wait timeout, for 4.x compatibility (disabled by default)",
@@ -15907,6 +16240,15 @@ static MYSQL_SYSVAR_BOOL(adaptive_hash_index, btr_search_enabled,
   "Disable with --skip-innodb-adaptive-hash-index.",
   NULL, innodb_adaptive_hash_index_update, TRUE);
 
+static MYSQL_SYSVAR_ULONG(adaptive_hash_index_parts, btr_ahi_parts,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of InnoDB adaptive hash index partitions, each protected by "
+  "its own latch. An index belongs to one partition. Default is 8.",
+  NULL, NULL,
+  8,			/* Default setting */
+  1,			/* Minimum value */
+  512, 0);		/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(replication_delay, srv_replication_delay,
   PLUGIN_VAR_RQCMDARG,
   "Replication thread delay (ms) on the slave server if "
@@ -15942,9 +16284,16 @@ static MYSQL_SYSVAR_ULONG(autoextend_increment, srv_auto_extend_increment,
   NULL, NULL, 64L, 1L, 1000L, 0);
 
 static MYSQL_SYSVAR_LONGLONG(buffer_pool_size, innobase_buffer_pool_size,
-  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  PLUGIN_VAR_RQCMDARG,
   "The size of the memory buffer InnoDB uses to cache data and indexes of its tables.",
-  NULL, NULL, 128*1024*1024L, 5*1024*1024L, LONGLONG_MAX, 1024*1024L);
+  innodb_buffer_pool_size_validate,
+  innodb_buffer_pool_size_update, 128*1024*1024L, 5*1024*1024L, LONGLONG_MAX, 1024*1024L);
+
+static MYSQL_SYSVAR_ULONG(buffer_pool_chunk_size, srv_buf_pool_chunk_size,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Size of the chunks in which the buffer pool is allocated, and added or"
+  " removed when innodb_buffer_pool_size is changed.",
+  NULL, NULL, 128*1024*1024L, 1024*1024L, LONG_MAX, 1024*1024L);
 
 #if defined UNIV_DEBUG || defined UNIV_PERF_DEBUG
 static MYSQL_SYSVAR_ULONG(page_hash_locks, srv_n_page_hash_locks,
@@ -15963,6 +16312,13 @@ static MYSQL_SYSVAR_LONG(buffer_pool_instances, innobase_buffer_pool_instances,
   "Number of buffer pool instances, set to higher value on high-end machines to increase scalability",
   NULL, NULL, 0L, 0L, MAX_BUFFER_POOLS, 1L);
 
+static MYSQL_SYSVAR_BOOL(numa_aware, srv_numa_aware,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Bind the memory of each buffer pool instance to a NUMA node, "
+  "round-robin, and run the page cleaner and data file i/o threads "
+  "on the nodes of the instances they serve.",
+  NULL, NULL, FALSE);
+
 static MYSQL_SYSVAR_STR(buffer_pool_filename, srv_buf_dump_filename,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_MEMALLOC,
   "Filename to/from which to dump/load the InnoDB buffer pool",
@@ -15978,6 +16334,13 @@ static MYSQL_SYSVAR_BOOL(buffer_pool_dump_at_shutdown, srv_buffer_pool_dump_at_s
   "Dump the buffer pool into a file named @@innodb_buffer_pool_filename",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_ULONG(buffer_pool_dump_interval, srv_buf_dump_interval,
+  PLUGIN_VAR_RQCMDARG,
+  "Dump the buffer pool into a file named @@innodb_buffer_pool_filename"
+  " every this many seconds, if pages entered it since the previous dump,"
+  " so that a crashed server can load it at startup. 0 disables.",
+  NULL, buffer_pool_dump_interval_update, 0, 0, 86400, 0);
+
 #ifdef UNIV_DEBUG
 static MYSQL_SYSVAR_STR(buffer_pool_evict, srv_buffer_pool_evict,
   PLUGIN_VAR_RQCMDARG,
@@ -16006,6 +16369,21 @@ static MYSQL_SYSVAR_ULONG(lru_scan_depth, srv_LRU_scan_depth,
   "How deep to scan LRU to keep it clean",
   NULL, NULL, 1024, 100, ~0UL, 0);
 
+static MYSQL_SYSVAR_ULONG(unzip_lru_max_pct, srv_unzip_LRU_max_pct,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum percentage of the buffer pool that uncompressed copies of"
+  " compressed pages may take. Above it, uncompressed copies are evicted"
+  " before any other page, whatever decompressing them again costs.",
+  NULL, NULL, 100, 1, 100, 0);
+
+static MYSQL_SYSVAR_ULONG(scan_ring_size, srv_scan_ring_size,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of pages that a full table scan or a large range scan may keep"
+  " in the buffer pool. Beyond it, the scan evicts the pages it read"
+  " earlier rather than pushing other pages out of the buffer pool."
+  " 0 lets such scans use the buffer pool like any other query.",
+  NULL, NULL, 128, 0, 65536, 0);
+
 static MYSQL_SYSVAR_ULONG(flush_neighbors, srv_flush_neighbors,
   PLUGIN_VAR_OPCMDARG,
   "Set to 0 (don't flush neighbors from buffer pool),"
@@ -16086,6 +16464,18 @@ static MYSQL_SYSVAR_ULONG(sort_buffer_size, srv_sort_buf_size,
   "Memory buffer size for index creation",
   NULL, NULL, 1048576, 65536, 64<<20, 0);
 
+static MYSQL_SYSVAR_ULONG(sort_pll_degree, srv_sort_pll_degree,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of threads that scan the clustered index and merge sort the"
+  " entries when creating secondary indexes",
+  NULL, NULL, 4, 1, 16, 0);
+
+static MYSQL_SYSVAR_ULONG(fill_factor, srv_fill_factor,
+  PLUGIN_VAR_RQCMDARG,
+  "Percentage of each B-tree page to fill when an index is built from"
+  " sorted data",
+  NULL, NULL, 100, 10, 100, 0);
+
 static MYSQL_SYSVAR_ULONGLONG(online_alter_log_max_size, srv_online_max_size,
   PLUGIN_VAR_RQCMDARG,
   "Maximum modification log file size for online index creation",
@@ -16168,6 +16558,13 @@ static MYSQL_SYSVAR_ULONG(sync_spin_loops, srv_n_spin_wait_rounds,
   "Count of spin-loop rounds in InnoDB mutexes (30 by default)",
   NULL, NULL, 30L, 0L, ~0UL, 0);
 
+static MYSQL_SYSVAR_BOOL(adaptive_spin, srv_adaptive_spin,
+  PLUGIN_VAR_OPCMDARG,
+  "Let each mutex and rw-lock adapt the number of spin-loop rounds made"
+  " before a waiting thread is suspended to how long the latch is held,"
+  " between 4 and 4 times innodb_sync_spin_loops (enabled by default)",
+  NULL, NULL, TRUE);
+
 static MYSQL_SYSVAR_ULONG(spin_wait_delay, srv_spin_wait_delay,
   PLUGIN_VAR_OPCMDARG,
   "Maximum delay between polling for a spin lock (6 by default)",
@@ -16187,6 +16584,16 @@ static MYSQL_SYSVAR_ULONG(
   150000,			/* Default setting */
   0,				/* Minimum value */
   1000000, 0);			/* Maximum value */
+
+static MYSQL_SYSVAR_BOOL(thread_concurrency_queue,
+  srv_thread_concurrency_queue,
+  PLUGIN_VAR_OPCMDARG,
+  "If innodb_thread_concurrency threads are inside InnoDB, queue the threads"
+  " that want to enter and admit them in FIFO order as soon as a thread"
+  " leaves, threads of transactions holding locks first (enabled by"
+  " default). If disabled, such threads retry after sleeping"
+  " innodb_thread_sleep_delay microseconds.",
+  NULL, NULL, TRUE);
 #endif /* HAVE_ATOMIC_BUILTINS */
 
 static MYSQL_SYSVAR_ULONG(thread_sleep_delay, srv_thread_sleep_delay,
@@ -16233,6 +16640,22 @@ static MYSQL_SYSVAR_ULONG(rollback_segments, srv_undo_logs,
   1,			/* Minimum value */
   TRX_SYS_N_RSEGS, 0);	/* Maximum value */
 
+static MYSQL_SYSVAR_BOOL(undo_log_truncate, srv_undo_log_truncate,
+  PLUGIN_VAR_OPCMDARG,
+  "Truncate an undo tablespace back to its initial size once it has grown "
+  "beyond innodb_max_undo_log_size and its undo logs have been purged. "
+  "Requires at least two undo tablespaces.",
+  NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_ULONGLONG(max_undo_log_size, srv_max_undo_log_size,
+  PLUGIN_VAR_OPCMDARG,
+  "Size in bytes above which an undo tablespace is truncated, if "
+  "innodb_undo_log_truncate is enabled.",
+  NULL, NULL,
+  1024 * 1024 * 1024L,	/* Default setting */
+  10 * 1024 * 1024L,	/* Minimum value */
+  ~0ULL, 0);		/* Maximum value */
+
 static MYSQL_SYSVAR_LONG(autoinc_lock_mode, innobase_autoinc_lock_mode,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
   "The AUTOINC lock modes supported by InnoDB:               "
@@ -16261,6 +16684,13 @@ static MYSQL_SYSVAR_BOOL(use_native_aio, srv_use_native_aio,
   "Use native AIO if supported on this platform.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_BOOL(use_futex, srv_use_futex,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Suspend threads waiting for InnoDB mutexes and rw-locks on a futex"
+  " in the lock instead of an event in the sync wait array"
+  " (Linux only).",
+  NULL, NULL, FALSE);
+
 static MYSQL_SYSVAR_BOOL(api_enable_binlog, ib_binlog_enabled,
   PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
   "Enable binlog for applications direct access InnoDB through InnoDB APIs",
@@ -16300,7 +16730,7 @@ static MYSQL_SYSVAR_STR(change_buffering, innobase_change_buffering,
   innodb_change_buffering_update, "all");
 
 static MYSQL_SYSVAR_UINT(change_buffer_max_size,
-  innobase_change_buffer_max_size,
+  srv_change_buffer_max_size,
   PLUGIN_VAR_RQCMDARG,
   "Maximum on-disk size of change buffer in terms of percentage"
   " of the buffer pool.",
@@ -16338,6 +16768,12 @@ static MYSQL_SYSVAR_ULONG(read_ahead_threshold, srv_read_ahead_threshold,
   "trigger a readahead.",
   NULL, NULL, 56, 0, 64, 0);
 
+static MYSQL_SYSVAR_ULONG(clust_prefetch_pages, srv_clust_prefetch_pages,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum number of clustered index pages to read ahead for the lookups "
+  "of a secondary index range scan; 0 disables the read ahead.",
+  NULL, NULL, 0, 0, 64, 0);
+
 static MYSQL_SYSVAR_STR(monitor_enable, innobase_enable_monitor_counter,
   PLUGIN_VAR_RQCMDARG,
   "Turn on a monitor counter",
@@ -16376,6 +16812,23 @@ static MYSQL_SYSVAR_BOOL(print_all_deadlocks, srv_print_all_deadlocks,
   "Print all deadlocks to MySQL error log (off by default)",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_ENUM(deadlock_detect, srv_deadlock_detect,
+  PLUGIN_VAR_RQCMDARG,
+  "How deadlocks are detected. ON (the default) searches the waits-for"
+  " graph whenever a lock wait is enqueued, BACKGROUND searches a snapshot"
+  " of the graph in the lock timeout thread and OFF relies on"
+  " innodb_lock_wait_timeout to break deadlocks.",
+  NULL, NULL, SRV_DEADLOCK_DETECT_ON, &innodb_deadlock_detect_typelib);
+
+static MYSQL_SYSVAR_ENUM(lock_schedule_algorithm, srv_lock_schedule_algorithm,
+  PLUGIN_VAR_RQCMDARG,
+  "The order in which waiting record locks are granted when a lock is"
+  " released. FCFS (the default) grants them in queue order, OLDEST to the"
+  " transaction that started first and MOST_LOCKS to the transaction that"
+  " holds the most locks.",
+  NULL, NULL, SRV_LOCK_SCHEDULE_FCFS,
+  &innodb_lock_schedule_algorithm_typelib);
+
 static MYSQL_SYSVAR_ULONG(compression_failure_threshold_pct,
   zip_failure_threshold_pct, PLUGIN_VAR_OPCMDARG,
   "If the compression failure rate of a table is greater than this number"
@@ -16435,10 +16888,13 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(api_bk_commit_interval),
   MYSQL_SYSVAR(autoextend_increment),
   MYSQL_SYSVAR(buffer_pool_size),
+  MYSQL_SYSVAR(buffer_pool_chunk_size),
   MYSQL_SYSVAR(buffer_pool_instances),
+  MYSQL_SYSVAR(numa_aware),
   MYSQL_SYSVAR(buffer_pool_filename),
   MYSQL_SYSVAR(buffer_pool_dump_now),
   MYSQL_SYSVAR(buffer_pool_dump_at_shutdown),
+  MYSQL_SYSVAR(buffer_pool_dump_interval),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(buffer_pool_evict),
 #endif /* UNIV_DEBUG */
@@ -16446,6 +16902,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(buffer_pool_load_abort),
   MYSQL_SYSVAR(buffer_pool_load_at_startup),
   MYSQL_SYSVAR(lru_scan_depth),
+  MYSQL_SYSVAR(unzip_lru_max_pct),
+  MYSQL_SYSVAR(scan_ring_size),
   MYSQL_SYSVAR(flush_neighbors),
   MYSQL_SYSVAR(checksum_algorithm),
   MYSQL_SYSVAR(checksums),
@@ -16455,6 +16913,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(data_file_path),
   MYSQL_SYSVAR(data_home_dir),
   MYSQL_SYSVAR(doublewrite),
+  MYSQL_SYSVAR(doublewrite_pages),
+  MYSQL_SYSVAR(use_atomic_writes),
   MYSQL_SYSVAR(api_enable_binlog),
   MYSQL_SYSVAR(api_enable_mdl),
   MYSQL_SYSVAR(api_disable_rowlock),
@@ -16502,6 +16962,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(flushing_avg_loops),
   MYSQL_SYSVAR(max_purge_lag),
   MYSQL_SYSVAR(max_purge_lag_delay),
+  MYSQL_SYSVAR(purge_read_ahead_pages),
   MYSQL_SYSVAR(mirrored_log_groups),
   MYSQL_SYSVAR(old_blocks_pct),
   MYSQL_SYSVAR(old_blocks_time),
@@ -16520,25 +16981,31 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(stats_persistent_sample_pages),
   MYSQL_SYSVAR(stats_auto_recalc),
   MYSQL_SYSVAR(adaptive_hash_index),
+  MYSQL_SYSVAR(adaptive_hash_index_parts),
   MYSQL_SYSVAR(stats_method),
   MYSQL_SYSVAR(replication_delay),
   MYSQL_SYSVAR(status_file),
   MYSQL_SYSVAR(strict_mode),
   MYSQL_SYSVAR(support_xa),
   MYSQL_SYSVAR(sort_buffer_size),
+  MYSQL_SYSVAR(sort_pll_degree),
+  MYSQL_SYSVAR(fill_factor),
   MYSQL_SYSVAR(online_alter_log_max_size),
   MYSQL_SYSVAR(sync_spin_loops),
+  MYSQL_SYSVAR(adaptive_spin),
   MYSQL_SYSVAR(spin_wait_delay),
   MYSQL_SYSVAR(table_locks),
   MYSQL_SYSVAR(thread_concurrency),
 #ifdef HAVE_ATOMIC_BUILTINS
   MYSQL_SYSVAR(adaptive_max_sleep_delay),
+  MYSQL_SYSVAR(thread_concurrency_queue),
 #endif /* HAVE_ATOMIC_BUILTINS */
   MYSQL_SYSVAR(thread_sleep_delay),
   MYSQL_SYSVAR(autoinc_lock_mode),
   MYSQL_SYSVAR(version),
   MYSQL_SYSVAR(use_sys_malloc),
   MYSQL_SYSVAR(use_native_aio),
+  MYSQL_SYSVAR(use_futex),
   MYSQL_SYSVAR(change_buffering),
   MYSQL_SYSVAR(change_buffer_max_size),
 #if defined UNIV_DEBUG || defined UNIV_IBUF_DEBUG
@@ -16547,6 +17014,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
 #endif /* UNIV_DEBUG || UNIV_IBUF_DEBUG */
   MYSQL_SYSVAR(random_read_ahead),
   MYSQL_SYSVAR(read_ahead_threshold),
+  MYSQL_SYSVAR(clust_prefetch_pages),
   MYSQL_SYSVAR(read_only),
   MYSQL_SYSVAR(io_capacity),
   MYSQL_SYSVAR(io_capacity_max),
@@ -16555,7 +17023,10 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(monitor_reset),
   MYSQL_SYSVAR(monitor_reset_all),
   MYSQL_SYSVAR(purge_threads),
+  MYSQL_SYSVAR(page_cleaners),
+  MYSQL_SYSVAR(recovery_apply_threads),
   MYSQL_SYSVAR(purge_batch_size),
+  MYSQL_SYSVAR(purge_rseg_truncate_frequency),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(purge_run_now),
   MYSQL_SYSVAR(purge_stop_now),
@@ -16569,14 +17040,19 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(status_output),
   MYSQL_SYSVAR(status_output_locks),
   MYSQL_SYSVAR(print_all_deadlocks),
+  MYSQL_SYSVAR(deadlock_detect),
+  MYSQL_SYSVAR(lock_schedule_algorithm),
   MYSQL_SYSVAR(cmp_per_index_enabled),
   MYSQL_SYSVAR(undo_logs),
   MYSQL_SYSVAR(rollback_segments),
   MYSQL_SYSVAR(undo_directory),
   MYSQL_SYSVAR(undo_tablespaces),
+  MYSQL_SYSVAR(undo_log_truncate),
+  MYSQL_SYSVAR(max_undo_log_size),
   MYSQL_SYSVAR(sync_array_size),
   MYSQL_SYSVAR(compression_failure_threshold_pct),
   MYSQL_SYSVAR(compression_pad_pct_max),
+  MYSQL_SYSVAR(page_compression),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(trx_rseg_n_slots_debug),
   MYSQL_SYSVAR(limit_optimistic_insert_debug),
@@ -16606,6 +17082,9 @@ mysql_declare_plugin(innobase)
 i_s_innodb_trx,
 i_s_innodb_locks,
 i_s_innodb_lock_waits,
+i_s_innodb_lock_wait_graph,
+i_s_innodb_latches,
+i_s_innodb_page_compression_stats,
 i_s_innodb_cmp,
 i_s_innodb_cmp_reset,
 i_s_innodb_cmpmem,
@@ -48,6 +48,7 @@ Created July 18, 2007 Vasil Dimov
 #include "srv0start.h"
 #include "trx0i_s.h"
 #include "trx0trx.h"
+#include "lock0lock.h"
 #include "srv0mon.h"
 #include "fut0fut.h"
 #include "pars0pars.h"
@@ -1260,6 +1261,681 @@ UNIV_INTERN struct st_mysql_plugin	i_s_innodb_lock_waits =
 	STRUCT_FLD(flags, 0UL),
 };
 
+/* Fields of the dynamic table INFORMATION_SCHEMA.innodb_lock_wait_graph */
+static ST_FIELD_INFO	innodb_lock_wait_graph_fields_info[] =
+{
+#define IDX_WFG_REQUESTING_TRX_ID	0
+	{STRUCT_FLD(field_name,		"requesting_trx_id"),
+	 STRUCT_FLD(field_length,	TRX_ID_MAX_LEN + 1),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_STRING),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	0),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_WFG_BLOCKING_TRX_ID		1
+	{STRUCT_FLD(field_name,		"blocking_trx_id"),
+	 STRUCT_FLD(field_length,	TRX_ID_MAX_LEN + 1),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_STRING),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	0),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_WFG_WAIT_SECONDS		2
+	{STRUCT_FLD(field_name,		"wait_seconds"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_WFG_BLOCKING_TRX_WAITING	3
+	{STRUCT_FLD(field_name,		"blocking_trx_waiting"),
+	 STRUCT_FLD(field_length,	1),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+	END_OF_ST_FIELD_INFO
+};
+
+/*******************************************************************//**
+Fill the dynamic table INFORMATION_SCHEMA.innodb_lock_wait_graph with
+a snapshot of the waits-for graph of the transactions that are suspended
+in a lock wait.
+@return	0 on success */
+static
+int
+i_s_innodb_lock_wait_graph_fill_table(
+/*==================================*/
+	THD*		thd,	/*!< in: thread */
+	TABLE_LIST*	tables,	/*!< in/out: tables to fill */
+	Item*		)	/*!< in: condition (not used) */
+{
+	Field**			fields;
+	mem_heap_t*		heap;
+	lock_wait_edge_t*	edges;
+	ulint			n_edges;
+	ib_time_t		now;
+	int			ret = 0;
+
+	DBUG_ENTER("i_s_innodb_lock_wait_graph_fill_table");
+
+	/* deny access to non-superusers */
+	if (check_global_access(thd, PROCESS_ACL)) {
+
+		DBUG_RETURN(0);
+	}
+
+	RETURN_IF_INNODB_NOT_STARTED(tables->schema_table_name);
+
+	fields = tables->table->field;
+
+	heap = mem_heap_create(1024);
+
+	n_edges = lock_wait_graph_get(heap, &edges);
+
+	now = ut_time();
+
+	for (ulint i = 0; i < n_edges; i++) {
+		const lock_wait_edge_t*	edge = &edges[i];
+		char			trx_id[TRX_ID_MAX_LEN + 1];
+		double			wait_time;
+
+		ut_snprintf(trx_id, sizeof(trx_id),
+			    TRX_ID_FMT, edge->requesting_trx_id);
+		OK(field_store_string(fields[IDX_WFG_REQUESTING_TRX_ID],
+				      trx_id));
+
+		ut_snprintf(trx_id, sizeof(trx_id),
+			    TRX_ID_FMT, edge->blocking_trx_id);
+		OK(field_store_string(fields[IDX_WFG_BLOCKING_TRX_ID],
+				      trx_id));
+
+		wait_time = ut_difftime(now, edge->wait_started);
+
+		OK(fields[IDX_WFG_WAIT_SECONDS]->store(
+			   wait_time > 0 ? (longlong) wait_time : 0, true));
+
+		OK(fields[IDX_WFG_BLOCKING_TRX_WAITING]->store(
+			   edge->blocking_trx_waits, true));
+
+		if (schema_table_store_record(thd, tables->table)) {
+			ret = 1;
+			break;
+		}
+	}
+
+	mem_heap_free(heap);
+
+	DBUG_RETURN(ret);
+}
+
+/*******************************************************************//**
+Bind the dynamic table INFORMATION_SCHEMA.innodb_lock_wait_graph
+@return	0 on success */
+static
+int
+innodb_lock_wait_graph_init(
+/*========================*/
+	void*	p)	/*!< in/out: table schema object */
+{
+	ST_SCHEMA_TABLE*	schema;
+
+	DBUG_ENTER("innodb_lock_wait_graph_init");
+
+	schema = (ST_SCHEMA_TABLE*) p;
+
+	schema->fields_info = innodb_lock_wait_graph_fields_info;
+	schema->fill_table = i_s_innodb_lock_wait_graph_fill_table;
+
+	DBUG_RETURN(0);
+}
+
+UNIV_INTERN struct st_mysql_plugin	i_s_innodb_lock_wait_graph =
+{
+	/* the plugin type (a MYSQL_XXX_PLUGIN value) */
+	/* int */
+	STRUCT_FLD(type, MYSQL_INFORMATION_SCHEMA_PLUGIN),
+
+	/* pointer to type-specific plugin descriptor */
+	/* void* */
+	STRUCT_FLD(info, &i_s_info),
+
+	/* plugin name */
+	/* const char* */
+	STRUCT_FLD(name, "INNODB_LOCK_WAIT_GRAPH"),
+
+	/* plugin author (for SHOW PLUGINS) */
+	/* const char* */
+	STRUCT_FLD(author, plugin_author),
+
+	/* general descriptive text (for SHOW PLUGINS) */
+	/* const char* */
+	STRUCT_FLD(descr, "InnoDB transaction waits-for graph"),
+
+	/* the plugin license (PLUGIN_LICENSE_XXX) */
+	/* int */
+	STRUCT_FLD(license, PLUGIN_LICENSE_GPL),
+
+	/* the function to invoke when plugin is loaded */
+	/* int (*)(void*); */
+	STRUCT_FLD(init, innodb_lock_wait_graph_init),
+
+	/* the function to invoke when plugin is unloaded */
+	/* int (*)(void*); */
+	STRUCT_FLD(deinit, i_s_common_deinit),
+
+	/* plugin version (for SHOW PLUGINS) */
+	/* unsigned int */
+	STRUCT_FLD(version, INNODB_VERSION_SHORT),
+
+	/* struct st_mysql_show_var* */
+	STRUCT_FLD(status_vars, NULL),
+
+	/* struct st_mysql_sys_var** */
+	STRUCT_FLD(system_vars, NULL),
+
+	/* reserved for dependency checking */
+	/* void* */
+	STRUCT_FLD(__reserved1, NULL),
+
+	/* Plugin flags */
+	/* unsigned long */
+	STRUCT_FLD(flags, 0UL),
+};
+
+/** Length of INFORMATION_SCHEMA.innodb_latches.name */
+#define I_S_LATCH_NAME_LEN	128
+
+/* Fields of the dynamic table INFORMATION_SCHEMA.innodb_latches */
+static ST_FIELD_INFO	innodb_latches_fields_info[] =
+{
+#define IDX_LATCH_TYPE		0
+	{STRUCT_FLD(field_name,		"latch_type"),
+	 STRUCT_FLD(field_length,	8),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_STRING),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	0),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_LATCH_NAME		1
+	{STRUCT_FLD(field_name,		"name"),
+	 STRUCT_FLD(field_length,	I_S_LATCH_NAME_LEN),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_STRING),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	0),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_LATCH_INSTANCES	2
+	{STRUCT_FLD(field_name,		"instances"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_LATCH_SPIN_WAITS	3
+	{STRUCT_FLD(field_name,		"spin_waits"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_LATCH_SPIN_ROUNDS	4
+	{STRUCT_FLD(field_name,		"spin_rounds"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_LATCH_SPIN_ACQUIRED	5
+	{STRUCT_FLD(field_name,		"spin_acquired"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_LATCH_OS_WAITS	6
+	{STRUCT_FLD(field_name,		"os_waits"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_LATCH_SPIN_LIMIT	7
+	{STRUCT_FLD(field_name,		"spin_limit"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_LATCH_AVG_HOLD_NS	8
+	{STRUCT_FLD(field_name,		"avg_hold_time_ns"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+	END_OF_ST_FIELD_INFO
+};
+
+/*******************************************************************//**
+Fill the dynamic table INFORMATION_SCHEMA.innodb_latches with the spin
+and wait statistics of the mutexes and rw-locks that have been waited for.
+@return	0 on success */
+static
+int
+i_s_innodb_latches_fill_table(
+/*==========================*/
+	THD*		thd,	/*!< in: thread */
+	TABLE_LIST*	tables,	/*!< in/out: tables to fill */
+	Item*		)	/*!< in: condition (not used) */
+{
+	Field**			fields;
+	sync_latch_stats_t*	stats;
+	ulint			n_stats;
+	int			ret = 0;
+
+	DBUG_ENTER("i_s_innodb_latches_fill_table");
+
+	/* deny access to non-superusers */
+	if (check_global_access(thd, PROCESS_ACL)) {
+
+		DBUG_RETURN(0);
+	}
+
+	RETURN_IF_INNODB_NOT_STARTED(tables->schema_table_name);
+
+	fields = tables->table->field;
+
+	n_stats = sync_latch_stats_get(&stats);
+
+	for (ulint i = 0; i < n_stats; i++) {
+		const sync_latch_stats_t*	latch = &stats[i];
+		char				name[I_S_LATCH_NAME_LEN];
+
+		ut_snprintf(name, sizeof name, "%s%s:%lu",
+			    latch->combined ? "combined " : "",
+			    innobase_basename(latch->cfile_name),
+			    (ulong) latch->cline);
+
+		OK(field_store_string(fields[IDX_LATCH_TYPE],
+				      latch->is_rw_lock
+				      ? "rw_lock" : "mutex"));
+		OK(field_store_string(fields[IDX_LATCH_NAME], name));
+		OK(fields[IDX_LATCH_INSTANCES]->store(
+			   latch->n_instances, true));
+		OK(fields[IDX_LATCH_SPIN_WAITS]->store(
+			   latch->n_waits, true));
+		OK(fields[IDX_LATCH_SPIN_ROUNDS]->store(
+			   latch->n_rounds, true));
+		OK(fields[IDX_LATCH_SPIN_ACQUIRED]->store(
+			   latch->n_spin_acquired, true));
+		OK(fields[IDX_LATCH_OS_WAITS]->store(
+			   latch->n_os_waits, true));
+		OK(fields[IDX_LATCH_SPIN_LIMIT]->store(
+			   latch->spin_limit, true));
+		OK(fields[IDX_LATCH_AVG_HOLD_NS]->store(
+			   latch->hold_time, true));
+
+		if (schema_table_store_record(thd, tables->table)) {
+			ret = 1;
+			break;
+		}
+	}
+
+	ut_free(stats);
+
+	DBUG_RETURN(ret);
+}
+
+/*******************************************************************//**
+Bind the dynamic table INFORMATION_SCHEMA.innodb_latches
+@return	0 on success */
+static
+int
+innodb_latches_init(
+/*================*/
+	void*	p)	/*!< in/out: table schema object */
+{
+	ST_SCHEMA_TABLE*	schema;
+
+	DBUG_ENTER("innodb_latches_init");
+
+	schema = (ST_SCHEMA_TABLE*) p;
+
+	schema->fields_info = innodb_latches_fields_info;
+	schema->fill_table = i_s_innodb_latches_fill_table;
+
+	DBUG_RETURN(0);
+}
+
+UNIV_INTERN struct st_mysql_plugin	i_s_innodb_latches =
+{
+	/* the plugin type (a MYSQL_XXX_PLUGIN value) */
+	/* int */
+	STRUCT_FLD(type, MYSQL_INFORMATION_SCHEMA_PLUGIN),
+
+	/* pointer to type-specific plugin descriptor */
+	/* void* */
+	STRUCT_FLD(info, &i_s_info),
+
+	/* plugin name */
+	/* const char* */
+	STRUCT_FLD(name, "INNODB_LATCHES"),
+
+	/* plugin author (for SHOW PLUGINS) */
+	/* const char* */
+	STRUCT_FLD(author, plugin_author),
+
+	/* general descriptive text (for SHOW PLUGINS) */
+	/* const char* */
+	STRUCT_FLD(descr, "InnoDB mutex and rw-lock spin and wait statistics"),
+
+	/* the plugin license (PLUGIN_LICENSE_XXX) */
+	/* int */
+	STRUCT_FLD(license, PLUGIN_LICENSE_GPL),
+
+	/* the function to invoke when plugin is loaded */
+	/* int (*)(void*); */
+	STRUCT_FLD(init, innodb_latches_init),
+
+	/* the function to invoke when plugin is unloaded */
+	/* int (*)(void*); */
+	STRUCT_FLD(deinit, i_s_common_deinit),
+
+	/* plugin version (for SHOW PLUGINS) */
+	/* unsigned int */
+	STRUCT_FLD(version, INNODB_VERSION_SHORT),
+
+	/* struct st_mysql_show_var* */
+	STRUCT_FLD(status_vars, NULL),
+
+	/* struct st_mysql_sys_var** */
+	STRUCT_FLD(system_vars, NULL),
+
+	/* reserved for dependency checking */
+	/* void* */
+	STRUCT_FLD(__reserved1, NULL),
+
+	/* Plugin flags */
+	/* unsigned long */
+	STRUCT_FLD(flags, 0UL),
+};
+
+/* Fields of the dynamic table
+INFORMATION_SCHEMA.innodb_page_compression_stats */
+static ST_FIELD_INFO	innodb_page_compression_stats_fields_info[] =
+{
+#define IDX_PAGE_COMPRESS_SPACE	0
+	{STRUCT_FLD(field_name,		"space"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_PAGE_COMPRESS_NAME	1
+	{STRUCT_FLD(field_name,		"name"),
+	 STRUCT_FLD(field_length,	MAX_FULL_NAME_LEN),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_STRING),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	0),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_PAGE_COMPRESS_ALGORITHM	2
+	{STRUCT_FLD(field_name,		"algorithm"),
+	 STRUCT_FLD(field_length,	4),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_STRING),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	0),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_PAGE_COMPRESS_PUNCH_HOLE	3
+	{STRUCT_FLD(field_name,		"punch_hole"),
+	 STRUCT_FLD(field_length,	1),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_PAGE_COMPRESS_OPS	4
+	{STRUCT_FLD(field_name,		"compress_ops"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_PAGE_COMPRESS_OPS_OK	5
+	{STRUCT_FLD(field_name,		"compress_ops_ok"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_PAGE_COMPRESS_TIME	6
+	{STRUCT_FLD(field_name,		"compress_time"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_PAGE_UNCOMPRESS_OPS	7
+	{STRUCT_FLD(field_name,		"uncompress_ops"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_PAGE_UNCOMPRESS_TIME	8
+	{STRUCT_FLD(field_name,		"uncompress_time"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_PAGE_COMPRESS_PAGE_BYTES	9
+	{STRUCT_FLD(field_name,		"uncompressed_bytes"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_PAGE_COMPRESS_WRITTEN_BYTES	10
+	{STRUCT_FLD(field_name,		"compressed_bytes"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+	END_OF_ST_FIELD_INFO
+};
+
+/*******************************************************************//**
+Fill the dynamic table INFORMATION_SCHEMA.innodb_page_compression_stats
+with the transparent page compression counters of the tablespaces. The
+times are in seconds, as in INFORMATION_SCHEMA.innodb_cmp.
+@return	0 on success */
+static
+int
+i_s_innodb_page_compression_stats_fill_table(
+/*=========================================*/
+	THD*		thd,	/*!< in: thread */
+	TABLE_LIST*	tables,	/*!< in/out: tables to fill */
+	Item*		)	/*!< in: condition (not used) */
+{
+	static const char*		algorithms[] = {
+		"none", "zlib", "lz4"
+	};
+	Field**				fields;
+	fil_space_compress_stats_t*	stats;
+	ulint				n_stats;
+	int				ret = 0;
+
+	DBUG_ENTER("i_s_innodb_page_compression_stats_fill_table");
+
+	/* deny access to non-superusers */
+	if (check_global_access(thd, PROCESS_ACL)) {
+
+		DBUG_RETURN(0);
+	}
+
+	RETURN_IF_INNODB_NOT_STARTED(tables->schema_table_name);
+
+	fields = tables->table->field;
+
+	n_stats = fil_space_get_compress_stats(&stats);
+
+	for (ulint i = 0; i < n_stats; i++) {
+		const os_file_compress_t*	compress = &stats[i].compress;
+
+		ut_ad(compress->algorithm < UT_ARR_SIZE(algorithms));
+
+		OK(fields[IDX_PAGE_COMPRESS_SPACE]->store(stats[i].id, true));
+		OK(field_store_string(fields[IDX_PAGE_COMPRESS_NAME],
+				      stats[i].name));
+		OK(field_store_string(fields[IDX_PAGE_COMPRESS_ALGORITHM],
+				      algorithms[compress->algorithm]));
+		OK(fields[IDX_PAGE_COMPRESS_PUNCH_HOLE]->store(
+			   compress->punch_hole, true));
+		OK(fields[IDX_PAGE_COMPRESS_OPS]->store(
+			   compress->compress_ops, true));
+		OK(fields[IDX_PAGE_COMPRESS_OPS_OK]->store(
+			   compress->compress_ops_ok, true));
+		OK(fields[IDX_PAGE_COMPRESS_TIME]->store(
+			   compress->compress_time / 1000000, true));
+		OK(fields[IDX_PAGE_UNCOMPRESS_OPS]->store(
+			   compress->uncompress_ops, true));
+		OK(fields[IDX_PAGE_UNCOMPRESS_TIME]->store(
+			   compress->uncompress_time / 1000000, true));
+		OK(fields[IDX_PAGE_COMPRESS_PAGE_BYTES]->store(
+			   compress->page_bytes, true));
+		OK(fields[IDX_PAGE_COMPRESS_WRITTEN_BYTES]->store(
+			   compress->written_bytes, true));
+
+		if (schema_table_store_record(thd, tables->table)) {
+			ret = 1;
+			break;
+		}
+	}
+
+	ut_free(stats);
+
+	DBUG_RETURN(ret);
+}
+
+/*******************************************************************//**
+Bind the dynamic table INFORMATION_SCHEMA.innodb_page_compression_stats
+@return	0 on success */
+static
+int
+innodb_page_compression_stats_init(
+/*===============================*/
+	void*	p)	/*!< in/out: table schema object */
+{
+	ST_SCHEMA_TABLE*	schema;
+
+	DBUG_ENTER("innodb_page_compression_stats_init");
+
+	schema = (ST_SCHEMA_TABLE*) p;
+
+	schema->fields_info = innodb_page_compression_stats_fields_info;
+	schema->fill_table = i_s_innodb_page_compression_stats_fill_table;
+
+	DBUG_RETURN(0);
+}
+
+UNIV_INTERN struct st_mysql_plugin	i_s_innodb_page_compression_stats =
+{
+	/* the plugin type (a MYSQL_XXX_PLUGIN value) */
+	/* int */
+	STRUCT_FLD(type, MYSQL_INFORMATION_SCHEMA_PLUGIN),
+
+	/* pointer to type-specific plugin descriptor */
+	/* void* */
+	STRUCT_FLD(info, &i_s_info),
+
+	/* plugin name */
+	/* const char* */
+	STRUCT_FLD(name, "INNODB_PAGE_COMPRESSION_STATS"),
+
+	/* plugin author (for SHOW PLUGINS) */
+	/* const char* */
+	STRUCT_FLD(author, plugin_author),
+
+	/* general descriptive text (for SHOW PLUGINS) */
+	/* const char* */
+	STRUCT_FLD(descr, "InnoDB transparent page compression statistics"),
+
+	/* the plugin license (PLUGIN_LICENSE_XXX) */
+	/* int */
+	STRUCT_FLD(license, PLUGIN_LICENSE_GPL),
+
+	/* the function to invoke when plugin is loaded */
+	/* int (*)(void*); */
+	STRUCT_FLD(init, innodb_page_compression_stats_init),
+
+	/* the function to invoke when plugin is unloaded */
+	/* int (*)(void*); */
+	STRUCT_FLD(deinit, i_s_common_deinit),
+
+	/* plugin version (for SHOW PLUGINS) */
+	/* unsigned int */
+	STRUCT_FLD(version, INNODB_VERSION_SHORT),
+
+	/* struct st_mysql_show_var* */
+	STRUCT_FLD(status_vars, NULL),
+
+	/* struct st_mysql_sys_var** */
+	STRUCT_FLD(system_vars, NULL),
+
+	/* reserved for dependency checking */
+	/* void* */
+	STRUCT_FLD(__reserved1, NULL),
+
+	/* Plugin flags */
+	/* unsigned long */
+	STRUCT_FLD(flags, 0UL),
+};
+
 /*******************************************************************//**
 Common function to fill any of the dynamic tables:
 INFORMATION_SCHEMA.innodb_trx
@@ -5230,9 +5906,11 @@ i_s_innodb_fill_buffer_pool(
 
 	heap = mem_heap_create(10000);
 
-	/* Go through each chunk of buffer pool. Currently, we only
-	have one single chunk for each buffer pool */
-	for (ulint n = 0; n < buf_pool->n_chunks; n++) {
+	/* Go through each chunk of buffer pool. The chunks may be
+	added or removed by a resize of the buffer pool whenever we
+	release the buffer pool mutex, so look the chunk up again
+	every time we acquire it. */
+	for (ulint n = 0; ; n++) {
 		const buf_block_t*	block;
 		ulint			n_blocks;
 		buf_page_info_t*	info_buffer;
@@ -5242,8 +5920,18 @@ i_s_innodb_fill_buffer_pool(
 		ulint			num_to_process = 0;
 		ulint			block_id = 0;
 
-		/* Get buffer block of the nth chunk */
-		block = buf_get_nth_chunk_block(buf_pool, n, &chunk_size);
+		buf_pool_mutex_enter(buf_pool);
+
+		if (n >= buf_pool->n_chunks) {
+			buf_pool_mutex_exit(buf_pool);
+			break;
+		}
+
+		/* Get the size of the nth chunk */
+		buf_get_nth_chunk_block(buf_pool, n, &chunk_size);
+
+		buf_pool_mutex_exit(buf_pool);
+
 		num_page = 0;
 
 		while (chunk_size > 0) {
@@ -5266,6 +5954,20 @@ i_s_innodb_fill_buffer_pool(
 			release mutex periodically */
 			buf_pool_mutex_enter(buf_pool);
 
+			if (n >= buf_pool->n_chunks) {
+				/* The chunk was removed. */
+				buf_pool_mutex_exit(buf_pool);
+				break;
+			}
+
+			block = buf_get_nth_chunk_block(
+				buf_pool, n, &n_blocks) + block_id;
+
+			if (block_id + num_to_process > n_blocks) {
+				buf_pool_mutex_exit(buf_pool);
+				break;
+			}
+
 			/* GO through each block in the chunk */
 			for (n_blocks = num_to_process; n_blocks--; block++) {
 				i_s_innodb_buffer_page_get_info(
@@ -31,6 +31,9 @@ const char plugin_author[] = "Oracle Corporation";
 extern struct st_mysql_plugin	i_s_innodb_trx;
 extern struct st_mysql_plugin	i_s_innodb_locks;
 extern struct st_mysql_plugin	i_s_innodb_lock_waits;
+extern struct st_mysql_plugin	i_s_innodb_lock_wait_graph;
+extern struct st_mysql_plugin	i_s_innodb_latches;
+extern struct st_mysql_plugin	i_s_innodb_page_compression_stats;
 extern struct st_mysql_plugin	i_s_innodb_cmp;
 extern struct st_mysql_plugin	i_s_innodb_cmp_reset;
 extern struct st_mysql_plugin	i_s_innodb_cmp_per_index;
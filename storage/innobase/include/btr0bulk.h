@@ -0,0 +1,85 @@
+/*****************************************************************************
+
+Copyright (c) 2014, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/********************************************************************//**
+@file include/btr0bulk.h
+Bottom-up loading of a B-tree from sorted input
+
+The leaf pages are filled from left to right, up to the fill factor
+innodb_fill_factor, without descending the tree for each record. A node
+pointer is appended to the level above whenever a page is started, and
+the single page of the highest level is finally copied to the root.
+*************************************************************************/
+
+#ifndef btr0bulk_h
+#define btr0bulk_h
+
+#include "univ.i"
+#include "btr0types.h"
+#include "data0types.h"
+#include "dict0types.h"
+#include "trx0types.h"
+
+/*********************************************************************//**
+Checks if an index can be loaded with btr_bulk_insert().
+@return	true if the index can be bulk loaded */
+UNIV_INTERN
+bool
+btr_bulk_is_supported(
+/*==================*/
+	const dict_index_t*	index)	/*!< in: index */
+	__attribute__((nonnull, warn_unused_result));
+/*********************************************************************//**
+Creates a bulk loader for an empty index. Nobody else may modify the
+index until btr_bulk_finish() has been called.
+@return	own: bulk loader */
+UNIV_INTERN
+btr_bulk_t*
+btr_bulk_create(
+/*============*/
+	dict_index_t*	index,	/*!< in: empty index */
+	trx_id_t	trx_id)	/*!< in: transaction identifier, for
+				PAGE_MAX_TRX_ID of secondary indexes */
+	__attribute__((nonnull, warn_unused_result));
+/*********************************************************************//**
+Appends a tuple to the index. The tuples must be inserted in ascending
+order, and they must not contain externally stored columns.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_insert(
+/*============*/
+	btr_bulk_t*	bulk,	/*!< in/out: bulk loader */
+	dtuple_t*	tuple)	/*!< in/out: tuple to insert; fields may
+				be moved off-page */
+	__attribute__((nonnull, warn_unused_result));
+/*********************************************************************//**
+Completes the loading of an index and frees the bulk loader. On
+failure, the pages loaded so far are left to be freed with the index.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_finish(
+/*============*/
+	btr_bulk_t*	bulk,	/*!< in,own: bulk loader */
+	dberr_t		err)	/*!< in: error from btr_bulk_insert(), or
+				DB_SUCCESS if the load should be
+				completed */
+	__attribute__((nonnull, warn_unused_result));
+
+#endif /* btr0bulk_h */
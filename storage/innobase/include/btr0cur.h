@@ -203,6 +203,18 @@ btr_cur_open_at_rnd_pos_func(
 	mtr_t*		mtr);		/*!< in: mtr */
 #define btr_cur_open_at_rnd_pos(i,l,c,m)				\
 	btr_cur_open_at_rnd_pos_func(i,l,c,__FILE__,__LINE__,m)
+/**********************************************************************//**
+Looks up the leaf page that a search tuple belongs to, without accessing
+the leaf page itself. The index tree is s-latched in mtr.
+@return	leaf page number, or FIL_NULL if the root page is a leaf page */
+UNIV_INTERN
+ulint
+btr_cur_get_leaf_page_no(
+/*=====================*/
+	dict_index_t*	index,	/*!< in: index */
+	const dtuple_t*	tuple,	/*!< in: search tuple */
+	mtr_t*		mtr)	/*!< in/out: mini-transaction */
+	__attribute__((nonnull, warn_unused_result));
 /*************************************************************//**
 Tries to perform an insert to a page in an index tree, next to cursor.
 It is assumed that mtr holds an x-latch on the page. The operation does
@@ -612,12 +624,15 @@ enum blob_op {
 	/** Store off-page columns for an insert by update */
 	BTR_STORE_INSERT_UPDATE,
 	/** Store off-page columns for an update */
-	BTR_STORE_UPDATE
+	BTR_STORE_UPDATE,
+	/** Store off-page columns for a record that was appended
+	to a page by btr_bulk_insert() in btr_mtr */
+	BTR_STORE_INSERT_BULK
 };
 
 /*******************************************************************//**
 Determine if an operation on off-page columns is an update.
-@return TRUE if op != BTR_STORE_INSERT */
+@return TRUE if op is BTR_STORE_INSERT_UPDATE or BTR_STORE_UPDATE */
 UNIV_INLINE
 ibool
 btr_blob_op_is_update(
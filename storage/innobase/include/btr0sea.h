@@ -35,12 +35,13 @@ Created 2/17/1996 Heikki Tuuri
 #include "ha0ha.h"
 
 /*****************************************************************//**
-Creates and initializes the adaptive search system at a database start. */
+Creates and initializes the adaptive search system at a database start.
+The hash table size is divided evenly among btr_ahi_parts partitions. */
 UNIV_INTERN
 void
 btr_search_sys_create(
 /*==================*/
-	ulint	hash_size);	/*!< in: hash index hash table size */
+	ulint	hash_size);	/*!< in: total hash index hash table size */
 /*****************************************************************//**
 Frees the adaptive search system at a database shutdown. */
 UNIV_INTERN
@@ -61,6 +62,71 @@ void
 btr_search_enable(void);
 /*====================*/
 
+/********************************************************************//**
+Returns the adaptive hash index partition of an index.
+@return	partition that the hash entries of the index belong to */
+UNIV_INLINE
+btr_search_part_t*
+btr_search_get_part(
+/*================*/
+	const dict_index_t*	index)	/*!< in: index */
+	__attribute__((nonnull, pure));
+/********************************************************************//**
+Returns the latch that protects the adaptive hash index of an index.
+@return	latch of the partition of the index */
+UNIV_INLINE
+rw_lock_t*
+btr_search_get_latch(
+/*=================*/
+	const dict_index_t*	index)	/*!< in: index */
+	__attribute__((nonnull, pure));
+/********************************************************************//**
+X-latches all the adaptive hash index partitions. */
+UNIV_INTERN
+void
+btr_search_x_lock_all(void);
+/*=======================*/
+/********************************************************************//**
+Releases the X-latches on all the adaptive hash index partitions. */
+UNIV_INTERN
+void
+btr_search_x_unlock_all(void);
+/*=========================*/
+#ifdef UNIV_SYNC_DEBUG
+/********************************************************************//**
+Checks if the thread owns the latch of every adaptive hash index partition.
+@return	TRUE if all are owned in the given mode */
+UNIV_INTERN
+ibool
+btr_search_own_all(
+/*===============*/
+	ulint	lock_type);	/*!< in: RW_LOCK_SHARED or RW_LOCK_EX */
+/********************************************************************//**
+Checks if the thread owns the latch of any adaptive hash index partition.
+@return	TRUE if any is owned in the given mode */
+UNIV_INTERN
+ibool
+btr_search_own_any(
+/*===============*/
+	ulint	lock_type);	/*!< in: RW_LOCK_SHARED or RW_LOCK_EX */
+#endif /* UNIV_SYNC_DEBUG */
+/********************************************************************//**
+Prints info of the adaptive hash index partitions. */
+UNIV_INTERN
+void
+btr_search_print_info(
+/*==================*/
+	FILE*	file);	/*!< in: file where to print */
+/********************************************************************//**
+Returns the total number of hash searches that succeeded or failed in
+all the adaptive hash index partitions.
+@return	number of searches */
+UNIV_INTERN
+ulint
+btr_search_get_n_searches(
+/*======================*/
+	bool	hits);	/*!< in: true for successful searches,
+			false for failed ones */
 /********************************************************************//**
 Returns search info for an index.
 @return	search info; search mutex reserved */
@@ -79,14 +145,15 @@ btr_search_info_create(
 /*===================*/
 	mem_heap_t*	heap);	/*!< in: heap where created */
 /*****************************************************************//**
-Returns the value of ref_count. The value is protected by
-btr_search_latch.
+Returns the value of ref_count. The value is protected by the latch of
+the adaptive hash index partition of the index.
 @return	ref_count value. */
 UNIV_INTERN
 ulint
 btr_search_info_get_ref_count(
 /*==========================*/
-	btr_search_t*   info);	/*!< in: search info. */
+	btr_search_t*   info,	/*!< in: search info. */
+	dict_index_t*	index);	/*!< in: index */
 /*********************************************************************//**
 Updates the search info. */
 UNIV_INLINE
@@ -112,7 +179,8 @@ btr_search_guess_on_hash(
 	ulint		latch_mode,	/*!< in: BTR_SEARCH_LEAF, ... */
 	btr_cur_t*	cursor,		/*!< out: tree cursor */
 	ulint		has_search_latch,/*!< in: latch mode the caller
-					currently has on btr_search_latch:
+					currently has on
+					btr_search_get_latch(index):
 					RW_S_LATCH, RW_X_LATCH, or 0 */
 	mtr_t*		mtr);		/*!< in: mtr */
 /********************************************************************//**
@@ -196,7 +264,8 @@ struct btr_search_t{
 	ulint	ref_count;	/*!< Number of blocks in this index tree
 				that have search index built
 				i.e. block->index points to this index.
-				Protected by btr_search_latch except
+				Protected by btr_search_get_latch()
+				of the index except
 				when during initialization in
 				btr_search_info_create(). */
 
@@ -246,11 +315,33 @@ struct btr_search_t{
 #endif /* UNIV_DEBUG */
 };
 
+/** A partition of the adaptive hash index. The hash entries of an index
+are all in the same partition, chosen by the index id, so that searches
+and updates in different indexes do not contend on one latch. */
+struct btr_search_part_t{
+	rw_lock_t	latch;		/*!< protects hash_index and the
+					columns of the records that it
+					points to; see btr_search_latch
+					in btr0types.h */
+	hash_table_t*	hash_index;	/*!< the hash table of the
+					partition, mapping dtuple_fold
+					values to rec_t pointers on index
+					pages */
+	ulint		n_hits;		/*!< number of successful hash
+					searches; not protected by any
+					latch, for statistics only */
+	ulint		n_misses;	/*!< number of failed hash
+					searches; not protected by any
+					latch, for statistics only */
+	byte		pad[64];	/*!< padding to keep the latches
+					of neighbouring partitions on
+					different cache lines */
+};
+
 /** The hash index system */
 struct btr_search_sys_t{
-	hash_table_t*	hash_index;	/*!< the adaptive hash index,
-					mapping dtuple_fold values
-					to rec_t pointers on index pages */
+	btr_search_part_t*	parts;	/*!< the btr_ahi_parts partitions
+					of the adaptive hash index */
 };
 
 /** The adaptive hash index */
@@ -38,14 +38,20 @@ struct btr_pcur_t;
 struct btr_cur_t;
 /** B-tree search information for the adaptive hash index */
 struct btr_search_t;
+/** A partition of the adaptive hash index */
+struct btr_search_part_t;
+/** Bottom-up loader of a B-tree from sorted input */
+struct btr_bulk_t;
 
 #ifndef UNIV_HOTBACKUP
 
-/** @brief The latch protecting the adaptive search system
+/** @brief The latches protecting the adaptive search system
 
-This latch protects the
-(1) hash index;
-(2) columns of a record to which we have a pointer in the hash index;
+The adaptive hash index is split into btr_ahi_parts partitions, each
+protected by its own latch, btr_search_get_latch(index). The latch of a
+partition protects the
+(1) hash index of the partition;
+(2) columns of a record to which we have a pointer in that hash index;
 
 but does NOT protect:
 
@@ -54,15 +60,14 @@ but does NOT protect:
 
 Bear in mind (3) and (4) when using the hash index.
 */
-extern rw_lock_t*	btr_search_latch_temp;
 
-#endif /* UNIV_HOTBACKUP */
+/** Number of partitions of the adaptive hash index */
+extern ulong	btr_ahi_parts;
 
-/** The latch protecting the adaptive search system */
-#define btr_search_latch	(*btr_search_latch_temp)
+#endif /* UNIV_HOTBACKUP */
 
 /** Flag: has the search system been enabled?
-Protected by btr_search_latch. */
+Protected by the latches of all the adaptive hash index partitions. */
 extern char	btr_search_enabled;
 
 #ifdef UNIV_BLOB_DEBUG
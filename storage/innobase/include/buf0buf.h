@@ -197,6 +197,10 @@ struct buf_pool_info_t{
 	ulint	unzip_cur;		/*!< buf_LRU_stat_cur.unzip, num
 					pages decompressed in current
 					interval */
+	ulint	io_usec_sum;		/*!< buf_LRU_stat_sum.io_usec */
+	ulint	io_usec_cur;		/*!< buf_LRU_stat_cur.io_usec */
+	ulint	unzip_usec_sum;		/*!< buf_LRU_stat_sum.unzip_usec */
+	ulint	unzip_usec_cur;		/*!< buf_LRU_stat_cur.unzip_usec */
 };
 
 /** The occupied bytes of lists in all buffer pools */
@@ -240,6 +244,46 @@ buf_pool_free(
 	ulint	n_instances);	/*!< in: numbere of instances to free */
 
 /********************************************************************//**
+Rounds a buffer pool size up to a whole number of chunks in every
+instance.
+@return	size in bytes, a multiple of
+innodb_buffer_pool_chunk_size * innodb_buffer_pool_instances */
+UNIV_INTERN
+ulint
+buf_pool_size_align(
+/*================*/
+	ulint	size);	/*!< in: size in bytes */
+/********************************************************************//**
+Checks whether a block belongs to one of the chunks that an ongoing
+shrink of its buffer pool instance is going to free.
+@return	true if the block will be withdrawn */
+UNIV_INTERN
+bool
+buf_block_will_withdrawn(
+/*=====================*/
+	buf_pool_t*		buf_pool,	/*!< in: buffer pool instance */
+	const buf_block_t*	block)		/*!< in: block, not
+						dereferenced */
+	__attribute__((nonnull, warn_unused_result));
+/********************************************************************//**
+Resizes the buffer pool to srv_buf_pool_size, adding or removing
+whole chunks in every instance while the server keeps running.
+Progress is reported in innodb_buffer_pool_resize_status. */
+UNIV_INTERN
+void
+buf_pool_resize(void);
+/*=================*/
+/*****************************************************************//**
+This is the thread that resizes the buffer pool whenever
+innodb_buffer_pool_size is changed.
+@return this function does not return, it calls os_thread_exit() */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_resize_thread)(
+/*==============================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+/********************************************************************//**
 Clears the adaptive hash index on all pages in the buffer pool. */
 UNIV_INTERN
 void
@@ -1633,6 +1677,12 @@ struct buf_block_t{
 					a block is in the unzip_LRU list
 					if page.state == BUF_BLOCK_FILE_PAGE
 					and page.zip.data != NULL */
+	ulint		unzip_usec;	/*!< microseconds that the last
+					page_zip_decompress() into frame
+					took, or 0 if not known; only a
+					hint for choosing which frame to
+					evict from the unzip_LRU list,
+					and not protected by any mutex */
 #ifdef UNIV_DEBUG
 	ibool		in_unzip_LRU_list;/*!< TRUE if the page is in the
 					decompressed LRU list;
@@ -1832,6 +1882,10 @@ struct buf_pool_t{
 					buf_block_t */
 	ulint		instance_no;	/*!< Array index of this buffer
 					pool instance */
+	ulint		numa_node;	/*!< NUMA node the memory of this
+					instance is bound to, or
+					ULINT_UNDEFINED if innodb_numa_aware
+					is not set */
 	ulint		old_pool_size;  /*!< Old pool size in bytes */
 	ulint		curr_pool_size;	/*!< Current pool size in bytes */
 	ulint		LRU_old_ratio;  /*!< Reserve this much of the buffer
@@ -1844,7 +1898,23 @@ struct buf_pool_t{
 	ulint		mutex_exit_forbidden; /*!< Forbid release mutex */
 #endif
 	ulint		n_chunks;	/*!< number of buffer pool chunks */
-	buf_chunk_t*	chunks;		/*!< buffer pool chunks */
+	ulint		n_chunks_new;	/*!< number of chunks the instance
+					will keep when an ongoing shrink
+					completes; equal to n_chunks when
+					no shrink is in progress */
+	buf_chunk_t*	chunks;		/*!< buffer pool chunks; protected
+					by buf_pool->mutex, because
+					buf_pool_resize() reallocates
+					the array */
+	buf_chunk_map_t* chunk_map;	/*!< frames of the chunks sorted by
+					address, for buf_block_align()
+					without buf_pool->mutex; replaced,
+					never modified, by a resize */
+	buf_chunk_map_t* chunk_map_old;	/*!< the chunk_map that the last
+					resize replaced; it is freed by
+					the next resize, after every
+					thread that could have read it
+					has long finished its lookup */
 	ulint		curr_size;	/*!< current pool size in pages */
 	hash_table_t*	page_hash;	/*!< hash table of buf_page_t or
 					buf_block_t file pages,
@@ -1946,6 +2016,14 @@ struct buf_pool_t{
 	UT_LIST_BASE_NODE_T(buf_page_t) free;
 					/*!< base node of the free
 					block list */
+	UT_LIST_BASE_NODE_T(buf_page_t) withdraw;
+					/*!< blocks of the chunks that an
+					ongoing shrink is going to free;
+					they are kept off the free list */
+	ulint		withdraw_target;/*!< number of blocks that must be
+					in the withdraw list before the
+					chunks can be freed; 0 when no
+					shrink is in progress */
 	UT_LIST_BASE_NODE_T(buf_page_t) LRU;
 					/*!< base node of the LRU list */
 	buf_page_t*	LRU_old;	/*!< pointer to the about
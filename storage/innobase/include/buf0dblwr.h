@@ -105,8 +105,12 @@ and also when we may have to wait for a page latch! Otherwise a deadlock
 of threads can occur. */
 UNIV_INTERN
 void
-buf_dblwr_flush_buffered_writes(void);
-/*=================================*/
+buf_dblwr_flush_buffered_writes(
+/*============================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance
+						whose batch to flush */
+	buf_flush_t		flush_type);	/*!< in: BUF_FLUSH_LRU or
+						BUF_FLUSH_LIST */
 /********************************************************************//**
 Writes a page to the doublewrite buffer on disk, sync it, then write
 the page to the datafile and sync the datafile. This function is used
@@ -122,19 +126,52 @@ buf_dblwr_write_single_page(
 	buf_page_t*	bpage,	/*!< in: buffer block to write */
 	bool		sync);	/*!< in: true if sync IO requested */
 
-/** Doublewrite control struct */
-struct buf_dblwr_t{
-	ib_mutex_t	mutex;	/*!< mutex protecting the first_free
-				field and write_buf */
-	ulint		block1;	/*!< the page number of the first
-				doublewrite block (64 pages) */
-	ulint		block2;	/*!< page number of the second block */
+/** Doublewrite batch. Pages posted for a batch flush are first copied
+to write_buf, then written to the doublewrite area on disk and synced,
+and only then written to their datafiles. Each buffer pool instance has
+one batch for LRU flushes and one for flush list flushes, so that the
+instances can be flushed in parallel without queueing on each other. */
+struct buf_dblwr_batch_t{
+	ib_mutex_t	mutex;	/*!< mutex protecting the fields below */
+	ulint		size;	/*!< capacity of the batch in pages */
 	ulint		first_free;/*!< first free position in write_buf
 				measured in units of UNIV_PAGE_SIZE */
 	ulint		b_reserved;/*!< number of slots currently reserved
 				for batch flush. */
 	os_event_t	b_event;/*!< event where threads wait for a
 				batch flush to end. */
+	bool		batch_running;/*!< set to TRUE if currently a batch
+				is being written from the doublewrite
+				buffer. */
+	byte*		write_buf;/*!< write buffer used in writing to the
+				doublewrite buffer, aligned to an
+				address divisible by UNIV_PAGE_SIZE */
+	byte*		write_buf_unaligned;/*!< pointer to write_buf,
+				but unaligned, or NULL if write_buf
+				points into buf_dblwr_t::write_buf */
+	buf_page_t**	buf_block_arr;/*!< array to store pointers to
+				the buffer blocks which have been
+				cached to write_buf */
+	const char*	file_name;/*!< name of the doublewrite file the
+				batch is written to, or NULL if it is
+				written to the doublewrite blocks of
+				the system tablespace */
+	os_file_t	file;	/*!< handle to the doublewrite file */
+	os_offset_t	file_offset;/*!< byte offset of the batch in
+				the doublewrite file */
+};
+
+/** Doublewrite control struct */
+struct buf_dblwr_t{
+	ib_mutex_t	mutex;	/*!< mutex protecting the single page
+				flush slots */
+	ulint		block1;	/*!< the page number of the first
+				doublewrite block (64 pages) */
+	ulint		block2;	/*!< page number of the second block */
+	ulint		s_first;/*!< first slot of write_buf used for
+				single page flushes; the slots before
+				it are used by the batch of the system
+				tablespace doublewrite buffer */
 	ulint		s_reserved;/*!< number of slots currently
 				reserved for single page flushes. */
 	os_event_t	s_event;/*!< event where threads wait for a
@@ -142,9 +179,6 @@ struct buf_dblwr_t{
 	bool*		in_use;	/*!< flag used to indicate if a slot is
 				in use. Only used for single page
 				flushes. */
-	bool		batch_running;/*!< set to TRUE if currently a batch
-				is being written from the doublewrite
-				buffer. */
 	byte*		write_buf;/*!< write buffer used in writing to the
 				doublewrite buffer, aligned to an
 				address divisible by UNIV_PAGE_SIZE
@@ -154,6 +188,18 @@ struct buf_dblwr_t{
 	buf_page_t**	buf_block_arr;/*!< array to store pointers to
 				the buffer blocks which have been
 				cached to write_buf */
+	ulint		n_files;/*!< number of doublewrite files, one
+				per buffer pool instance, or 0 if batch
+				flushes use the doublewrite blocks of
+				the system tablespace */
+	char**		file_names;/*!< names of the doublewrite files */
+	os_file_t*	files;	/*!< handles to the doublewrite files */
+	ulint		n_batches;/*!< number of elements in batches */
+	buf_dblwr_batch_t* batches;/*!< doublewrite batches: if n_files
+				is 0 there is only one, otherwise
+				batches[i * 2 + flush_type] is used
+				for the flushes of buffer pool
+				instance i */
 };
 
 
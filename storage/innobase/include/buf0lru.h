@@ -63,7 +63,8 @@ buf_LRU_flush_or_remove_pages(
 	ulint		id,		/*!< in: space id */
 	buf_remove_t	buf_remove,	/*!< in: remove or flush strategy */
 	const trx_t*	trx);		/*!< to check if the operation must
-					be interrupted */
+					be interrupted, or NULL if it must
+					not be interrupted */
 
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /********************************************************************//**
@@ -157,6 +158,16 @@ buf_LRU_evict_from_unzip_LRU(
 /*=========================*/
 	buf_pool_t*	buf_pool);
 /******************************************************************//**
+Determines if the uncompressed frames of compressed pages take more of
+the buffer pool than innodb_unzip_lru_max_pct allows.
+@return	true if frames should be evicted from unzip_LRU */
+UNIV_INTERN
+bool
+buf_LRU_unzip_over_budget(
+/*======================*/
+	const buf_pool_t*	buf_pool)	/*!< in: buffer pool instance */
+	__attribute__((nonnull, warn_unused_result));
+/******************************************************************//**
 Puts a block back to the free list. */
 UNIV_INTERN
 void
@@ -231,6 +242,44 @@ buf_LRU_free_one_page(
 				may or may not be a hash index to the page */
 	__attribute__((nonnull));
 
+/******************************************************************//**
+Creates a scan ring. A table scan or a large range scan registers in the
+ring each page that it reads into the buffer pool, and once the ring is
+full, evicts the page that it registered longest ago, so that the scan
+recycles a few buffer frames instead of filling the LRU list.
+@return	own: scan ring */
+UNIV_INTERN
+buf_scan_ring_t*
+buf_scan_ring_create(
+/*=================*/
+	ulint		size);	/*!< in: number of pages to keep, > 0 */
+/******************************************************************//**
+Frees a scan ring. The pages registered in it stay in the buffer pool. */
+UNIV_INTERN
+void
+buf_scan_ring_free(
+/*===============*/
+	buf_scan_ring_t*	ring);	/*!< in, own: scan ring */
+/******************************************************************//**
+Gets the number of pages that a scan ring keeps.
+@return	ring size in pages */
+UNIV_INTERN
+ulint
+buf_scan_ring_get_size(
+/*===================*/
+	const buf_scan_ring_t*	ring);	/*!< in: scan ring */
+/******************************************************************//**
+Registers a page that a large scan read into the buffer pool, and
+evicts the page registered longest ago if the ring is full. That page is
+left alone if it is in use, dirty, or has been made young meanwhile. */
+UNIV_INTERN
+void
+buf_scan_ring_add(
+/*==============*/
+	buf_scan_ring_t*	ring,	/*!< in/out: scan ring */
+	ulint			space,	/*!< in: space id */
+	ulint			offset);/*!< in: page number */
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /**********************************************************************//**
 Validates the LRU list.
@@ -278,12 +327,17 @@ extern uint	buf_LRU_old_threshold_ms;
 /** @brief Statistics for selecting the LRU list for eviction.
 
 These statistics are not 'of' LRU but 'for' LRU.  We keep count of I/O
-and page_zip_decompress() operations.  Based on the statistics we decide
-if we want to evict from buf_pool->unzip_LRU or buf_pool->LRU. */
+and page_zip_decompress() operations, and of the time that they take.
+Based on the statistics we decide if we want to evict from
+buf_pool->unzip_LRU or buf_pool->LRU. */
 struct buf_LRU_stat_t
 {
 	ulint	io;	/**< Counter of buffer pool I/O operations. */
 	ulint	unzip;	/**< Counter of page_zip_decompress operations. */
+	ulint	io_usec;/**< Microseconds that threads waited for
+			synchronous page reads. */
+	ulint	unzip_usec;/**< Microseconds spent in
+			page_zip_decompress. */
 };
 
 /** Current operation counters.  Not protected by any mutex.
@@ -300,6 +354,13 @@ Increments the I/O counter in buf_LRU_stat_cur. */
 /********************************************************************//**
 Increments the page_zip_decompress() counter in buf_LRU_stat_cur. */
 #define buf_LRU_stat_inc_unzip() buf_LRU_stat_cur.unzip++
+/********************************************************************//**
+Adds the time that a synchronous page read waited to buf_LRU_stat_cur. */
+#define buf_LRU_stat_inc_io_time(usec) buf_LRU_stat_cur.io_usec += (usec)
+/********************************************************************//**
+Adds the time of a page_zip_decompress() to buf_LRU_stat_cur. */
+#define buf_LRU_stat_inc_unzip_time(usec)	\
+	buf_LRU_stat_cur.unzip_usec += (usec)
 
 #ifndef UNIV_NONINL
 #include "buf0lru.ic"
@@ -55,6 +55,22 @@ buf_read_page_async(
 	ulint	space,	/*!< in: space id */
 	ulint	offset);/*!< in: page number */
 /********************************************************************//**
+Reads a batch of pages of a tablespace asynchronously to the buffer pool,
+for example the leaf pages that a scan is going to access next. The reads
+are submitted together, and the pages that are already in the buffer
+pool are skipped. NOTE: the calling thread may own latches on pages:
+this function does not wait for the reads to complete.
+@return	number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_pages_async(
+/*=================*/
+	ulint		space,		/*!< in: space id */
+	ulint		zip_size,	/*!< in: compressed page size in
+					bytes, or 0 */
+	const ulint*	page_nos,	/*!< in: page numbers */
+	ulint		n_pages);	/*!< in: number of pages */
+/********************************************************************//**
 Applies a random read-ahead in buf_pool if there are at least a threshold
 value of accessed pages from the random read-ahead area. Does not read any
 page, not even the one at the position (space, offset), if the read-ahead
@@ -36,6 +36,8 @@ struct buf_page_t;
 struct buf_block_t;
 /** Buffer pool chunk comprising buf_block_t */
 struct buf_chunk_t;
+/** Address-ordered index of the chunks of a buffer pool instance */
+struct buf_chunk_map_t;
 /** Buffer pool comprising buf_chunk_t */
 struct buf_pool_t;
 /** Buffer pool statistics struct */
@@ -44,6 +46,8 @@ struct buf_pool_stat_t;
 struct buf_buddy_stat_t;
 /** Doublewrite memory struct */
 struct buf_dblwr_t;
+/** Private ring of recently read pages of a large scan */
+struct buf_scan_ring_t;
 
 /** A buffer frame. @see page_t */
 typedef	byte	buf_frame_t;
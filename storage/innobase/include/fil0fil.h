@@ -158,6 +158,29 @@ extern fil_addr_t	fil_addr_null;
 #define FIL_PAGE_TYPE_ZBLOB2	12	/*!< Subsequent compressed BLOB page */
 #define FIL_PAGE_TYPE_LAST	FIL_PAGE_TYPE_ZBLOB2
 					/*!< Last page type */
+#define FIL_PAGE_COMPRESSED	14	/*!< Page written with transparent
+					page compression. Such pages are
+					only found in data files: they
+					are decompressed when read, see
+					os_file_decompress_page() */
+/* @} */
+
+/** Header of a page written with transparent page compression. The
+fields replace FIL_PAGE_FILE_FLUSH_LSN, which is not used on such
+pages, and the compressed page from FIL_PAGE_DATA on follows the
+header. @{ */
+#define FIL_PAGE_COMPRESS_VERSION	FIL_PAGE_FILE_FLUSH_LSN
+					/*!< version of the format, 1 byte */
+#define FIL_PAGE_COMPRESS_ALGORITHM	(FIL_PAGE_COMPRESS_VERSION + 1)
+					/*!< OS_FILE_COMPRESSION_ZLIB, ...,
+					1 byte */
+#define FIL_PAGE_COMPRESS_ORIGINAL_TYPE	(FIL_PAGE_COMPRESS_ALGORITHM + 1)
+					/*!< FIL_PAGE_TYPE of the page,
+					2 bytes */
+#define FIL_PAGE_COMPRESS_SIZE		(FIL_PAGE_COMPRESS_ORIGINAL_TYPE + 2)
+					/*!< size of the compressed data,
+					2 bytes */
+#define FIL_PAGE_COMPRESS_VERSION_1	1	/*!< the only format so far */
 /* @} */
 
 /** Space types @{ */
@@ -704,6 +727,20 @@ fil_extend_space_to_desired_size(
 	ulint	size_after_extend);/*!< in: desired size in pages after the
 				extension; if the current space size is bigger
 				than this already, the function does nothing */
+#ifndef UNIV_HOTBACKUP
+/**********************************************************************//**
+Truncates the data file of a single-file tablespace to the given size. The
+pages of the tablespace are evicted from the buffer pool without writing
+them, so the caller must make sure that no other thread accesses the
+tablespace and that its pages need not be recovered from the redo log.
+@return	TRUE if success */
+UNIV_INTERN
+ibool
+fil_truncate_tablespace(
+/*====================*/
+	ulint	space_id,	/*!< in: space id */
+	ulint	size);		/*!< in: new size in pages */
+#endif /* !UNIV_HOTBACKUP */
 /*******************************************************************//**
 Tries to reserve free extents in a file space.
 @return	TRUE if succeed */
@@ -984,6 +1021,26 @@ fil_get_space_names(
 				/*!< in/out: Vector for collecting the names. */
 	__attribute__((warn_unused_result));
 
+/** Transparent page compression of a tablespace, as returned by
+fil_space_get_compress_stats() */
+struct fil_space_compress_stats_t {
+	ulint			id;	/*!< space id */
+	char			name[MAX_FULL_NAME_LEN + 1];
+					/*!< tablespace name */
+	os_file_compress_t	compress;/*!< copy of fil_space_t::compress */
+};
+
+/*******************************************************************//**
+Takes a snapshot of the page compression counters of the tablespaces
+that are compressed or that have compressed or decompressed any pages.
+@return	number of entries in *stats */
+UNIV_INTERN
+ulint
+fil_space_get_compress_stats(
+/*=========================*/
+	fil_space_compress_stats_t**	stats);	/*!< out: array of entries,
+						to be freed with ut_free() */
+
 /****************************************************************//**
 Generate redo logs for swapping two .ibd files */
 UNIV_INTERN
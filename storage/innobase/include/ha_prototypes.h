@@ -562,6 +562,15 @@ innobase_get_int_col_max_value(
 	const Field*	field)	/*!< in: MySQL field */
 	__attribute__((nonnull, pure, warn_unused_result));
 
+/********************************************************************//**
+Sets innodb_buffer_pool_size to the size of the buffer pool that is in
+use, after the buffer pool could not be resized to the requested size. */
+UNIV_INTERN
+void
+innobase_set_buffer_pool_size(
+/*==========================*/
+	ulint	buf_pool_size);	/*!< in: size of the buffer pool in use */
+
 /**********************************************************************
 Check if the length of the identifier exceeds the maximum allowed.
 The input to this function is an identifier in charset my_charset_filename.
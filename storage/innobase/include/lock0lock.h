@@ -532,6 +532,45 @@ lock_rec_hash(
 	ulint	space,	/*!< in: space */
 	ulint	page_no);/*!< in: page number */
 
+/*********************************************************************//**
+Gets the mutex protecting the record lock queue of a page, that is, the
+mutex of the partition of lock_sys->rec_hash that the page hashes to.
+@return	record lock shard mutex */
+UNIV_INLINE
+ib_mutex_t*
+lock_rec_get_mutex(
+/*===============*/
+	ulint	space,	/*!< in: space */
+	ulint	page_no);/*!< in: page number */
+/*********************************************************************//**
+Gets the mutex protecting the record lock queue of a buffer block.
+@return	record lock shard mutex */
+UNIV_INLINE
+ib_mutex_t*
+lock_rec_get_block_mutex(
+/*=====================*/
+	const buf_block_t*	block);	/*!< in: buffer block */
+/*********************************************************************//**
+Acquires all the record lock shard mutexes. The caller must own
+lock_sys->mutex. */
+UNIV_INTERN
+void
+lock_rec_mutex_enter_all(void);
+/*==========================*/
+/*********************************************************************//**
+Releases all the record lock shard mutexes. */
+UNIV_INTERN
+void
+lock_rec_mutex_exit_all(void);
+/*=========================*/
+/*********************************************************************//**
+Tries to latch the whole lock system without waiting for lock_sys->mutex.
+@return	0 if succeeded, like mutex_enter_nowait() */
+UNIV_INTERN
+ulint
+lock_mutex_enter_nowait(void);
+/*=========================*/
+
 /**********************************************************************//**
 Looks for a set bit in a record lock bitmap. Returns ULINT_UNDEFINED,
 if none found.
@@ -749,7 +788,30 @@ lock_table_has_locks(
 					table itself */
 
 /*********************************************************************//**
-A thread which wakes up threads whose lock wait may have lasted too long.
+Looks for deadlocks in a snapshot of the waits-for graph of the
+transactions that are suspended in a lock wait, and rolls back a victim of
+each deadlock that is found. This is used when innodb_deadlock_detect is
+BACKGROUND. The caller must hold lock_sys->wait_mutex, which keeps the
+waiting transactions from going away. */
+UNIV_INTERN
+void
+lock_deadlock_check_background(void);
+/*================================*/
+
+/*********************************************************************//**
+Takes a snapshot of the waits-for graph of the transactions that are
+suspended in a lock wait, for INFORMATION_SCHEMA.INNODB_LOCK_WAIT_GRAPH.
+@return	number of edges stored in *edges */
+UNIV_INTERN
+ulint
+lock_wait_graph_get(
+/*================*/
+	mem_heap_t*		heap,	/*!< in: memory heap for *edges */
+	lock_wait_edge_t**	edges);	/*!< out: edges of the graph */
+
+/*********************************************************************//**
+A thread which wakes up threads whose lock wait may have lasted too long,
+and which looks for deadlocks if innodb_deadlock_detect=BACKGROUND.
 @return	a dummy parameter */
 extern "C" UNIV_INTERN
 os_thread_ret_t
@@ -907,12 +969,42 @@ struct lock_op_t{
 	enum lock_mode	mode;	/*!< lock mode */
 };
 
+/** An edge of the transaction waits-for graph, from a transaction that
+is waiting for a lock to a transaction that holds or has requested a
+conflicting lock ahead of it in the lock queue */
+struct lock_wait_edge_t{
+	trx_id_t	requesting_trx_id;/*!< waiting transaction */
+	trx_id_t	blocking_trx_id;/*!< transaction that blocks it */
+	ib_time_t	wait_started;	/*!< time when the requesting
+					transaction started to wait */
+	bool		blocking_trx_waits;/*!< true if the blocking
+					transaction is waiting for a lock
+					as well */
+};
+
+/** Number of partitions of the record lock hash table, each of which is
+protected by its own mutex */
+#define LOCK_REC_N_SHARDS	32
+
 /** The lock system struct */
 struct lock_sys_t{
 	ib_mutex_t	mutex;			/*!< Mutex protecting the
-						locks */
+						table locks and the lock
+						wait state; together with
+						all of rec_mutexes, it
+						protects the whole lock
+						system, which is needed for
+						deadlock detection and for
+						moving locks between pages */
 	hash_table_t*	rec_hash;		/*!< hash table of the record
 						locks */
+	ib_mutex_t	rec_mutexes[LOCK_REC_N_SHARDS];
+						/*!< Mutexes protecting the
+						record lock queues: the queue
+						in cell i of rec_hash is
+						protected by rec_mutexes[i %
+						LOCK_REC_N_SHARDS]; see
+						lock_rec_get_mutex() */
 	ib_mutex_t	wait_mutex;		/*!< Mutex protecting the
 						next two fields */
 	srv_slot_t*	waiting_threads;	/*!< Array  of user threads
@@ -943,22 +1035,38 @@ struct lock_sys_t{
 /** The lock system */
 extern lock_sys_t*	lock_sys;
 
-/** Test if lock_sys->mutex can be acquired without waiting. */
-#define lock_mutex_enter_nowait() mutex_enter_nowait(&lock_sys->mutex)
-
 /** Test if lock_sys->mutex is owned. */
 #define lock_mutex_own() mutex_own(&lock_sys->mutex)
 
-/** Acquire the lock_sys->mutex. */
+/** Acquire the lock_sys->mutex and all the record lock shard mutexes,
+that is, latch the whole lock system. */
 #define lock_mutex_enter() do {			\
 	mutex_enter(&lock_sys->mutex);		\
+	lock_rec_mutex_enter_all();		\
 } while (0)
 
-/** Release the lock_sys->mutex. */
+/** Release the lock_sys->mutex and all the record lock shard mutexes. */
 #define lock_mutex_exit() do {			\
+	lock_rec_mutex_exit_all();		\
+	mutex_exit(&lock_sys->mutex);		\
+} while (0)
+
+/** Acquire only the lock_sys->mutex. This is enough for operations on
+table locks; record lock queues additionally need the shard mutex of
+the page, see lock_rec_get_mutex(). */
+#define lock_sys_mutex_enter() do {		\
+	mutex_enter(&lock_sys->mutex);		\
+} while (0)
+
+/** Release the lock_sys->mutex acquired by lock_sys_mutex_enter(). */
+#define lock_sys_mutex_exit() do {		\
 	mutex_exit(&lock_sys->mutex);		\
 } while (0)
 
+/** Test if the record lock shard mutex of a page is owned. */
+#define lock_rec_mutex_own(space, page_no)	\
+	mutex_own(lock_rec_get_mutex(space, page_no))
+
 /** Test if lock_sys->wait_mutex is owned. */
 #define lock_wait_mutex_own() mutex_own(&lock_sys->wait_mutex)
 
@@ -29,6 +29,7 @@ Created 5/7/1996 Heikki Tuuri
 #define lock_t ib_lock_t
 struct lock_t;
 struct lock_sys_t;
+struct lock_wait_edge_t;
 
 /* Basic lock modes */
 enum lock_mode {
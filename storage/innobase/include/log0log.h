@@ -88,23 +88,6 @@ log_calc_where_lsn_is(
 	ib_int64_t	log_file_size);		/*!< in: log file size
 						(including the header) */
 #ifndef UNIV_HOTBACKUP
-/************************************************************//**
-Writes to the log the string given. The log must be released with
-log_release.
-@return	end lsn of the log record, zero if did not succeed */
-UNIV_INLINE
-lsn_t
-log_reserve_and_write_fast(
-/*=======================*/
-	const void*	str,	/*!< in: string */
-	ulint		len,	/*!< in: string length */
-	lsn_t*		start_lsn);/*!< out: start lsn of the log record */
-/***********************************************************************//**
-Releases the log mutex. */
-UNIV_INLINE
-void
-log_release(void);
-/*=============*/
 /***********************************************************************//**
 Checks if there is need for a log buffer flush or a new checkpoint, and does
 this if yes. Any database operation should call this when it has modified
@@ -115,30 +98,40 @@ void
 log_free_check(void);
 /*================*/
 /************************************************************//**
-Opens the log for log_write_low. The log must be closed with log_close and
-released with log_release.
-@return	start lsn of the log record */
+Reserves space in the redo log for the log records of a mini-transaction.
+The range of lsn is allocated with an atomic increment of log_sys->sn,
+so that log_sys->mutex is not acquired: the caller copies its log records
+to the reserved range with log_buffer_write() concurrently with other
+threads, and finishes with log_buffer_close().
+@return	start lsn of the reserved range */
 UNIV_INTERN
 lsn_t
-log_reserve_and_open(
-/*=================*/
-	ulint	len);	/*!< in: length of data to be catenated */
+log_buffer_reserve(
+/*===============*/
+	ulint	len,		/*!< in: length of data to be catenated */
+	lsn_t*	end_lsn);	/*!< out: end lsn of the reserved range */
 /************************************************************//**
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
+Copies a string to a range of the log buffer reserved with
+log_buffer_reserve(). The string need not fit in the log buffer: if
+there is not enough free space, this waits until the log has been
+written far enough. */
 UNIV_INTERN
 void
-log_write_low(
-/*==========*/
-	byte*	str,		/*!< in: string */
-	ulint	str_len);	/*!< in: string length */
+log_buffer_write(
+/*=============*/
+	const byte*	str,	/*!< in: string */
+	ulint		str_len,/*!< in: string length */
+	lsn_t*		lsn,	/*!< in/out: lsn where to copy the string;
+				advanced past the string */
+	lsn_t		end_lsn);/*!< in: end lsn of the reserved range */
 /************************************************************//**
-Closes the log.
-@return	lsn */
+Closes a range of the log reserved with log_buffer_reserve(), checking
+whether a log buffer flush or a new checkpoint is needed. */
 UNIV_INTERN
-lsn_t
-log_close(void);
-/*===========*/
+void
+log_buffer_close(
+/*=============*/
+	lsn_t	end_lsn);	/*!< in: end lsn of the reserved range */
 /************************************************************//**
 Gets the current lsn.
 @return	current lsn */
@@ -168,6 +161,17 @@ UNIV_INTERN
 void
 log_init(void);
 /*==========*/
+/******************************************************//**
+Sets the current lsn of the log system and prepares the log buffer, so that
+new log records are catenated after the given lsn. */
+UNIV_INTERN
+void
+log_buffer_reset(
+/*=============*/
+	lsn_t		lsn,		/*!< in: current lsn */
+	const byte*	last_block);	/*!< in: contents of the log block
+					which contains lsn, or NULL if the
+					block is empty */
 /******************************************************************//**
 Inits a log group to the log system. */
 UNIV_INTERN
@@ -521,6 +525,23 @@ ulint
 log_block_convert_lsn_to_no(
 /*========================*/
 	lsn_t	lsn);	/*!< in: lsn of a byte within the block */
+/************************************************************//**
+Converts a count of log data bytes to an lsn, which also counts the
+headers and trailers of the log blocks.
+@return	lsn */
+UNIV_INLINE
+lsn_t
+log_translate_sn_to_lsn(
+/*====================*/
+	lsn_t	sn);	/*!< in: number of log data bytes */
+/************************************************************//**
+Converts an lsn to the count of log data bytes before it.
+@return	number of log data bytes */
+UNIV_INLINE
+lsn_t
+log_translate_lsn_to_sn(
+/*====================*/
+	lsn_t	lsn);	/*!< in: lsn, pointing to the data area of a block */
 /******************************************************//**
 Prints info of the log. */
 UNIV_INTERN
@@ -560,9 +581,36 @@ UNIV_INTERN
 void
 log_mem_free(void);
 /*==============*/
+/******************************************************************//**
+The log writer thread. Writes the log records that have been copied to the
+log buffer to the log files as soon as they are available, and wakes up
+the threads waiting for them to be written and the log flusher thread.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_writer_thread)(
+/*==============================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+/******************************************************************//**
+The log flusher thread. Flushes the log files after the log writer thread
+has written to them, and wakes up the threads waiting for the log to be
+flushed to disk.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_flusher_thread)(
+/*===============================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
 
 extern log_t*	log_sys;
 
+/** Flag indicating if the log writer thread is in active state. */
+extern bool	log_writer_is_active;
+/** Flag indicating if the log flusher thread is in active state. */
+extern bool	log_flusher_is_active;
+
 /* Values used as flags */
 #define LOG_FLUSH	7652559
 #define LOG_CHECKPOINT	78656949
@@ -577,6 +625,12 @@ extern log_t*	log_sys;
 #define LOG_BUFFER_SIZE		(srv_log_buffer_size * UNIV_PAGE_SIZE)
 #define LOG_ARCHIVE_BUF_SIZE	(srv_log_buffer_size * UNIV_PAGE_SIZE / 4)
 
+/* Number of events on which the threads waiting for the log writer and
+flusher threads sleep; the waiters for lsns in different log blocks are
+spread over them, so that a write or flush wakes up only the threads whose
+lsn it may have reached */
+#define LOG_N_EVENTS		2048
+
 /* Offsets of a log block header */
 #define	LOG_BLOCK_HDR_NO	0	/* block number which must be > 0 and
 					is allowed to wrap around at 2G; the
@@ -616,6 +670,10 @@ extern log_t*	log_sys;
 					.._HDR_NO */
 #define	LOG_BLOCK_TRL_SIZE	4	/* trailer size in bytes */
 
+/* Number of bytes of log records that fit in one log block */
+#define LOG_BLOCK_DATA_SIZE	(OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_HDR_SIZE \
+				 - LOG_BLOCK_TRL_SIZE)
+
 /* Offsets for a checkpoint field */
 #define LOG_CHECKPOINT_NO		0
 #define LOG_CHECKPOINT_LSN		8
@@ -766,9 +824,15 @@ struct log_t{
 	byte		pad[64];	/*!< padding to prevent other memory
 					update hotspots from residing on the
 					same memory cache line */
-	lsn_t		lsn;		/*!< log sequence number */
-	ulint		buf_free;	/*!< first free offset within the log
-					buffer */
+	volatile lsn_t	sn;		/*!< number of bytes of log records
+					catenated to the log so far, that is,
+					the log sequence number without the
+					log block headers and trailers; this
+					is incremented atomically by
+					log_buffer_reserve(), see
+					log_translate_sn_to_lsn() */
+	byte		pad2[64];	/*!< padding to keep sn on its own
+					cache line */
 #ifndef UNIV_HOTBACKUP
 	ib_mutex_t		mutex;		/*!< mutex protecting the log */
 
@@ -782,19 +846,26 @@ struct log_t{
 					in the LSN order. */
 #endif /* !UNIV_HOTBACKUP */
 	byte*		buf_ptr;	/* unaligned log buffer */
-	byte*		buf;		/*!< log buffer */
+	byte*		buf;		/*!< log buffer; this is used as a
+					ring buffer where the log block of
+					lsn is at offset lsn % buf_size,
+					aligned down to a block boundary */
 	ulint		buf_size;	/*!< log buffer size in bytes */
-	ulint		max_buf_free;	/*!< recommended maximum value of
-					buf_free, after which the buffer is
-					flushed */
- #ifdef UNIV_LOG_DEBUG
-	ulint		old_buf_free;	/*!< value of buf free when log was
-					last time opened; only in the debug
-					version */
-	ib_uint64_t	old_lsn;	/*!< value of lsn when log was
-					last time opened; only in the
-					debug version */
-#endif /* UNIV_LOG_DEBUG */
+	ulint		max_buf_free;	/*!< recommended maximum amount of
+					log not yet written to the log files,
+					after which the buffer is flushed */
+	ulint*		buf_copied;	/*!< number of bytes of log records
+					copied to each log block of buf;
+					incremented atomically by
+					log_buffer_write(), and reset when
+					the block has been written */
+	lsn_t		buf_ready_lsn;	/*!< all log records up to this lsn
+					have been copied to buf; protected by
+					mutex */
+	byte*		write_buf_ptr;	/* unaligned write buffer */
+	byte*		write_buf;	/*!< the log blocks are copied here
+					from buf before they are written to
+					the log files; protected by mutex */
 	ibool		check_flush_or_checkpoint;
 					/*!< this is set to TRUE when there may
 					be need to flush the log buffer, or
@@ -810,15 +881,6 @@ struct log_t{
 #ifndef UNIV_HOTBACKUP
 	/** The fields involved in the log buffer flush @{ */
 
-	ulint		buf_next_to_write;/*!< first offset in the log buffer
-					where the byte content may not exist
-					written to file, e.g., the start
-					offset of a log record catenated
-					later; this is advanced when a flush
-					operation is completed to all the log
-					groups */
-	volatile bool	is_extending;	/*!< this is set to true during extend
-					the log buffer size */
 	lsn_t		written_to_some_lsn;
 					/*!< first log sequence number not yet
 					written to any log group; for this to
@@ -843,11 +905,6 @@ struct log_t{
 					up-to-date and accurate. */
 	lsn_t		write_lsn;	/*!< end lsn for the current running
 					write */
-	ulint		write_end_offset;/*!< the data in buffer has
-					been written up to this offset
-					when the current write ends:
-					this field will then be copied
-					to buf_next_to_write */
 	lsn_t		current_flush_lsn;/*!< end lsn for the current running
 					write + flush operation */
 	lsn_t		flushed_to_disk_lsn;
@@ -878,6 +935,22 @@ struct log_t{
 					but NOTE that to set or reset this
 					event, the thread MUST own the log
 					mutex! */
+	os_event_t	writer_event;	/*!< set to wake up the log writer
+					thread when there is log to write */
+	os_event_t	flusher_event;	/*!< set by the log writer thread to
+					wake up the log flusher thread after
+					each write */
+	os_event_t*	write_events;	/*!< LOG_N_EVENTS events on which
+					the threads waiting for the log
+					writer thread to write the log up to
+					an lsn sleep, one per log block
+					modulo LOG_N_EVENTS; set by the log
+					writer thread when it has written
+					to the block */
+	os_event_t*	flush_events;	/*!< the same as write_events, for
+					the threads waiting for the log to
+					be flushed to disk; set by the log
+					flusher thread */
 	ulint		n_log_ios;	/*!< number of log i/os initiated thus
 					far */
 	ulint		n_log_ios_old;	/*!< number of log i/o's at the
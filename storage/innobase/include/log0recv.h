@@ -369,14 +369,21 @@ struct recv_addr_t{
 };
 
 struct recv_dblwr_t {
+	recv_dblwr_t() : files_buf(NULL) {}
+
 	void add(byte* page);
 
 	byte* find_page(ulint space_id, ulint page_no);
 
 	std::list<byte *> pages; /* Pages from double write buffer */
 
+	byte*	files_buf;	/* Buffer holding the pages read from the
+				doublewrite files, or NULL */
+
 	void operator() () {
 		pages.clear();
+		ut_free(files_buf);
+		files_buf = NULL;
 	}
 };
 
@@ -444,6 +451,11 @@ struct recv_sys_t{
 	hash_table_t*	addr_hash;/*!< hash table of file addresses of pages */
 	ulint		n_addrs;/*!< number of not processed hashed file
 				addresses in the hash table */
+	ulint		n_apply_threads;
+				/*!< number of recv_apply_thread workers
+				that have not yet gone through their
+				share of the hash table in the current
+				apply batch; protected by mutex */
 
 	recv_dblwr_t	dblwr;
 };
@@ -492,6 +504,9 @@ times! */
 roll-forward */
 #define RECV_SCAN_SIZE		(4 * UNIV_PAGE_SIZE)
 
+/** Maximum value of innodb_recovery_apply_threads */
+#define RECV_MAX_APPLY_THREADS	64
+
 /** This many frames must be left free in the buffer pool when we scan
 the log and store the scanned log records in the buffer pool: we will
 use these free frames to read in pages when we start applying the
@@ -400,6 +400,11 @@ struct mtr_t{
 				this mtr */
 	lsn_t		end_lsn;/* end lsn of the possible log entry for
 				this mtr */
+	buf_scan_ring_t*scan_ring;
+				/*!< if not NULL, pages read for
+				this mtr are part of a large scan
+				and are kept in this ring instead
+				of the LRU list; see buf0lru.h */
 #ifdef UNIV_DEBUG
 	ulint		magic_n;
 #endif /* UNIV_DEBUG */
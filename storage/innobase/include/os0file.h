@@ -163,6 +163,53 @@ enum os_file_create_t {
 #define OS_FILE_LOG	256	/* This can be ORed to type */
 /* @} */
 
+/** Algorithms of transparent page compression, see os_file_compress_t.
+The value is stored in the PAGE_COMPRESSION field of the table and
+tablespace flags and in the header of every compressed page. @{ */
+#define OS_FILE_COMPRESSION_NONE	0	/*!< pages are written as
+						they are */
+#define OS_FILE_COMPRESSION_ZLIB	1	/*!< zlib, at
+						innodb_compression_level;
+						always available */
+#define OS_FILE_COMPRESSION_LZ4		2	/*!< LZ4; only available
+						if InnoDB was built with
+						HAVE_LZ4 */
+#define OS_FILE_COMPRESSION_LAST	OS_FILE_COMPRESSION_LZ4
+/* @} */
+
+/** Compressed pages are written in whole blocks of this size, and the
+rest of the page is freed by punching a hole into the file. This is
+a multiple of the sector size that O_DIRECT requires and of the block
+size of common file systems. */
+#define OS_FILE_COMPRESS_BLOCK		4096
+
+/** Transparent page compression of the data file of a tablespace. The
+pages are compressed in os_aio() when they are written, and
+decompressed when they have been read. The counters are updated
+without synchronization and are thus approximate. */
+struct os_file_compress_t {
+	ulint		algorithm;	/*!< OS_FILE_COMPRESSION_NONE, ...:
+					how pages are written; pages that
+					were compressed earlier are read
+					back whatever this is */
+	bool		punch_hole;	/*!< false if the file system did
+					not support punching holes; the
+					compressed pages then take as much
+					space as uncompressed ones */
+	ulint		compress_ops;	/*!< number of pages compressed */
+	ulint		compress_ops_ok;/*!< number of pages that saved
+					at least one OS_FILE_COMPRESS_BLOCK
+					and were written compressed; the
+					others were written as they are */
+	ib_uint64_t	compress_time;	/*!< microseconds spent in
+					compressing pages */
+	ib_uint64_t	page_bytes;	/*!< size of the compressed pages */
+	ib_uint64_t	written_bytes;	/*!< bytes written for them */
+	ulint		uncompress_ops;	/*!< number of pages decompressed */
+	ib_uint64_t	uncompress_time;/*!< microseconds spent in
+					decompressing pages */
+};
+
 #define OS_AIO_N_PENDING_IOS_PER_THREAD 32	/*!< Win NT does not allow more
 						than 64 */
 
@@ -311,9 +358,10 @@ The wrapper functions have the prefix of "innodb_". */
 	pfs_os_file_close_func(file, __FILE__, __LINE__)
 
 # define os_aio(type, mode, name, file, buf, offset,			\
-		n, message1, message2)					\
+		n, compress, message1, message2)			\
 	pfs_os_aio_func(type, mode, name, file, buf, offset,		\
-			n, message1, message2, __FILE__, __LINE__)
+			n, compress, message1, message2,		\
+			__FILE__, __LINE__)
 
 # define os_file_read(file, buf, offset, n)				\
 	pfs_os_file_read_func(file, buf, offset, n, __FILE__, __LINE__)
@@ -354,8 +402,9 @@ to original un-instrumented file I/O APIs */
 
 # define os_file_close(file)	os_file_close_func(file)
 
-# define os_aio(type, mode, name, file, buf, offset, n, message1, message2) \
-	os_aio_func(type, mode, name, file, buf, offset, n,		\
+# define os_aio(type, mode, name, file, buf, offset, n, compress,	\
+	       message1, message2)					\
+	os_aio_func(type, mode, name, file, buf, offset, n, compress,	\
 		    message1, message2)
 
 # define os_file_read(file, buf, offset, n)	\
@@ -745,6 +794,9 @@ pfs_os_aio_func(
 				to write */
 	os_offset_t	offset,	/*!< in: file offset where to read or write */
 	ulint		n,	/*!< in: number of bytes to read or write */
+	os_file_compress_t* compress,
+				/*!< in/out: transparent page
+				compression of the file, or NULL */
 	fil_node_t*	message1,/*!< in: message for the aio handler
 				(can be used to identify a completed
 				aio operation); ignored if mode is
@@ -878,6 +930,40 @@ os_file_set_eof(
 /*============*/
 	FILE*		file);	/*!< in: file to be truncated */
 /***********************************************************************//**
+Truncates or extends a file to the given size.
+@return	TRUE if success */
+UNIV_INTERN
+ibool
+os_file_truncate(
+/*=============*/
+	const char*	name,	/*!< in: name of the file, for messages */
+	os_file_t	file,	/*!< in: handle to a file */
+	os_offset_t	size)	/*!< in: new file size in bytes */
+	__attribute__((nonnull, warn_unused_result));
+/***********************************************************************//**
+Checks whether InnoDB was built with a transparent page compression
+algorithm.
+@return	true if pages can be compressed and decompressed with it */
+UNIV_INTERN
+bool
+os_file_compression_is_supported(
+/*=============================*/
+	ulint	algorithm);	/*!< in: OS_FILE_COMPRESSION_ZLIB, ... */
+/***********************************************************************//**
+Decompresses in place a page that was written with transparent page
+compression. Other pages are left alone.
+@return	false if the page is compressed but cannot be decompressed */
+UNIV_INTERN
+bool
+os_file_decompress_page(
+/*====================*/
+	os_file_compress_t*	compress,	/*!< in/out: compression
+						counters of the tablespace,
+						or NULL */
+	byte*			page)		/*!< in/out: page of
+						UNIV_PAGE_SIZE bytes */
+	__attribute__((nonnull(2)));
+/***********************************************************************//**
 NOTE! Use the corresponding macro os_file_flush(), not directly this function!
 Flushes the write buffers of a given file to the disk.
 @return	TRUE if success */
@@ -1109,6 +1195,11 @@ os_aio_func(
 				to write */
 	os_offset_t	offset,	/*!< in: file offset where to read or write */
 	ulint		n,	/*!< in: number of bytes to read or write */
+	os_file_compress_t* compress,
+				/*!< in/out: transparent page
+				compression of the file, or NULL
+				if the data is not in pages of a
+				tablespace */
 	fil_node_t*	message1,/*!< in: message for the aio handler
 				(can be used to identify a completed
 				aio operation); ignored if mode is
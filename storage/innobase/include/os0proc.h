@@ -69,6 +69,43 @@ os_mem_free_large(
 					os_mem_alloc_large() */
 	ulint	size);			/*!< in: size returned by
 					os_mem_alloc_large() */
+/****************************************************************//**
+Returns the number of NUMA nodes that memory and threads can be bound to.
+@return	number of nodes, or 0 if NUMA is not supported */
+UNIV_INTERN
+ulint
+os_numa_get_n_nodes(void);
+/*=====================*/
+/****************************************************************//**
+Returns the NUMA node of the CPU the calling thread is running on.
+@return	node number, or ULINT_UNDEFINED if it cannot be determined */
+UNIV_INTERN
+ulint
+os_numa_get_curr_node(void);
+/*=======================*/
+/****************************************************************//**
+Sets the memory policy of a range of pages so that they are allocated
+from the given NUMA node, migrating pages that were already touched.
+The node is preferred rather than mandatory: when it runs out of memory
+the pages are allocated elsewhere instead of failing.
+@return	true on success */
+UNIV_INTERN
+bool
+os_mem_bind_to_numa_node(
+/*=====================*/
+	void*	ptr,			/*!< in: start of the range, aligned
+					to the system page size */
+	ulint	size,			/*!< in: size of the range in bytes */
+	ulint	node);			/*!< in: NUMA node */
+/****************************************************************//**
+Restricts the calling thread to the CPUs of a NUMA node and makes it
+prefer that node for its memory allocations.
+@return	true on success */
+UNIV_INTERN
+bool
+os_thread_bind_to_numa_node(
+/*========================*/
+	ulint	node);			/*!< in: NUMA node */
 
 #ifndef UNIV_NONINL
 #include "os0proc.ic"
@@ -85,6 +85,10 @@ struct os_event {
 					/*!< list of all created events */
 };
 
+/** A 32-bit word on which threads can be suspended until another thread
+changes it; see os_futex_wait() and os_futex_wake() */
+typedef ib_uint32_t		os_futex_t;
+
 /** Denotes an infinite delay for os_event_wait_time() */
 #define OS_SYNC_INFINITE_TIME   ULINT_UNDEFINED
 
@@ -198,6 +202,30 @@ os_event_wait_time_low(
 	ib_int64_t	reset_sig_count);	/*!< in: zero or the value
 						returned by previous call of
 						os_event_reset(). */
+/**********************************************************//**
+Suspends the calling thread on a futex word, unless the word no longer
+holds the value the caller based its decision to wait on. The thread
+returns when it is woken up by os_futex_wake(), when the timeout is
+exceeded, or spuriously; the caller must recheck its wait condition.
+Only available when built with HAVE_IB_LINUX_FUTEX.
+@return	0 if woken up, OS_SYNC_TIME_EXCEEDED if timeout was exceeded */
+UNIV_INTERN
+ulint
+os_futex_wait(
+/*==========*/
+	os_futex_t*	futex,		/*!< in: futex word */
+	os_futex_t	val,		/*!< in: value of the word observed
+					before deciding to wait */
+	ulint		time_in_usec);	/*!< in: timeout in microseconds,
+					or OS_SYNC_INFINITE_TIME */
+/**********************************************************//**
+Changes the value of a futex word and wakes up all threads suspended on
+it in os_futex_wait(). */
+UNIV_INTERN
+void
+os_futex_wake(
+/*==========*/
+	os_futex_t*	futex);		/*!< in/out: futex word */
 /*********************************************************//**
 Creates an operating system mutex semaphore. Because these are slow, the
 mutex semaphore of InnoDB itself (ib_mutex_t) should be used where possible.
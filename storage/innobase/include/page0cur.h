@@ -257,6 +257,62 @@ page_copy_rec_list_end_to_created_page(
 	rec_t*		rec,		/*!< in: first record to copy */
 	dict_index_t*	index,		/*!< in: record descriptor */
 	mtr_t*		mtr);		/*!< in: mtr */
+#ifndef UNIV_HOTBACKUP
+/*************************************************************//**
+Starts appending records in ascending order to a newly created
+uncompressed page. The page header and the page directory are only
+valid after page_cur_append_end(), so the page must stay x-latched in
+mtr until then. */
+UNIV_INTERN
+void
+page_cur_append_start(
+/*==================*/
+	page_append_t*	app,	/*!< out: append context */
+	page_t*		page,	/*!< in/out: empty index page */
+	dict_index_t*	index,	/*!< in: record descriptor */
+	mtr_t*		mtr);	/*!< in/out: mtr */
+/*************************************************************//**
+Returns the maximum size of a record that can still be appended to
+the page, see page_get_max_insert_size().
+@return	maximum record size in bytes */
+UNIV_INTERN
+ulint
+page_cur_append_get_max_insert_size(
+/*================================*/
+	const page_append_t*	app);	/*!< in: append context */
+/*************************************************************//**
+Converts a data tuple to a record and appends it to the page. The
+caller must have checked that the record fits.
+@return	pointer to the appended record */
+UNIV_INTERN
+rec_t*
+page_cur_append_tuple(
+/*==================*/
+	page_append_t*	app,	/*!< in/out: append context */
+	const dtuple_t*	tuple,	/*!< in: data tuple, greater than
+				the previously appended records */
+	ulint		n_ext,	/*!< in: number of externally stored
+				columns */
+	ulint**		offsets,/*!< out: offsets on the record */
+	mem_heap_t**	heap);	/*!< in/out: heap for offsets */
+/*************************************************************//**
+Ends the redo log record of the records appended so far. This must be
+called before anything else is logged for the page in the same mtr.
+The log record of any records appended later starts after it. */
+UNIV_INTERN
+void
+page_cur_append_close_log(
+/*======================*/
+	page_append_t*	app);	/*!< in/out: append context */
+/*************************************************************//**
+Finishes appending records to a page: writes the page directory and
+the page header. At least one record must have been appended. */
+UNIV_INTERN
+void
+page_cur_append_end(
+/*================*/
+	page_append_t*	app);	/*!< in/out: append context */
+#endif /* !UNIV_HOTBACKUP */
 /***********************************************************//**
 Deletes a record at the page cursor. The cursor is moved to the
 next record after the deleted one. */
@@ -380,6 +436,33 @@ struct page_cur_t{
 	buf_block_t*	block;	/*!< pointer to the block containing rec */
 };
 
+/** Context for appending records in ascending order to a newly created
+uncompressed page, see page_cur_append_start(). The records are logged
+as MLOG_LIST_END_COPY_CREATED, like page_copy_rec_list_end_to_created_page()
+does. */
+
+struct page_append_t{
+	page_t*		page;	/*!< page being filled */
+	dict_index_t*	index;	/*!< record descriptor */
+	mtr_t*		mtr;	/*!< mini-transaction */
+	ibool		log_open;/*!< TRUE if a log record is open */
+	byte*		log_ptr;/*!< length field of the open log record,
+				or NULL if logging is disabled */
+	ulint		log_data_len;/*!< size of the mtr log when the
+				log record was opened */
+	ulint		log_mode;/*!< log mode to restore when the log
+				record is closed */
+	rec_t*		prev_rec;/*!< last appended record, or the
+				infimum */
+	byte*		heap_top;/*!< end of the last appended record */
+	ulint		n_recs;	/*!< number of appended records */
+	ulint		count;	/*!< number of records appended since
+				the last directory slot was set */
+	ulint		slot_index;/*!< index of the last directory slot
+				that has been set */
+	page_dir_slot_t* slot;	/*!< directory slot slot_index */
+};
+
 #ifndef UNIV_NONINL
 #include "page0cur.ic"
 #endif
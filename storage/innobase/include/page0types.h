@@ -40,6 +40,8 @@ using namespace std;
 typedef	byte		page_t;
 /** Index page cursor */
 struct page_cur_t;
+/** Context for appending sorted records to a new page */
+struct page_append_t;
 
 /** Compressed index page */
 typedef byte		page_zip_t;
@@ -44,6 +44,9 @@ read_view_open_now(
 /*===============*/
 	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
 					transaction, or 0 used in purge */
+	read_view_t*	view,		/*!< in: closed read view allocated
+					from heap, to be reused if possible,
+					or NULL */
 	mem_heap_t*	heap);		/*!< in: memory heap from which
 					allocated */
 /*********************************************************************//**
@@ -145,14 +148,22 @@ struct read_view_t{
 				this is the "low water mark". */
 	ulint		n_trx_ids;
 				/*!< Number of cells in the trx_ids array */
+	ulint		max_trx_ids;
+				/*!< Number of cells allocated for the
+				trx_ids array */
 	trx_id_t*	trx_ids;/*!< Additional trx ids which the read should
 				not see: typically, these are the read-write
 				active transactions at the time when the read
 				is serialized, except the reading transaction
-				itself; the trx ids in this array are in a
-				descending order. These trx_ids should be
+				itself; the trx ids in this array are in an
+				ascending order. These trx_ids should be
 				between the "low" and "high" water marks,
 				that is, up_limit_id and low_limit_id. */
+	ib_uint64_t	rw_trx_ids_version;
+				/*!< trx_sys->rw_trx_ids_version when
+				trx_ids was copied from trx_sys->rw_trx_ids;
+				if it is still the same when the view is
+				opened again, the contents can be reused */
 	trx_id_t	creator_trx_id;
 				/*!< trx id of creating transaction, or
 				0 used in purge */
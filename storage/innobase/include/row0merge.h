@@ -117,6 +117,9 @@ struct row_merge_dup_t {
 					(index->table), or NULL if not
 					rebuilding table */
 	ulint			n_dup;	/*!< number of duplicates */
+	ib_mutex_t*		mutex;	/*!< serializes the reporting into
+					table when several threads sort
+					the entries of the index, or NULL */
 };
 
 /*************************************************************//**
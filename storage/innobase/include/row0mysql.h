@@ -35,6 +35,7 @@ Created 9/17/2000 Heikki Tuuri
 #include "row0types.h"
 #include "btr0pcur.h"
 #include "trx0types.h"
+#include "buf0types.h"
 
 // Forward declaration
 struct SysIndexCallback;
@@ -767,6 +768,10 @@ struct row_prebuilt_t {
 					updated */
 	dtuple_t*	clust_ref;	/*!< prebuilt dtuple used in
 					sel/upd/del */
+	ulint		clust_prefetch_skip;/*!< number of clustered index
+					lookups to do before the leaf pages
+					of the following lookups are read
+					ahead, see innodb_clust_prefetch_pages */
 	ulint		select_lock_type;/*!< LOCK_NONE, LOCK_S, or LOCK_X */
 	ulint		stored_select_lock_type;/*!< this field is used to
 					remember the original select_lock_type
@@ -865,6 +870,12 @@ struct row_prebuilt_t {
 	ulint		idx_cond_n_cols;/*!< Number of fields in idx_cond_cols.
 					0 if and only if idx_cond == NULL. */
 	/*----------------------*/
+	buf_scan_ring_t*scan_ring;	/*!< ring of the pages read by a
+					full table scan or a large range
+					scan in the current statement, or
+					NULL if MySQL did not announce such
+					a scan; see HA_EXTRA_LARGE_SCAN */
+	/*----------------------*/
 	ulint		magic_n2;	/*!< this should be the same as
 					magic_n */
 	/*----------------------*/
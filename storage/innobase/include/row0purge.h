@@ -118,6 +118,13 @@ struct purge_node_t{
 	btr_pcur_t	pcur;	/*!< persistent cursor used in searching the
 				clustered index record */
 	ibool		done;	/* Debug flag */
+	ulint		n_tables;/*!< number of distinct tables whose undo
+				records were attached to this node in the
+				current batch */
+	ulint		n_purged;/*!< number of undo records purged by this
+				node since startup */
+	ulint		n_purged_old;/*!< value of n_purged at the last
+				monitor printout */
 
 };
 
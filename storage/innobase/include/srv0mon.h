@@ -132,6 +132,30 @@ enum monitor_id_t {
 	MONITOR_TIMEOUT,
 	MONITOR_LOCKREC_WAIT,
 	MONITOR_TABLELOCK_WAIT,
+	MONITOR_DEADLOCK_SEARCH,
+	MONITOR_DEADLOCK_SEARCH_STEPS,
+	MONITOR_DEADLOCK_SEARCH_TIME,
+
+	/* Row lock wait time histogram for each
+	innodb_lock_schedule_algorithm */
+	MONITOR_LOCK_WAIT_FCFS_LE_1MS,
+	MONITOR_LOCK_WAIT_FCFS_LE_10MS,
+	MONITOR_LOCK_WAIT_FCFS_LE_100MS,
+	MONITOR_LOCK_WAIT_FCFS_LE_1S,
+	MONITOR_LOCK_WAIT_FCFS_LE_10S,
+	MONITOR_LOCK_WAIT_FCFS_GT_10S,
+	MONITOR_LOCK_WAIT_OLDEST_LE_1MS,
+	MONITOR_LOCK_WAIT_OLDEST_LE_10MS,
+	MONITOR_LOCK_WAIT_OLDEST_LE_100MS,
+	MONITOR_LOCK_WAIT_OLDEST_LE_1S,
+	MONITOR_LOCK_WAIT_OLDEST_LE_10S,
+	MONITOR_LOCK_WAIT_OLDEST_GT_10S,
+	MONITOR_LOCK_WAIT_MOST_LOCKS_LE_1MS,
+	MONITOR_LOCK_WAIT_MOST_LOCKS_LE_10MS,
+	MONITOR_LOCK_WAIT_MOST_LOCKS_LE_100MS,
+	MONITOR_LOCK_WAIT_MOST_LOCKS_LE_1S,
+	MONITOR_LOCK_WAIT_MOST_LOCKS_LE_10S,
+	MONITOR_LOCK_WAIT_MOST_LOCKS_GT_10S,
 	MONITOR_NUM_RECLOCK_REQ,
 	MONITOR_RECLOCK_CREATED,
 	MONITOR_RECLOCK_REMOVED,
@@ -154,6 +178,7 @@ enum monitor_id_t {
 	MONITOR_OVLD_BUF_POOL_WAIT_FREE,
 	MONITOR_OVLD_BUF_POOL_READ_AHEAD,
 	MONITOR_OVLD_BUF_POOL_READ_AHEAD_EVICTED,
+	MONITOR_READ_AHEAD_CLUST,
 	MONITOR_OVLD_BUF_POOL_PAGE_TOTAL,
 	MONITOR_OVLD_BUF_POOL_PAGE_MISC,
 	MONITOR_OVLD_BUF_POOL_PAGES_DATA,
@@ -177,6 +202,15 @@ enum monitor_id_t {
 	MONITOR_FLUSH_NEIGHBOR_COUNT,
 	MONITOR_FLUSH_NEIGHBOR_PAGES,
 	MONITOR_FLUSH_N_TO_FLUSH_REQUESTED,
+	MONITOR_FLUSH_ADAPTIVE_AVG_TIME_SLOT,
+	MONITOR_LRU_BATCH_FLUSH_AVG_TIME_SLOT,
+	MONITOR_FLUSH_ADAPTIVE_AVG_TIME_THREAD,
+	MONITOR_LRU_BATCH_FLUSH_AVG_TIME_THREAD,
+	MONITOR_FLUSH_AVG_TIME,
+	MONITOR_FLUSH_AVG_WAIT_TIME,
+	MONITOR_FLUSH_ADAPTIVE_AVG_PASS,
+	MONITOR_LRU_BATCH_FLUSH_AVG_PASS,
+	MONITOR_FLUSH_AVG_PASS,
 	MONITOR_FLUSH_AVG_PAGE_RATE,
 	MONITOR_FLUSH_LSN_AVG_RATE,
 	MONITOR_FLUSH_PCT_FOR_DIRTY,
@@ -261,6 +295,7 @@ enum monitor_id_t {
 	MONITOR_TRX_RW_COMMIT,
 	MONITOR_TRX_RO_COMMIT,
 	MONITOR_TRX_NL_RO_COMMIT,
+	MONITOR_READ_VIEW_REUSED,
 	MONITOR_TRX_COMMIT_UNDO,
 	MONITOR_TRX_ROLLBACK,
 	MONITOR_TRX_ROLLBACK_SAVEPOINT,
@@ -280,6 +315,12 @@ enum monitor_id_t {
 	MONITOR_DML_PURGE_DELAY,
 	MONITOR_PURGE_STOP_COUNT,
 	MONITOR_PURGE_RESUME_COUNT,
+	MONITOR_PURGE_HISTORY_DRAINED,
+	MONITOR_PURGE_READ_AHEAD,
+	MONITOR_PURGE_BATCH_TABLES,
+	MONITOR_PURGE_BATCH_TABLE_SPLITS,
+	MONITOR_UNDO_TRUNCATE_COUNT,
+	MONITOR_UNDO_TRUNCATE_MICROSECOND,
 
 	/* Recovery related counters */
 	MONITOR_MODULE_RECOVERY,
@@ -318,6 +359,8 @@ enum monitor_id_t {
 	MONITOR_MODULE_ADAPTIVE_HASH,
 	MONITOR_OVLD_ADAPTIVE_HASH_SEARCH,
 	MONITOR_OVLD_ADAPTIVE_HASH_SEARCH_BTREE,
+	MONITOR_OVLD_ADAPTIVE_HASH_HITS,
+	MONITOR_OVLD_ADAPTIVE_HASH_MISSES,
 	MONITOR_ADAPTIVE_HASH_PAGE_ADDED,
 	MONITOR_ADAPTIVE_HASH_PAGE_REMOVED,
 	MONITOR_ADAPTIVE_HASH_ROW_ADDED,
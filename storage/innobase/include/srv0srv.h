@@ -141,6 +141,9 @@ extern os_event_t	srv_error_event;
 /** The buffer pool dump/load thread waits on this event. */
 extern os_event_t	srv_buf_dump_event;
 
+/** The buffer pool resize thread waits on this event. */
+extern os_event_t	srv_buf_resize_event;
+
 /** The buffer pool dump/load file name */
 #define SRV_BUF_DUMP_FILENAME_DEFAULT	"ib_buffer_pool"
 extern char*		srv_buf_dump_filename;
@@ -150,6 +153,10 @@ and/or load it during startup. */
 extern char		srv_buffer_pool_dump_at_shutdown;
 extern char		srv_buffer_pool_load_at_startup;
 
+/** Interval in seconds between periodic dumps of the buffer pool,
+0 if the buffer pool is only dumped on request and at shutdown */
+extern ulong		srv_buf_dump_interval;
+
 /* Whether to disable file system cache if it is defined */
 extern char		srv_disable_sort_file_cache;
 
@@ -195,6 +202,9 @@ extern	ulong	srv_thread_sleep_delay;
 #if defined(HAVE_ATOMIC_BUILTINS)
 /** Maximum sleep delay (in micro-seconds), value of 0 disables it.*/
 extern	ulong	srv_adaptive_max_sleep_delay;
+/** TRUE if threads wait in a queue to enter InnoDB instead of sleeping
+(innodb_thread_concurrency_queue) */
+extern	my_bool	srv_thread_concurrency_queue;
 #endif /* HAVE_ATOMIC_BUILTINS */
 
 /** The file format to use on new *.ibd files. */
@@ -209,6 +219,12 @@ extern ibool	srv_locks_unsafe_for_binlog;
 
 /** Sort buffer size in index creation */
 extern ulong	srv_sort_buf_size;
+/** Number of threads that scan the clustered index and merge sort
+the entries when creating secondary indexes */
+extern ulong	srv_sort_pll_degree;
+/** Percentage of each B-tree page to fill when an index is built
+from sorted data */
+extern ulong	srv_fill_factor;
 /** Maximum modification log file size for online index creation */
 extern unsigned long long	srv_online_max_size;
 
@@ -234,6 +250,13 @@ extern ulint	srv_undo_tablespaces_open;
 /* The number of undo segments to use */
 extern ulong	srv_undo_logs;
 
+/** Whether undo tablespaces larger than srv_max_undo_log_size are
+truncated. */
+extern my_bool	srv_undo_log_truncate;
+
+/** Size in bytes above which an undo tablespace is truncated. */
+extern unsigned long long	srv_max_undo_log_size;
+
 extern ulint	srv_n_data_files;
 extern char**	srv_data_file_names;
 extern ulint*	srv_data_file_sizes;
@@ -272,20 +295,37 @@ extern ibool	srv_use_sys_malloc;
 #endif /* UNIV_HOTBACKUP */
 extern ulint	srv_buf_pool_size;	/*!< requested size in bytes */
 extern ulint    srv_buf_pool_instances; /*!< requested number of buffer pool instances */
+extern ulong	srv_buf_pool_chunk_size;/*!< size in bytes of the chunks
+					in which the buffer pool is
+					allocated and resized */
+extern my_bool	srv_numa_aware;		/*!< whether to bind buffer pool
+					instances and the threads serving
+					them to NUMA nodes */
 extern ulong	srv_n_page_hash_locks;	/*!< number of locks to
 					protect buf_pool->page_hash */
 extern ulong	srv_LRU_scan_depth;	/*!< Scan depth for LRU
 					flush batch */
+extern ulong	srv_unzip_LRU_max_pct;	/*!< maximum size of the
+					uncompressed frames of compressed
+					pages, in percent of the buffer
+					pool size */
+extern ulong	srv_scan_ring_size;	/*!< number of pages that a
+					large scan may keep in the
+					buffer pool */
 extern ulong	srv_flush_neighbors;	/*!< whether or not to flush
 					neighbors of a block */
 extern ulint	srv_buf_pool_old_size;	/*!< previously requested size */
 extern ulint	srv_buf_pool_curr_size;	/*!< current size in bytes */
+extern uint	srv_change_buffer_max_size;/*!< maximum size of the change
+					buffer, in percent of the buffer
+					pool size */
 extern ulint	srv_mem_pool_size;
 extern ulint	srv_lock_table_size;
 
 extern ulint	srv_n_file_io_threads;
 extern my_bool	srv_random_read_ahead;
 extern ulong	srv_read_ahead_threshold;
+extern ulong	srv_clust_prefetch_pages;
 extern ulint	srv_n_read_io_threads;
 extern ulint	srv_n_write_io_threads;
 
@@ -346,11 +386,18 @@ extern my_bool			srv_stats_auto_recalc;
 
 extern ibool	srv_use_doublewrite_buf;
 extern ulong	srv_doublewrite_batch_size;
+extern ulong	srv_doublewrite_pages;
+
+/** Whether the data files are assumed to be written a page at a time
+atomically, so that no page goes through the doublewrite buffer
+(innodb_use_atomic_writes) */
+extern my_bool	srv_use_atomic_writes;
 extern ulong	srv_checksum_algorithm;
 
 extern ulong	srv_max_buf_pool_modified_pct;
 extern ulong	srv_max_purge_lag;
 extern ulong	srv_max_purge_lag_delay;
+extern ulong	srv_purge_read_ahead_pages;
 
 extern ulong	srv_replication_delay;
 /*-------------------------------------------*/
@@ -371,6 +418,9 @@ extern ibool	srv_error_monitor_active;
 /* TRUE during the lifetime of the buffer pool dump/load thread */
 extern ibool	srv_buf_dump_thread_active;
 
+/* TRUE during the lifetime of the buffer pool resize thread */
+extern ibool	srv_buf_resize_thread_active;
+
 /* TRUE during the lifetime of the stats thread */
 extern ibool	srv_dict_stats_thread_active;
 
@@ -378,6 +428,12 @@ extern ulong	srv_n_spin_wait_rounds;
 extern ulong	srv_n_free_tickets_to_enter;
 extern ulong	srv_thread_sleep_delay;
 extern ulong	srv_spin_wait_delay;
+/** TRUE if threads waiting for a mutex or rw-lock sleep on a futex
+embedded in the latch (innodb_use_futex) */
+extern my_bool	srv_use_futex;
+/** TRUE if each mutex and rw-lock adapts its own spin limit to how long
+it is held (innodb_adaptive_spin) */
+extern my_bool	srv_adaptive_spin;
 extern ibool	srv_priority_boost;
 
 extern ulint	srv_truncated_status_writes;
@@ -427,15 +483,32 @@ extern const char* srv_io_thread_function[];
 /* the number of purge threads to use from the worker pool (currently 0 or 1) */
 extern ulong srv_n_purge_threads;
 
+/* the number of page cleaner threads, including the coordinator */
+extern ulong srv_n_page_cleaners;
+
+/* the number of threads applying redo log records during crash recovery */
+extern ulong srv_n_recovery_apply_threads;
+
 /* the number of pages to purge in one batch */
 extern ulong srv_purge_batch_size;
 
+/* the number of purge batches after which the history list is truncated */
+extern ulong srv_purge_rseg_truncate_frequency;
+
 /* the number of sync wait arrays */
 extern ulong srv_sync_array_size;
 
 /* print all user-level transactions deadlocks to mysqld stderr */
 extern my_bool srv_print_all_deadlocks;
 
+/** How deadlocks are detected, one of srv_deadlock_detect_t
+(innodb_deadlock_detect) */
+extern ulong	srv_deadlock_detect;
+
+/** Order in which waiting record locks are granted, one of
+srv_lock_schedule_t (innodb_lock_schedule_algorithm) */
+extern ulong	srv_lock_schedule_algorithm;
+
 extern my_bool	srv_cmp_per_index_enabled;
 
 /** Status variables to be passed to MySQL */
@@ -447,6 +520,9 @@ extern srv_stats_t	srv_stats;
 # ifdef UNIV_PFS_THREAD
 /* Keys to register InnoDB threads with performance schema */
 extern mysql_pfs_key_t	buf_page_cleaner_thread_key;
+extern mysql_pfs_key_t	buf_page_cleaner_worker_thread_key;
+extern mysql_pfs_key_t	log_writer_thread_key;
+extern mysql_pfs_key_t	log_flusher_thread_key;
 extern mysql_pfs_key_t	trx_rollback_clean_thread_key;
 extern mysql_pfs_key_t	io_handler_thread_key;
 extern mysql_pfs_key_t	srv_lock_timeout_thread_key;
@@ -455,6 +531,7 @@ extern mysql_pfs_key_t	srv_monitor_thread_key;
 extern mysql_pfs_key_t	srv_master_thread_key;
 extern mysql_pfs_key_t	srv_purge_thread_key;
 extern mysql_pfs_key_t	recv_writer_thread_key;
+extern mysql_pfs_key_t	recv_apply_thread_key;
 
 /* This macro register the current thread and its key with performance
 schema */
@@ -548,6 +625,34 @@ enum srv_stats_method_name_enum {
 
 typedef enum srv_stats_method_name_enum		srv_stats_method_name_t;
 
+/** Alternatives for srv_deadlock_detect, which can be changed by
+setting innodb_deadlock_detect */
+enum srv_deadlock_detect_t {
+	SRV_DEADLOCK_DETECT_OFF,	/*!< Do not look for deadlocks;
+					rely on innodb_lock_wait_timeout
+					to break them */
+	SRV_DEADLOCK_DETECT_ON,		/*!< Search the waits-for graph
+					whenever a lock wait is enqueued.
+					This is the default setting */
+	SRV_DEADLOCK_DETECT_BACKGROUND	/*!< Search a snapshot of the
+					waits-for graph in the lock
+					timeout thread */
+};
+
+/** Alternatives for srv_lock_schedule_algorithm, which can be changed by
+setting innodb_lock_schedule_algorithm */
+enum srv_lock_schedule_t {
+	SRV_LOCK_SCHEDULE_FCFS,		/*!< Grant waiting record locks in
+					queue order. This is the default
+					setting */
+	SRV_LOCK_SCHEDULE_OLDEST,	/*!< Grant waiting record locks to
+					the oldest transaction first */
+	SRV_LOCK_SCHEDULE_MOST_LOCKS,	/*!< Grant waiting record locks to
+					the transaction that holds the most
+					locks first */
+	SRV_LOCK_SCHEDULE_N		/*!< Number of algorithms */
+};
+
 #ifndef UNIV_HOTBACKUP
 /** Types of threads existing in the system. */
 enum srv_thread_type {
@@ -792,6 +897,8 @@ struct export_var_t{
 	ulint innodb_data_reads;		/*!< I/O read requests */
 	char  innodb_buffer_pool_dump_status[512];/*!< Buf pool dump status */
 	char  innodb_buffer_pool_load_status[512];/*!< Buf pool load status */
+	char  innodb_buffer_pool_resize_status[512];/*!< Buf pool resize
+						status */
 	ulint innodb_buffer_pool_pages_total;	/*!< Buffer pool size */
 	ulint innodb_buffer_pool_pages_data;	/*!< Data pages */
 	ulint innodb_buffer_pool_bytes_data;	/*!< File bytes used */
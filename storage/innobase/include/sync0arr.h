@@ -30,12 +30,29 @@ Created 9/5/1995 Heikki Tuuri
 #include "ut0lst.h"
 #include "ut0mem.h"
 #include "os0thread.h"
+#include "os0sync.h"
 
 /** Synchronization wait array cell */
 struct sync_cell_t;
 /** Synchronization wait array */
 struct sync_array_t;
 
+/** A wait for a mutex or rw-lock that a thread has prepared for, after
+giving up spinning. Without innodb_use_futex the wait goes through a
+reserved wait array cell; with it the thread sleeps on the futex word of
+the object and a cell is only reserved if the wait lasts long. */
+struct sync_wait_t {
+	void*		object;	/*!< mutex or rw-lock waited for */
+	ulint		type;	/*!< lock request type */
+	const char*	file;	/*!< file where requested */
+	ulint		line;	/*!< line where requested */
+	sync_array_t*	arr;	/*!< wait array of the reserved cell,
+				or NULL if no cell is reserved */
+	ulint		index;	/*!< index of the reserved cell */
+	os_futex_t	futex_val;/*!< value of the futex word of the
+				object when the wait was prepared */
+};
+
 /******************************************************************//**
 Get an instance of the sync wait array and reserve a wait array cell
 in the instance for waiting for an object. The event of the cell is
@@ -86,6 +103,38 @@ sync_array_free_cell(
 /*=================*/
 	sync_array_t*	arr,	/*!< in: wait array */
 	ulint		index);	/*!< in: index of the cell in array */
+/******************************************************************//**
+Prepares the calling thread to wait for a mutex or rw-lock. Without
+innodb_use_futex this reserves a wait array cell, which resets the event
+of the object; with it, the current value of the futex word of the object
+is recorded. Either way, a release of the object that happens after this
+call will not be missed by sync_array_wait(). */
+UNIV_INTERN
+void
+sync_array_prepare_wait(
+/*====================*/
+	sync_wait_t*	wait,	/*!< out: pending wait */
+	void*		object,	/*!< in: pointer to the object to wait for */
+	ulint		type,	/*!< in: lock request type */
+	const char*	file,	/*!< in: file where requested */
+	ulint		line);	/*!< in: line where requested */
+/******************************************************************//**
+Cancels a wait prepared with sync_array_prepare_wait(), after the caller
+acquired the object after all. */
+UNIV_INTERN
+void
+sync_array_cancel_wait(
+/*===================*/
+	sync_wait_t*	wait);	/*!< in/out: pending wait */
+/******************************************************************//**
+Suspends the calling thread until the object of a wait prepared with
+sync_array_prepare_wait() has been signalled since the preparation. The
+caller must retry acquiring the object afterwards. */
+UNIV_INTERN
+void
+sync_array_wait(
+/*============*/
+	sync_wait_t*	wait);	/*!< in/out: pending wait */
 /**********************************************************************//**
 Note that one of the wait objects was signalled. */
 UNIV_INTERN
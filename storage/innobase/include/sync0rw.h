@@ -594,10 +594,15 @@ struct rw_lock_t {
 				/*!< Thread id of writer thread. Is only
 				guaranteed to have sane and non-stale
 				value iff recursive flag is set. */
-	os_event_t	event;	/*!< Used by sync0arr.cc for thread queueing */
+	os_event_t	event;	/*!< Used by sync0arr.cc for thread queueing;
+				NULL if srv_use_futex */
 	os_event_t	wait_ex_event;
 				/*!< Event for next-writer to wait on. A thread
 				must decrement lock_word before waiting. */
+	os_futex_t	futex;	/*!< Replaces event if srv_use_futex */
+	os_futex_t	wait_ex_futex;
+				/*!< Replaces wait_ex_event if
+				srv_use_futex */
 #ifndef INNODB_RW_LOCKS_USE_ATOMICS
 	ib_mutex_t	mutex;		/*!< The mutex protecting rw_lock_t */
 #endif /* INNODB_RW_LOCKS_USE_ATOMICS */
@@ -615,6 +620,8 @@ struct rw_lock_t {
 	struct PSI_rwlock *pfs_psi;/*!< The instrumentation hook */
 #endif
 	ulint count_os_wait;	/*!< Count of os_waits. May not be accurate */
+	sync_spin_t	spin;	/*!< adaptive spin state; only exclusive
+				holds are timed */
 	const char*	cfile_name;/*!< File name where lock created */
         /* last s-lock file/line is not guaranteed to be correct */
 	const char*	last_s_file_name;/*!< File name where last s-locked */
@@ -97,9 +97,11 @@ extern mysql_pfs_key_t	mem_hash_mutex_key;
 # endif /* UNIV_MEM_DEBUG */
 extern mysql_pfs_key_t	mem_pool_mutex_key;
 extern mysql_pfs_key_t	mutex_list_mutex_key;
+extern mysql_pfs_key_t	page_cleaner_mutex_key;
 extern mysql_pfs_key_t	purge_sys_bh_mutex_key;
 extern mysql_pfs_key_t	recv_sys_mutex_key;
 extern mysql_pfs_key_t	recv_writer_mutex_key;
+extern mysql_pfs_key_t	row_merge_pll_mutex_key;
 extern mysql_pfs_key_t	rseg_mutex_key;
 # ifdef UNIV_SYNC_DEBUG
 extern mysql_pfs_key_t	rw_lock_debug_mutex_key;
@@ -119,12 +121,11 @@ extern mysql_pfs_key_t	trx_undo_mutex_key;
 extern mysql_pfs_key_t	trx_mutex_key;
 extern mysql_pfs_key_t	lock_sys_mutex_key;
 extern mysql_pfs_key_t	lock_sys_wait_mutex_key;
+extern mysql_pfs_key_t	lock_rec_shard_mutex_key;
 extern mysql_pfs_key_t	trx_sys_mutex_key;
 extern mysql_pfs_key_t	srv_sys_mutex_key;
 extern mysql_pfs_key_t	srv_sys_tasks_mutex_key;
-#ifndef HAVE_ATOMIC_BUILTINS
 extern mysql_pfs_key_t	srv_conc_mutex_key;
-#endif /* !HAVE_ATOMIC_BUILTINS */
 #ifndef HAVE_ATOMIC_BUILTINS_64
 extern mysql_pfs_key_t	monitor_mutex_key;
 #endif /* !HAVE_ATOMIC_BUILTINS_64 */
@@ -618,6 +619,9 @@ V
 lock_sys_mutex				Mutex protecting lock_sys_t
 |
 V
+lock_sys->rec_mutexes			Mutexes protecting the partitions
+|					of the record lock hash table
+V
 trx_sys->mutex				Mutex protecting trx_sys_t
 |
 V
@@ -702,8 +706,9 @@ or row lock! */
 /*------------------------------------- MySQL query cache mutex */
 /*------------------------------------- MySQL binlog mutex */
 /*-------------------------------*/
-#define SYNC_LOCK_WAIT_SYS	300
-#define SYNC_LOCK_SYS		299
+#define SYNC_LOCK_WAIT_SYS	301
+#define SYNC_LOCK_SYS		300
+#define SYNC_LOCK_REC_SHARD	299	/* lock_sys->rec_mutexes */
 #define SYNC_TRX_SYS		298
 #define SYNC_TRX		297
 #define SYNC_THREADS		295
@@ -717,7 +722,9 @@ or row lock! */
 #define SYNC_FTS_CACHE_INIT	166	/* Used for FTS cache initialization */
 #define SYNC_FTS_BG_THREADS	165
 #define SYNC_FTS_OPTIMIZE       164     // FIXME: is this correct number, test
+#define	SYNC_ROW_MERGE_PLL	163	/* row_merge_pll_t::mutex */
 #define	SYNC_WORK_QUEUE		162
+#define	SYNC_PAGE_CLEANER	161	/* page_cleaner_t::mutex */
 #define	SYNC_SEARCH_SYS		160	/* NOTE that if we have a memory
 					heap that can be extended to the
 					buffer pool, its logical level is
@@ -741,13 +748,38 @@ or row lock! */
 #define RW_LOCK_WAIT_EX		353
 #define SYNC_MUTEX		354
 
+/** Adaptive spin state and contention statistics of a mutex or an
+rw-lock. The fields are updated without synchronization by the threads
+that wait for the latch, so, like count_os_wait, they may be slightly
+inaccurate. */
+struct sync_spin_t {
+	ulint		limit;	/*!< spin rounds a waiter makes before
+				it suspends itself if innodb_adaptive_spin;
+				0 until the latch is first contended */
+	ulint		n_waits;/*!< number of spin waits */
+	ulint		n_rounds;/*!< number of spin rounds made in
+				all the spin waits */
+	ulint		n_spin_acquired;
+				/*!< number of spin waits that acquired
+				the latch without suspending the thread */
+	ulint		hold_time;
+				/*!< moving average of how long the latch
+				is held after a contended acquisition,
+				in nanoseconds */
+	ullint		hold_start;
+				/*!< ut_time_us() when a thread that had
+				waited for the latch acquired it, or 0
+				if the current hold is not timed */
+};
+
 /* NOTE! The structure appears here only for the compiler to know its size.
 Do not use its fields directly! The structure used in the spin lock
 implementation of a mutual exclusion semaphore. */
 
 /** InnoDB mutex */
 struct ib_mutex_t {
-	os_event_t	event;	/*!< Used by sync0arr.cc for the wait queue */
+	os_event_t	event;	/*!< Used by sync0arr.cc for the wait queue;
+				NULL if srv_use_futex */
 	volatile lock_word_t	lock_word;	/*!< lock_word is the target
 				of the atomic test-and-set instruction when
 				atomic operations are enabled. */
@@ -761,6 +793,9 @@ struct ib_mutex_t {
 				may be) threads waiting in the global wait
 				array for this mutex to be released.
 				Otherwise, this is 0. */
+	os_futex_t	futex;	/*!< Changed whenever waiters are
+				released; waiting threads sleep on this
+				word instead of event if srv_use_futex */
 	UT_LIST_NODE_T(ib_mutex_t)	list; /*!< All allocated mutexes are put into
 				a list.	Pointers to the next and prev. */
 #ifdef UNIV_SYNC_DEBUG
@@ -771,6 +806,7 @@ struct ib_mutex_t {
 	const char*	cfile_name;/*!< File name where mutex created */
 	ulint		cline;	/*!< Line where created */
 	ulong		count_os_wait;	/*!< count of os_wait */
+	sync_spin_t	spin;	/*!< adaptive spin state */
 #ifdef UNIV_DEBUG
 
 /** Value of mutex_t::magic_n */
@@ -794,6 +830,101 @@ to 20 microseconds. */
 
 #define	SYNC_SPIN_ROUNDS	srv_n_spin_wait_rounds
 
+/** With innodb_adaptive_spin, the spin limit of a latch stays between
+SYNC_SPIN_MIN_ROUNDS and SYNC_SPIN_MAX_FACTOR * SYNC_SPIN_ROUNDS */
+#define SYNC_SPIN_MIN_ROUNDS	4
+/** @see SYNC_SPIN_MIN_ROUNDS */
+#define SYNC_SPIN_MAX_FACTOR	4
+
+/******************************************************************//**
+Initializes the adaptive spin state of a latch. */
+UNIV_INTERN
+void
+sync_spin_init(
+/*===========*/
+	sync_spin_t*	spin);	/*!< out: adaptive spin state */
+/******************************************************************//**
+Gets the number of rounds a thread should spin for a latch before it
+suspends itself.
+@return	SYNC_SPIN_ROUNDS, or the adaptive limit if innodb_adaptive_spin */
+UNIV_INTERN
+ulint
+sync_spin_get_limit(
+/*================*/
+	const sync_spin_t*	spin);	/*!< in: adaptive spin state */
+/******************************************************************//**
+Records the outcome of a spin wait for a latch and, if
+innodb_adaptive_spin, adapts the spin limit of the latch: the limit grows
+when waits succeed only near its end, decays when they succeed early and
+shrinks when the latch is typically held for longer than spinning up to
+the limit takes, as then the spinning is wasted. */
+UNIV_INTERN
+void
+sync_spin_end(
+/*==========*/
+	sync_spin_t*	spin,		/*!< in/out: adaptive spin state */
+	ulint		n_rounds,	/*!< in: rounds spun */
+	ullint		start_us,	/*!< in: ut_time_us() when the
+					spinning began, or 0 if not timed */
+	ibool		acquired);	/*!< in: TRUE if the latch was
+					acquired, FALSE if the thread
+					will be suspended */
+/******************************************************************//**
+Starts timing the hold of a latch that the current thread acquired after
+waiting for it. Must be called by the holder of the latch. */
+UNIV_INLINE
+void
+sync_spin_hold_begin(
+/*=================*/
+	sync_spin_t*	spin);	/*!< in/out: adaptive spin state */
+/******************************************************************//**
+Finishes timing the hold of a latch, if sync_spin_hold_begin() was
+called for it. Must be called by the holder before releasing it. */
+UNIV_INLINE
+void
+sync_spin_hold_end(
+/*===============*/
+	sync_spin_t*	spin);	/*!< in/out: adaptive spin state */
+/******************************************************************//**
+Adds a timed hold of a latch to its moving average. */
+UNIV_INTERN
+void
+sync_spin_hold_sample(
+/*==================*/
+	sync_spin_t*	spin);	/*!< in/out: adaptive spin state */
+
+/** Contention statistics of a latch, or of all the buffer block latches
+of one kind, as returned by sync_latch_stats_get() */
+struct sync_latch_stats_t {
+	ibool		is_rw_lock;	/*!< TRUE for rw_lock_t,
+					FALSE for ib_mutex_t */
+	ibool		combined;	/*!< TRUE if this entry combines
+					the buffer block latches */
+	const char*	cfile_name;	/*!< file where created */
+	ulint		cline;		/*!< line where created */
+	ulint		n_instances;	/*!< number of latches combined */
+	ulint		n_waits;	/*!< sync_spin_t::n_waits */
+	ulint		n_rounds;	/*!< sync_spin_t::n_rounds */
+	ulint		n_spin_acquired;/*!< sync_spin_t::n_spin_acquired */
+	ulint		n_os_waits;	/*!< count_os_wait */
+	ulint		spin_limit;	/*!< sync_spin_get_limit(), averaged
+					over the combined latches */
+	ulint		hold_time;	/*!< sync_spin_t::hold_time, averaged
+					over the combined latches */
+};
+
+/*******************************************************************//**
+Takes a snapshot of the contention statistics of the mutexes and rw-locks
+that have been waited for. The buffer block mutexes and the buffer block
+rw-locks are each combined into one entry, as in SHOW ENGINE INNODB MUTEX.
+@return	number of entries in *stats */
+UNIV_INTERN
+ulint
+sync_latch_stats_get(
+/*=================*/
+	sync_latch_stats_t**	stats);	/*!< out: array of entries,
+					to be freed with ut_free() */
+
 /** The number of mutex_exit calls. Intended for performance monitoring. */
 extern	ib_int64_t	mutex_exit_count;
 
@@ -119,6 +119,37 @@ UNIV_INTERN
 purge_state_t
 trx_purge_state(void);
 /*=================*/
+/*******************************************************************//**
+Prints the rate at which the history list is drained and, for each purge
+worker, the rate at which it purges undo log records. The counters are
+read without latching. */
+UNIV_INTERN
+void
+trx_purge_print(
+/*============*/
+	FILE*	file,		/*!< in: file where to print */
+	double	time_elapsed);	/*!< in: seconds since the last printout */
+/*******************************************************************//**
+Truncates the undo tablespace that is marked for truncation if none of its
+rollback segments is in use any more, or marks an undo tablespace that has
+grown beyond innodb_max_undo_log_size. The rollback segments of a marked
+tablespace are not assigned to new transactions. Only the purge coordinator
+calls this, after the history list has been truncated. */
+UNIV_INTERN
+void
+trx_purge_truncate_undo_tablespaces(void);
+/*=====================================*/
+/*******************************************************************//**
+Completes the truncation of the undo tablespaces that were being truncated
+when the server was killed. This is called at startup after the redo log has
+been scanned and before the rollback segments are loaded into memory.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+trx_purge_undo_truncate_fix_up(
+/*===========================*/
+	ulint	n_undo_tablespaces);	/*!< in: number of open undo
+					tablespaces */
 
 /** This is the purge pointer/iterator. We need both the undo no and the
 transaction no up to which purge has parsed and applied the records. */
@@ -194,6 +225,30 @@ struct trx_purge_t{
 	ulint		hdr_page_no;	/*!< Header page of the undo log where
 					the next record to purge belongs */
 	ulint		hdr_offset;	/*!< Header byte offset on the page */
+	ulint		read_ahead_page_no;
+					/*!< Undo page whose successor was
+					last read ahead, or FIL_NULL */
+	/*-----------------------------*/
+	ulint		n_history_drained;
+					/*!< Number of undo logs removed
+					from the history lists; only the
+					purge coordinator updates this */
+	ulint		n_history_drained_old;
+					/*!< Value of n_history_drained at
+					the last monitor printout */
+	/*-----------------------------*/
+	ulint		undo_trunc_space;
+					/*!< Id of the undo tablespace whose
+					rollback segments are not assigned to
+					new transactions, because it is
+					truncated as soon as they are no longer
+					used; ULINT_UNDEFINED if none. Only the
+					purge coordinator accesses this */
+	ulint		undo_trunc_last;
+					/*!< Id of the undo tablespace that
+					was marked for truncation last, so that
+					they are considered in round-robin
+					order; 0 if none */
 	/*-----------------------------*/
 	mem_heap_t*	heap;		/*!< Temporary storage used during a
 					purge: can be emptied after purge
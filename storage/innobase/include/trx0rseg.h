@@ -124,6 +124,18 @@ trx_rseg_mem_free(
 /*==============*/
 	trx_rseg_t*	rseg);		/*!< in, own: instance to free */
 
+/***************************************************************************
+Resets the memory object of a rollback segment after its header has been
+re-created by the truncation of its undo tablespace. Frees the cached undo
+log segments, which no longer exist. */
+UNIV_INTERN
+void
+trx_rseg_mem_reset(
+/*===============*/
+	trx_rseg_t*	rseg,		/*!< in/out: rollback segment that no
+					transaction uses */
+	ulint		page_no);	/*!< in: page number of the new
+					rollback segment header */
 /*********************************************************************
 Creates a rollback segment. */
 UNIV_INTERN
@@ -165,6 +177,14 @@ struct trx_rseg_t{
 				header */
 	ulint		max_size;/* maximum allowed size in pages */
 	ulint		curr_size;/* current size in pages */
+	bool		skip_allocation;
+				/*!< true if the rollback segment is not
+				assigned to new transactions, because its
+				undo tablespace is to be truncated */
+	ulint		trx_ref_count;
+				/*!< number of transactions that have been
+				assigned this rollback segment and have not
+				yet committed or been cleaned up */
 	/*--------------------------------------------------------*/
 	/* Fields for update undo logs */
 	UT_LIST_BASE_NODE_T(trx_undo_t) update_undo_list;
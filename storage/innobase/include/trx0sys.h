@@ -176,6 +176,22 @@ trx_id_t
 trx_sys_get_new_trx_id(void);
 /*========================*/
 /*****************************************************************//**
+Adds the id of a read-write transaction to trx_sys->rw_trx_ids, which
+read views are copied from. */
+UNIV_INTERN
+void
+trx_sys_rw_trx_id_insert(
+/*=====================*/
+	trx_id_t	id);	/*!< in: transaction id */
+/*****************************************************************//**
+Removes the id of a read-write transaction from trx_sys->rw_trx_ids,
+if it is there. */
+UNIV_INTERN
+void
+trx_sys_rw_trx_id_erase(
+/*====================*/
+	trx_id_t	id);	/*!< in: transaction id */
+/*****************************************************************//**
 Determines the maximum transaction id.
 @return maximum currently allocated trx id; will be stale after the
 next call to trx_sys_get_new_trx_id() */
@@ -659,12 +675,37 @@ struct trx_sys_t{
 	UT_LIST_BASE_NODE_T(read_view_t) view_list;
 					/*!< List of read views sorted
 					on trx no, biggest first */
+	trx_id_t*	rw_trx_ids;	/*!< Ids of the read-write
+					transactions on rw_trx_list that a
+					read view opened now must not see,
+					in ascending order; a read view
+					copies this array instead of
+					traversing rw_trx_list */
+	ulint		n_rw_trx_ids;	/*!< Number of ids in rw_trx_ids */
+	ulint		rw_trx_ids_size;/*!< Number of cells allocated
+					for rw_trx_ids */
+	ib_uint64_t	rw_trx_ids_version;
+					/*!< Incremented whenever rw_trx_ids
+					changes: a read view that was opened
+					when this had the same value as now
+					would be identical to one opened now,
+					and can be reused */
+	trx_list_t	serialisation_list;
+					/*!< The transactions on rw_trx_ids
+					that have been assigned a trx->no,
+					in ascending order of trx->no; the
+					first one determines the low_limit_no
+					of a read view */
 };
 
 /** When a trx id which is zero modulo this number (which must be a power of
 two) is assigned, the field TRX_SYS_TRX_ID_STORE on the transaction system
 page is updated */
 #define TRX_SYS_TRX_ID_WRITE_MARGIN	256
+
+/** Initial number of cells allocated for trx_sys_t::rw_trx_ids; the array
+is doubled when it becomes full */
+#define TRX_SYS_RW_TRX_IDS_INIT_SIZE	256
 #endif /* !UNIV_HOTBACKUP */
 
 #ifndef UNIV_NONINL
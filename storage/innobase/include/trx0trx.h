@@ -799,6 +799,9 @@ struct trx_t{
 	ulint		has_search_latch;
 					/*!< TRUE if this trx has latched the
 					search system latch in S-mode */
+	rw_lock_t*	search_latch;	/*!< the adaptive hash index
+					partition latch that is S-latched
+					when has_search_latch is set */
 	ulint		search_latch_timeout;
 					/*!< If we notice that someone is
 					waiting for our S-lock on the search
@@ -880,6 +883,12 @@ struct trx_t{
 	ibool		in_rw_trx_list;	/*!< TRUE if in trx_sys->rw_trx_list */
 	/* @} */
 #endif /* UNIV_DEBUG */
+	UT_LIST_NODE_T(trx_t)
+			no_list;	/*!< trx_sys->serialisation_list;
+					protected by trx_sys->mutex */
+	bool		in_serialisation_list;
+					/*!< true if in
+					trx_sys->serialisation_list */
 	UT_LIST_NODE_T(trx_t)
 			mysql_trx_list;	/*!< list of transactions created for
 					MySQL; protected by trx_sys->mutex */
@@ -913,6 +922,13 @@ struct trx_t{
 	read_view_t*	global_read_view;
 					/*!< consistent read view associated
 					to a transaction or NULL */
+	read_view_t*	cached_read_view;
+					/*!< the read view last allocated from
+					global_read_view_heap, or NULL; it is
+					kept after it has been closed, so that
+					the next read view of this trx_t can
+					reuse its memory, and its contents if
+					trx_sys->rw_trx_ids has not changed */
 	read_view_t*	read_view;	/*!< consistent read view used in the
 					transaction or NULL, this read view
 					if defined can be normal read view
@@ -1090,24 +1106,6 @@ struct commit_node_t{
 	mutex_exit(&t->mutex);			\
 } while (0)
 
-/** @brief The latch protecting the adaptive search system
-
-This latch protects the
-(1) hash index;
-(2) columns of a record to which we have a pointer in the hash index;
-
-but does NOT protect:
-
-(3) next record offset field in a record;
-(4) next or previous records on the same page.
-
-Bear in mind (3) and (4) when using the hash index.
-*/
-extern rw_lock_t*	btr_search_latch_temp;
-
-/** The latch protecting the adaptive search system */
-#define btr_search_latch	(*btr_search_latch_temp)
-
 #ifndef UNIV_NONINL
 #include "trx0trx.ic"
 #endif
@@ -48,6 +48,7 @@ Created 5/7/1996 Heikki Tuuri
 #include "ut0vec.h"
 #include "btr0btr.h"
 #include "dict0boot.h"
+#include <algorithm>
 #include <set>
 
 /* Restricts the length of search we will do in the waits-for
@@ -386,6 +387,8 @@ static const ulint	lock_types = UT_ARR_SIZE(lock_compatibility_matrix);
 UNIV_INTERN mysql_pfs_key_t	lock_sys_mutex_key;
 /* Key to register mutex with performance schema */
 UNIV_INTERN mysql_pfs_key_t	lock_sys_wait_mutex_key;
+/* Key to register mutex with performance schema */
+UNIV_INTERN mysql_pfs_key_t	lock_rec_shard_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
 #ifdef UNIV_DEBUG
@@ -611,6 +614,11 @@ lock_sys_create(
 	mutex_create(lock_sys_wait_mutex_key,
 		     &lock_sys->wait_mutex, SYNC_LOCK_WAIT_SYS);
 
+	for (ulint i = 0; i < LOCK_REC_N_SHARDS; i++) {
+		mutex_create(lock_rec_shard_mutex_key,
+			     &lock_sys->rec_mutexes[i], SYNC_LOCK_REC_SHARD);
+	}
+
 	lock_sys->timeout_event = os_event_create();
 
 	lock_sys->rec_hash = hash_create(n_cells);
@@ -638,6 +646,10 @@ lock_sys_close(void)
 	mutex_free(&lock_sys->mutex);
 	mutex_free(&lock_sys->wait_mutex);
 
+	for (ulint i = 0; i < LOCK_REC_N_SHARDS; i++) {
+		mutex_free(&lock_sys->rec_mutexes[i]);
+	}
+
 	mem_free(lock_stack);
 	mem_free(lock_sys);
 
@@ -645,6 +657,75 @@ lock_sys_close(void)
 	lock_stack = NULL;
 }
 
+/*********************************************************************//**
+Acquires all the record lock shard mutexes. The caller must own
+lock_sys->mutex. */
+UNIV_INTERN
+void
+lock_rec_mutex_enter_all(void)
+/*==========================*/
+{
+	ut_ad(lock_mutex_own());
+
+	for (ulint i = 0; i < LOCK_REC_N_SHARDS; i++) {
+		mutex_enter(&lock_sys->rec_mutexes[i]);
+	}
+}
+
+/*********************************************************************//**
+Releases all the record lock shard mutexes. */
+UNIV_INTERN
+void
+lock_rec_mutex_exit_all(void)
+/*=========================*/
+{
+	ut_ad(lock_mutex_own());
+
+	for (ulint i = LOCK_REC_N_SHARDS; i--; ) {
+		mutex_exit(&lock_sys->rec_mutexes[i]);
+	}
+}
+
+/*********************************************************************//**
+Tries to latch the whole lock system without waiting for lock_sys->mutex.
+The record lock shard mutexes are only held for short periods, so they
+are waited for once lock_sys->mutex has been acquired.
+@return	0 if succeeded, like mutex_enter_nowait() */
+UNIV_INTERN
+ulint
+lock_mutex_enter_nowait(void)
+/*=========================*/
+{
+	if (mutex_enter_nowait(&lock_sys->mutex)) {
+		return(1);
+	}
+
+	lock_rec_mutex_enter_all();
+
+	return(0);
+}
+
+#ifdef UNIV_DEBUG
+/*********************************************************************//**
+Checks if the calling thread owns the mutex that protects the queue of a
+lock: the record lock shard mutex of its page for a record lock, or
+lock_sys->mutex for a table lock.
+@return	TRUE if owned */
+static
+ibool
+lock_queue_mutex_own(
+/*=================*/
+	const lock_t*	lock)	/*!< in: lock */
+{
+	if (lock_get_type_low(lock) == LOCK_REC) {
+		return(lock_rec_mutex_own(lock->un_member.rec_lock.space,
+					  lock->un_member.rec_lock.page_no));
+	}
+
+	return(lock_mutex_own());
+}
+#endif /* UNIV_DEBUG */
+
 /*********************************************************************//**
 Gets the size of a lock struct.
 @return	size in bytes */
@@ -787,7 +868,7 @@ lock_is_table_exclusive(
 	ut_ad(table);
 	ut_ad(trx);
 
-	lock_mutex_enter();
+	lock_sys_mutex_enter();
 
 	for (lock = UT_LIST_GET_FIRST(table->locks);
 	     lock != NULL;
@@ -820,7 +901,7 @@ not_ok:
 	}
 
 func_exit:
-	lock_mutex_exit();
+	lock_sys_mutex_exit();
 
 	return(ok);
 }
@@ -837,7 +918,7 @@ lock_set_lock_and_trx_wait(
 	ut_ad(lock);
 	ut_ad(lock->trx == trx);
 	ut_ad(trx->lock.wait_lock == NULL);
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(lock));
 	ut_ad(trx_mutex_own(trx));
 
 	trx->lock.wait_lock = lock;
@@ -855,7 +936,7 @@ lock_reset_lock_and_trx_wait(
 {
 	ut_ad(lock->trx->lock.wait_lock == lock);
 	ut_ad(lock_get_wait(lock));
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(lock));
 
 	lock->trx->lock.wait_lock = NULL;
 	lock->type_mode &= ~LOCK_WAIT;
@@ -1152,7 +1233,7 @@ lock_rec_get_next_on_page_const(
 	ulint	space;
 	ulint	page_no;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(lock));
 	ut_ad(lock_get_type_low(lock) == LOCK_REC);
 
 	space = lock->un_member.rec_lock.space;
@@ -1201,7 +1282,7 @@ lock_rec_get_first_on_page_addr(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(space, page_no));
 
 	for (lock = static_cast<lock_t*>(
 			HASH_GET_FIRST(lock_sys->rec_hash,
@@ -1229,11 +1310,12 @@ lock_rec_expl_exist_on_page(
 	ulint	space,	/*!< in: space id */
 	ulint	page_no)/*!< in: page number */
 {
-	lock_t*	lock;
+	lock_t*		lock;
+	ib_mutex_t*	rec_mutex = lock_rec_get_mutex(space, page_no);
 
-	lock_mutex_enter();
+	mutex_enter(rec_mutex);
 	lock = lock_rec_get_first_on_page_addr(space, page_no);
-	lock_mutex_exit();
+	mutex_exit(rec_mutex);
 
 	return(lock);
 }
@@ -1253,7 +1335,7 @@ lock_rec_get_first_on_page(
 	ulint	space	= buf_block_get_space(block);
 	ulint	page_no	= buf_block_get_page_no(block);
 
-	ut_ad(lock_mutex_own());
+	ut_ad(mutex_own(lock_rec_get_block_mutex(block)));
 
 	hash = buf_block_get_lock_hash_val(block);
 
@@ -1282,7 +1364,7 @@ lock_rec_get_next(
 	ulint	heap_no,/*!< in: heap number of the record */
 	lock_t*	lock)	/*!< in: lock */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(lock));
 
 	do {
 		ut_ad(lock_get_type_low(lock) == LOCK_REC);
@@ -1317,7 +1399,7 @@ lock_rec_get_first(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(mutex_own(lock_rec_get_block_mutex(block)));
 
 	for (lock = lock_rec_get_first_on_page(block); lock;
 	     lock = lock_rec_get_next_on_page(lock)) {
@@ -1387,7 +1469,7 @@ lock_rec_get_prev(
 	ulint	page_no;
 	lock_t*	found_lock	= NULL;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(in_lock));
 	ut_ad(lock_get_type_low(in_lock) == LOCK_REC);
 
 	space = in_lock->un_member.rec_lock.space;
@@ -1484,7 +1566,7 @@ lock_rec_has_expl(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(mutex_own(lock_rec_get_block_mutex(block)));
 	ut_ad((precise_mode & LOCK_MODE_MASK) == LOCK_S
 	      || (precise_mode & LOCK_MODE_MASK) == LOCK_X);
 	ut_ad(!(precise_mode & LOCK_INSERT_INTENTION));
@@ -1538,7 +1620,7 @@ lock_rec_other_has_expl_req(
 {
 	const lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(mutex_own(lock_rec_get_block_mutex(block)));
 	ut_ad(mode == LOCK_X || mode == LOCK_S);
 	ut_ad(gap == 0 || gap == LOCK_GAP);
 	ut_ad(wait == 0 || wait == LOCK_WAIT);
@@ -1582,7 +1664,7 @@ lock_rec_other_has_conflicting(
 	const lock_t*		lock;
 	ibool			is_supremum;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(mutex_own(lock_rec_get_block_mutex(block)));
 
 	is_supremum = (heap_no == PAGE_HEAP_NO_SUPREMUM);
 
@@ -1612,7 +1694,7 @@ lock_rec_find_similar_on_page(
 	lock_t*		lock,		/*!< in: lock_rec_get_first_on_page() */
 	const trx_t*	trx)		/*!< in: transaction */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(!lock || lock_queue_mutex_own(lock));
 
 	for (/* No op */;
 	     lock != NULL;
@@ -1798,7 +1880,7 @@ lock_rec_create(
 	ulint		n_bytes;
 	const page_t*	page;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(mutex_own(lock_rec_get_block_mutex(block)));
 	ut_ad(caller_owns_trx_mutex == trx_mutex_own(trx));
 	ut_ad(dict_index_is_clust(index) || !dict_index_is_online_ddl(index));
 
@@ -1826,6 +1908,15 @@ lock_rec_create(
 	n_bits = page_dir_get_n_heap(page) + LOCK_PAGE_BITMAP_MARGIN;
 	n_bytes = 1 + n_bits / 8;
 
+	/* The lock heap and the lock list of trx may also be modified
+	by a thread that holds the record lock shard mutex of some other
+	page, on behalf of trx; both are protected by trx->mutex. */
+
+	if (!caller_owns_trx_mutex) {
+		trx_mutex_enter(trx);
+	}
+	ut_ad(trx_mutex_own(trx));
+
 	lock = static_cast<lock_t*>(
 		mem_heap_alloc(trx->lock.lock_heap, sizeof(lock_t) + n_bytes));
 
@@ -1846,18 +1937,13 @@ lock_rec_create(
 	/* Set the bit corresponding to rec */
 	lock_rec_set_nth_bit(lock, heap_no);
 
-	index->table->n_rec_locks++;
+	os_atomic_increment_ulint(&index->table->n_rec_locks, 1);
 
 	ut_ad(index->table->n_ref_count > 0 || !index->table->can_be_evicted);
 
 	HASH_INSERT(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), lock);
 
-	if (!caller_owns_trx_mutex) {
-		trx_mutex_enter(trx);
-	}
-	ut_ad(trx_mutex_own(trx));
-
 	if (type_mode & LOCK_WAIT) {
 
 		lock_set_lock_and_trx_wait(lock, trx);
@@ -1869,8 +1955,8 @@ lock_rec_create(
 		trx_mutex_exit(trx);
 	}
 
-	MONITOR_INC(MONITOR_RECLOCK_CREATED);
-	MONITOR_INC(MONITOR_NUM_RECLOCK);
+	MONITOR_ATOMIC_INC(MONITOR_RECLOCK_CREATED);
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK);
 
 	return(lock);
 }
@@ -2024,7 +2110,7 @@ lock_rec_add_to_queue(
 	lock_t*	lock;
 	lock_t*	first_lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(mutex_own(lock_rec_get_block_mutex(block)));
 	ut_ad(caller_owns_trx_mutex == trx_mutex_own(trx));
 	ut_ad(dict_index_is_clust(index) || !dict_index_is_online_ddl(index));
 #ifdef UNIV_DEBUG
@@ -2138,7 +2224,7 @@ lock_rec_lock_fast(
 	trx_t*			trx;
 	enum lock_rec_req_status status = LOCK_REC_SUCCESS;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(mutex_own(lock_rec_get_block_mutex(block)));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2211,12 +2297,20 @@ lock_rec_lock_slow(
 					the record */
 	ulint			heap_no,/*!< in: heap number of record */
 	dict_index_t*		index,	/*!< in: index of record */
-	que_thr_t*		thr)	/*!< in: query thread */
+	que_thr_t*		thr,	/*!< in: query thread */
+	ibool			may_wait)/*!< in: TRUE if the caller has
+					latched the whole lock system, so
+					that a waiting request can be
+					enqueued; FALSE if it only holds
+					the record lock shard mutex of the
+					page, in which case DB_LOCK_WAIT is
+					returned without enqueueing
+					anything */
 {
 	trx_t*			trx;
 	dberr_t			err = DB_SUCCESS;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(mutex_own(lock_rec_get_block_mutex(block)));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2247,8 +2341,10 @@ lock_rec_lock_slow(
 		have a lock strong enough already granted on the
 		record, we have to wait. */
 
-		err = lock_rec_enqueue_waiting(
-			mode, block, heap_no, index, thr);
+		err = may_wait
+			? lock_rec_enqueue_waiting(
+				mode, block, heap_no, index, thr)
+			: DB_LOCK_WAIT;
 
 	} else if (!impl) {
 		/* Set the requested lock on the record, note that
@@ -2288,9 +2384,12 @@ lock_rec_lock(
 					the record */
 	ulint			heap_no,/*!< in: heap number of record */
 	dict_index_t*		index,	/*!< in: index of record */
-	que_thr_t*		thr)	/*!< in: query thread */
+	que_thr_t*		thr,	/*!< in: query thread */
+	ibool			may_wait)/*!< in: FALSE if the caller only
+					holds the record lock shard mutex;
+					see lock_rec_lock_slow() */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(mutex_own(lock_rec_get_block_mutex(block)));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2311,13 +2410,65 @@ lock_rec_lock(
 		return(DB_SUCCESS_LOCKED_REC);
 	case LOCK_REC_FAIL:
 		return(lock_rec_lock_slow(impl, mode, block,
-					  heap_no, index, thr));
+					  heap_no, index, thr, may_wait));
 	}
 
 	ut_error;
 	return(DB_ERROR);
 }
 
+/*********************************************************************//**
+Tries to lock the specified record in the mode requested, holding only the
+record lock shard mutex of the page. Only if the request has to wait is it
+retried after latching the whole lock system, because enqueueing a waiting
+request involves a deadlock check across all the lock queues.
+@return	DB_SUCCESS, DB_SUCCESS_LOCKED_REC, DB_LOCK_WAIT, DB_DEADLOCK,
+or DB_QUE_THR_SUSPENDED */
+static
+dberr_t
+lock_rec_lock_sharded(
+/*==================*/
+	ibool			impl,	/*!< in: if TRUE, no lock is set
+					if no wait is necessary: we
+					assume that the caller will
+					set an implicit lock */
+	ulint			mode,	/*!< in: lock mode: LOCK_X or
+					LOCK_S possibly ORed to either
+					LOCK_GAP or LOCK_REC_NOT_GAP */
+	const buf_block_t*	block,	/*!< in: buffer block containing
+					the record */
+	ulint			heap_no,/*!< in: heap number of record */
+	dict_index_t*		index,	/*!< in: index of record */
+	que_thr_t*		thr)	/*!< in: query thread */
+{
+	ib_mutex_t*	rec_mutex = lock_rec_get_block_mutex(block);
+	dberr_t		err;
+
+	ut_ad(!lock_mutex_own());
+
+	mutex_enter(rec_mutex);
+
+	err = lock_rec_lock(impl, mode, block, heap_no, index, thr, FALSE);
+
+	mutex_exit(rec_mutex);
+
+	if (err == DB_LOCK_WAIT) {
+		/* Nothing was enqueued. The queue may have changed
+		while no mutex was held, so start over. */
+
+		lock_mutex_enter();
+
+		err = lock_rec_lock(
+			impl, mode, block, heap_no, index, thr, TRUE);
+
+		lock_mutex_exit();
+	}
+
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
+
+	return(err);
+}
+
 /*********************************************************************//**
 Checks if a waiting record lock request still has to wait in a queue.
 @return	lock that is causing the wait */
@@ -2334,7 +2485,7 @@ lock_rec_has_to_wait_in_queue(
 	ulint		bit_mask;
 	ulint		bit_offset;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(wait_lock));
 	ut_ad(lock_get_wait(wait_lock));
 	ut_ad(lock_get_type_low(wait_lock) == LOCK_REC);
 
@@ -2371,7 +2522,7 @@ lock_grant(
 /*=======*/
 	lock_t*	lock)	/*!< in/out: waiting lock request */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(lock));
 
 	lock_reset_lock_and_trx_wait(lock);
 
@@ -2428,7 +2579,7 @@ lock_rec_cancel(
 {
 	que_thr_t*	thr;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(lock));
 	ut_ad(lock_get_type_low(lock) == LOCK_REC);
 
 	/* Reset the bit (there can be only one set bit) in the lock bitmap */
@@ -2451,6 +2602,168 @@ lock_rec_cancel(
 	trx_mutex_exit(lock->trx);
 }
 
+/*********************************************************************//**
+Checks if a waiting record lock request conflicts with a granted lock on
+the same record. Unlike lock_rec_has_to_wait_in_queue(), this ignores the
+waiting requests ahead in the queue.
+@return	TRUE if a granted lock blocks the request */
+static
+ibool
+lock_rec_has_to_wait_for_granted(
+/*=============================*/
+	const lock_t*	wait_lock)	/*!< in: waiting record lock */
+{
+	const lock_t*	lock;
+	ulint		heap_no;
+
+	ut_ad(lock_queue_mutex_own(wait_lock));
+	ut_ad(lock_get_wait(wait_lock));
+
+	heap_no = lock_rec_find_set_bit(wait_lock);
+
+	for (lock = lock_rec_get_first_on_page_addr(
+			wait_lock->un_member.rec_lock.space,
+			wait_lock->un_member.rec_lock.page_no);
+	     lock != NULL;
+	     lock = lock_rec_get_next_on_page_const(lock)) {
+
+		if (!lock_get_wait(lock)
+		    && lock_rec_get_nth_bit(lock, heap_no)
+		    && lock_has_to_wait(wait_lock, lock)) {
+
+			return(TRUE);
+		}
+	}
+
+	return(FALSE);
+}
+
+/*********************************************************************//**
+Checks if a waiting record lock request should be granted before another
+one, according to innodb_lock_schedule_algorithm.
+@return	true if a goes first */
+static
+bool
+lock_rec_grant_before(
+/*==================*/
+	const lock_t*	a,	/*!< in: waiting record lock */
+	const lock_t*	b)	/*!< in: waiting record lock */
+{
+	switch (srv_lock_schedule_algorithm) {
+	case SRV_LOCK_SCHEDULE_OLDEST:
+		/* Transaction identifiers are assigned when a
+		transaction starts. */
+		return(a->trx->id < b->trx->id);
+	case SRV_LOCK_SCHEDULE_MOST_LOCKS:
+		/* The lock list of another transaction may change
+		under us; a slightly stale length is good enough
+		here. */
+		return(UT_LIST_GET_LEN(a->trx->lock.trx_locks)
+		       > UT_LIST_GET_LEN(b->trx->lock.trx_locks));
+	}
+
+	return(false);
+}
+
+/*********************************************************************//**
+Moves a record lock to the head of its hash chain, which puts it ahead of
+all other locks on the same page. */
+static
+void
+lock_rec_move_to_front(
+/*===================*/
+	lock_t*	lock)	/*!< in/out: record lock */
+{
+	hash_cell_t*	cell;
+	ulint		fold;
+
+	ut_ad(lock_queue_mutex_own(lock));
+
+	fold = lock_rec_fold(lock->un_member.rec_lock.space,
+			     lock->un_member.rec_lock.page_no);
+
+	HASH_DELETE(lock_t, hash, lock_sys->rec_hash, fold, lock);
+
+	cell = hash_get_nth_cell(lock_sys->rec_hash,
+				 hash_calc_hash(fold, lock_sys->rec_hash));
+
+	lock->hash = static_cast<lock_t*>(cell->node);
+	cell->node = lock;
+}
+
+/*********************************************************************//**
+Grants the waiting record lock requests on a page that no longer have to
+wait. With innodb_lock_schedule_algorithm=FCFS a request is granted if no
+conflicting lock, granted or waiting, is ahead of it in the queue.
+Otherwise, among the requests that do not conflict with a granted lock,
+the preferred one is granted and moved to the head of the queue, ahead of
+the requests that it now blocks, and this is repeated until no more
+requests can be granted. */
+static
+void
+lock_rec_grant_waiting(
+/*===================*/
+	ulint	space,		/*!< in: space id */
+	ulint	page_no,	/*!< in: page number */
+	ulint	heap_no)	/*!< in: heap number of the record whose
+				requests to check, or ULINT_UNDEFINED
+				for all records on the page */
+{
+	lock_t*	lock;
+
+	ut_ad(lock_rec_mutex_own(space, page_no));
+
+	if (srv_lock_schedule_algorithm == SRV_LOCK_SCHEDULE_FCFS) {
+
+		for (lock = lock_rec_get_first_on_page_addr(space, page_no);
+		     lock != NULL;
+		     lock = lock_rec_get_next_on_page(lock)) {
+
+			if (lock_get_wait(lock)
+			    && (heap_no == ULINT_UNDEFINED
+				|| lock_rec_get_nth_bit(lock, heap_no))
+			    && !lock_rec_has_to_wait_in_queue(lock)) {
+
+				lock_grant(lock);
+			}
+		}
+
+		return;
+	}
+
+	for (;;) {
+		lock_t*	best = NULL;
+
+		for (lock = lock_rec_get_first_on_page_addr(space, page_no);
+		     lock != NULL;
+		     lock = lock_rec_get_next_on_page(lock)) {
+
+			if (lock_get_wait(lock)
+			    && (heap_no == ULINT_UNDEFINED
+				|| lock_rec_get_nth_bit(lock, heap_no))
+			    && (best == NULL
+				|| lock_rec_grant_before(lock, best))
+			    && !lock_rec_has_to_wait_for_granted(lock)) {
+
+				best = lock;
+			}
+		}
+
+		if (best == NULL) {
+			return;
+		}
+
+		/* Waiting requests that conflict with best must now
+		find it ahead of them in the queue. Granted locks are
+		compatible with each other, so their order does not
+		matter. */
+
+		lock_rec_move_to_front(best);
+
+		lock_grant(best);
+	}
+}
+
 /*************************************************************//**
 Removes a record lock request, waiting or granted, from the queue and
 grants locks to other transactions in the queue if they now are entitled
@@ -2468,10 +2781,9 @@ lock_rec_dequeue_from_page(
 {
 	ulint		space;
 	ulint		page_no;
-	lock_t*		lock;
 	trx_lock_t*	trx_lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(in_lock));
 	ut_ad(lock_get_type_low(in_lock) == LOCK_REC);
 	/* We may or may not be holding in_lock->trx->mutex here. */
 
@@ -2480,32 +2792,19 @@ lock_rec_dequeue_from_page(
 	space = in_lock->un_member.rec_lock.space;
 	page_no = in_lock->un_member.rec_lock.page_no;
 
-	in_lock->index->table->n_rec_locks--;
+	os_atomic_decrement_ulint(&in_lock->index->table->n_rec_locks, 1);
 
 	HASH_DELETE(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), in_lock);
 
 	UT_LIST_REMOVE(trx_locks, trx_lock->trx_locks, in_lock);
 
-	MONITOR_INC(MONITOR_RECLOCK_REMOVED);
-	MONITOR_DEC(MONITOR_NUM_RECLOCK);
-
-	/* Check if waiting locks in the queue can now be granted: grant
-	locks if there are no conflicting locks ahead. Stop at the first
-	X lock that is waiting or has been granted. */
-
-	for (lock = lock_rec_get_first_on_page_addr(space, page_no);
-	     lock != NULL;
-	     lock = lock_rec_get_next_on_page(lock)) {
+	MONITOR_ATOMIC_INC(MONITOR_RECLOCK_REMOVED);
+	MONITOR_ATOMIC_DEC(MONITOR_NUM_RECLOCK);
 
-		if (lock_get_wait(lock)
-		    && !lock_rec_has_to_wait_in_queue(lock)) {
+	/* Check if waiting locks in the queue can now be granted. */
 
-			/* Grant the lock */
-			ut_ad(lock->trx != in_lock->trx);
-			lock_grant(lock);
-		}
-	}
+	lock_rec_grant_waiting(space, page_no, ULINT_UNDEFINED);
 }
 
 /*************************************************************//**
@@ -2530,15 +2829,15 @@ lock_rec_discard(
 	space = in_lock->un_member.rec_lock.space;
 	page_no = in_lock->un_member.rec_lock.page_no;
 
-	in_lock->index->table->n_rec_locks--;
+	os_atomic_decrement_ulint(&in_lock->index->table->n_rec_locks, 1);
 
 	HASH_DELETE(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), in_lock);
 
 	UT_LIST_REMOVE(trx_locks, trx_lock->trx_locks, in_lock);
 
-	MONITOR_INC(MONITOR_RECLOCK_REMOVED);
-	MONITOR_DEC(MONITOR_NUM_RECLOCK);
+	MONITOR_ATOMIC_INC(MONITOR_RECLOCK_REMOVED);
+	MONITOR_ATOMIC_DEC(MONITOR_NUM_RECLOCK);
 }
 
 /*************************************************************//**
@@ -2590,7 +2889,7 @@ lock_rec_reset_and_release_wait(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(mutex_own(lock_rec_get_block_mutex(block)));
 
 	for (lock = lock_rec_get_first(block, heap_no);
 	     lock != NULL;
@@ -2626,7 +2925,8 @@ lock_rec_inherit_to_gap(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(mutex_own(lock_rec_get_block_mutex(heir_block)));
+	ut_ad(mutex_own(lock_rec_get_block_mutex(block)));
 
 	/* If srv_locks_unsafe_for_binlog is TRUE or session is using
 	READ COMMITTED isolation level, we do not want locks set
@@ -2668,9 +2968,15 @@ lock_rec_inherit_to_gap_if_gap_lock(
 						does NOT reset the locks
 						on this record */
 {
-	lock_t*	lock;
+	lock_t*		lock;
+	ib_mutex_t*	rec_mutex = lock_rec_get_block_mutex(block);
 
-	lock_mutex_enter();
+	/* The inherited locks belong to other transactions, so
+	lock_sys->mutex is needed in addition to the record lock
+	shard mutex of the page. */
+
+	lock_sys_mutex_enter();
+	mutex_enter(rec_mutex);
 
 	for (lock = lock_rec_get_first(block, heap_no);
 	     lock != NULL;
@@ -2687,7 +2993,8 @@ lock_rec_inherit_to_gap_if_gap_lock(
 		}
 	}
 
-	lock_mutex_exit();
+	mutex_exit(rec_mutex);
+	lock_sys_mutex_exit();
 }
 
 /*************************************************************//**
@@ -3400,6 +3707,7 @@ lock_update_delete(
 	const page_t*	page = block->frame;
 	ulint		heap_no;
 	ulint		next_heap_no;
+	ib_mutex_t*	rec_mutex;
 
 	ut_ad(page == page_align(rec));
 
@@ -3415,7 +3723,23 @@ lock_update_delete(
 								       FALSE));
 	}
 
-	lock_mutex_enter();
+	rec_mutex = lock_rec_get_block_mutex(block);
+
+	/* Purge and rollback remove records from pages that usually
+	carry no locks at all. The caller holds an x-latch on the page,
+	so no locks can be created on it until we return. */
+
+	mutex_enter(rec_mutex);
+
+	if (!lock_rec_get_first_on_page(block)) {
+		mutex_exit(rec_mutex);
+		return;
+	}
+
+	mutex_exit(rec_mutex);
+
+	lock_sys_mutex_enter();
+	mutex_enter(rec_mutex);
 
 	/* Let the next record inherit the locks from rec, in gap mode */
 
@@ -3425,7 +3749,8 @@ lock_update_delete(
 
 	lock_rec_reset_and_release_wait(block, heap_no);
 
-	lock_mutex_exit();
+	mutex_exit(rec_mutex);
+	lock_sys_mutex_exit();
 }
 
 /*********************************************************************//**
@@ -3446,15 +3771,18 @@ lock_rec_store_on_page_infimum(
 					bits are reset on the
 					record */
 {
-	ulint	heap_no = page_rec_get_heap_no(rec);
+	ulint		heap_no = page_rec_get_heap_no(rec);
+	ib_mutex_t*	rec_mutex = lock_rec_get_block_mutex(block);
 
 	ut_ad(block->frame == page_align(rec));
 
-	lock_mutex_enter();
+	lock_sys_mutex_enter();
+	mutex_enter(rec_mutex);
 
 	lock_rec_move(block, block, PAGE_HEAP_NO_INFIMUM, heap_no);
 
-	lock_mutex_exit();
+	mutex_exit(rec_mutex);
+	lock_sys_mutex_exit();
 }
 
 /*********************************************************************//**
@@ -3986,6 +4314,15 @@ lock_deadlock_check_and_resolve(
 	ut_ad(lock_mutex_own());
 	assert_trx_in_list(trx);
 
+	if (srv_deadlock_detect != SRV_DEADLOCK_DETECT_ON) {
+		/* Deadlocks are broken by the lock timeout thread,
+		either by lock_deadlock_check_background() or by
+		innodb_lock_wait_timeout. */
+		return(0);
+	}
+
+	ullint	start_time = ut_time_us(NULL);
+
 	/* Try and resolve as many deadlocks as possible. */
 	do {
 		lock_deadlock_ctx_t	ctx;
@@ -4000,6 +4337,9 @@ lock_deadlock_check_and_resolve(
 
 		victim_trx_id = lock_deadlock_search(&ctx);
 
+		MONITOR_INC(MONITOR_DEADLOCK_SEARCH);
+		MONITOR_INC_VALUE(MONITOR_DEADLOCK_SEARCH_STEPS, ctx.cost);
+
 		/* Search too deep, we rollback the joining transaction. */
 		if (ctx.too_deep) {
 
@@ -4024,6 +4364,9 @@ lock_deadlock_check_and_resolve(
 
 	} while (victim_trx_id != 0 && victim_trx_id != trx->id);
 
+	MONITOR_INC_VALUE(MONITOR_DEADLOCK_SEARCH_TIME,
+			  ut_time_us(NULL) - start_time);
+
 	/* If the joining transaction was selected as the victim. */
 	if (victim_trx_id != 0) {
 		ut_a(victim_trx_id == trx->id);
@@ -4036,11 +4379,588 @@ lock_deadlock_check_and_resolve(
 	return(victim_trx_id);
 }
 
-/*========================= TABLE LOCKS ==============================*/
+/*=============== BACKGROUND DEADLOCK CHECKING =======================*/
+
+/** DFS colours of a node of the waits-for graph snapshot */
+enum lock_wfg_state_t {
+	LOCK_WFG_NEW,		/*!< not visited yet */
+	LOCK_WFG_ACTIVE,	/*!< on the DFS stack */
+	LOCK_WFG_DONE,		/*!< visited; not part of any cycle */
+	LOCK_WFG_REMOVED	/*!< rolled back, or removed from the
+				graph because its edges had changed */
+};
+
+/** A transaction suspended in a lock wait, as a node of a snapshot of
+the waits-for graph */
+struct lock_wfg_node_t {
+	trx_t*		trx;		/*!< waiting transaction */
+	const lock_t*	wait_lock;	/*!< lock that trx is waiting for,
+					when the snapshot was taken */
+	trx_id_t	trx_id;		/*!< trx->id */
+	ib_time_t	wait_started;	/*!< trx->lock.wait_started */
+	ulint		first_edge;	/*!< position of the first outgoing
+					edge in lock_wfg_t::edges */
+	ulint		n_edges;	/*!< number of outgoing edges */
+	ulint		next_edge;	/*!< next edge to follow in DFS */
+	ulint		stack_pos;	/*!< position on the DFS stack */
+	lock_wfg_state_t state;		/*!< DFS state */
+};
+
+/** An edge of a snapshot of the waits-for graph */
+struct lock_wfg_edge_t {
+	const trx_t*	blocker;	/*!< blocking transaction; may only
+					be dereferenced if to is defined */
+	trx_id_t	blocker_id;	/*!< blocker->id */
+	ulint		to;		/*!< the node of blocker, or
+					ULINT_UNDEFINED if blocker is not
+					suspended in a lock wait */
+};
+
+/** A snapshot of the waits-for graph. The graph only contains the
+transactions that are suspended in a lock wait: they cannot commit or go
+away while the lock wait mutex is held, so the graph can be searched
+without holding lock_sys->mutex. */
+struct lock_wfg_t {
+	lock_wfg_node_t*	nodes;		/*!< waiting transactions,
+						sorted by trx */
+	ulint			n_nodes;	/*!< number of nodes */
+	ib_vector_t*		edges;		/*!< lock_wfg_edge_t, grouped
+						by the waiting node */
+	ulint*			stack;		/*!< DFS stack */
+};
 
 /*********************************************************************//**
-Creates a table lock object and adds it as the last in the lock queue
-of the table. Does NOT check for deadlocks or lock compatibility.
+Gets the next lock ahead of a waiting lock in its queue that the waiting
+lock has to wait for.
+@return next conflicting lock, or NULL */
+static
+const lock_t*
+lock_wfg_get_next_blocker(
+/*======================*/
+	const lock_t*	wait_lock,	/*!< in: waiting lock */
+	const lock_t*	lock)		/*!< in: lock returned by the previous
+					call, or NULL to start from the head
+					of the queue */
+{
+	ut_ad(lock_mutex_own());
+	ut_ad(lock_get_wait(wait_lock));
+
+	if (lock_get_type_low(wait_lock) == LOCK_REC) {
+		ulint	heap_no = lock_rec_find_set_bit(wait_lock);
+
+		lock = lock == NULL
+			? lock_rec_get_first_on_page_addr(
+				wait_lock->un_member.rec_lock.space,
+				wait_lock->un_member.rec_lock.page_no)
+			: lock_rec_get_next_on_page_const(lock);
+
+		for (; lock != wait_lock;
+		     lock = lock_rec_get_next_on_page_const(lock)) {
+
+			if (lock_rec_get_nth_bit(lock, heap_no)
+			    && lock_has_to_wait(wait_lock, lock)) {
+
+				return(lock);
+			}
+		}
+	} else {
+		ut_ad(lock_get_type_low(wait_lock) == LOCK_TABLE);
+
+		lock = lock == NULL
+			? UT_LIST_GET_FIRST(
+				wait_lock->un_member.tab_lock.table->locks)
+			: UT_LIST_GET_NEXT(un_member.tab_lock.locks, lock);
+
+		for (; lock != wait_lock;
+		     lock = UT_LIST_GET_NEXT(un_member.tab_lock.locks, lock)) {
+
+			if (lock_has_to_wait(wait_lock, lock)) {
+
+				return(lock);
+			}
+		}
+	}
+
+	return(NULL);
+}
+
+/*********************************************************************//**
+Compares two nodes of the waits-for graph by transaction.
+@return true if a sorts before b */
+static
+bool
+lock_wfg_node_less(
+/*===============*/
+	const lock_wfg_node_t&	a,	/*!< in: node */
+	const lock_wfg_node_t&	b)	/*!< in: node */
+{
+	return(a.trx < b.trx);
+}
+
+/*********************************************************************//**
+Looks up the node of a transaction in the waits-for graph.
+@return node number, or ULINT_UNDEFINED if trx is not waiting */
+static
+ulint
+lock_wfg_find(
+/*==========*/
+	const lock_wfg_t*	graph,	/*!< in: waits-for graph */
+	const trx_t*		trx)	/*!< in: transaction */
+{
+	lock_wfg_node_t		key;
+	lock_wfg_node_t*	end = graph->nodes + graph->n_nodes;
+	lock_wfg_node_t*	node;
+
+	key.trx = const_cast<trx_t*>(trx);
+
+	node = std::lower_bound(graph->nodes, end, key, lock_wfg_node_less);
+
+	return(node != end && node->trx == trx
+	       ? ulint(node - graph->nodes) : ULINT_UNDEFINED);
+}
+
+/*********************************************************************//**
+Takes a snapshot of the waits-for graph of the transactions that are
+suspended in a lock wait. Latches the whole lock system while doing so.
+@return	number of edges visited */
+static
+ulint
+lock_wfg_build(
+/*===========*/
+	lock_wfg_t*	graph,	/*!< out: waits-for graph */
+	mem_heap_t*	heap)	/*!< in: memory heap for graph */
+{
+	const srv_slot_t*	slot;
+	ulint			n_slots;
+	ulint			n_steps = 0;
+
+	ut_ad(lock_wait_mutex_own());
+
+	n_slots = lock_sys->last_slot - lock_sys->waiting_threads;
+
+	graph->nodes = static_cast<lock_wfg_node_t*>(
+		mem_heap_zalloc(heap, (n_slots + 1) * sizeof *graph->nodes));
+	graph->stack = static_cast<ulint*>(
+		mem_heap_alloc(heap, (n_slots + 1) * sizeof *graph->stack));
+	graph->edges = ib_vector_create(
+		ib_heap_allocator_create(heap), sizeof(lock_wfg_edge_t),
+		n_slots + 1);
+	graph->n_nodes = 0;
+
+	lock_mutex_enter();
+
+	/* The slots cannot be freed or reserved without the lock wait
+	mutex, and a transaction cannot commit while it is waiting. */
+
+	for (slot = lock_sys->waiting_threads;
+	     slot < lock_sys->last_slot;
+	     ++slot) {
+
+		if (!slot->in_use) {
+			continue;
+		}
+
+		trx_t*	trx = thr_get_trx(slot->thr);
+
+		if (trx->lock.wait_lock != NULL) {
+			lock_wfg_node_t*	node;
+
+			node = &graph->nodes[graph->n_nodes++];
+
+			node->trx = trx;
+			node->wait_lock = trx->lock.wait_lock;
+			node->trx_id = trx->id;
+			node->wait_started = trx->lock.wait_started;
+		}
+	}
+
+	std::sort(graph->nodes, graph->nodes + graph->n_nodes,
+		  lock_wfg_node_less);
+
+	for (ulint i = 0; i < graph->n_nodes; ++i) {
+		lock_wfg_node_t*	node = &graph->nodes[i];
+		const lock_t*		lock = NULL;
+
+		node->first_edge = ib_vector_size(graph->edges);
+
+		while ((lock = lock_wfg_get_next_blocker(
+				node->wait_lock, lock)) != NULL) {
+
+			lock_wfg_edge_t	edge;
+			ulint		j;
+
+			++n_steps;
+
+			/* A transaction can hold several conflicting
+			locks ahead of us; record it only once. */
+
+			for (j = node->first_edge;
+			     j < ib_vector_size(graph->edges);
+			     ++j) {
+
+				const lock_wfg_edge_t*	prev;
+
+				prev = static_cast<const lock_wfg_edge_t*>(
+					ib_vector_get(graph->edges, j));
+
+				if (prev->blocker == lock->trx) {
+					break;
+				}
+			}
+
+			if (j < ib_vector_size(graph->edges)) {
+				continue;
+			}
+
+			edge.blocker = lock->trx;
+			edge.blocker_id = lock->trx->id;
+			edge.to = lock_wfg_find(graph, lock->trx);
+
+			ib_vector_push(graph->edges, &edge);
+		}
+
+		node->n_edges = ib_vector_size(graph->edges)
+			- node->first_edge;
+	}
+
+	lock_mutex_exit();
+
+	return(n_steps);
+}
+
+/*********************************************************************//**
+Gets an outgoing edge of a node of the waits-for graph.
+@return edge */
+static
+const lock_wfg_edge_t*
+lock_wfg_get_edge(
+/*==============*/
+	const lock_wfg_t*	graph,	/*!< in: waits-for graph */
+	const lock_wfg_node_t*	node,	/*!< in: node */
+	ulint			i)	/*!< in: edge number, < n_edges */
+{
+	ut_ad(i < node->n_edges);
+
+	return(static_cast<const lock_wfg_edge_t*>(
+		ib_vector_get(graph->edges, node->first_edge + i)));
+}
+
+/*********************************************************************//**
+Looks for a cycle among the nodes of the waits-for graph that have not
+been removed. Uses an explicit stack, so the cost is bounded by the size
+of the graph and not by the thread stack.
+@return number of nodes in the cycle, stored in graph->stack[0..n-1],
+or 0 if there is no cycle */
+static
+ulint
+lock_wfg_find_cycle(
+/*================*/
+	lock_wfg_t*	graph,	/*!< in/out: waits-for graph */
+	ulint*		n_steps)/*!< in/out: number of edges visited */
+{
+	lock_wfg_node_t*	nodes = graph->nodes;
+
+	for (ulint i = 0; i < graph->n_nodes; ++i) {
+		if (nodes[i].state != LOCK_WFG_REMOVED) {
+			nodes[i].state = LOCK_WFG_NEW;
+			nodes[i].next_edge = 0;
+		}
+	}
+
+	for (ulint root = 0; root < graph->n_nodes; ++root) {
+		ulint	depth = 0;
+
+		if (nodes[root].state != LOCK_WFG_NEW) {
+			continue;
+		}
+
+		nodes[root].state = LOCK_WFG_ACTIVE;
+		nodes[root].stack_pos = depth;
+		graph->stack[depth++] = root;
+
+		while (depth > 0) {
+			lock_wfg_node_t*	node;
+			ulint			to;
+
+			node = &nodes[graph->stack[depth - 1]];
+
+			if (node->next_edge == node->n_edges) {
+				node->state = LOCK_WFG_DONE;
+				--depth;
+				continue;
+			}
+
+			++*n_steps;
+
+			to = lock_wfg_get_edge(
+				graph, node, node->next_edge++)->to;
+
+			if (to == ULINT_UNDEFINED) {
+				/* The blocker is running. */
+				continue;
+			}
+
+			switch (nodes[to].state) {
+			case LOCK_WFG_NEW:
+				nodes[to].state = LOCK_WFG_ACTIVE;
+				nodes[to].stack_pos = depth;
+				graph->stack[depth++] = to;
+				break;
+			case LOCK_WFG_ACTIVE:
+				/* Found a cycle: move it to the bottom
+				of the stack. */
+				depth -= nodes[to].stack_pos;
+
+				memmove(graph->stack,
+					graph->stack + nodes[to].stack_pos,
+					depth * sizeof *graph->stack);
+
+				return(depth);
+			case LOCK_WFG_DONE:
+			case LOCK_WFG_REMOVED:
+				break;
+			}
+		}
+	}
+
+	return(0);
+}
+
+/*********************************************************************//**
+Checks if a transaction still waits for another one.
+@return true if the edge still exists */
+static
+bool
+lock_wfg_edge_exists(
+/*=================*/
+	const lock_wfg_node_t*	from,	/*!< in: waiting transaction */
+	const trx_t*		to)	/*!< in: blocking transaction */
+{
+	const lock_t*	lock = NULL;
+
+	ut_ad(lock_mutex_own());
+
+	if (from->trx->lock.wait_lock != from->wait_lock) {
+		return(false);
+	}
+
+	while ((lock = lock_wfg_get_next_blocker(from->wait_lock, lock))
+	       != NULL) {
+
+		if (lock->trx == to) {
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/*********************************************************************//**
+Resolves a deadlock that was found in the waits-for graph by rolling back
+the transaction in the cycle that has modified the fewest rows. The cycle
+is verified against the current lock queues first, because the graph is
+a snapshot.
+@return node of the victim, or ULINT_UNDEFINED if the cycle no longer
+exists */
+static
+ulint
+lock_wfg_resolve_cycle(
+/*===================*/
+	lock_wfg_t*	graph,		/*!< in: waits-for graph */
+	ulint		n)		/*!< in: number of nodes in the cycle
+					on graph->stack */
+{
+	const ulint*	cycle = graph->stack;
+	ulint		victim = cycle[0];
+	char		buf[64];
+
+	lock_mutex_enter();
+
+	for (ulint i = 0; i < n; ++i) {
+		const lock_wfg_node_t*	node = &graph->nodes[cycle[i]];
+		const lock_wfg_node_t*	next;
+
+		next = &graph->nodes[cycle[(i + 1) % n]];
+
+		if (!lock_wfg_edge_exists(node, next->trx)) {
+			lock_mutex_exit();
+			return(ULINT_UNDEFINED);
+		}
+
+		if (!trx_weight_ge(node->trx, graph->nodes[victim].trx)) {
+			victim = cycle[i];
+		}
+	}
+
+	if (!srv_read_only_mode) {
+		ulint	victim_pos = 0;
+
+		lock_deadlock_start_print();
+
+		lock_deadlock_fputs("\n");
+
+		for (ulint i = 0; i < n; ++i) {
+			const trx_t*	trx = graph->nodes[cycle[i]].trx;
+
+			if (cycle[i] == victim) {
+				victim_pos = i;
+			}
+
+			ut_snprintf(buf, sizeof buf,
+				    "*** (%lu) TRANSACTION:\n", i + 1);
+			lock_deadlock_fputs(buf);
+
+			lock_deadlock_trx_print(trx, 3000);
+
+			ut_snprintf(buf, sizeof buf,
+				    "*** (%lu) WAITING FOR THIS LOCK"
+				    " TO BE GRANTED:\n", i + 1);
+			lock_deadlock_fputs(buf);
+
+			lock_deadlock_lock_print(trx->lock.wait_lock);
+		}
+
+		ut_snprintf(buf, sizeof buf,
+			    "*** WE ROLL BACK TRANSACTION (%lu)\n",
+			    victim_pos + 1);
+		lock_deadlock_fputs(buf);
+	}
+
+	trx_t*	trx = graph->nodes[victim].trx;
+
+	trx_mutex_enter(trx);
+
+	trx->lock.was_chosen_as_deadlock_victim = TRUE;
+
+	lock_cancel_waiting_and_release(trx->lock.wait_lock);
+
+	trx_mutex_exit(trx);
+
+	lock_deadlock_found = TRUE;
+
+	MONITOR_INC(MONITOR_DEADLOCK);
+
+	lock_mutex_exit();
+
+	return(victim);
+}
+
+/*********************************************************************//**
+Looks for deadlocks in a snapshot of the waits-for graph of the
+transactions that are suspended in a lock wait, and rolls back a victim of
+each deadlock that is found. This is used when innodb_deadlock_detect is
+BACKGROUND. The caller must hold lock_sys->wait_mutex, which keeps the
+waiting transactions from going away. */
+UNIV_INTERN
+void
+lock_deadlock_check_background(void)
+/*================================*/
+{
+	lock_wfg_t	graph;
+	mem_heap_t*	heap;
+	ulint		n_steps;
+	ullint		start_time;
+	ullint		locked_time;
+
+	ut_ad(lock_wait_mutex_own());
+
+	heap = mem_heap_create(1024);
+
+	start_time = ut_time_us(NULL);
+
+	n_steps = lock_wfg_build(&graph, heap);
+
+	locked_time = ut_time_us(NULL) - start_time;
+
+	/* A transaction that was granted its lock or rolled back after
+	the snapshot was taken only makes the graph stale: a cycle is
+	verified under lock_sys->mutex before it is broken. Transactions
+	that enqueue a wait after the snapshot was taken will be looked
+	at in the next round. */
+
+	for (ulint i = 0; i < graph.n_nodes; ++i) {
+		ulint	n = lock_wfg_find_cycle(&graph, &n_steps);
+		ulint	victim;
+
+		if (n == 0) {
+			break;
+		}
+
+		start_time = ut_time_us(NULL);
+
+		victim = lock_wfg_resolve_cycle(&graph, n);
+
+		locked_time += ut_time_us(NULL) - start_time;
+
+		/* Remove a node to ensure that the next search makes
+		progress. If the cycle is gone, its first node will be
+		looked at again in the next round. */
+
+		graph.nodes[victim == ULINT_UNDEFINED
+			    ? graph.stack[0] : victim].state
+			= LOCK_WFG_REMOVED;
+	}
+
+	MONITOR_INC(MONITOR_DEADLOCK_SEARCH);
+	MONITOR_INC_VALUE(MONITOR_DEADLOCK_SEARCH_STEPS, n_steps);
+	MONITOR_INC_VALUE(MONITOR_DEADLOCK_SEARCH_TIME, locked_time);
+
+	mem_heap_free(heap);
+}
+
+/*********************************************************************//**
+Takes a snapshot of the waits-for graph of the transactions that are
+suspended in a lock wait, for INFORMATION_SCHEMA.INNODB_LOCK_WAIT_GRAPH.
+@return	number of edges stored in *edges */
+UNIV_INTERN
+ulint
+lock_wait_graph_get(
+/*================*/
+	mem_heap_t*		heap,	/*!< in: memory heap for *edges */
+	lock_wait_edge_t**	edges)	/*!< out: edges of the graph */
+{
+	lock_wfg_t	graph;
+	mem_heap_t*	graph_heap = mem_heap_create(1024);
+	ulint		n_edges;
+
+	lock_wait_mutex_enter();
+
+	lock_wfg_build(&graph, graph_heap);
+
+	lock_wait_mutex_exit();
+
+	n_edges = ib_vector_size(graph.edges);
+
+	*edges = static_cast<lock_wait_edge_t*>(
+		mem_heap_alloc(heap, (n_edges + 1) * sizeof **edges));
+
+	for (ulint i = 0; i < graph.n_nodes; ++i) {
+		const lock_wfg_node_t*	node = &graph.nodes[i];
+
+		for (ulint j = 0; j < node->n_edges; ++j) {
+			const lock_wfg_edge_t*	edge;
+			lock_wait_edge_t*	out;
+
+			edge = lock_wfg_get_edge(&graph, node, j);
+			out = &(*edges)[node->first_edge + j];
+
+			out->requesting_trx_id = node->trx_id;
+			out->blocking_trx_id = edge->blocker_id;
+			out->wait_started = node->wait_started;
+			out->blocking_trx_waits = edge->to != ULINT_UNDEFINED;
+		}
+	}
+
+	mem_heap_free(graph_heap);
+
+	return(n_edges);
+}
+
+/*========================= TABLE LOCKS ==============================*/
+
+/*********************************************************************//**
+Creates a table lock object and adds it as the last in the lock queue
+of the table. Does NOT check for deadlocks or lock compatibility.
 @return	own: new lock object */
 UNIV_INLINE
 lock_t*
@@ -4409,7 +5329,7 @@ lock_table(
 		return(DB_SUCCESS);
 	}
 
-	lock_mutex_enter();
+	lock_sys_mutex_enter();
 
 	/* We have to check if the new lock is compatible with any locks
 	other transactions have in the table lock queue. */
@@ -4417,6 +5337,12 @@ lock_table(
 	wait_for = lock_table_other_has_incompatible(
 		trx, LOCK_WAIT, table, mode);
 
+	if (wait_for != NULL) {
+		/* The deadlock check of a waiting request looks at
+		the record lock queues too. */
+		lock_rec_mutex_enter_all();
+	}
+
 	trx_mutex_enter(trx);
 
 	/* Another trx has a request on the table in an incompatible
@@ -4424,6 +5350,8 @@ lock_table(
 
 	if (wait_for != NULL) {
 		err = lock_table_enqueue_waiting(mode | flags, table, thr);
+
+		lock_rec_mutex_exit_all();
 	} else {
 		lock_table_create(table, mode | flags, trx);
 
@@ -4432,7 +5360,7 @@ lock_table(
 		err = DB_SUCCESS;
 	}
 
-	lock_mutex_exit();
+	lock_sys_mutex_exit();
 
 	trx_mutex_exit(trx);
 
@@ -4555,6 +5483,7 @@ lock_rec_unlock(
 	lock_t*		first_lock;
 	lock_t*		lock;
 	ulint		heap_no;
+	ib_mutex_t*	rec_mutex;
 	const char*	stmt;
 	size_t		stmt_len;
 
@@ -4565,8 +5494,9 @@ lock_rec_unlock(
 	ut_ad(trx_state_eq(trx, TRX_STATE_ACTIVE));
 
 	heap_no = page_rec_get_heap_no(rec);
+	rec_mutex = lock_rec_get_block_mutex(block);
 
-	lock_mutex_enter();
+	mutex_enter(rec_mutex);
 	trx_mutex_enter(trx);
 
 	first_lock = lock_rec_get_first(block, heap_no);
@@ -4581,7 +5511,7 @@ lock_rec_unlock(
 		}
 	}
 
-	lock_mutex_exit();
+	mutex_exit(rec_mutex);
 	trx_mutex_exit(trx);
 
 	stmt = innobase_get_stmt(trx->mysql_thd, &stmt_len);
@@ -4602,24 +5532,18 @@ released:
 
 	/* Check if we can now grant waiting lock requests */
 
-	for (lock = first_lock; lock != NULL;
-	     lock = lock_rec_get_next(heap_no, lock)) {
-		if (lock_get_wait(lock)
-		    && !lock_rec_has_to_wait_in_queue(lock)) {
-
-			/* Grant the lock */
-			ut_ad(trx != lock->trx);
-			lock_grant(lock);
-		}
-	}
+	lock_rec_grant_waiting(buf_block_get_space(block),
+			       buf_block_get_page_no(block), heap_no);
 
-	lock_mutex_exit();
+	mutex_exit(rec_mutex);
 	trx_mutex_exit(trx);
 }
 
 /*********************************************************************//**
 Releases transaction locks, and releases possible other transactions waiting
-because of these locks. */
+because of these locks. The caller must hold lock_sys->mutex, which keeps
+other threads from creating or moving locks of the transaction; the record
+lock shard mutexes are acquired here as needed. */
 static
 void
 lock_release(
@@ -4629,6 +5553,7 @@ lock_release(
 	lock_t*		lock;
 	ulint		count = 0;
 	trx_id_t	max_trx_id;
+	ib_mutex_t*	rec_mutex = NULL;
 
 	ut_ad(lock_mutex_own());
 	ut_ad(!trx_mutex_own(trx));
@@ -4653,6 +5578,22 @@ lock_release(
 			}
 #endif /* UNIV_DEBUG */
 
+			ib_mutex_t*	mutex = lock_rec_get_mutex(
+				lock->un_member.rec_lock.space,
+				lock->un_member.rec_lock.page_no);
+
+			/* Consecutive locks are usually on the same
+			page; keep the shard mutex across them. */
+
+			if (mutex != rec_mutex) {
+				if (rec_mutex != NULL) {
+					mutex_exit(rec_mutex);
+				}
+
+				rec_mutex = mutex;
+				mutex_enter(rec_mutex);
+			}
+
 			lock_rec_dequeue_from_page(lock);
 		} else {
 			dict_table_t*	table;
@@ -4689,9 +5630,14 @@ lock_release(
 			/* Release the  mutex for a while, so that we
 			do not monopolize it */
 
-			lock_mutex_exit();
+			if (rec_mutex != NULL) {
+				mutex_exit(rec_mutex);
+				rec_mutex = NULL;
+			}
 
-			lock_mutex_enter();
+			lock_sys_mutex_exit();
+
+			lock_sys_mutex_enter();
 
 			count = 0;
 		}
@@ -4699,6 +5645,10 @@ lock_release(
 		++count;
 	}
 
+	if (rec_mutex != NULL) {
+		mutex_exit(rec_mutex);
+	}
+
 	/* We don't remove the locks one by one from the vector for
 	efficiency reasons. We simply reset it because we would have
 	released all the locks anyway. */
@@ -5906,6 +6856,7 @@ lock_rec_insert_check_and_lock(
 	lock_t*		lock;
 	dberr_t		err;
 	ulint		next_rec_heap_no;
+	ib_mutex_t*	rec_mutex;
 	ibool		inherit_in = *inherit;
 
 	ut_ad(block->frame == page_align(rec));
@@ -5921,8 +6872,9 @@ lock_rec_insert_check_and_lock(
 	trx = thr_get_trx(thr);
 	next_rec = page_rec_get_next_const(rec);
 	next_rec_heap_no = page_rec_get_heap_no(next_rec);
+	rec_mutex = lock_rec_get_block_mutex(block);
 
-	lock_mutex_enter();
+	mutex_enter(rec_mutex);
 	/* Because this code is invoked for a running transaction by
 	the thread that is serving the transaction, it is not necessary
 	to hold trx->mutex here. */
@@ -5937,7 +6889,7 @@ lock_rec_insert_check_and_lock(
 	if (UNIV_LIKELY(lock == NULL)) {
 		/* We optimize CPU time usage in the simplest case */
 
-		lock_mutex_exit();
+		mutex_exit(rec_mutex);
 
 		if (inherit_in && !dict_index_is_clust(index)) {
 			/* Update the page max trx id field */
@@ -5963,24 +6915,42 @@ lock_rec_insert_check_and_lock(
 	had to wait for their insert. Both had waiting gap type lock requests
 	on the successor, which produced an unnecessary deadlock. */
 
-	if (lock_rec_other_has_conflicting(
+	if (!lock_rec_other_has_conflicting(
 		    static_cast<enum lock_mode>(
 			    LOCK_X | LOCK_GAP | LOCK_INSERT_INTENTION),
 		    block, next_rec_heap_no, trx)) {
 
-		/* Note that we may get DB_SUCCESS also here! */
-		trx_mutex_enter(trx);
-
-		err = lock_rec_enqueue_waiting(
-			LOCK_X | LOCK_GAP | LOCK_INSERT_INTENTION,
-			block, next_rec_heap_no, index, thr);
+		mutex_exit(rec_mutex);
 
-		trx_mutex_exit(trx);
-	} else {
 		err = DB_SUCCESS;
-	}
+	} else {
+		/* Enqueueing a waiting request requires a deadlock
+		check, for which the whole lock system must be latched.
+		The conflict may have gone away in between. */
 
-	lock_mutex_exit();
+		mutex_exit(rec_mutex);
+
+		lock_mutex_enter();
+
+		if (lock_rec_other_has_conflicting(
+			    static_cast<enum lock_mode>(
+				    LOCK_X | LOCK_GAP | LOCK_INSERT_INTENTION),
+			    block, next_rec_heap_no, trx)) {
+
+			/* Note that we may get DB_SUCCESS also here! */
+			trx_mutex_enter(trx);
+
+			err = lock_rec_enqueue_waiting(
+				LOCK_X | LOCK_GAP | LOCK_INSERT_INTENTION,
+				block, next_rec_heap_no, index, thr);
+
+			trx_mutex_exit(trx);
+		} else {
+			err = DB_SUCCESS;
+		}
+
+		lock_mutex_exit();
+	}
 
 	switch (err) {
 	case DB_SUCCESS_LOCKED_REC:
@@ -6057,17 +7027,23 @@ lock_rec_convert_impl_to_expl(
 	}
 
 	if (trx_id != 0) {
-		trx_t*	impl_trx;
-		ulint	heap_no = page_rec_get_heap_no(rec);
+		trx_t*		impl_trx;
+		ulint		heap_no = page_rec_get_heap_no(rec);
+		ib_mutex_t*	rec_mutex = lock_rec_get_block_mutex(block);
 
-		lock_mutex_enter();
+		/* The lock is created on behalf of another transaction,
+		so lock_sys->mutex is needed in addition to the record
+		lock shard mutex. */
+
+		lock_sys_mutex_enter();
+		mutex_enter(rec_mutex);
 
 		/* If the transaction is still active and has no
 		explicit x-lock set on the record, set one for it */
 
 		impl_trx = trx_rw_is_active(trx_id, NULL);
 
-		/* impl_trx cannot be committed until lock_mutex_exit()
+		/* impl_trx cannot be committed until lock_sys_mutex_exit()
 		because lock_trx_release_locks() acquires lock_sys->mutex */
 
 		if (impl_trx != NULL
@@ -6081,7 +7057,8 @@ lock_rec_convert_impl_to_expl(
 				impl_trx, FALSE);
 		}
 
-		lock_mutex_exit();
+		mutex_exit(rec_mutex);
+		lock_sys_mutex_exit();
 	}
 }
 
@@ -6127,16 +7104,10 @@ lock_clust_rec_modify_check_and_lock(
 
 	lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 
-	lock_mutex_enter();
-
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
-	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
-			    block, heap_no, index, thr);
-
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	err = lock_rec_lock_sharded(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
+				    block, heap_no, index, thr);
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6187,16 +7158,10 @@ lock_sec_rec_modify_check_and_lock(
 	index record, and this would not have been possible if another active
 	transaction had modified this secondary index record. */
 
-	lock_mutex_enter();
-
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
-	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
-			    block, heap_no, index, thr);
-
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	err = lock_rec_lock_sharded(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
+				    block, heap_no, index, thr);
 
 #ifdef UNIV_DEBUG
 	{
@@ -6286,19 +7251,13 @@ lock_sec_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 	ut_ad(mode != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 
-	err = lock_rec_lock(FALSE, mode | gap_mode,
-			    block, heap_no, index, thr);
-
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	err = lock_rec_lock_sharded(FALSE, mode | gap_mode,
+				    block, heap_no, index, thr);
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6358,19 +7317,13 @@ lock_clust_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 	ut_ad(mode != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 
-	err = lock_rec_lock(FALSE, mode | gap_mode,
-			    block, heap_no, index, thr);
-
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	err = lock_rec_lock_sharded(FALSE, mode | gap_mode,
+				    block, heap_no, index, thr);
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6778,11 +7731,11 @@ lock_unlock_table_autoinc(
 	necessary to hold trx->mutex here. */
 
 	if (lock_trx_holds_autoinc_locks(trx)) {
-		lock_mutex_enter();
+		lock_sys_mutex_enter();
 
 		lock_release_autoinc_locks(trx);
 
-		lock_mutex_exit();
+		lock_sys_mutex_exit();
 	}
 }
 
@@ -6812,8 +7765,11 @@ lock_trx_release_locks(
 	}
 
 	/* The transition of trx->state to TRX_STATE_COMMITTED_IN_MEMORY
-	is protected by both the lock_sys->mutex and the trx->mutex. */
-	lock_mutex_enter();
+	is protected by both the lock_sys->mutex and the trx->mutex.
+	The record lock shard mutexes are only acquired by
+	lock_release() for the pages that the transaction has locks
+	on, so that lock requests on other pages can proceed. */
+	lock_sys_mutex_enter();
 	trx_mutex_enter(trx);
 
 	/* The following assignment makes the transaction committed in memory
@@ -6851,7 +7807,7 @@ lock_trx_release_locks(
 
 	lock_release(trx);
 
-	lock_mutex_exit();
+	lock_sys_mutex_exit();
 }
 
 /*********************************************************************//**
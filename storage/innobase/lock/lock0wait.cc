@@ -184,6 +184,38 @@ lock_wait_table_reserve_slot(
 	return(NULL);
 }
 
+/***************************************************************//**
+Adds a row lock wait to the wait time histogram of the current
+innodb_lock_schedule_algorithm. */
+static
+void
+lock_wait_histogram_add(
+/*====================*/
+	ulint	wait_time)	/*!< in: wait time in microseconds */
+{
+	/* Upper bounds of the histogram buckets, in microseconds. The
+	last bucket counts the waits that exceed all of them. */
+	static const ulint	bounds[] = {
+		1000, 10000, 100000, 1000000, 10000000
+	};
+	static const ulint	n_buckets = UT_ARR_SIZE(bounds) + 1;
+	ulint			bucket = 0;
+	ulint			monitor;
+
+	ut_ad(MONITOR_LOCK_WAIT_OLDEST_LE_1MS - MONITOR_LOCK_WAIT_FCFS_LE_1MS
+	      == n_buckets);
+	ut_ad(srv_lock_schedule_algorithm < SRV_LOCK_SCHEDULE_N);
+
+	while (bucket < UT_ARR_SIZE(bounds) && wait_time > bounds[bucket]) {
+		++bucket;
+	}
+
+	monitor = MONITOR_LOCK_WAIT_FCFS_LE_1MS
+		+ srv_lock_schedule_algorithm * n_buckets + bucket;
+
+	MONITOR_ATOMIC_INC(static_cast<monitor_id_t>(monitor));
+}
+
 /***************************************************************//**
 Puts a user OS thread to wait for a lock to be released. If an error
 occurs during the wait trx->error_state associated with thr is
@@ -368,6 +400,10 @@ lock_wait_suspend_thread(
 			lock_sys->n_lock_max_wait_time = diff_time;
 		}
 
+		if (start_time != -1 && finish_time != -1) {
+			lock_wait_histogram_add(diff_time);
+		}
+
 		/* Record the lock wait time for this thread */
 		thd_set_lock_wait_time(trx->mysql_thd, diff_time);
 
@@ -397,13 +433,14 @@ lock_wait_release_thread_if_suspended(
 	que_thr_t*	thr)	/*!< in: query thread associated with the
 				user OS thread	 */
 {
-	ut_ad(lock_mutex_own());
 	ut_ad(trx_mutex_own(thr_get_trx(thr)));
 
-	/* We own both the lock mutex and the trx_t::mutex but not the
-	lock wait mutex. This is OK because other threads will see the state
-	of this slot as being in use and no other thread can change the state
-	of the slot to free unless that thread also owns the lock mutex. */
+	/* We own the trx_t::mutex and either the lock mutex or the
+	record lock shard mutex of the granted lock, but not the lock
+	wait mutex. This is OK because other threads will see the state
+	of this slot as being in use and no other thread can change the
+	state of the slot to free unless that thread has latched the whole
+	lock system with lock_mutex_enter(). */
 
 	if (thr->slot != NULL && thr->slot->in_use && thr->slot->thr == thr) {
 		trx_t*	trx = thr_get_trx(thr);
@@ -473,7 +510,8 @@ lock_wait_check_and_cancel(
 }
 
 /*********************************************************************//**
-A thread which wakes up threads whose lock wait may have lasted too long.
+A thread which wakes up threads whose lock wait may have lasted too long,
+and which looks for deadlocks if innodb_deadlock_detect=BACKGROUND.
 @return	a dummy parameter */
 extern "C" UNIV_INTERN
 os_thread_ret_t
@@ -496,6 +534,7 @@ DECLARE_THREAD(lock_wait_timeout_thread)(
 
 	do {
 		srv_slot_t*	slot;
+		ulint		n_waiting = 0;
 
 		/* When someone is waiting for a lock, we wake up every second
 		and check if a timeout has passed for a lock wait */
@@ -523,9 +562,19 @@ DECLARE_THREAD(lock_wait_timeout_thread)(
 
 			if (slot->in_use) {
 				lock_wait_check_and_cancel(slot);
+				++n_waiting;
 			}
 		}
 
+		/* It takes at least two waiting transactions to
+		form a deadlock. */
+
+		if (n_waiting > 1
+		    && srv_deadlock_detect == SRV_DEADLOCK_DETECT_BACKGROUND) {
+
+			lock_deadlock_check_background();
+		}
+
 		sig_count = os_event_reset(event);
 
 		lock_wait_mutex_exit();
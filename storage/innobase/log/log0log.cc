@@ -91,10 +91,20 @@ UNIV_INTERN mysql_pfs_key_t	log_sys_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	log_flush_order_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
+#ifdef UNIV_PFS_THREAD
+UNIV_INTERN mysql_pfs_key_t	log_writer_thread_key;
+UNIV_INTERN mysql_pfs_key_t	log_flusher_thread_key;
+#endif /* UNIV_PFS_THREAD */
+
 #ifdef UNIV_DEBUG
 UNIV_INTERN ibool	log_do_write = TRUE;
 #endif /* UNIV_DEBUG */
 
+/** Flag indicating if the log writer thread is in active state. */
+UNIV_INTERN bool	log_writer_is_active = false;
+/** Flag indicating if the log flusher thread is in active state. */
+UNIV_INTERN bool	log_flusher_is_active = false;
+
 /* These control how often we print warnings if the last checkpoint is too
 old */
 UNIV_INTERN ibool	log_has_printed_chkp_warning = FALSE;
@@ -137,6 +147,15 @@ the previous */
 /* This parameter controls asynchronous writing to the archive */
 #define LOG_ARCHIVE_RATIO_ASYNC		16
 
+/* How long the log writer and flusher threads sleep at most when they
+are not woken up, in microseconds */
+#define LOG_THREAD_IDLE_TIMEOUT		10000
+
+/* How long a thread waiting for the log writer or flusher thread sleeps
+at most before it checks again whether its lsn has been reached, in
+microseconds; this only matters if a wake-up was missed */
+#define LOG_WAIT_TIMEOUT		100000
+
 /* Codes used in unlocking flush latches */
 #define LOG_UNLOCK_NONE_FLUSHED_LOCK	1
 #define LOG_UNLOCK_FLUSH_LOCK		2
@@ -161,7 +180,7 @@ log_io_complete_archive(void);
 #endif /* UNIV_LOG_ARCHIVE */
 
 /****************************************************************//**
-Returns the oldest modified block lsn in the pool, or log_sys->lsn if none
+Returns the oldest modified block lsn in the pool, or the current lsn if none
 exists.
 @return	LSN of oldest modification */
 static
@@ -170,313 +189,232 @@ log_buf_pool_get_oldest_modification(void)
 /*======================================*/
 {
 	lsn_t	lsn;
+	lsn_t	oldest_lsn;
 
 	ut_ad(mutex_own(&(log_sys->mutex)));
 
-	lsn = buf_pool_get_oldest_modification();
+	/* Read the current lsn first: buf_pool_get_oldest_modification()
+	acquires the flush order mutex, so any mini-transaction that
+	reserved its log before this will have added the pages that it
+	dirtied to the flush lists. */
 
-	if (!lsn) {
+	lsn = log_get_lsn();
 
-		lsn = log_sys->lsn;
-	}
-
-	return(lsn);
-}
-
-/** Extends the log buffer.
-@param[in] len	requested minimum size in bytes */
-static
-void
-log_buffer_extend(
-	ulint	len)
-{
-	ulint	move_start;
-	ulint	move_end;
-	byte	tmp_buf[OS_FILE_LOG_BLOCK_SIZE];
-
-	mutex_enter(&(log_sys->mutex));
-
-	while (log_sys->is_extending) {
-		/* Another thread is trying to extend already.
-		Needs to wait for. */
-		mutex_exit(&(log_sys->mutex));
+	os_rmb;
 
-		log_buffer_flush_to_disk();
+	oldest_lsn = buf_pool_get_oldest_modification();
 
-		mutex_enter(&(log_sys->mutex));
+	if (!oldest_lsn) {
 
-		if (srv_log_buffer_size > len / UNIV_PAGE_SIZE) {
-			/* Already extended enough by the others */
-			mutex_exit(&(log_sys->mutex));
-			return;
-		}
+		oldest_lsn = lsn;
 	}
 
-	log_sys->is_extending = true;
-
-	while (log_sys->n_pending_writes != 0
-	       || ut_calc_align_down(log_sys->buf_free,
-				     OS_FILE_LOG_BLOCK_SIZE)
-		  != ut_calc_align_down(log_sys->buf_next_to_write,
-					OS_FILE_LOG_BLOCK_SIZE)) {
-		/* Buffer might have >1 blocks to write still. */
-		mutex_exit(&(log_sys->mutex));
+	return(oldest_lsn);
+}
 
-		log_buffer_flush_to_disk();
+/************************************************************//**
+Gets the counter of copied bytes of a log block in the log buffer.
+@return	pointer to the counter */
+UNIV_INLINE
+ulint*
+log_buffer_get_copied(
+/*==================*/
+	lsn_t	lsn)	/*!< in: lsn within the log block */
+{
+	return(log_sys->buf_copied
+	       + (ulint) (lsn / OS_FILE_LOG_BLOCK_SIZE)
+	       % (log_sys->buf_size / OS_FILE_LOG_BLOCK_SIZE));
+}
 
-		mutex_enter(&(log_sys->mutex));
-	}
+/************************************************************//**
+Gets the log block of an lsn in the log buffer.
+@return	pointer to the start of the log block */
+UNIV_INLINE
+byte*
+log_buffer_get_block(
+/*=================*/
+	lsn_t	lsn)	/*!< in: lsn within the log block */
+{
+	return(log_sys->buf
+	       + (ulint) (ut_uint64_align_down(lsn, OS_FILE_LOG_BLOCK_SIZE)
+			  % log_sys->buf_size));
+}
 
-	move_start = ut_calc_align_down(
-		log_sys->buf_free,
-		OS_FILE_LOG_BLOCK_SIZE);
-	move_end = log_sys->buf_free;
+/************************************************************//**
+Waits until the log buffer has room for the log block of an lsn, that is,
+until all the blocks that previously occupied the same space in the log
+buffer have been written to the log files. */
+static
+void
+log_buffer_wait_for_space(
+/*======================*/
+	lsn_t	lsn)	/*!< in: lsn within the log block */
+{
+	lsn_t	end_lsn;
 
-	/* store the last log block in buffer */
-	ut_memcpy(tmp_buf, log_sys->buf + move_start,
-		  move_end - move_start);
+	end_lsn = ut_uint64_align_down(lsn, OS_FILE_LOG_BLOCK_SIZE)
+		+ OS_FILE_LOG_BLOCK_SIZE;
 
-	log_sys->buf_free -= move_start;
-	log_sys->buf_next_to_write -= move_start;
+	if (end_lsn <= ut_uint64_align_down(log_sys->written_to_all_lsn,
+					    OS_FILE_LOG_BLOCK_SIZE)
+	    + log_sys->buf_size) {
 
-	/* reallocate log buffer */
-	srv_log_buffer_size = len / UNIV_PAGE_SIZE + 1;
-	mem_free(log_sys->buf_ptr);
-	log_sys->buf_ptr = static_cast<byte*>(
-		mem_zalloc(LOG_BUFFER_SIZE + OS_FILE_LOG_BLOCK_SIZE));
-	log_sys->buf = static_cast<byte*>(
-		ut_align(log_sys->buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
-	log_sys->buf_size = LOG_BUFFER_SIZE;
-	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
-		- LOG_BUF_FLUSH_MARGIN;
+		return;
+	}
 
-	/* restore the last log block */
-	ut_memcpy(log_sys->buf, tmp_buf, move_end - move_start);
+	srv_stats.log_waits.inc();
 
-	ut_ad(log_sys->is_extending);
-	log_sys->is_extending = false;
+	do {
+		/* The log up to end_lsn - buf_size has been reserved by
+		other threads before us, and they need no latches to
+		complete copying it to the log buffer. Write it. */
 
-	mutex_exit(&(log_sys->mutex));
+		log_write_up_to(end_lsn - log_sys->buf_size,
+				LOG_WAIT_ALL_GROUPS, FALSE);
 
-	ib_logf(IB_LOG_LEVEL_INFO,
-		"innodb_log_buffer_size was extended to %lu.",
-		LOG_BUFFER_SIZE);
+	} while (end_lsn > ut_uint64_align_down(log_sys->written_to_all_lsn,
+						OS_FILE_LOG_BLOCK_SIZE)
+		 + log_sys->buf_size);
 }
 
 /************************************************************//**
-Opens the log for log_write_low. The log must be closed with log_close and
-released with log_release.
-@return	start lsn of the log record */
+Reserves space in the redo log for the log records of a mini-transaction.
+The range of lsn is allocated with an atomic increment of log_sys->sn,
+so that log_sys->mutex is not acquired: the caller copies its log records
+to the reserved range with log_buffer_write() concurrently with other
+threads, and finishes with log_buffer_close().
+@return	start lsn of the reserved range */
 UNIV_INTERN
 lsn_t
-log_reserve_and_open(
-/*=================*/
-	ulint	len)	/*!< in: length of data to be catenated */
+log_buffer_reserve(
+/*===============*/
+	ulint	len,		/*!< in: length of data to be catenated */
+	lsn_t*	end_lsn)	/*!< out: end lsn of the reserved range */
 {
-	log_t*	log			= log_sys;
-	ulint	len_upper_limit;
+	lsn_t	sn;
 #ifdef UNIV_LOG_ARCHIVE
-	ulint	archived_lsn_age;
 	ulint	dummy;
-#endif /* UNIV_LOG_ARCHIVE */
-#ifdef UNIV_DEBUG
-	ulint	count			= 0;
-#endif /* UNIV_DEBUG */
-
-	if (len >= log->buf_size / 2) {
-		DBUG_EXECUTE_IF("ib_log_buffer_is_short_crash",
-				DBUG_SUICIDE(););
-
-		/* log_buffer is too small. try to extend instead of crash. */
-		ib_logf(IB_LOG_LEVEL_WARN,
-			"The transaction log size is too large"
-			" for innodb_log_buffer_size (%lu >= %lu / 2). "
-			"Trying to extend it.",
-			len, LOG_BUFFER_SIZE);
-
-		log_buffer_extend((len + 1) * 2);
-	}
-loop:
-	mutex_enter(&(log->mutex));
-	ut_ad(!recv_no_log_write);
 
-	if (log->is_extending) {
+	while (log_sys->archiving_state != LOG_ARCH_OFF
+	       && log_get_lsn() - log_sys->archived_lsn + len
+	       > log_sys->max_archived_lsn_age) {
+		/* Not enough free archived space in log groups: do a
+		synchronous archive write batch: */
 
-		mutex_exit(&(log->mutex));
-
-		/* Log buffer size is extending. Writing up to the next block
-		should wait for the extending finished. */
-
-		os_thread_sleep(100000);
-
-		ut_ad(++count < 50);
-
-		goto loop;
-	}
-
-	/* Calculate an upper limit for the space the string may take in the
-	log buffer */
-
-	len_upper_limit = LOG_BUF_WRITE_MARGIN + (5 * len) / 4;
-
-	if (log->buf_free + len_upper_limit > log->buf_size) {
-
-		mutex_exit(&(log->mutex));
-
-		/* Not enough free space, do a syncronous flush of the log
-		buffer */
-
-		log_buffer_flush_to_disk();
-
-		srv_stats.log_waits.inc();
-
-		ut_ad(++count < 50);
-
-		goto loop;
+		log_archive_do(TRUE, &dummy);
 	}
+#endif /* UNIV_LOG_ARCHIVE */
 
-#ifdef UNIV_LOG_ARCHIVE
-	if (log->archiving_state != LOG_ARCH_OFF) {
-
-		archived_lsn_age = log->lsn - log->archived_lsn;
-		if (archived_lsn_age + len_upper_limit
-		    > log->max_archived_lsn_age) {
-			/* Not enough free archived space in log groups: do a
-			synchronous archive write batch: */
-
-			mutex_exit(&(log->mutex));
-
-			ut_ad(len_upper_limit <= log->max_archived_lsn_age);
+	ut_ad(!recv_no_log_write);
 
-			log_archive_do(TRUE, &dummy);
+	sn = os_atomic_increment_uint64(&log_sys->sn, len) - len;
 
-			ut_ad(++count < 50);
+	*end_lsn = log_translate_sn_to_lsn(sn + len);
 
-			goto loop;
-		}
-	}
-#endif /* UNIV_LOG_ARCHIVE */
+	srv_stats.log_write_requests.inc();
 
-#ifdef UNIV_LOG_DEBUG
-	log->old_buf_free = log->buf_free;
-	log->old_lsn = log->lsn;
-#endif
-	return(log->lsn);
+	return(log_translate_sn_to_lsn(sn));
 }
 
 /************************************************************//**
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
+Copies a string to a range of the log buffer reserved with
+log_buffer_reserve(). The string need not fit in the log buffer: if
+there is not enough free space, this waits until the log has been
+written far enough. */
 UNIV_INTERN
 void
-log_write_low(
-/*==========*/
-	byte*	str,		/*!< in: string */
-	ulint	str_len)	/*!< in: string length */
+log_buffer_write(
+/*=============*/
+	const byte*	str,	/*!< in: string */
+	ulint		str_len,/*!< in: string length */
+	lsn_t*		lsn,	/*!< in/out: lsn where to copy the string;
+				advanced past the string */
+	lsn_t		end_lsn)/*!< in: end lsn of the reserved range */
 {
-	log_t*	log	= log_sys;
-	ulint	len;
-	ulint	data_len;
-	byte*	log_block;
+	lsn_t	start_lsn	= *lsn;
 
-	ut_ad(mutex_own(&(log->mutex)));
-part_loop:
-	ut_ad(!recv_no_log_write);
-	/* Calculate a part length */
+	while (str_len > 0) {
+		ulint	offset;
+		ulint	len;
 
-	data_len = (log->buf_free % OS_FILE_LOG_BLOCK_SIZE) + str_len;
+		ut_ad(start_lsn < end_lsn);
 
-	if (data_len <= OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
+		offset = (ulint) (start_lsn % OS_FILE_LOG_BLOCK_SIZE);
 
-		/* The string fits within the current log block */
+		ut_ad(offset >= LOG_BLOCK_HDR_SIZE);
 
-		len = str_len;
-	} else {
-		data_len = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE;
+		/* Calculate a part length */
 
-		len = OS_FILE_LOG_BLOCK_SIZE
-			- (log->buf_free % OS_FILE_LOG_BLOCK_SIZE)
-			- LOG_BLOCK_TRL_SIZE;
-	}
+		len = ut_min(str_len,
+			     OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE
+			     - offset);
 
-	ut_memcpy(log->buf + log->buf_free, str, len);
+		log_buffer_wait_for_space(start_lsn);
 
-	str_len -= len;
-	str = str + len;
+		ut_memcpy(log_buffer_get_block(start_lsn) + offset, str, len);
 
-	log_block = static_cast<byte*>(
-		ut_align_down(
-			log->buf + log->buf_free, OS_FILE_LOG_BLOCK_SIZE));
+		str += len;
+		str_len -= len;
 
-	log_block_set_data_len(log_block, data_len);
+		if (offset + len
+		    == OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
+			/* We filled the block: we are responsible for
+			the header of the next block, which the log writer
+			may use as soon as all of this block is copied.
+			The next mtr log record group will start at the
+			end of this mtr, if it is within that block. */
 
-	if (data_len == OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
-		/* This block became full */
-		log_block_set_data_len(log_block, OS_FILE_LOG_BLOCK_SIZE);
-		log_block_set_checkpoint_no(log_block,
-					    log_sys->next_checkpoint_no);
-		len += LOG_BLOCK_HDR_SIZE + LOG_BLOCK_TRL_SIZE;
+			lsn_t	next_lsn = ut_uint64_align_up(
+				start_lsn, OS_FILE_LOG_BLOCK_SIZE);
 
-		log->lsn += len;
+			log_buffer_wait_for_space(next_lsn);
 
-		/* Initialize the next block header */
-		log_block_init(log_block + OS_FILE_LOG_BLOCK_SIZE, log->lsn);
-	} else {
-		log->lsn += len;
-	}
+			log_block_set_first_rec_group(
+				log_buffer_get_block(next_lsn),
+				end_lsn < next_lsn + OS_FILE_LOG_BLOCK_SIZE
+				? (ulint) (end_lsn % OS_FILE_LOG_BLOCK_SIZE)
+				: 0);
+
+			os_atomic_increment_ulint(
+				log_buffer_get_copied(start_lsn), len);
 
-	log->buf_free += len;
+			start_lsn = next_lsn + LOG_BLOCK_HDR_SIZE;
+		} else {
+			/* The atomic increment is also a memory barrier:
+			the log writer will see the bytes that we copied
+			when it sees the new count. */
 
-	ut_ad(log->buf_free <= log->buf_size);
+			os_atomic_increment_ulint(
+				log_buffer_get_copied(start_lsn), len);
 
-	if (str_len > 0) {
-		goto part_loop;
+			start_lsn += len;
+		}
 	}
 
-	srv_stats.log_write_requests.inc();
+	*lsn = start_lsn;
 }
 
 /************************************************************//**
-Closes the log.
-@return	lsn */
+Closes a range of the log reserved with log_buffer_reserve(), checking
+whether a log buffer flush or a new checkpoint is needed. */
 UNIV_INTERN
-lsn_t
-log_close(void)
-/*===========*/
+void
+log_buffer_close(
+/*=============*/
+	lsn_t	end_lsn)	/*!< in: end lsn of the reserved range */
 {
-	byte*		log_block;
-	ulint		first_rec_group;
 	lsn_t		oldest_lsn;
-	lsn_t		lsn;
 	log_t*		log	= log_sys;
 	lsn_t		checkpoint_age;
 
-	ut_ad(mutex_own(&(log->mutex)));
 	ut_ad(!recv_no_log_write);
 
-	lsn = log->lsn;
-
-	log_block = static_cast<byte*>(
-		ut_align_down(
-			log->buf + log->buf_free, OS_FILE_LOG_BLOCK_SIZE));
-
-	first_rec_group = log_block_get_first_rec_group(log_block);
-
-	if (first_rec_group == 0) {
-		/* We initialized a new log block which was not written
-		full by the current mtr: the next mtr log record group
-		will start within this block at the offset data_len */
-
-		log_block_set_first_rec_group(
-			log_block, log_block_get_data_len(log_block));
-	}
-
-	if (log->buf_free > log->max_buf_free) {
+	if (end_lsn - log->written_to_all_lsn > log->max_buf_free) {
 
 		log->check_flush_or_checkpoint = TRUE;
 	}
 
-	checkpoint_age = lsn - log->last_checkpoint_lsn;
+	checkpoint_age = end_lsn - log->last_checkpoint_lsn;
 
 	if (checkpoint_age >= log->log_group_capacity) {
 		/* TODO: split btr_store_big_rec_extern_fields() into small
@@ -509,27 +447,105 @@ log_close(void)
 
 	if (checkpoint_age <= log->max_modified_age_sync) {
 
-		goto function_exit;
+		return;
 	}
 
 	oldest_lsn = buf_pool_get_oldest_modification();
 
 	if (!oldest_lsn
-	    || lsn - oldest_lsn > log->max_modified_age_sync
+	    || end_lsn - oldest_lsn > log->max_modified_age_sync
 	    || checkpoint_age > log->max_checkpoint_age_async) {
 
 		log->check_flush_or_checkpoint = TRUE;
 	}
-function_exit:
+}
 
-#ifdef UNIV_LOG_DEBUG
-	log_check_log_recs(log->buf + log->old_buf_free,
-			   log->buf_free - log->old_buf_free, log->old_lsn);
-#endif
+/************************************************************//**
+Calculates how far the log records have been copied to the log buffer
+without gaps, advancing log_sys->buf_ready_lsn.
+@return	lsn up to which the log buffer can be written */
+static
+lsn_t
+log_buffer_ready(void)
+/*==================*/
+{
+	lsn_t	lsn	= log_sys->buf_ready_lsn;
+
+	ut_ad(mutex_own(&(log_sys->mutex)));
+
+	for (;;) {
+		lsn_t	block_lsn;
+		lsn_t	reserved_lsn;
+		ulint	copied;
+
+		block_lsn = ut_uint64_align_down(lsn, OS_FILE_LOG_BLOCK_SIZE);
+
+		copied = *(volatile ulint*) log_buffer_get_copied(lsn);
+
+		if (copied == LOG_BLOCK_DATA_SIZE) {
+			/* The block is full: continue from the next one */
+
+			lsn = block_lsn + OS_FILE_LOG_BLOCK_SIZE
+				+ LOG_BLOCK_HDR_SIZE;
+			continue;
+		}
+
+		/* The block was partially copied. Since the copy count
+		was read before the reserved lsn, if every byte reserved
+		in this block has been copied, nothing in the block is
+		missing. Otherwise, we can only rely on the blocks before
+		this one, which are full. */
+
+		os_rmb;
+
+		reserved_lsn = ut_min(log_get_lsn(),
+				      block_lsn + OS_FILE_LOG_BLOCK_SIZE
+				      - LOG_BLOCK_TRL_SIZE);
+
+		if (block_lsn + LOG_BLOCK_HDR_SIZE + copied == reserved_lsn) {
+			lsn = reserved_lsn;
+		} else {
+			lsn = ut_max(lsn, block_lsn + LOG_BLOCK_HDR_SIZE);
+		}
+
+		break;
+	}
+
+	os_rmb;
+
+	log_sys->buf_ready_lsn = lsn;
 
 	return(lsn);
 }
 
+/************************************************************//**
+Resets the copy counts of the log blocks which have been written full to
+the log files, so that their space in the log buffer can be reused. */
+static
+void
+log_buffer_free_blocks(
+/*===================*/
+	lsn_t	start_lsn,	/*!< in: old value of written_to_all_lsn */
+	lsn_t	end_lsn)	/*!< in: new value of written_to_all_lsn */
+{
+	ut_ad(mutex_own(&(log_sys->mutex)));
+
+	for (lsn_t lsn = ut_uint64_align_down(start_lsn,
+					      OS_FILE_LOG_BLOCK_SIZE);
+	     lsn < ut_uint64_align_down(end_lsn, OS_FILE_LOG_BLOCK_SIZE);
+	     lsn += OS_FILE_LOG_BLOCK_SIZE) {
+
+		ut_ad(*log_buffer_get_copied(lsn) == LOG_BLOCK_DATA_SIZE);
+
+		*log_buffer_get_copied(lsn) = 0;
+	}
+
+	/* The counts must be reset before other threads see the
+	new value of written_to_all_lsn and start reusing the blocks */
+
+	os_wmb;
+}
+
 #ifdef UNIV_LOG_ARCHIVE
 /******************************************************//**
 Pads the current log block full with dummy log records. Used in producing
@@ -542,25 +558,26 @@ log_pad_current_log_block(void)
 	byte		b		= MLOG_DUMMY_RECORD;
 	ulint		pad_length;
 	ulint		i;
-	ib_uint64_t	lsn;
-
-	/* We retrieve lsn only because otherwise gcc crashed on HP-UX */
-	lsn = log_reserve_and_open(OS_FILE_LOG_BLOCK_SIZE);
+	lsn_t		lsn;
+	lsn_t		end_lsn;
 
-	pad_length = OS_FILE_LOG_BLOCK_SIZE
-		- (log_sys->buf_free % OS_FILE_LOG_BLOCK_SIZE)
-		- LOG_BLOCK_TRL_SIZE;
+	do {
+		pad_length = OS_FILE_LOG_BLOCK_SIZE
+			- (ulint) (log_get_lsn() % OS_FILE_LOG_BLOCK_SIZE)
+			- LOG_BLOCK_TRL_SIZE;
 
-	for (i = 0; i < pad_length; i++) {
-		log_write_low(&b, 1);
-	}
+		lsn = log_buffer_reserve(pad_length, &end_lsn);
 
-	lsn = log_sys->lsn;
+		for (i = 0; i < pad_length; i++) {
+			log_buffer_write(&b, 1, &lsn, end_lsn);
+		}
 
-	log_close();
-	log_release();
+		log_buffer_close(end_lsn);
 
-	ut_a(lsn % OS_FILE_LOG_BLOCK_SIZE == LOG_BLOCK_HDR_SIZE);
+		/* Other threads may have catenated log records
+		concurrently: pad again until we end at a block
+		boundary */
+	} while (end_lsn % OS_FILE_LOG_BLOCK_SIZE != LOG_BLOCK_HDR_SIZE);
 }
 #endif /* UNIV_LOG_ARCHIVE */
 
@@ -848,11 +865,6 @@ log_init(void)
 
 	mutex_enter(&(log_sys->mutex));
 
-	/* Start the lsn from one log block from zero: this way every
-	log record has a start lsn != zero, a fact which we will use */
-
-	log_sys->lsn = LOG_START_LSN;
-
 	ut_a(LOG_BUFFER_SIZE >= 16 * OS_FILE_LOG_BLOCK_SIZE);
 	ut_a(LOG_BUFFER_SIZE >= 4 * UNIV_PAGE_SIZE);
 
@@ -863,7 +875,16 @@ log_init(void)
 		ut_align(log_sys->buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
 
 	log_sys->buf_size = LOG_BUFFER_SIZE;
-	log_sys->is_extending = false;
+
+	log_sys->buf_copied = static_cast<ulint*>(
+		mem_zalloc(sizeof(ulint)
+			   * (LOG_BUFFER_SIZE / OS_FILE_LOG_BLOCK_SIZE)));
+
+	log_sys->write_buf_ptr = static_cast<byte*>(
+		mem_zalloc(LOG_BUFFER_SIZE + OS_FILE_LOG_BLOCK_SIZE));
+
+	log_sys->write_buf = static_cast<byte*>(
+		ut_align(log_sys->write_buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
 
 	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
 		- LOG_BUF_FLUSH_MARGIN;
@@ -876,14 +897,17 @@ log_init(void)
 	log_sys->last_printout_time = time(NULL);
 	/*----------------------------*/
 
-	log_sys->buf_next_to_write = 0;
+	/* Start the lsn from one log block from zero: this way every
+	log record has a start lsn != zero, a fact which we will use */
+
+	log_buffer_reset(LOG_START_LSN + LOG_BLOCK_HDR_SIZE, NULL);
 
 	log_sys->write_lsn = 0;
 	log_sys->current_flush_lsn = 0;
 	log_sys->flushed_to_disk_lsn = 0;
 
-	log_sys->written_to_some_lsn = log_sys->lsn;
-	log_sys->written_to_all_lsn = log_sys->lsn;
+	log_sys->written_to_some_lsn = LOG_START_LSN;
+	log_sys->written_to_all_lsn = LOG_START_LSN;
 
 	log_sys->n_pending_writes = 0;
 
@@ -895,10 +919,23 @@ log_init(void)
 
 	os_event_set(log_sys->one_flushed_event);
 
+	log_sys->writer_event = os_event_create();
+	log_sys->flusher_event = os_event_create();
+
+	log_sys->write_events = static_cast<os_event_t*>(
+		mem_alloc(LOG_N_EVENTS * sizeof(os_event_t)));
+	log_sys->flush_events = static_cast<os_event_t*>(
+		mem_alloc(LOG_N_EVENTS * sizeof(os_event_t)));
+
+	for (ulint i = 0; i < LOG_N_EVENTS; i++) {
+		log_sys->write_events[i] = os_event_create();
+		log_sys->flush_events[i] = os_event_create();
+	}
+
 	/*----------------------------*/
 
 	log_sys->next_checkpoint_no = 0;
-	log_sys->last_checkpoint_lsn = log_sys->lsn;
+	log_sys->last_checkpoint_lsn = LOG_START_LSN;
 	log_sys->n_pending_checkpoint_writes = 0;
 
 
@@ -916,7 +953,7 @@ log_init(void)
 #ifdef UNIV_LOG_ARCHIVE
 	/* Under MySQL, log archiving is always off */
 	log_sys->archiving_state = LOG_ARCH_OFF;
-	log_sys->archived_lsn = log_sys->lsn;
+	log_sys->archived_lsn = LOG_START_LSN;
 	log_sys->next_archived_lsn = 0;
 
 	log_sys->n_pending_archive_ios = 0;
@@ -939,14 +976,8 @@ log_init(void)
 
 	/*----------------------------*/
 
-	log_block_init(log_sys->buf, log_sys->lsn);
-	log_block_set_first_rec_group(log_sys->buf, LOG_BLOCK_HDR_SIZE);
-
-	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
-	log_sys->lsn = LOG_START_LSN + LOG_BLOCK_HDR_SIZE;
-
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
-		    log_sys->lsn - log_sys->last_checkpoint_lsn);
+		    log_get_lsn() - log_sys->last_checkpoint_lsn);
 
 	mutex_exit(&(log_sys->mutex));
 
@@ -954,14 +985,60 @@ log_init(void)
 	recv_sys_create();
 	recv_sys_init(buf_pool_get_curr_size());
 
-	recv_sys->parse_start_lsn = log_sys->lsn;
-	recv_sys->scanned_lsn = log_sys->lsn;
+	recv_sys->parse_start_lsn = log_get_lsn();
+	recv_sys->scanned_lsn = log_get_lsn();
 	recv_sys->scanned_checkpoint_no = 0;
-	recv_sys->recovered_lsn = log_sys->lsn;
+	recv_sys->recovered_lsn = log_get_lsn();
 	recv_sys->limit_lsn = LSN_MAX;
 #endif
 }
 
+/******************************************************//**
+Sets the current lsn of the log system and prepares the log buffer, so that
+new log records are catenated after the given lsn. */
+UNIV_INTERN
+void
+log_buffer_reset(
+/*=============*/
+	lsn_t		lsn,		/*!< in: current lsn */
+	const byte*	last_block)	/*!< in: contents of the log block
+					which contains lsn, or NULL if the
+					block is empty */
+{
+	byte*	log_block;
+	ulint	data_len;
+
+	ut_ad(mutex_own(&(log_sys->mutex)));
+
+	data_len = (ulint) (lsn % OS_FILE_LOG_BLOCK_SIZE);
+
+	ut_a(data_len >= LOG_BLOCK_HDR_SIZE);
+	ut_a(data_len < OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE);
+
+	memset(log_sys->buf_copied, 0,
+	       sizeof(ulint) * (log_sys->buf_size / OS_FILE_LOG_BLOCK_SIZE));
+
+	log_block = log_buffer_get_block(lsn);
+
+	if (last_block != NULL && data_len > LOG_BLOCK_HDR_SIZE) {
+		ut_memcpy(log_block, last_block, OS_FILE_LOG_BLOCK_SIZE);
+	} else {
+		log_block_init(log_block, lsn);
+	}
+
+	if (log_block_get_first_rec_group(log_block) == 0) {
+		/* The next mtr log record group will start within this
+		block at the offset data_len */
+
+		log_block_set_first_rec_group(log_block, data_len);
+	}
+
+	*log_buffer_get_copied(lsn) = data_len - LOG_BLOCK_HDR_SIZE;
+
+	log_sys->buf_ready_lsn = lsn;
+	log_sys->sn = log_translate_lsn_to_sn(lsn);
+}
+
 /******************************************************************//**
 Inits a log group to the log system. */
 UNIV_INTERN
@@ -1121,32 +1198,14 @@ ulint
 log_sys_check_flush_completion(void)
 /*================================*/
 {
-	ulint	move_start;
-	ulint	move_end;
-
 	ut_ad(mutex_own(&(log_sys->mutex)));
 
 	if (log_sys->n_pending_writes == 0) {
 
-		log_sys->written_to_all_lsn = log_sys->write_lsn;
-		log_sys->buf_next_to_write = log_sys->write_end_offset;
-
-		if (log_sys->write_end_offset > log_sys->max_buf_free / 2) {
-			/* Move the log buffer content to the start of the
-			buffer */
+		log_buffer_free_blocks(log_sys->written_to_all_lsn,
+				       log_sys->write_lsn);
 
-			move_start = ut_calc_align_down(
-				log_sys->write_end_offset,
-				OS_FILE_LOG_BLOCK_SIZE);
-			move_end = ut_calc_align(log_sys->buf_free,
-						 OS_FILE_LOG_BLOCK_SIZE);
-
-			ut_memmove(log_sys->buf, log_sys->buf + move_start,
-				   move_end - move_start);
-			log_sys->buf_free -= move_start;
-
-			log_sys->buf_next_to_write -= move_start;
-		}
+		log_sys->written_to_all_lsn = log_sys->write_lsn;
 
 		return(LOG_UNLOCK_FLUSH_LOCK);
 	}
@@ -1419,17 +1478,88 @@ loop:
 }
 
 /******************************************************//**
-This function is called, e.g., when a transaction wants to commit. It checks
-that the log has been written to the log file up to the last log entry written
-by the transaction. If there is a flush running, it waits and checks if the
-flush flushed enough. If not, starts a new flush. */
-UNIV_INTERN
+Copies the log blocks to be written from the log buffer to
+log_sys->write_buf, and fills in the block headers. */
+static
 void
-log_write_up_to(
-/*============*/
+log_buffer_prepare_write(
+/*=====================*/
+	lsn_t	start_lsn,	/*!< in: lsn up to which the log has
+				already been written */
+	lsn_t	end_lsn)	/*!< in: lsn up to which to write */
+{
+	lsn_t	area_start;
+	lsn_t	area_end;
+	ulint	offset;
+	ulint	len;
+	ulint	n;
+	byte*	log_block;
+
+	ut_ad(mutex_own(&(log_sys->mutex)));
+
+	area_start = ut_uint64_align_down(start_lsn, OS_FILE_LOG_BLOCK_SIZE);
+	area_end = ut_uint64_align_up(end_lsn, OS_FILE_LOG_BLOCK_SIZE);
+
+	len = (ulint) (area_end - area_start);
+	offset = (ulint) (area_start % log_sys->buf_size);
+
+	ut_ad(len > 0);
+	ut_ad(len <= log_sys->buf_size);
+
+	/* The log buffer may wrap around */
+
+	n = ut_min(len, log_sys->buf_size - offset);
+
+	ut_memcpy(log_sys->write_buf, log_sys->buf + offset, n);
+
+	if (n < len) {
+		ut_memcpy(log_sys->write_buf + n, log_sys->buf, len - n);
+	}
+
+	/* The first record group fields were written by log_buffer_write().
+	Fill in the other header fields, which are the same for all the
+	blocks that we write. */
+
+	log_block = log_sys->write_buf;
+
+	for (lsn_t lsn = area_start; lsn < area_end;
+	     lsn += OS_FILE_LOG_BLOCK_SIZE) {
+
+		log_block_set_hdr_no(log_block,
+				     log_block_convert_lsn_to_no(lsn));
+
+		if (end_lsn > lsn + OS_FILE_LOG_BLOCK_SIZE) {
+			log_block_set_data_len(log_block,
+					       OS_FILE_LOG_BLOCK_SIZE);
+		} else {
+			log_block_set_data_len(log_block,
+					       (ulint) (end_lsn - lsn));
+		}
+
+		log_block_set_checkpoint_no(log_block,
+					    log_sys->next_checkpoint_no);
+
+		log_block += OS_FILE_LOG_BLOCK_SIZE;
+	}
+
+	log_block_set_flush_bit(log_sys->write_buf, TRUE);
+}
+
+/******************************************************//**
+Writes the log up to lsn to the log files in the calling thread, and
+flushes it if requested. If there is a flush running, it waits and checks
+if the flush flushed enough. If not, starts a new flush. Only the log
+records which have been completely copied to the log buffer without gaps
+are written: if the log up to lsn is still being copied by other threads,
+this waits for them unless wait is LOG_NO_WAIT. This is used while the log
+writer and flusher threads are not running, and by the log writer thread
+itself. */
+static
+void
+log_write_up_to_low(
+/*================*/
 	lsn_t	lsn,	/*!< in: log sequence number up to which
-			the log should be written,
-			LSN_MAX if not specified */
+			the log should be written */
 	ulint	wait,	/*!< in: LOG_NO_WAIT, LOG_WAIT_ONE_GROUP,
 			or LOG_WAIT_ALL_GROUPS */
 	ibool	flush_to_disk)
@@ -1437,37 +1567,13 @@ log_write_up_to(
 			also to be flushed to disk */
 {
 	log_group_t*	group;
-	ulint		start_offset;
-	ulint		end_offset;
-	ulint		area_start;
-	ulint		area_end;
-#ifdef UNIV_DEBUG
-	ulint		loop_count	= 0;
-#endif /* UNIV_DEBUG */
+	lsn_t		start_lsn;
+	lsn_t		end_lsn;
+	lsn_t		area_start;
+	lsn_t		area_end;
 	ulint		unlock;
 
-	ut_ad(!srv_read_only_mode);
-
-	if (recv_no_ibuf_operations) {
-		/* Recovery is running and no operations on the log files are
-		allowed yet (the variable name .._no_ibuf_.. is misleading) */
-
-		return;
-	}
-
 loop:
-#ifdef UNIV_DEBUG
-	loop_count++;
-
-	ut_ad(loop_count < 5);
-
-# if 0
-	if (loop_count > 2) {
-		fprintf(stderr, "Log loop count %lu\n", loop_count);
-	}
-# endif
-#endif
-
 	mutex_enter(&(log_sys->mutex));
 	ut_ad(!recv_no_log_write);
 
@@ -1518,21 +1624,30 @@ loop:
 		goto loop;
 	}
 
-	if (!flush_to_disk
-	    && log_sys->buf_free == log_sys->buf_next_to_write) {
-		/* Nothing to write and no flush to disk requested */
+	start_lsn = log_sys->written_to_all_lsn;
+	end_lsn = log_buffer_ready();
+
+	if (end_lsn == start_lsn && end_lsn < lsn) {
+		/* Nothing to write: the log up to lsn is still being
+		copied to the log buffer by other threads */
 
 		mutex_exit(&(log_sys->mutex));
 
-		return;
+		if (wait == LOG_NO_WAIT) {
+
+			return;
+		}
+
+		os_thread_yield();
+
+		goto loop;
 	}
 
 #ifdef UNIV_DEBUG
 	if (log_debug_writes) {
 		fprintf(stderr,
 			"Writing log from " LSN_PF " up to lsn " LSN_PF "\n",
-			log_sys->written_to_all_lsn,
-			log_sys->lsn);
+			start_lsn, end_lsn);
 	}
 #endif /* UNIV_DEBUG */
 	log_sys->n_pending_writes++;
@@ -1545,37 +1660,25 @@ loop:
 	os_event_reset(log_sys->no_flush_event);
 	os_event_reset(log_sys->one_flushed_event);
 
-	start_offset = log_sys->buf_next_to_write;
-	end_offset = log_sys->buf_free;
+	area_start = ut_uint64_align_down(start_lsn, OS_FILE_LOG_BLOCK_SIZE);
+	area_end = ut_uint64_align_up(end_lsn, OS_FILE_LOG_BLOCK_SIZE);
 
-	area_start = ut_calc_align_down(start_offset, OS_FILE_LOG_BLOCK_SIZE);
-	area_end = ut_calc_align(end_offset, OS_FILE_LOG_BLOCK_SIZE);
-
-	ut_ad(area_end - area_start > 0);
-
-	log_sys->write_lsn = log_sys->lsn;
+	log_sys->write_lsn = end_lsn;
 
 	if (flush_to_disk) {
-		log_sys->current_flush_lsn = log_sys->lsn;
+		log_sys->current_flush_lsn = end_lsn;
 	}
 
 	log_sys->one_flushed = FALSE;
 
-	log_block_set_flush_bit(log_sys->buf + area_start, TRUE);
-	log_block_set_checkpoint_no(
-		log_sys->buf + area_end - OS_FILE_LOG_BLOCK_SIZE,
-		log_sys->next_checkpoint_no);
+	/* Copy the blocks to the write buffer, so that other threads can
+	keep catenating log records to the last, incompletely written, log
+	block while we write */
 
-	/* Copy the last, incompletely written, log block a log block length
-	up, so that when the flush operation writes from the log buffer, the
-	segment to write will not be changed by writers to the log */
+	log_buffer_prepare_write(start_lsn, end_lsn);
 
-	ut_memcpy(log_sys->buf + area_end,
-		  log_sys->buf + area_end - OS_FILE_LOG_BLOCK_SIZE,
-		  OS_FILE_LOG_BLOCK_SIZE);
-
-	log_sys->buf_free += OS_FILE_LOG_BLOCK_SIZE;
-	log_sys->write_end_offset = log_sys->buf_free;
+	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
+		    end_lsn - log_sys->last_checkpoint_lsn);
 
 	group = UT_LIST_GET_FIRST(log_sys->log_groups);
 
@@ -1583,11 +1686,9 @@ loop:
 
 	while (group) {
 		log_group_write_buf(
-			group, log_sys->buf + area_start,
-			area_end - area_start,
-			ut_uint64_align_down(log_sys->written_to_all_lsn,
-					     OS_FILE_LOG_BLOCK_SIZE),
-			start_offset - area_start);
+			group, log_sys->write_buf,
+			(ulint) (area_end - area_start),
+			area_start, (ulint) (start_lsn - area_start));
 
 		log_group_set_fields(group, log_sys->write_lsn);
 
@@ -1628,6 +1729,13 @@ loop:
 
 	mutex_exit(&(log_sys->mutex));
 
+	if (end_lsn < lsn && wait != LOG_NO_WAIT) {
+		/* Some of the log up to lsn was not yet copied to the
+		log buffer when we started the write */
+
+		goto loop;
+	}
+
 	return;
 
 do_waits:
@@ -1649,6 +1757,324 @@ do_waits:
 	}
 }
 
+/******************************************************//**
+Gets the event on which the threads waiting for the log writer or flusher
+thread to reach an lsn sleep.
+@return	event of the log block which contains lsn */
+UNIV_INLINE
+os_event_t
+log_get_wait_event(
+/*===============*/
+	os_event_t*	events,	/*!< in: log_sys->write_events or
+				log_sys->flush_events */
+	lsn_t		lsn)	/*!< in: lsn */
+{
+	return(events[(lsn / OS_FILE_LOG_BLOCK_SIZE) % LOG_N_EVENTS]);
+}
+
+/******************************************************//**
+Wakes up the threads waiting for an lsn in the range (start_lsn, end_lsn]
+that the log writer or flusher thread has just reached. */
+static
+void
+log_notify_waiters(
+/*===============*/
+	os_event_t*	events,		/*!< in: log_sys->write_events or
+					log_sys->flush_events */
+	lsn_t		start_lsn,	/*!< in: lsn previously reached */
+	lsn_t		end_lsn)	/*!< in: lsn reached now */
+{
+	lsn_t	lsn;
+
+	ut_ad(end_lsn > start_lsn);
+
+	if (end_lsn - start_lsn
+	    >= (lsn_t) LOG_N_EVENTS * OS_FILE_LOG_BLOCK_SIZE) {
+
+		start_lsn = end_lsn
+			- (lsn_t) (LOG_N_EVENTS - 1) * OS_FILE_LOG_BLOCK_SIZE;
+	}
+
+	/* The waiters for lsns within the log block of start_lsn and
+	end_lsn sleep on the same event as the ones that were or are
+	still not reached: they will check their lsn again. */
+
+	for (lsn = ut_uint64_align_down(start_lsn, OS_FILE_LOG_BLOCK_SIZE);
+	     lsn <= end_lsn;
+	     lsn += OS_FILE_LOG_BLOCK_SIZE) {
+
+		os_event_set(log_get_wait_event(events, lsn));
+	}
+}
+
+/******************************************************//**
+Waits for the log writer thread to write, and if requested, the log flusher
+thread to flush the log up to lsn.
+@return	true if the lsn was reached, false if the threads are no longer
+running and the caller should do the write itself */
+static
+bool
+log_wait_for_threads(
+/*=================*/
+	lsn_t	lsn,		/*!< in: lsn to wait for */
+	ibool	flush_to_disk)	/*!< in: TRUE if the log should also
+				be flushed to disk */
+{
+	os_event_t	event;
+
+	event = log_get_wait_event(flush_to_disk
+				   ? log_sys->flush_events
+				   : log_sys->write_events, lsn);
+
+	for (;;) {
+		ib_int64_t	sig_count = os_event_reset(event);
+
+		if (flush_to_disk
+		    ? log_sys->flushed_to_disk_lsn >= lsn
+		    : log_sys->written_to_all_lsn >= lsn) {
+
+			return(true);
+		}
+
+		if (!log_writer_is_active || !log_flusher_is_active) {
+
+			return(false);
+		}
+
+		os_event_set(log_sys->writer_event);
+
+		os_event_wait_time_low(event, LOG_WAIT_TIMEOUT, sig_count);
+	}
+}
+
+/******************************************************//**
+This function is called, e.g., when a transaction wants to commit. It checks
+that the log has been written to the log file up to the last log entry written
+by the transaction. If the log writer and flusher threads are running, the
+write and the flush are left to them and this waits to be woken up by them;
+otherwise the calling thread writes the log itself. */
+UNIV_INTERN
+void
+log_write_up_to(
+/*============*/
+	lsn_t	lsn,	/*!< in: log sequence number up to which
+			the log should be written,
+			LSN_MAX if not specified */
+	ulint	wait,	/*!< in: LOG_NO_WAIT, LOG_WAIT_ONE_GROUP,
+			or LOG_WAIT_ALL_GROUPS */
+	ibool	flush_to_disk)
+			/*!< in: TRUE if we want the written log
+			also to be flushed to disk */
+{
+	ut_ad(!srv_read_only_mode);
+
+	if (recv_no_ibuf_operations) {
+		/* Recovery is running and no operations on the log files are
+		allowed yet (the variable name .._no_ibuf_.. is misleading) */
+
+		return;
+	}
+
+	/* We need not wait for log records catenated after this call */
+
+	lsn = ut_min(lsn, log_get_lsn());
+
+	if (log_writer_is_active && log_flusher_is_active) {
+
+		if (wait == LOG_NO_WAIT) {
+			/* The log flusher thread flushes whatever
+			the log writer thread writes */
+
+			os_event_set(log_sys->writer_event);
+
+			return;
+		}
+
+		/* There is only one log group: LOG_WAIT_ONE_GROUP and
+		LOG_WAIT_ALL_GROUPS are the same thing */
+
+		if (log_wait_for_threads(lsn, flush_to_disk)) {
+
+			return;
+		}
+	}
+
+	log_write_up_to_low(lsn, wait, flush_to_disk);
+}
+
+/******************************************************//**
+Flushes the log files up to the lsn written so far. Called by the log
+flusher thread only. */
+static
+void
+log_flush_written(void)
+/*===================*/
+{
+	log_group_t*	group;
+	lsn_t		lsn;
+
+	mutex_enter(&log_sys->mutex);
+	lsn = log_sys->written_to_all_lsn;
+	mutex_exit(&log_sys->mutex);
+
+	if (log_sys->flushed_to_disk_lsn >= lsn) {
+
+		return;
+	}
+
+	group = UT_LIST_GET_FIRST(log_sys->log_groups);
+
+	fil_flush(group->space_id);
+
+	mutex_enter(&log_sys->mutex);
+
+	if (lsn > log_sys->flushed_to_disk_lsn) {
+		log_sys->flushed_to_disk_lsn = lsn;
+	}
+
+	mutex_exit(&log_sys->mutex);
+}
+
+/******************************************************************//**
+The log writer thread. Writes the log records that have been copied to the
+log buffer to the log files as soon as they are available, and wakes up
+the threads waiting for them to be written and the log flusher thread.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_writer_thread)(
+/*==============================*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	ut_ad(!srv_read_only_mode);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(log_writer_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "InnoDB: log writer thread running, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
+	log_writer_is_active = true;
+
+	for (;;) {
+		ib_int64_t	sig_count;
+		lsn_t		start_lsn;
+		lsn_t		end_lsn;
+
+		sig_count = os_event_reset(log_sys->writer_event);
+
+		start_lsn = log_sys->written_to_all_lsn;
+
+		log_write_up_to_low(log_get_lsn(), LOG_NO_WAIT, FALSE);
+
+		end_lsn = log_sys->written_to_all_lsn;
+
+		if (end_lsn > start_lsn) {
+
+			log_notify_waiters(log_sys->write_events,
+					   start_lsn, end_lsn);
+
+			os_event_set(log_sys->flusher_event);
+
+			/* More log has probably been copied to the log
+			buffer meanwhile: write it without sleeping */
+
+			continue;
+		}
+
+		if (srv_shutdown_state >= SRV_SHUTDOWN_LAST_PHASE) {
+
+			break;
+		}
+
+		os_event_wait_time_low(log_sys->writer_event,
+				       LOG_THREAD_IDLE_TIMEOUT, sig_count);
+	}
+
+	log_writer_is_active = false;
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/******************************************************************//**
+The log flusher thread. Flushes the log files after the log writer thread
+has written to them, and wakes up the threads waiting for the log to be
+flushed to disk. Every flush covers all the writes done since the previous
+one, whichever thread requested them.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_flusher_thread)(
+/*===============================*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	lsn_t	notified_lsn;
+
+	ut_ad(!srv_read_only_mode);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(log_flusher_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "InnoDB: log flusher thread running, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
+	notified_lsn = log_sys->flushed_to_disk_lsn;
+
+	log_flusher_is_active = true;
+
+	for (;;) {
+		ib_int64_t	sig_count;
+		lsn_t		flushed_lsn;
+
+		sig_count = os_event_reset(log_sys->flusher_event);
+
+		/* With O_DSYNC the log writer thread already advanced
+		flushed_to_disk_lsn, and there is nothing to flush. */
+
+		log_flush_written();
+
+		flushed_lsn = log_sys->flushed_to_disk_lsn;
+
+		if (flushed_lsn > notified_lsn) {
+
+			log_notify_waiters(log_sys->flush_events,
+					   notified_lsn, flushed_lsn);
+
+			notified_lsn = flushed_lsn;
+
+			continue;
+		}
+
+		if (srv_shutdown_state >= SRV_SHUTDOWN_LAST_PHASE) {
+
+			break;
+		}
+
+		os_event_wait_time_low(log_sys->flusher_event,
+				       LOG_THREAD_IDLE_TIMEOUT, sig_count);
+	}
+
+	log_flusher_is_active = false;
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /****************************************************************//**
 Does a syncronous flush of the log buffer to disk. */
 UNIV_INTERN
@@ -1656,16 +2082,9 @@ void
 log_buffer_flush_to_disk(void)
 /*==========================*/
 {
-	lsn_t	lsn;
-
 	ut_ad(!srv_read_only_mode);
-	mutex_enter(&(log_sys->mutex));
-
-	lsn = log_sys->lsn;
-
-	mutex_exit(&(log_sys->mutex));
 
-	log_write_up_to(lsn, LOG_WAIT_ALL_GROUPS, TRUE);
+	log_write_up_to(log_get_lsn(), LOG_WAIT_ALL_GROUPS, TRUE);
 }
 
 /****************************************************************//**
@@ -1679,15 +2098,7 @@ log_buffer_sync_in_background(
 /*==========================*/
 	ibool	flush)	/*!< in: flush the logs to disk */
 {
-	lsn_t	lsn;
-
-	mutex_enter(&(log_sys->mutex));
-
-	lsn = log_sys->lsn;
-
-	mutex_exit(&(log_sys->mutex));
-
-	log_write_up_to(lsn, LOG_NO_WAIT, flush);
+	log_write_up_to(log_get_lsn(), LOG_NO_WAIT, flush);
 }
 
 /********************************************************************
@@ -1704,13 +2115,13 @@ log_flush_margin(void)
 
 	mutex_enter(&(log->mutex));
 
-	if (log->buf_free > log->max_buf_free) {
+	if (log_get_lsn() - log->written_to_all_lsn > log->max_buf_free) {
 
 		if (log->n_pending_writes > 0) {
 			/* A flush is running: hope that it will provide enough
 			free space */
 		} else {
-			lsn = log->lsn;
+			lsn = log_get_lsn();
 		}
 	}
 
@@ -1781,7 +2192,7 @@ log_complete_checkpoint(void)
 
 	log_sys->last_checkpoint_lsn = log_sys->next_checkpoint_lsn;
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
-		    log_sys->lsn - log_sys->last_checkpoint_lsn);
+		    log_get_lsn() - log_sys->last_checkpoint_lsn);
 
 	rw_lock_x_unlock_gen(&(log_sys->checkpoint_lock), LOG_CHECKPOINT);
 }
@@ -2102,7 +2513,7 @@ log_checkpoint(
 
 	/* Because log also contains headers and dummy log records,
 	if the buffer pool contains no dirty buffers, oldest_lsn
-	gets the value log_sys->lsn from the previous function,
+	gets the current lsn from the previous function,
 	and we must make sure that the log is flushed up to that
 	lsn. If there are dirty buffers in the buffer pool, then our
 	write-ahead-logging algorithm ensures that the log has been flushed
@@ -2224,7 +2635,7 @@ loop:
 
 	oldest_lsn = log_buf_pool_get_oldest_modification();
 
-	age = log->lsn - oldest_lsn;
+	age = log_get_lsn() - oldest_lsn;
 
 	if (age > log->max_modified_age_sync) {
 
@@ -2232,7 +2643,7 @@ loop:
 		advance = 2 * (age - log->max_modified_age_sync);
 	}
 
-	checkpoint_age = log->lsn - log->last_checkpoint_lsn;
+	checkpoint_age = log_get_lsn() - log->last_checkpoint_lsn;
 
 	if (checkpoint_age > log->max_checkpoint_age) {
 		/* A checkpoint is urgent: we do it synchronously */
@@ -2781,10 +3192,10 @@ arch_none:
 
 		*n_bytes = log_sys->archive_buf_size;
 
-		if (limit_lsn >= log_sys->lsn) {
+		if (limit_lsn >= log_get_lsn()) {
 
 			limit_lsn = ut_uint64_align_down(
-				log_sys->lsn, OS_FILE_LOG_BLOCK_SIZE);
+				log_get_lsn(), OS_FILE_LOG_BLOCK_SIZE);
 		}
 	}
 
@@ -2870,7 +3281,7 @@ log_archive_all(void)
 		return;
 	}
 
-	present_lsn = log_sys->lsn;
+	present_lsn = log_get_lsn();
 
 	mutex_exit(&(log_sys->mutex));
 
@@ -3084,7 +3495,7 @@ log_archive_archivelog(void)
 		log_sys->archiving_state = LOG_ARCH_ON;
 
 		log_sys->archived_lsn
-			= ut_uint64_align_down(log_sys->lsn,
+			= ut_uint64_align_down(log_get_lsn(),
 					       OS_FILE_LOG_BLOCK_SIZE);
 		mutex_exit(&(log_sys->mutex));
 
@@ -3118,7 +3529,7 @@ loop:
 		return;
 	}
 
-	age = log->lsn - log->archived_lsn;
+	age = log_get_lsn() - log->archived_lsn;
 
 	if (age > log->max_archived_lsn_age) {
 
@@ -3183,6 +3594,24 @@ loop:
 	mutex_exit(&(log_sys->mutex));
 }
 
+/****************************************************************//**
+Wakes up the log writer and flusher threads and waits for them to exit.
+Must be called after srv_shutdown_state has been set to
+SRV_SHUTDOWN_LAST_PHASE, when no more log is being generated. */
+static
+void
+log_wait_for_threads_to_exit(void)
+/*==============================*/
+{
+	ut_ad(srv_shutdown_state >= SRV_SHUTDOWN_LAST_PHASE);
+
+	while (log_writer_is_active || log_flusher_is_active) {
+		os_event_set(log_sys->writer_event);
+		os_event_set(log_sys->flusher_event);
+		os_thread_sleep(10000);
+	}
+}
+
 /****************************************************************//**
 Makes a checkpoint at the latest lsn and writes it to first page of each
 data file in the database, so that we know that the file spaces contain
@@ -3382,6 +3811,8 @@ loop:
 
 		srv_shutdown_state = SRV_SHUTDOWN_LAST_PHASE;
 
+		log_wait_for_threads_to_exit();
+
 		fil_close_all_files();
 
 		thread_name = srv_any_background_threads_are_active();
@@ -3397,7 +3828,7 @@ loop:
 
 	mutex_enter(&log_sys->mutex);
 
-	lsn = log_sys->lsn;
+	lsn = log_get_lsn();
 
 	if (lsn != log_sys->last_checkpoint_lsn
 #ifdef UNIV_LOG_ARCHIVE
@@ -3459,6 +3890,8 @@ loop:
 
 	srv_shutdown_state = SRV_SHUTDOWN_LAST_PHASE;
 
+	log_wait_for_threads_to_exit();
+
 	/* Make some checks that the server really is quiet */
 	srv_thread_type	type = srv_get_active_thread_type();
 	ut_a(type == SRV_NONE);
@@ -3466,7 +3899,7 @@ loop:
 	bool	freed = buf_all_freed();
 	ut_a(freed);
 
-	ut_a(lsn == log_sys->lsn);
+	ut_a(lsn == log_get_lsn());
 
 	if (lsn < srv_start_lsn) {
 		ib_logf(IB_LOG_LEVEL_ERROR,
@@ -3492,60 +3925,8 @@ loop:
 	freed = buf_all_freed();
 	ut_a(freed);
 
-	ut_a(lsn == log_sys->lsn);
-}
-
-#ifdef UNIV_LOG_DEBUG
-/******************************************************//**
-Checks by parsing that the catenated log segment for a single mtr is
-consistent. */
-UNIV_INTERN
-ibool
-log_check_log_recs(
-/*===============*/
-	const byte*	buf,		/*!< in: pointer to the start of
-					the log segment in the
-					log_sys->buf log buffer */
-	ulint		len,		/*!< in: segment length in bytes */
-	ib_uint64_t	buf_start_lsn)	/*!< in: buffer start lsn */
-{
-	ib_uint64_t	contiguous_lsn;
-	ib_uint64_t	scanned_lsn;
-	const byte*	start;
-	const byte*	end;
-	byte*		buf1;
-	byte*		scan_buf;
-
-	ut_ad(mutex_own(&(log_sys->mutex)));
-
-	if (len == 0) {
-
-		return(TRUE);
-	}
-
-	start = ut_align_down(buf, OS_FILE_LOG_BLOCK_SIZE);
-	end = ut_align(buf + len, OS_FILE_LOG_BLOCK_SIZE);
-
-	buf1 = mem_alloc((end - start) + OS_FILE_LOG_BLOCK_SIZE);
-	scan_buf = ut_align(buf1, OS_FILE_LOG_BLOCK_SIZE);
-
-	ut_memcpy(scan_buf, start, end - start);
-
-	recv_scan_log_recs((buf_pool_get_n_pages()
-			   - (recv_n_pool_free_frames * srv_buf_pool_instances))
-			   * UNIV_PAGE_SIZE, FALSE, scan_buf, end - start,
-			   ut_uint64_align_down(buf_start_lsn,
-						OS_FILE_LOG_BLOCK_SIZE),
-			   &contiguous_lsn, &scanned_lsn);
-
-	ut_a(scanned_lsn == buf_start_lsn + len);
-	ut_a(recv_sys->recovered_lsn == scanned_lsn);
-
-	mem_free(buf1);
-
-	return(TRUE);
+	ut_a(lsn == log_get_lsn());
 }
-#endif /* UNIV_LOG_DEBUG */
 
 /******************************************************//**
 Peeks the current lsn.
@@ -3557,7 +3938,7 @@ log_peek_lsn(
 	lsn_t*	lsn)	/*!< out: if returns TRUE, current lsn is here */
 {
 	if (0 == mutex_enter_nowait(&(log_sys->mutex))) {
-		*lsn = log_sys->lsn;
+		*lsn = log_get_lsn();
 
 		mutex_exit(&(log_sys->mutex));
 
@@ -3585,7 +3966,7 @@ log_print(
 		"Log flushed up to   " LSN_PF "\n"
 		"Pages flushed up to " LSN_PF "\n"
 		"Last checkpoint at  " LSN_PF "\n",
-		log_sys->lsn,
+		log_get_lsn(),
 		log_sys->flushed_to_disk_lsn,
 		log_buf_pool_get_oldest_modification(),
 		log_sys->last_checkpoint_lsn);
@@ -3687,6 +4068,11 @@ log_shutdown(void)
 
 	mem_free(log_sys->buf_ptr);
 	log_sys->buf_ptr = NULL;
+	mem_free(log_sys->buf_copied);
+	log_sys->buf_copied = NULL;
+	mem_free(log_sys->write_buf_ptr);
+	log_sys->write_buf_ptr = NULL;
+	log_sys->write_buf = NULL;
 	log_sys->buf = NULL;
 	mem_free(log_sys->checkpoint_buf_ptr);
 	log_sys->checkpoint_buf_ptr = NULL;
@@ -3695,6 +4081,19 @@ log_shutdown(void)
 	os_event_free(log_sys->no_flush_event);
 	os_event_free(log_sys->one_flushed_event);
 
+	os_event_free(log_sys->writer_event);
+	os_event_free(log_sys->flusher_event);
+
+	for (ulint i = 0; i < LOG_N_EVENTS; i++) {
+		os_event_free(log_sys->write_events[i]);
+		os_event_free(log_sys->flush_events[i]);
+	}
+
+	mem_free(log_sys->write_events);
+	log_sys->write_events = NULL;
+	mem_free(log_sys->flush_events);
+	log_sys->flush_events = NULL;
+
 	rw_lock_free(&log_sys->checkpoint_lock);
 
 	mutex_free(&log_sys->mutex);
@@ -71,6 +71,10 @@ this must be less than UNIV_PAGE_SIZE as it is stored in the buffer pool */
 /** Read-ahead area in applying log records to file pages */
 #define RECV_READ_AHEAD_AREA	32
 
+/** Interval in seconds between the progress messages printed while
+applying log records */
+#define RECV_APPLY_PROGRESS_INTERVAL	10
+
 /** The recovery system */
 UNIV_INTERN recv_sys_t*	recv_sys = NULL;
 /** TRUE when applying redo log records during crash recovery; FALSE
@@ -166,6 +170,7 @@ UNIV_INTERN mysql_pfs_key_t	recv_sys_mutex_key;
 #ifndef UNIV_HOTBACKUP
 # ifdef UNIV_PFS_THREAD
 UNIV_INTERN mysql_pfs_key_t	recv_writer_thread_key;
+UNIV_INTERN mysql_pfs_key_t	recv_apply_thread_key;
 # endif /* UNIV_PFS_THREAD */
 
 # ifdef UNIV_PFS_MUTEX
@@ -414,6 +419,7 @@ recv_sys_init(
 
 	recv_sys->addr_hash = hash_create(available_memory / 512);
 	recv_sys->n_addrs = 0;
+	recv_sys->n_apply_threads = 0;
 
 	recv_sys->apply_log_recs = FALSE;
 	recv_sys->apply_batch_on = FALSE;
@@ -1830,48 +1836,28 @@ recv_read_in_area(
 }
 
 /*******************************************************************//**
-Empties the hash table of stored log records, applying them to appropriate
-pages. */
-UNIV_INTERN
+Applies the hashed log records in the hash cells of one apply worker: the
+cells whose number modulo the number of workers is the worker number. A
+page found in the buffer pool is recovered in the calling thread; the
+other pages are read in, together with their neighbours that have log
+records too, with asynchronous reads, and recovered by the i/o handler
+threads when the reads complete. */
+static
 void
-recv_apply_hashed_log_recs(
-/*=======================*/
-	ibool	allow_ibuf)	/*!< in: if TRUE, also ibuf operations are
-				allowed during the application; if FALSE,
-				no ibuf operations are allowed, and after
-				the application all file pages are flushed to
-				disk and invalidated in buffer pool: this
-				alternative means that no new log records
-				can be generated during the application;
-				the caller must in this case own the log
-				mutex */
+recv_apply_hashed_log_recs_low(
+/*===========================*/
+	ulint	worker_no,	/*!< in: number of the apply worker */
+	ulint	n_workers)	/*!< in: number of apply workers */
 {
-	recv_addr_t* recv_addr;
-	ulint	i;
-	ibool	has_printed	= FALSE;
-	mtr_t	mtr;
-loop:
-	mutex_enter(&(recv_sys->mutex));
-
-	if (recv_sys->apply_batch_on) {
-
-		mutex_exit(&(recv_sys->mutex));
-
-		os_thread_sleep(500000);
-
-		goto loop;
-	}
-
-	ut_ad(!allow_ibuf == mutex_own(&log_sys->mutex));
-
-	if (!allow_ibuf) {
-		recv_no_ibuf_operations = TRUE;
-	}
+	recv_addr_t*	recv_addr;
+	ulint		i;
+	mtr_t		mtr;
 
-	recv_sys->apply_log_recs = TRUE;
-	recv_sys->apply_batch_on = TRUE;
+	mutex_enter(&(recv_sys->mutex));
 
-	for (i = 0; i < hash_get_n_cells(recv_sys->addr_hash); i++) {
+	for (i = worker_no;
+	     i < hash_get_n_cells(recv_sys->addr_hash);
+	     i += n_workers) {
 
 		for (recv_addr = static_cast<recv_addr_t*>(
 				HASH_GET_FIRST(recv_sys->addr_hash, i));
@@ -1884,15 +1870,6 @@ loop:
 			ulint	page_no = recv_addr->page_no;
 
 			if (recv_addr->state == RECV_NOT_PROCESSED) {
-				if (!has_printed) {
-					ib_logf(IB_LOG_LEVEL_INFO,
-						"Starting an apply batch"
-						" of log records"
-						" to the database...");
-					fputs("InnoDB: Progress in percent: ",
-					      stderr);
-					has_printed = TRUE;
-				}
 
 				mutex_exit(&(recv_sys->mutex));
 
@@ -1917,32 +1894,145 @@ loop:
 				mutex_enter(&(recv_sys->mutex));
 			}
 		}
+	}
 
-		if (has_printed
-		    && (i * 100) / hash_get_n_cells(recv_sys->addr_hash)
-		    != ((i + 1) * 100)
-		    / hash_get_n_cells(recv_sys->addr_hash)) {
+	mutex_exit(&(recv_sys->mutex));
+}
 
-			fprintf(stderr, "%lu ", (ulong)
-				((i * 100)
-				 / hash_get_n_cells(recv_sys->addr_hash)));
-		}
-	}
+/******************************************************************//**
+Worker thread of the application of hashed log records. Applies the log
+records of its share of the hash cells and exits.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(recv_apply_thread)(
+/*==============================*/
+	void*	arg)	/*!< in: pointer to the number of the worker */
+{
+	ulint	worker_no = *static_cast<ulint*>(arg);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(recv_apply_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "InnoDB: recv_apply thread %lu running, id %lu\n",
+		worker_no, os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
+	recv_apply_hashed_log_recs_low(worker_no, srv_n_recovery_apply_threads);
+
+	mutex_enter(&(recv_sys->mutex));
+	ut_ad(recv_sys->n_apply_threads > 0);
+	recv_sys->n_apply_threads--;
+	mutex_exit(&(recv_sys->mutex));
 
-	/* Wait until all the pages have been processed */
+	/* We count the number of threads in os_thread_exit().
+	A created thread should always use that to exit and not
+	use return() to exit. */
+	os_thread_exit(NULL);
 
-	while (recv_sys->n_addrs != 0) {
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*******************************************************************//**
+Empties the hash table of stored log records, applying them to appropriate
+pages. The hash cells are divided between innodb_recovery_apply_threads
+worker threads, while this thread reports the progress. */
+UNIV_INTERN
+void
+recv_apply_hashed_log_recs(
+/*=======================*/
+	ibool	allow_ibuf)	/*!< in: if TRUE, also ibuf operations are
+				allowed during the application; if FALSE,
+				no ibuf operations are allowed, and after
+				the application all file pages are flushed to
+				disk and invalidated in buffer pool: this
+				alternative means that no new log records
+				can be generated during the application;
+				the caller must in this case own the log
+				mutex */
+{
+	ulint	worker_nos[RECV_MAX_APPLY_THREADS];
+	ulint	i;
+	ibool	has_printed	= FALSE;
+	ulint	n_total;
+	ulint	n_last;
+	ulint	start_time;
+	ulint	last_time;
+loop:
+	mutex_enter(&(recv_sys->mutex));
+
+	if (recv_sys->apply_batch_on) {
 
 		mutex_exit(&(recv_sys->mutex));
 
 		os_thread_sleep(500000);
 
-		mutex_enter(&(recv_sys->mutex));
+		goto loop;
 	}
 
-	if (has_printed) {
+	ut_ad(!allow_ibuf == mutex_own(&log_sys->mutex));
 
-		fprintf(stderr, "\n");
+	if (!allow_ibuf) {
+		recv_no_ibuf_operations = TRUE;
+	}
+
+	recv_sys->apply_log_recs = TRUE;
+	recv_sys->apply_batch_on = TRUE;
+
+	n_total = n_last = recv_sys->n_addrs;
+	start_time = last_time = ut_time_ms();
+
+	if (n_total > 0) {
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Starting an apply batch of log records"
+			" to the database: %lu pages, %lu threads...",
+			(ulong) n_total, (ulong) srv_n_recovery_apply_threads);
+		has_printed = TRUE;
+	}
+
+	ut_a(srv_n_recovery_apply_threads <= RECV_MAX_APPLY_THREADS);
+
+	recv_sys->n_apply_threads = srv_n_recovery_apply_threads;
+
+	for (i = 0; i < srv_n_recovery_apply_threads; i++) {
+		worker_nos[i] = i;
+		os_thread_create(recv_apply_thread, worker_nos + i, NULL);
+	}
+
+	/* Wait until the workers have gone through their hash cells
+	and all the pages have been processed, also the ones that are
+	recovered by the i/o handler threads when they are read in */
+
+	while (recv_sys->n_apply_threads > 0 || recv_sys->n_addrs != 0) {
+		ulint	now;
+
+		mutex_exit(&(recv_sys->mutex));
+
+		os_thread_sleep(100000);
+
+		mutex_enter(&(recv_sys->mutex));
+
+		now = ut_time_ms();
+
+		if (has_printed
+		    && now - last_time
+		    >= RECV_APPLY_PROGRESS_INTERVAL * 1000) {
+
+			ib_logf(IB_LOG_LEVEL_INFO,
+				"Applied log records to %lu of %lu pages"
+				" (%lu%%), %lu pages/s",
+				(ulong) (n_total - recv_sys->n_addrs),
+				(ulong) n_total,
+				(ulong) ((n_total - recv_sys->n_addrs)
+					 * 100 / n_total),
+				(ulong) ((n_last - recv_sys->n_addrs)
+					 * 1000 / (now - last_time)));
+
+			n_last = recv_sys->n_addrs;
+			last_time = now;
+		}
 	}
 
 	if (!allow_ibuf) {
@@ -1986,7 +2076,13 @@ loop:
 	recv_sys_empty_hash();
 
 	if (has_printed) {
-		fprintf(stderr, "InnoDB: Apply batch completed\n");
+		ulint	elapsed = ut_time_ms() - start_time;
+
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Apply batch completed: %lu pages in %lu ms,"
+			" %lu pages/s",
+			(ulong) n_total, (ulong) elapsed,
+			(ulong) (n_total * 1000 / ut_max(elapsed, 1)));
 	}
 
 	mutex_exit(&(recv_sys->mutex));
@@ -2191,11 +2287,7 @@ recv_parse_log_rec(
 #ifdef UNIV_LOG_LSN_DEBUG
 	if (*type == MLOG_LSN) {
 		lsn_t	lsn = (lsn_t) *space << 32 | *page_no;
-# ifdef UNIV_LOG_DEBUG
-		ut_a(lsn == log_sys->old_lsn);
-# else /* UNIV_LOG_DEBUG */
 		ut_a(lsn == recv_sys->recovered_lsn);
-# endif /* UNIV_LOG_DEBUG */
 	}
 #endif /* UNIV_LOG_LSN_DEBUG */
 
@@ -3323,19 +3415,15 @@ recv_recovery_from_checkpoint_start_func(
 		srv_start_lsn = recv_sys->recovered_lsn;
 	}
 
-	log_sys->lsn = recv_sys->recovered_lsn;
+	log_buffer_reset(recv_sys->recovered_lsn, recv_sys->last_block);
 
-	ut_memcpy(log_sys->buf, recv_sys->last_block, OS_FILE_LOG_BLOCK_SIZE);
-
-	log_sys->buf_free = (ulint) log_sys->lsn % OS_FILE_LOG_BLOCK_SIZE;
-	log_sys->buf_next_to_write = log_sys->buf_free;
-	log_sys->written_to_some_lsn = log_sys->lsn;
-	log_sys->written_to_all_lsn = log_sys->lsn;
+	log_sys->written_to_some_lsn = recv_sys->recovered_lsn;
+	log_sys->written_to_all_lsn = recv_sys->recovered_lsn;
 
 	log_sys->last_checkpoint_lsn = checkpoint_lsn;
 
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
-		    log_sys->lsn - log_sys->last_checkpoint_lsn);
+		    log_get_lsn() - log_sys->last_checkpoint_lsn);
 
 	log_sys->next_checkpoint_no = checkpoint_no + 1;
 
@@ -3513,12 +3601,12 @@ recv_reset_logs(
 
 	ut_ad(mutex_own(&(log_sys->mutex)));
 
-	log_sys->lsn = ut_uint64_align_up(lsn, OS_FILE_LOG_BLOCK_SIZE);
+	lsn = ut_uint64_align_up(lsn, OS_FILE_LOG_BLOCK_SIZE);
 
 	group = UT_LIST_GET_FIRST(log_sys->log_groups);
 
 	while (group) {
-		group->lsn = log_sys->lsn;
+		group->lsn = lsn;
 		group->lsn_offset = LOG_FILE_HDR_SIZE;
 #ifdef UNIV_LOG_ARCHIVE
 		group->archived_file_no = arch_log_no;
@@ -3533,25 +3621,20 @@ recv_reset_logs(
 		group = UT_LIST_GET_NEXT(log_groups, group);
 	}
 
-	log_sys->buf_next_to_write = 0;
-	log_sys->written_to_some_lsn = log_sys->lsn;
-	log_sys->written_to_all_lsn = log_sys->lsn;
+	log_sys->written_to_some_lsn = lsn;
+	log_sys->written_to_all_lsn = lsn;
 
 	log_sys->next_checkpoint_no = 0;
 	log_sys->last_checkpoint_lsn = 0;
 
 #ifdef UNIV_LOG_ARCHIVE
-	log_sys->archived_lsn = log_sys->lsn;
+	log_sys->archived_lsn = lsn;
 #endif /* UNIV_LOG_ARCHIVE */
 
-	log_block_init(log_sys->buf, log_sys->lsn);
-	log_block_set_first_rec_group(log_sys->buf, LOG_BLOCK_HDR_SIZE);
-
-	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
-	log_sys->lsn += LOG_BLOCK_HDR_SIZE;
+	log_buffer_reset(lsn + LOG_BLOCK_HDR_SIZE, NULL);
 
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
-		    (log_sys->lsn - log_sys->last_checkpoint_lsn));
+		    (log_get_lsn() - log_sys->last_checkpoint_lsn));
 
 	mutex_exit(&(log_sys->mutex));
 
@@ -197,40 +197,9 @@ mtr_memo_note_modifications(
 }
 
 /************************************************************//**
-Append the dirty pages to the flush list. */
-static
-void
-mtr_add_dirtied_pages_to_flush_list(
-/*================================*/
-	mtr_t*	mtr)	/*!< in/out: mtr */
-{
-	ut_ad(!srv_read_only_mode);
-
-	/* No need to acquire log_flush_order_mutex if this mtr has
-	not dirtied a clean page. log_flush_order_mutex is used to
-	ensure ordered insertions in the flush_list. We need to
-	insert in the flush_list iff the page in question was clean
-	before modifications. */
-	if (mtr->made_dirty) {
-		log_flush_order_mutex_enter();
-	}
-
-	/* It is now safe to release the log mutex because the
-	flush_order mutex will ensure that we are the first one
-	to insert into the flush list. */
-	log_release();
-
-	if (mtr->modifications) {
-		mtr_memo_note_modifications(mtr);
-	}
-
-	if (mtr->made_dirty) {
-		log_flush_order_mutex_exit();
-	}
-}
-
-/************************************************************//**
-Writes the contents of a mini-transaction log, if any, to the database log. */
+Writes the contents of a mini-transaction log, if any, to the database log.
+The log records are copied to the log buffer without holding log_sys->mutex,
+concurrently with other mini-transactions. */
 static
 void
 mtr_log_reserve_and_write(
@@ -240,6 +209,7 @@ mtr_log_reserve_and_write(
 	dyn_array_t*	mlog;
 	ulint		data_size;
 	byte*		first_data;
+	lsn_t		lsn;
 
 	ut_ad(!srv_read_only_mode);
 
@@ -254,50 +224,57 @@ mtr_log_reserve_and_write(
 				     | MLOG_SINGLE_REC_FLAG);
 	}
 
-	if (mlog->heap == NULL) {
-		ulint	len;
+	if (mtr->log_mode == MTR_LOG_ALL) {
 
-		len = mtr->log_mode != MTR_LOG_NO_REDO
-			? dyn_block_get_used(mlog) : 0;
+		data_size = dyn_array_get_data_size(mlog);
+	} else {
+		ut_ad(mtr->log_mode == MTR_LOG_NONE
+		      || mtr->log_mode == MTR_LOG_NO_REDO);
 
-		mtr->end_lsn = log_reserve_and_write_fast(
-			first_data, len, &mtr->start_lsn);
+		data_size = 0;
+	}
 
-		if (mtr->end_lsn) {
+	/* No need to acquire log_flush_order_mutex if this mtr has
+	not dirtied a clean page. log_flush_order_mutex is used to
+	ensure ordered insertions in the flush_list. We need to
+	insert in the flush_list iff the page in question was clean
+	before modifications. The lsn range must be reserved while
+	holding the mutex, so that the insertions happen in the
+	order of start_lsn. */
+	if (mtr->made_dirty) {
+		log_flush_order_mutex_enter();
+	}
 
-			/* Success. We have the log mutex.
-			Add pages to flush list and exit */
-			mtr_add_dirtied_pages_to_flush_list(mtr);
+	mtr->start_lsn = log_buffer_reserve(data_size, &mtr->end_lsn);
 
-			return;
-		}
+	if (mtr->modifications) {
+		mtr_memo_note_modifications(mtr);
 	}
 
-	data_size = dyn_array_get_data_size(mlog);
+	if (mtr->made_dirty) {
+		log_flush_order_mutex_exit();
+	}
 
-	/* Open the database log for log_write_low */
-	mtr->start_lsn = log_reserve_and_open(data_size);
+	/* The pages stay latched until the log records have been
+	copied, so they cannot be flushed before that. */
 
-	if (mtr->log_mode == MTR_LOG_ALL) {
+	lsn = mtr->start_lsn;
 
+	if (data_size > 0) {
 		for (dyn_block_t* block = mlog;
 		     block != 0;
 		     block = dyn_array_get_next_block(mlog, block)) {
 
-			log_write_low(
+			log_buffer_write(
 				dyn_block_get_data(block),
-				dyn_block_get_used(block));
+				dyn_block_get_used(block),
+				&lsn, mtr->end_lsn);
 		}
-
-	} else {
-		ut_ad(mtr->log_mode == MTR_LOG_NONE
-		      || mtr->log_mode == MTR_LOG_NO_REDO);
-		/* Do nothing */
 	}
 
-	mtr->end_lsn = log_close();
+	ut_ad(lsn == mtr->end_lsn);
 
-	mtr_add_dirtied_pages_to_flush_list(mtr);
+	log_buffer_close(mtr->end_lsn);
 }
 #endif /* !UNIV_HOTBACKUP */
 
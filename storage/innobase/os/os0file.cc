@@ -60,6 +60,15 @@ Created 10/21/1995 Heikki Tuuri
 #include <libaio.h>
 #endif
 
+#include "page0zip.h"
+#include <zlib.h>
+#ifdef HAVE_LZ4
+# include <lz4.h>
+#endif /* HAVE_LZ4 */
+#ifdef HAVE_FALLOC_PUNCH_HOLE_AND_KEEP_SIZE
+# include <linux/falloc.h>
+#endif /* HAVE_FALLOC_PUNCH_HOLE_AND_KEEP_SIZE */
+
 /** Insert buffer segment id */
 static const ulint IO_IBUF_SEGMENT = 0;
 
@@ -175,6 +184,15 @@ struct os_aio_slot_t{
 					and which can be used to identify
 					which pending aio operation was
 					completed */
+	os_file_compress_t* compress;	/*!< transparent page compression
+					of the file, or NULL */
+	byte*		compressed_buf;	/*!< if not NULL, buf points into
+					this memory, which holds the
+					compressed page to write and is
+					freed with the slot */
+	ulint		page_len;	/*!< size of the page before
+					compression; larger than len if
+					the page is written compressed */
 #ifdef WIN_ASYNC_IO
 	HANDLE		handle;		/*!< handle object we need in the
 					OVERLAPPED struct */
@@ -234,6 +252,16 @@ struct os_aio_array_t{
 				There is one such event for each
 				possible pending IO. The size of the
 				array is equal to n_slots. */
+	struct iocb**		pending;
+				/* Reads that have been requested with
+				OS_AIO_SIMULATED_WAKE_LATER but not
+				yet submitted to the kernel, see
+				os_aio_linux_defer(). There are
+				n_slots / n_segments entries for each
+				segment. Protected by mutex. */
+	ulint*			n_pending;
+				/* Number of requests in pending,
+				for each segment. Protected by mutex. */
 #endif /* LINUX_NATIV_AIO */
 };
 
@@ -246,6 +274,12 @@ struct os_aio_array_t{
 
 /** number of attempts before giving up on io_setup(). */
 #define OS_AIO_IO_SETUP_RETRY_ATTEMPTS	5
+
+/** maximum number of requests to submit with one io_submit() call. */
+#define OS_AIO_SUBMIT_BATCH		64
+
+/** time to sleep, in microseconds if io_submit() returns EAGAIN. */
+#define OS_AIO_SUBMIT_RETRY_SLEEP	(10000UL)
 #endif
 
 /** Array of events used in simulated aio */
@@ -2184,6 +2218,401 @@ os_file_set_eof(
 #endif /* __WIN__ */
 }
 
+/***********************************************************************//**
+Truncates or extends a file to the given size.
+@return	TRUE if success */
+UNIV_INTERN
+ibool
+os_file_truncate(
+/*=============*/
+	const char*	name,	/*!< in: name of the file, for messages */
+	os_file_t	file,	/*!< in: handle to a file */
+	os_offset_t	size)	/*!< in: new file size in bytes */
+{
+#ifdef __WIN__
+	LARGE_INTEGER	length;
+	BOOL		success;
+
+	length.QuadPart = size;
+
+	success = SetFilePointerEx(file, length, NULL, FILE_BEGIN);
+
+	if (success) {
+		success = SetEndOfFile(file);
+	}
+
+	if (!success) {
+		os_file_handle_error_no_exit(name, "SetEndOfFile", FALSE);
+	}
+
+	return(success);
+#else /* __WIN__ */
+	if (ftruncate(file, size) != 0) {
+		os_file_handle_error_no_exit(name, "ftruncate", FALSE);
+
+		return(FALSE);
+	}
+
+	return(TRUE);
+#endif /* __WIN__ */
+}
+
+/***********************************************************************//**
+Checks whether InnoDB was built with a transparent page compression
+algorithm.
+@return	true if pages can be compressed and decompressed with it */
+UNIV_INTERN
+bool
+os_file_compression_is_supported(
+/*=============================*/
+	ulint	algorithm)	/*!< in: OS_FILE_COMPRESSION_ZLIB, ... */
+{
+	switch (algorithm) {
+	case OS_FILE_COMPRESSION_ZLIB:
+		return(true);
+	case OS_FILE_COMPRESSION_LZ4:
+#ifdef HAVE_LZ4
+		return(true);
+#else
+		return(false);
+#endif /* HAVE_LZ4 */
+	}
+
+	return(false);
+}
+
+/***********************************************************************//**
+Compresses data with a transparent page compression algorithm.
+@return	size of the compressed data, or 0 if it did not fit in dst */
+static
+ulint
+os_file_compress_low(
+/*=================*/
+	ulint		algorithm,	/*!< in: OS_FILE_COMPRESSION_ZLIB, ... */
+	const byte*	src,		/*!< in: data to compress */
+	ulint		src_len,	/*!< in: size of src */
+	byte*		dst,		/*!< out: compressed data */
+	ulint		dst_len)	/*!< in: size of dst */
+{
+	switch (algorithm) {
+	case OS_FILE_COMPRESSION_ZLIB:
+		z_stream	strm;
+		ulint		len;
+
+		memset(&strm, 0, sizeof strm);
+
+		/* A window of one page is all that a page can use */
+		if (deflateInit2(&strm, page_zip_level, Z_DEFLATED,
+				 UNIV_PAGE_SIZE_SHIFT, 8,
+				 Z_DEFAULT_STRATEGY) != Z_OK) {
+			return(0);
+		}
+
+		strm.next_in = const_cast<byte*>(src);
+		strm.avail_in = static_cast<uInt>(src_len);
+		strm.next_out = dst;
+		strm.avail_out = static_cast<uInt>(dst_len);
+
+		len = deflate(&strm, Z_FINISH) == Z_STREAM_END
+			? strm.total_out : 0;
+
+		deflateEnd(&strm);
+
+		return(len);
+#ifdef HAVE_LZ4
+	case OS_FILE_COMPRESSION_LZ4:
+		/* Returns 0 if the data does not fit */
+		return(LZ4_compress_default(
+			       reinterpret_cast<const char*>(src),
+			       reinterpret_cast<char*>(dst),
+			       static_cast<int>(src_len),
+			       static_cast<int>(dst_len)));
+#endif /* HAVE_LZ4 */
+	}
+
+	return(0);
+}
+
+/***********************************************************************//**
+Decompresses data that was compressed with os_file_compress_low().
+@return	true if exactly dst_len bytes were decompressed */
+static
+bool
+os_file_uncompress_low(
+/*===================*/
+	ulint		algorithm,	/*!< in: OS_FILE_COMPRESSION_ZLIB, ... */
+	const byte*	src,		/*!< in: compressed data */
+	ulint		src_len,	/*!< in: size of src */
+	byte*		dst,		/*!< out: decompressed data */
+	ulint		dst_len)	/*!< in: size of the data before it
+					was compressed */
+{
+	switch (algorithm) {
+	case OS_FILE_COMPRESSION_ZLIB:
+		uLongf	len;
+
+		len = static_cast<uLongf>(dst_len);
+
+		return(uncompress(dst, &len, src, static_cast<uLong>(src_len))
+		       == Z_OK
+		       && len == dst_len);
+#ifdef HAVE_LZ4
+	case OS_FILE_COMPRESSION_LZ4:
+		return(LZ4_decompress_safe(
+			       reinterpret_cast<const char*>(src),
+			       reinterpret_cast<char*>(dst),
+			       static_cast<int>(src_len),
+			       static_cast<int>(dst_len))
+		       == static_cast<int>(dst_len));
+#endif /* HAVE_LZ4 */
+	}
+
+	return(false);
+}
+
+/***********************************************************************//**
+Compresses a page for writing it with transparent page compression. The
+compressed page keeps the FIL header of the page, with FIL_PAGE_TYPE set
+to FIL_PAGE_COMPRESSED and the FIL_PAGE_COMPRESS_ fields filled in, and
+is padded to whole OS_FILE_COMPRESS_BLOCKs.
+@return	the compressed page, or NULL if the page is to be written as it
+is */
+static
+byte*
+os_file_compress_page(
+/*==================*/
+	os_file_compress_t*	compress,	/*!< in/out: compression of
+						the tablespace */
+	os_offset_t		offset,		/*!< in: file offset */
+	const byte*		page,		/*!< in: page to write */
+	ulint*			n,		/*!< in: bytes to write;
+						out: bytes of the compressed
+						page to write */
+	byte**			alloc)		/*!< out: memory of the
+						compressed page, to be freed
+						after the write */
+{
+	ulint		algorithm = compress->algorithm;
+	ulint		len;
+	byte*		buf;
+	ullint		start_time;
+
+	/* The first page holds the flags that tell how the other
+	pages are written, so it is always written as it is. */
+	if (algorithm == OS_FILE_COMPRESSION_NONE
+	    || *n != UNIV_PAGE_SIZE
+	    || offset == 0
+	    || UNIV_PAGE_SIZE <= OS_FILE_COMPRESS_BLOCK) {
+
+		return(NULL);
+	}
+
+	ut_ad(mach_read_from_2(page + FIL_PAGE_TYPE) != FIL_PAGE_COMPRESSED);
+
+	*alloc = static_cast<byte*>(
+		ut_malloc(UNIV_PAGE_SIZE + OS_FILE_COMPRESS_BLOCK));
+
+	buf = static_cast<byte*>(ut_align(*alloc, OS_FILE_COMPRESS_BLOCK));
+
+	start_time = ut_time_us(NULL);
+
+	/* Only keep the result if it saves at least one block */
+	len = os_file_compress_low(
+		algorithm, page + FIL_PAGE_DATA,
+		UNIV_PAGE_SIZE - FIL_PAGE_DATA, buf + FIL_PAGE_DATA,
+		UNIV_PAGE_SIZE - FIL_PAGE_DATA - OS_FILE_COMPRESS_BLOCK);
+
+	compress->compress_time += ut_time_us(NULL) - start_time;
+	compress->compress_ops++;
+	compress->page_bytes += UNIV_PAGE_SIZE;
+
+	if (len == 0) {
+		ut_free(*alloc);
+		*alloc = NULL;
+
+		compress->written_bytes += UNIV_PAGE_SIZE;
+
+		return(NULL);
+	}
+
+	memcpy(buf, page, FIL_PAGE_DATA);
+
+	mach_write_to_2(buf + FIL_PAGE_TYPE, FIL_PAGE_COMPRESSED);
+	memset(buf + FIL_PAGE_FILE_FLUSH_LSN, 0, 8);
+	mach_write_to_1(buf + FIL_PAGE_COMPRESS_VERSION,
+			FIL_PAGE_COMPRESS_VERSION_1);
+	mach_write_to_1(buf + FIL_PAGE_COMPRESS_ALGORITHM, algorithm);
+	mach_write_to_2(buf + FIL_PAGE_COMPRESS_ORIGINAL_TYPE,
+			mach_read_from_2(page + FIL_PAGE_TYPE));
+	mach_write_to_2(buf + FIL_PAGE_COMPRESS_SIZE, len);
+
+	*n = ut_calc_align(FIL_PAGE_DATA + len, OS_FILE_COMPRESS_BLOCK);
+
+	memset(buf + FIL_PAGE_DATA + len, 0, *n - FIL_PAGE_DATA - len);
+
+	compress->compress_ops_ok++;
+	compress->written_bytes += *n;
+
+	return(buf);
+}
+
+/***********************************************************************//**
+Decompresses in place a page that was written with transparent page
+compression. Other pages are left alone.
+@return	false if the page is compressed but cannot be decompressed */
+UNIV_INTERN
+bool
+os_file_decompress_page(
+/*====================*/
+	os_file_compress_t*	compress,	/*!< in/out: compression
+						counters of the tablespace,
+						or NULL */
+	byte*			page)		/*!< in/out: page of
+						UNIV_PAGE_SIZE bytes */
+{
+	ulint		algorithm;
+	ulint		len;
+	byte*		buf;
+	bool		success;
+	ullint		start_time;
+
+	if (mach_read_from_2(page + FIL_PAGE_TYPE) != FIL_PAGE_COMPRESSED) {
+
+		return(true);
+	}
+
+	algorithm = mach_read_from_1(page + FIL_PAGE_COMPRESS_ALGORITHM);
+	len = mach_read_from_2(page + FIL_PAGE_COMPRESS_SIZE);
+
+	if (mach_read_from_1(page + FIL_PAGE_COMPRESS_VERSION)
+	    != FIL_PAGE_COMPRESS_VERSION_1
+	    || len == 0 || len > UNIV_PAGE_SIZE - FIL_PAGE_DATA
+	    || !os_file_compression_is_supported(algorithm)) {
+
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"Page %lu of space %lu was compressed in an unknown"
+			" format (version %lu, algorithm %lu, %lu bytes)."
+			" InnoDB may have been built without the algorithm.",
+			(ulong) mach_read_from_4(page + FIL_PAGE_OFFSET),
+			(ulong) mach_read_from_4(page + FIL_PAGE_SPACE_ID),
+			(ulong) mach_read_from_1(
+				page + FIL_PAGE_COMPRESS_VERSION),
+			(ulong) algorithm, (ulong) len);
+
+		return(false);
+	}
+
+	buf = static_cast<byte*>(ut_malloc(UNIV_PAGE_SIZE - FIL_PAGE_DATA));
+
+	start_time = ut_time_us(NULL);
+
+	success = os_file_uncompress_low(
+		algorithm, page + FIL_PAGE_DATA, len,
+		buf, UNIV_PAGE_SIZE - FIL_PAGE_DATA);
+
+	if (compress != NULL) {
+		compress->uncompress_time += ut_time_us(NULL) - start_time;
+		compress->uncompress_ops++;
+	}
+
+	if (success) {
+		memcpy(page + FIL_PAGE_DATA, buf,
+		       UNIV_PAGE_SIZE - FIL_PAGE_DATA);
+
+		mach_write_to_2(page + FIL_PAGE_TYPE,
+				mach_read_from_2(
+					page + FIL_PAGE_COMPRESS_ORIGINAL_TYPE));
+		memset(page + FIL_PAGE_FILE_FLUSH_LSN, 0, 8);
+	}
+
+	ut_free(buf);
+
+	return(success);
+}
+
+/***********************************************************************//**
+Frees the space of a file range by punching a hole into the file, for
+the part of a page that was not written because the page was
+compressed. If the file system does not support it, this is noted in
+the compression of the tablespace and not tried again. */
+static
+void
+os_file_punch_hole(
+/*===============*/
+	os_file_compress_t*	compress,	/*!< in/out: compression of
+						the tablespace */
+	const char*		name,		/*!< in: name of the file */
+	os_file_t		file,		/*!< in: handle to the file */
+	os_offset_t		offset,		/*!< in: start of the hole */
+	ulint			len)		/*!< in: size of the hole */
+{
+	if (!compress->punch_hole) {
+		return;
+	}
+
+#ifdef HAVE_FALLOC_PUNCH_HOLE_AND_KEEP_SIZE
+	if (fallocate(file, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+		      offset, len) == 0) {
+
+		return;
+	}
+
+	if (errno != EOPNOTSUPP && errno != ENOSYS) {
+		/* The unused part of the page keeps its old
+		contents, which is harmless. */
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Punching a hole of %lu bytes at offset " UINT64PF
+			" into %s failed: %s",
+			(ulong) len, offset, name, strerror(errno));
+
+		return;
+	}
+#endif /* HAVE_FALLOC_PUNCH_HOLE_AND_KEEP_SIZE */
+
+	compress->punch_hole = false;
+
+	ib_logf(IB_LOG_LEVEL_WARN,
+		"The file system of %s does not support punching holes."
+		" Its compressed pages will take as much disk space"
+		" as uncompressed ones.", name);
+}
+
+/***********************************************************************//**
+Finishes an i/o of a file with transparent page compression: decompresses
+the page that was read, or frees the rest of a page that was written
+compressed. */
+static
+void
+os_file_compress_io_complete(
+/*=========================*/
+	ulint			type,		/*!< in: OS_FILE_READ or
+						OS_FILE_WRITE */
+	os_file_compress_t*	compress,	/*!< in/out: compression of
+						the tablespace, or NULL */
+	const char*		name,		/*!< in: name of the file */
+	os_file_t		file,		/*!< in: handle to the file */
+	byte*			buf,		/*!< in/out: buffer of the i/o */
+	os_offset_t		offset,		/*!< in: file offset */
+	ulint			n,		/*!< in: bytes read or written */
+	ulint			page_len)	/*!< in: size of the page
+						before compression */
+{
+	if (compress == NULL) {
+		return;
+	}
+
+	if (type == OS_FILE_READ) {
+		if (n == UNIV_PAGE_SIZE) {
+			/* A failure leaves the page as it was read,
+			and the caller will find it corrupted */
+			os_file_decompress_page(compress, buf);
+		}
+	} else if (n < page_len) {
+		os_file_punch_hole(compress, name, file, offset + n,
+				   page_len - n);
+	}
+}
+
 #ifndef __WIN__
 /***********************************************************************//**
 Wrapper to fsync(2) that retries the call on some errors.
@@ -3725,6 +4154,8 @@ os_aio_array_create(
 #if defined(LINUX_NATIVE_AIO)
 	array->aio_ctx = NULL;
 	array->aio_events = NULL;
+	array->pending = NULL;
+	array->n_pending = NULL;
 
 	/* If we are not using native aio interface then skip this
 	part of initialization. */
@@ -3758,6 +4189,13 @@ os_aio_array_create(
 	memset(io_event, 0x0, sizeof(*io_event) * n);
 	array->aio_events = io_event;
 
+	array->pending = static_cast<struct iocb**>(
+		ut_malloc(n * sizeof(*array->pending)));
+	array->n_pending = static_cast<ulint*>(
+		ut_malloc(n_segments * sizeof(*array->n_pending)));
+
+	memset(array->n_pending, 0x0, n_segments * sizeof(*array->n_pending));
+
 skip_native_aio:
 #endif /* LINUX_NATIVE_AIO */
 	for (ulint i = 0; i < n; i++) {
@@ -3812,6 +4250,8 @@ os_aio_array_free(
 
 #if defined(LINUX_NATIVE_AIO)
 	if (srv_use_native_aio) {
+		ut_free(array->n_pending);
+		ut_free(array->pending);
 		ut_free(array->aio_events);
 		ut_free(array->aio_ctx);
 	}
@@ -4150,7 +4590,17 @@ os_aio_array_reserve_slot(
 	void*		buf,	/*!< in: buffer where to read or from which
 				to write */
 	os_offset_t	offset,	/*!< in: file offset */
-	ulint		len)	/*!< in: length of the block to read or write */
+	ulint		len,	/*!< in: length of the block to read or write */
+	os_file_compress_t* compress,
+				/*!< in/out: transparent page
+				compression of the file, or NULL */
+	byte*		compressed_buf,
+				/*!< in: memory holding the compressed
+				page in buf, to be freed with the slot,
+				or NULL */
+	ulint		page_len)
+				/*!< in: size of the page before
+				compression */
 {
 	os_aio_slot_t*	slot = NULL;
 #ifdef WIN_ASYNC_IO
@@ -4186,12 +4636,11 @@ loop:
 	if (array->n_reserved == array->n_slots) {
 		os_mutex_exit(array->mutex);
 
-		if (!srv_use_native_aio) {
-			/* If the handler threads are suspended, wake them
-			so that we get more slots */
+		/* If the handler threads are suspended, wake them, and
+		submit any native aio requests that are waiting for a
+		batch to be completed, so that we get more slots */
 
-			os_aio_simulated_wake_handler_threads();
-		}
+		os_aio_simulated_wake_handler_threads();
 
 		os_event_wait(array->not_full);
 
@@ -4240,6 +4689,9 @@ found:
 	slot->buf      = static_cast<byte*>(buf);
 	slot->offset   = offset;
 	slot->io_already_done = FALSE;
+	slot->compress = compress;
+	slot->compressed_buf = compressed_buf;
+	slot->page_len = page_len;
 
 #ifdef WIN_ASYNC_IO
 	control = &slot->control;
@@ -4296,6 +4748,11 @@ os_aio_array_free_slot(
 
 	slot->reserved = FALSE;
 
+	if (slot->compressed_buf != NULL) {
+		ut_free(slot->compressed_buf);
+		slot->compressed_buf = NULL;
+	}
+
 	array->n_reserved--;
 
 	if (array->n_reserved == array->n_slots - 1) {
@@ -4376,15 +4833,102 @@ os_aio_simulated_wake_handler_thread(
 	os_mutex_exit(array->mutex);
 }
 
+#if defined(LINUX_NATIVE_AIO)
+/*******************************************************************//**
+Queues a read request to be submitted to the kernel together with the
+other requests of a batch by os_aio_linux_dispatch_pending(). */
+static
+void
+os_aio_linux_defer(
+/*===============*/
+	os_aio_array_t*	array,	/*!< in: io request array. */
+	os_aio_slot_t*	slot)	/*!< in: an already reserved slot. */
+{
+	ulint	seg_size = array->n_slots / array->n_segments;
+	ulint	segment = slot->pos / seg_size;
+
+	ut_a(slot->reserved);
+
+	os_mutex_enter(array->mutex);
+
+	ut_ad(array->n_pending[segment] < seg_size);
+
+	array->pending[segment * seg_size + array->n_pending[segment]++]
+		= &slot->control;
+
+	os_mutex_exit(array->mutex);
+}
+
+/*******************************************************************//**
+Submits the requests that were queued by os_aio_linux_defer() to the
+kernel, with one io_submit() call for up to OS_AIO_SUBMIT_BATCH requests
+of a segment. */
+static
+void
+os_aio_linux_dispatch_pending(
+/*==========================*/
+	os_aio_array_t*	array)	/*!< in: io request array. */
+{
+	ulint	seg_size = array->n_slots / array->n_segments;
+
+	for (ulint i = 0; i < array->n_segments; i++) {
+		struct iocb*	batch[OS_AIO_SUBMIT_BATCH];
+		ulint		n;
+
+		/* A dirty read is enough: the requests that are
+		being queued concurrently will be submitted by
+		the threads that queue them. */
+
+		while (array->n_pending[i] > 0) {
+
+			os_mutex_enter(array->mutex);
+
+			n = ut_min(array->n_pending[i],
+				   OS_AIO_SUBMIT_BATCH);
+
+			array->n_pending[i] -= n;
+
+			memcpy(batch, array->pending + i * seg_size
+			       + array->n_pending[i], n * sizeof *batch);
+
+			os_mutex_exit(array->mutex);
+
+			for (ulint done = 0; done < n; ) {
+				int	ret = io_submit(array->aio_ctx[i],
+							n - done,
+							batch + done);
+
+				if (ret > 0) {
+					done += ret;
+				} else if (ret == -EAGAIN || ret == -EINTR) {
+					os_thread_sleep(OS_AIO_SUBMIT_RETRY_SLEEP);
+				} else {
+					ib_logf(IB_LOG_LEVEL_FATAL,
+						"io_submit() of %lu"
+						" requests failed: %d",
+						(ulong) (n - done), -ret);
+				}
+			}
+		}
+	}
+}
+#endif /* LINUX_NATIVE_AIO */
+
 /**********************************************************************//**
-Wakes up simulated aio i/o-handler threads if they have something to do. */
+Wakes up simulated aio i/o-handler threads if they have something to do.
+With Linux native aio, submits the reads that were requested with
+OS_AIO_SIMULATED_WAKE_LATER. */
 UNIV_INTERN
 void
 os_aio_simulated_wake_handler_threads(void)
 /*=======================================*/
 {
 	if (srv_use_native_aio) {
-		/* We do not use simulated aio: do nothing */
+#if defined(LINUX_NATIVE_AIO)
+		if (os_aio_read_array != NULL) {
+			os_aio_linux_dispatch_pending(os_aio_read_array);
+		}
+#endif /* LINUX_NATIVE_AIO */
 
 		return;
 	}
@@ -4510,6 +5054,11 @@ os_aio_func(
 				to write */
 	os_offset_t	offset,	/*!< in: file offset where to read or write */
 	ulint		n,	/*!< in: number of bytes to read or write */
+	os_file_compress_t* compress,
+				/*!< in/out: transparent page
+				compression of the file, or NULL
+				if the data is not in pages of a
+				tablespace */
 	fil_node_t*	message1,/*!< in: message for the aio handler
 				(can be used to identify a completed
 				aio operation); ignored if mode is
@@ -4521,6 +5070,8 @@ os_aio_func(
 {
 	os_aio_array_t*	array;
 	os_aio_slot_t*	slot;
+	byte*		compressed_buf = NULL;
+	ulint		page_len = n;
 #ifdef WIN_ASYNC_IO
 	ibool		retval;
 	BOOL		ret		= TRUE;
@@ -4544,6 +5095,18 @@ os_aio_func(
 	wake_later = mode & OS_AIO_SIMULATED_WAKE_LATER;
 	mode = mode & (~OS_AIO_SIMULATED_WAKE_LATER);
 
+	if (type == OS_FILE_WRITE && compress != NULL) {
+		/* Compress the page here, in the thread that posts
+		the write, rather than in the i/o-handler thread */
+		byte*	compressed = os_file_compress_page(
+			compress, offset, static_cast<const byte*>(buf),
+			&n, &compressed_buf);
+
+		if (compressed != NULL) {
+			buf = compressed;
+		}
+	}
+
 	if (mode == OS_AIO_SYNC
 #ifdef WIN_ASYNC_IO
 	    && !srv_use_native_aio
@@ -4562,14 +5125,28 @@ os_aio_func(
 		os_file_write(). Instead, we should use os_file_read_func()
 		and os_file_write_func() */
 
+		ibool	ret;
+
 		if (type == OS_FILE_READ) {
-			return(os_file_read_func(file, buf, offset, n));
+			ret = os_file_read_func(file, buf, offset, n);
+		} else {
+			ut_ad(!srv_read_only_mode);
+			ut_a(type == OS_FILE_WRITE);
+
+			ret = os_file_write_func(name, file, buf, offset, n);
 		}
 
-		ut_ad(!srv_read_only_mode);
-		ut_a(type == OS_FILE_WRITE);
+		if (ret) {
+			os_file_compress_io_complete(
+				type, compress, name, file,
+				static_cast<byte*>(buf), offset, n, page_len);
+		}
+
+		if (compressed_buf != NULL) {
+			ut_free(compressed_buf);
+		}
 
-		return(os_file_write_func(name, file, buf, offset, n));
+		return(ret);
 	}
 
 try_again:
@@ -4615,7 +5192,8 @@ try_again:
 	}
 
 	slot = os_aio_array_reserve_slot(type, array, message1, message2, file,
-					 name, buf, offset, n);
+					 name, buf, offset, n, compress,
+					 compressed_buf, page_len);
 	if (type == OS_FILE_READ) {
 		if (srv_use_native_aio) {
 			os_n_file_reads++;
@@ -4625,7 +5203,12 @@ try_again:
 				       &(slot->control));
 
 #elif defined(LINUX_NATIVE_AIO)
-			if (!os_aio_linux_dispatch(array, slot)) {
+			if (wake_later && array == os_aio_read_array) {
+				/* Submit the read together with the
+				rest of the batch, in
+				os_aio_simulated_wake_handler_threads(). */
+				os_aio_linux_defer(array, slot);
+			} else if (!os_aio_linux_dispatch(array, slot)) {
 				goto err_exit;
 			}
 #endif /* WIN_ASYNC_IO */
@@ -4692,6 +5275,9 @@ try_again:
 #if defined LINUX_NATIVE_AIO || defined WIN_ASYNC_IO
 err_exit:
 #endif /* LINUX_NATIVE_AIO || WIN_ASYNC_IO */
+	/* Keep the compressed page for a retry */
+	slot->compressed_buf = NULL;
+
 	os_aio_array_free_slot(array, slot);
 
 	if (os_file_handle_error(
@@ -4700,6 +5286,10 @@ err_exit:
 		goto try_again;
 	}
 
+	if (compressed_buf != NULL) {
+		ut_free(compressed_buf);
+	}
+
 	return(FALSE);
 }
 
@@ -4872,6 +5462,12 @@ os_aio_windows_handle(
 		ret_val = ret && len == slot->len;
 	}
 
+	if (ret_val) {
+		os_file_compress_io_complete(
+			slot->type, slot->compress, slot->name, slot->file,
+			slot->buf, slot->offset, slot->len, slot->page_len);
+	}
+
 	os_aio_array_free_slot(array, slot);
 
 	return(ret_val);
@@ -5118,6 +5714,12 @@ found:
 
 	os_mutex_exit(array->mutex);
 
+	if (ret) {
+		os_file_compress_io_complete(
+			slot->type, slot->compress, slot->name, slot->file,
+			slot->buf, slot->offset, slot->len, slot->page_len);
+	}
+
 	os_aio_array_free_slot(array, slot);
 
 	return(ret);
@@ -5436,6 +6038,13 @@ slot_io_done:
 
 	os_mutex_exit(array->mutex);
 
+	if (ret) {
+		os_file_compress_io_complete(
+			aio_slot->type, aio_slot->compress, aio_slot->name,
+			aio_slot->file, aio_slot->buf, aio_slot->offset,
+			aio_slot->len, aio_slot->page_len);
+	}
+
 	os_aio_array_free_slot(array, aio_slot);
 
 	return(ret);
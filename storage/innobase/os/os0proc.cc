@@ -32,6 +32,12 @@ Created 9/30/1995 Heikki Tuuri
 #include "ut0mem.h"
 #include "ut0byte.h"
 
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#include <numaif.h>
+#include <sched.h>
+#endif /* HAVE_LIBNUMA */
+
 /* FreeBSD for example has only MAP_ANON, Linux has MAP_ANONYMOUS and
 MAP_ANON but MAP_ANON is marked as deprecated */
 #if defined(MAP_ANONYMOUS)
@@ -230,3 +236,108 @@ os_mem_free_large(
 	}
 #endif
 }
+
+/****************************************************************//**
+Returns the number of NUMA nodes that memory and threads can be bound to.
+@return	number of nodes, or 0 if NUMA is not supported */
+UNIV_INTERN
+ulint
+os_numa_get_n_nodes(void)
+/*=====================*/
+{
+#ifdef HAVE_LIBNUMA
+	if (numa_available() != -1) {
+		return((ulint) numa_max_node() + 1);
+	}
+#endif /* HAVE_LIBNUMA */
+	return(0);
+}
+
+/****************************************************************//**
+Returns the NUMA node of the CPU the calling thread is running on.
+@return	node number, or ULINT_UNDEFINED if it cannot be determined */
+UNIV_INTERN
+ulint
+os_numa_get_curr_node(void)
+/*=======================*/
+{
+#ifdef HAVE_LIBNUMA
+	int	cpu = sched_getcpu();
+
+	if (cpu >= 0) {
+		int	node = numa_node_of_cpu(cpu);
+
+		if (node >= 0) {
+			return((ulint) node);
+		}
+	}
+#endif /* HAVE_LIBNUMA */
+	return(ULINT_UNDEFINED);
+}
+
+/****************************************************************//**
+Sets the memory policy of a range of pages so that they are allocated
+from the given NUMA node, migrating pages that were already touched.
+The node is preferred rather than mandatory: when it runs out of memory
+the pages are allocated elsewhere instead of failing.
+@return	true on success */
+UNIV_INTERN
+bool
+os_mem_bind_to_numa_node(
+/*=====================*/
+	void*	ptr __attribute__((unused)),
+					/*!< in: start of the range, aligned
+					to the system page size */
+	ulint	size __attribute__((unused)),
+					/*!< in: size of the range in bytes */
+	ulint	node __attribute__((unused)))
+					/*!< in: NUMA node */
+{
+#ifdef HAVE_LIBNUMA
+	struct bitmask*	mask = numa_allocate_nodemask();
+	long		ret;
+
+	numa_bitmask_setbit(mask, (unsigned int) node);
+
+	ret = mbind(ptr, size, MPOL_PREFERRED, mask->maskp,
+		    mask->size + 1, MPOL_MF_MOVE);
+
+	numa_free_nodemask(mask);
+
+	if (ret != 0) {
+		fprintf(stderr, "InnoDB: mbind(%p, %lu, node %lu) failed;"
+			" errno %lu\n",
+			ptr, (ulong) size, (ulong) node, (ulong) errno);
+		return(false);
+	}
+
+	return(true);
+#else
+	return(false);
+#endif /* HAVE_LIBNUMA */
+}
+
+/****************************************************************//**
+Restricts the calling thread to the CPUs of a NUMA node and makes it
+prefer that node for its memory allocations.
+@return	true on success */
+UNIV_INTERN
+bool
+os_thread_bind_to_numa_node(
+/*========================*/
+	ulint	node __attribute__((unused)))	/*!< in: NUMA node */
+{
+#ifdef HAVE_LIBNUMA
+	if (numa_run_on_node((int) node) != 0) {
+		fprintf(stderr, "InnoDB: numa_run_on_node(%lu) failed;"
+			" errno %lu\n", (ulong) node, (ulong) errno);
+		return(false);
+	}
+
+	numa_set_preferred((int) node);
+
+	return(true);
+#else
+	return(false);
+#endif /* HAVE_LIBNUMA */
+}
@@ -33,6 +33,13 @@ Created 9/6/1995 Heikki Tuuri
 #include <windows.h>
 #endif
 
+#ifdef HAVE_IB_LINUX_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <limits.h>
+#include <unistd.h>
+#endif /* HAVE_IB_LINUX_FUTEX */
+
 #include "ut0mem.h"
 #include "srv0start.h"
 #include "srv0srv.h"
@@ -729,6 +736,78 @@ os_event_wait_time_low(
 	return(timed_out ? OS_SYNC_TIME_EXCEEDED : 0);
 }
 
+/**********************************************************//**
+Suspends the calling thread on a futex word, unless the word no longer
+holds the value the caller based its decision to wait on. The thread
+returns when it is woken up by os_futex_wake(), when the timeout is
+exceeded, or spuriously; the caller must recheck its wait condition.
+@return	0 if woken up, OS_SYNC_TIME_EXCEEDED if timeout was exceeded */
+UNIV_INTERN
+ulint
+os_futex_wait(
+/*==========*/
+	os_futex_t*	futex,		/*!< in: futex word */
+	os_futex_t	val,		/*!< in: value of the word observed
+					before deciding to wait */
+	ulint		time_in_usec)	/*!< in: timeout in microseconds,
+					or OS_SYNC_INFINITE_TIME */
+{
+#ifdef HAVE_IB_LINUX_FUTEX
+	struct timespec	timeout;
+	struct timespec*	timeoutp = NULL;
+
+	if (time_in_usec != OS_SYNC_INFINITE_TIME) {
+		timeout.tv_sec = time_in_usec / MICROSECS_IN_A_SECOND;
+		timeout.tv_nsec = (time_in_usec % MICROSECS_IN_A_SECOND)
+			* 1000;
+		timeoutp = &timeout;
+	}
+
+	if (syscall(SYS_futex, futex, FUTEX_WAIT_PRIVATE, val,
+		    timeoutp, NULL, 0) == -1) {
+
+		switch (errno) {
+		case ETIMEDOUT:
+			return(OS_SYNC_TIME_EXCEEDED);
+		case EAGAIN:
+		case EINTR:
+			break;
+		default:
+			ib_logf(IB_LOG_LEVEL_FATAL,
+				"futex(FUTEX_WAIT) failed: %s",
+				strerror(errno));
+		}
+	}
+
+	return(0);
+#else
+	ut_error;
+
+	return(0);
+#endif /* HAVE_IB_LINUX_FUTEX */
+}
+
+/**********************************************************//**
+Changes the value of a futex word and wakes up all threads suspended on
+it in os_futex_wait(). Changing the value first ensures that a thread
+which has observed the old value but not yet gone to sleep does not go
+to sleep at all. */
+UNIV_INTERN
+void
+os_futex_wake(
+/*==========*/
+	os_futex_t*	futex)		/*!< in/out: futex word */
+{
+#if defined(HAVE_IB_LINUX_FUTEX) && defined(HAVE_ATOMIC_BUILTINS)
+	(void) os_atomic_increment_uint32(futex, 1);
+
+	syscall(SYS_futex, futex, FUTEX_WAKE_PRIVATE, INT_MAX,
+		NULL, NULL, 0);
+#else
+	ut_error;
+#endif /* HAVE_IB_LINUX_FUTEX && HAVE_ATOMIC_BUILTINS */
+}
+
 /*********************************************************//**
 Creates an operating system mutex semaphore. Because these are slow, the
 mutex semaphore of InnoDB itself (ib_mutex_t) should be used where possible.
@@ -1705,134 +1705,233 @@ page_parse_copy_rec_list_to_created_page(
 
 #ifndef UNIV_HOTBACKUP
 /*************************************************************//**
-Copies records from page to a newly created page, from a given record onward,
-including that record. Infimum and supremum records are not copied.
+Starts appending records in ascending order to a newly created
+uncompressed page. The page header and the page directory are only
+valid after page_cur_append_end(), so the page must stay x-latched in
+mtr until then. */
+UNIV_INTERN
+void
+page_cur_append_start(
+/*==================*/
+	page_append_t*	app,	/*!< out: append context */
+	page_t*		page,	/*!< in/out: empty index page */
+	dict_index_t*	index,	/*!< in: record descriptor */
+	mtr_t*		mtr)	/*!< in/out: mtr */
+{
+	ut_ad(page_dir_get_n_heap(page) == PAGE_HEAP_NO_USER_LOW);
+	ut_ad(!!page_is_comp(page) == dict_table_is_comp(index->table));
 
-IMPORTANT: The caller will have to update IBUF_BITMAP_FREE
-if this is a compressed leaf page in a secondary index.
-This has to be done either within the same mini-transaction,
-or by invoking ibuf_reset_free_bits() before mtr_commit(). */
+#ifdef UNIV_DEBUG
+	/* To pass the debug tests we have to set these dummy values
+	in the debug version */
+	page_dir_set_n_slots(page, NULL, UNIV_PAGE_SIZE / 2);
+	page_header_set_ptr(page, NULL, PAGE_HEAP_TOP,
+			    page + UNIV_PAGE_SIZE - 1);
+#endif
+
+	app->page = page;
+	app->index = index;
+	app->mtr = mtr;
+	app->log_open = FALSE;
+	app->log_ptr = NULL;
+	app->log_data_len = 0;
+	app->log_mode = 0;
+	app->prev_rec = page_get_infimum_rec(page);
+
+	if (page_is_comp(page)) {
+		app->heap_top = page + PAGE_NEW_SUPREMUM_END;
+	} else {
+		app->heap_top = page + PAGE_OLD_SUPREMUM_END;
+	}
+
+	app->n_recs = 0;
+	app->count = 0;
+	app->slot_index = 0;
+	app->slot = NULL;
+}
+
+/*************************************************************//**
+Returns the maximum size of a record that can still be appended to
+the page, see page_get_max_insert_size().
+@return	maximum record size in bytes */
 UNIV_INTERN
+ulint
+page_cur_append_get_max_insert_size(
+/*================================*/
+	const page_append_t*	app)	/*!< in: append context */
+{
+	ulint	occupied;
+	ulint	free_space;
+
+	if (page_is_comp(app->page)) {
+		occupied = app->heap_top - (app->page + PAGE_NEW_SUPREMUM_END);
+		free_space = page_get_free_space_of_empty(TRUE);
+	} else {
+		occupied = app->heap_top - (app->page + PAGE_OLD_SUPREMUM_END);
+		free_space = page_get_free_space_of_empty(FALSE);
+	}
+
+	occupied += page_dir_calc_reserved_space(app->n_recs + 1);
+
+	return(occupied > free_space ? 0 : free_space - occupied);
+}
+
+/*************************************************************//**
+Appends a record that has been copied to the top of the record heap
+of the page. */
+static
 void
-page_copy_rec_list_end_to_created_page(
-/*===================================*/
-	page_t*		new_page,	/*!< in/out: index page to copy to */
-	rec_t*		rec,		/*!< in: first record to copy */
-	dict_index_t*	index,		/*!< in: record descriptor */
-	mtr_t*		mtr)		/*!< in: mtr */
+page_cur_append_low(
+/*================*/
+	page_append_t*	app,		/*!< in/out: append context */
+	rec_t*		insert_rec,	/*!< in: record at app->heap_top */
+	ulint*		offsets)	/*!< in/out: rec_get_offsets(
+					insert_rec, app->index) */
 {
-	page_dir_slot_t* slot = 0; /* remove warning */
-	byte*	heap_top;
-	rec_t*	insert_rec = 0; /* remove warning */
-	rec_t*	prev_rec;
-	ulint	count;
-	ulint	n_recs;
-	ulint	slot_index;
+	page_t*	page = app->page;
 	ulint	rec_size;
-	ulint	log_mode;
-	byte*	log_ptr;
-	ulint	log_data_len;
-	mem_heap_t*	heap		= NULL;
-	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
-	ulint*		offsets		= offsets_;
-	rec_offs_init(offsets_);
 
-	ut_ad(page_dir_get_n_heap(new_page) == PAGE_HEAP_NO_USER_LOW);
-	ut_ad(page_align(rec) != new_page);
-	ut_ad(page_rec_is_comp(rec) == page_is_comp(new_page));
+	ut_ad(rec_offs_validate(NULL, app->index, offsets));
 
-	if (page_rec_is_infimum(rec)) {
+	if (!app->log_open) {
+		app->log_ptr = page_copy_rec_list_to_created_page_write_log(
+			page, app->index, app->mtr);
 
-		rec = page_rec_get_next(rec);
+		app->log_data_len = dyn_array_get_data_size(&app->mtr->log);
+
+		/* Individual inserts are logged in a shorter form */
+
+		app->log_mode = mtr_set_log_mode(
+			app->mtr, MTR_LOG_SHORT_INSERTS);
+		app->log_open = TRUE;
 	}
 
-	if (page_rec_is_supremum(rec)) {
+	if (page_is_comp(page)) {
+		rec_set_next_offs_new(app->prev_rec, page_offset(insert_rec));
 
-		return;
+		rec_set_n_owned_new(insert_rec, NULL, 0);
+		rec_set_heap_no_new(insert_rec,
+				    PAGE_HEAP_NO_USER_LOW + app->n_recs);
+	} else {
+		rec_set_next_offs_old(app->prev_rec, page_offset(insert_rec));
+
+		rec_set_n_owned_old(insert_rec, 0);
+		rec_set_heap_no_old(insert_rec,
+				    PAGE_HEAP_NO_USER_LOW + app->n_recs);
 	}
 
-#ifdef UNIV_DEBUG
-	/* To pass the debug tests we have to set these dummy values
-	in the debug version */
-	page_dir_set_n_slots(new_page, NULL, UNIV_PAGE_SIZE / 2);
-	page_header_set_ptr(new_page, NULL, PAGE_HEAP_TOP,
-			    new_page + UNIV_PAGE_SIZE - 1);
-#endif
+	app->count++;
+	app->n_recs++;
 
-	log_ptr = page_copy_rec_list_to_created_page_write_log(new_page,
-							       index, mtr);
+	if (UNIV_UNLIKELY
+	    (app->count == (PAGE_DIR_SLOT_MAX_N_OWNED + 1) / 2)) {
 
-	log_data_len = dyn_array_get_data_size(&(mtr->log));
+		app->slot_index++;
 
-	/* Individual inserts are logged in a shorter form */
+		app->slot = page_dir_get_nth_slot(page, app->slot_index);
 
-	log_mode = mtr_set_log_mode(mtr, MTR_LOG_SHORT_INSERTS);
+		page_dir_slot_set_rec(app->slot, insert_rec);
+		page_dir_slot_set_n_owned(app->slot, NULL, app->count);
 
-	prev_rec = page_get_infimum_rec(new_page);
-	if (page_is_comp(new_page)) {
-		heap_top = new_page + PAGE_NEW_SUPREMUM_END;
-	} else {
-		heap_top = new_page + PAGE_OLD_SUPREMUM_END;
+		app->count = 0;
 	}
-	count = 0;
-	slot_index = 0;
-	n_recs = 0;
 
-	do {
-		offsets = rec_get_offsets(rec, index, offsets,
-					  ULINT_UNDEFINED, &heap);
-		insert_rec = rec_copy(heap_top, rec, offsets);
+	rec_size = rec_offs_size(offsets);
 
-		if (page_is_comp(new_page)) {
-			rec_set_next_offs_new(prev_rec,
-					      page_offset(insert_rec));
+	ut_ad(app->heap_top < page + UNIV_PAGE_SIZE);
 
-			rec_set_n_owned_new(insert_rec, NULL, 0);
-			rec_set_heap_no_new(insert_rec,
-					    PAGE_HEAP_NO_USER_LOW + n_recs);
-		} else {
-			rec_set_next_offs_old(prev_rec,
-					      page_offset(insert_rec));
+	app->heap_top += rec_size;
 
-			rec_set_n_owned_old(insert_rec, 0);
-			rec_set_heap_no_old(insert_rec,
-					    PAGE_HEAP_NO_USER_LOW + n_recs);
-		}
+	rec_offs_make_valid(insert_rec, app->index, offsets);
+	btr_blob_dbg_add_rec(insert_rec, app->index, offsets, "copy_end");
 
-		count++;
-		n_recs++;
+	page_cur_insert_rec_write_log(insert_rec, rec_size, app->prev_rec,
+				      app->index, app->mtr);
+	app->prev_rec = insert_rec;
+}
 
-		if (UNIV_UNLIKELY
-		    (count == (PAGE_DIR_SLOT_MAX_N_OWNED + 1) / 2)) {
+/*************************************************************//**
+Converts a data tuple to a record and appends it to the page. The
+caller must have checked that the record fits.
+@return	pointer to the appended record */
+UNIV_INTERN
+rec_t*
+page_cur_append_tuple(
+/*==================*/
+	page_append_t*	app,	/*!< in/out: append context */
+	const dtuple_t*	tuple,	/*!< in: data tuple, greater than
+				the previously appended records */
+	ulint		n_ext,	/*!< in: number of externally stored
+				columns */
+	ulint**		offsets,/*!< out: offsets on the record */
+	mem_heap_t**	heap)	/*!< in/out: heap for offsets */
+{
+	rec_t*	insert_rec;
 
-			slot_index++;
+	ut_ad(rec_get_converted_size(app->index, tuple, n_ext)
+	      <= page_cur_append_get_max_insert_size(app));
 
-			slot = page_dir_get_nth_slot(new_page, slot_index);
+	insert_rec = rec_convert_dtuple_to_rec(
+		app->heap_top, app->index, tuple, n_ext);
 
-			page_dir_slot_set_rec(slot, insert_rec);
-			page_dir_slot_set_n_owned(slot, NULL, count);
+	*offsets = rec_get_offsets(insert_rec, app->index, *offsets,
+				   ULINT_UNDEFINED, heap);
 
-			count = 0;
-		}
+	page_cur_append_low(app, insert_rec, *offsets);
 
-		rec_size = rec_offs_size(offsets);
+	return(insert_rec);
+}
 
-		ut_ad(heap_top < new_page + UNIV_PAGE_SIZE);
+/*************************************************************//**
+Ends the redo log record of the records appended so far. This must be
+called before anything else is logged for the page in the same mtr.
+The log record of any records appended later starts after it. */
+UNIV_INTERN
+void
+page_cur_append_close_log(
+/*======================*/
+	page_append_t*	app)	/*!< in/out: append context */
+{
+	ulint	log_data_len;
 
-		heap_top += rec_size;
+	if (!app->log_open) {
+		return;
+	}
 
-		rec_offs_make_valid(insert_rec, index, offsets);
-		btr_blob_dbg_add_rec(insert_rec, index, offsets, "copy_end");
+	log_data_len = dyn_array_get_data_size(&app->mtr->log)
+		- app->log_data_len;
 
-		page_cur_insert_rec_write_log(insert_rec, rec_size, prev_rec,
-					      index, mtr);
-		prev_rec = insert_rec;
-		rec = page_rec_get_next(rec);
-	} while (!page_rec_is_supremum(rec));
+	ut_a(log_data_len < 100 * UNIV_PAGE_SIZE);
+
+	if (UNIV_LIKELY(app->log_ptr != NULL)) {
+		mach_write_to_4(app->log_ptr, log_data_len);
+	}
+
+	/* Restore the log mode */
+
+	mtr_set_log_mode(app->mtr, app->log_mode);
+	app->log_open = FALSE;
+}
+
+/*************************************************************//**
+Finishes appending records to a page: writes the page directory and
+the page header. At least one record must have been appended. */
+UNIV_INTERN
+void
+page_cur_append_end(
+/*================*/
+	page_append_t*	app)	/*!< in/out: append context */
+{
+	page_t*			page	= app->page;
+	page_dir_slot_t*	slot;
+
+	ut_ad(app->n_recs > 0);
 
-	if ((slot_index > 0) && (count + 1
-				 + (PAGE_DIR_SLOT_MAX_N_OWNED + 1) / 2
-				 <= PAGE_DIR_SLOT_MAX_N_OWNED)) {
+	page_cur_append_close_log(app);
+
+	if ((app->slot_index > 0) && (app->count + 1
+				      + (PAGE_DIR_SLOT_MAX_N_OWNED + 1) / 2
+				      <= PAGE_DIR_SLOT_MAX_N_OWNED)) {
 		/* We can merge the two last dir slots. This operation is
 		here to make this function imitate exactly the equivalent
 		task made using page_cur_insert_rec, which we use in database
@@ -1840,49 +1939,89 @@ page_copy_rec_list_end_to_created_page(
 		To be able to check the correctness of recovery, it is good
 		that it imitates exactly. */
 
-		count += (PAGE_DIR_SLOT_MAX_N_OWNED + 1) / 2;
+		app->count += (PAGE_DIR_SLOT_MAX_N_OWNED + 1) / 2;
 
-		page_dir_slot_set_n_owned(slot, NULL, 0);
+		page_dir_slot_set_n_owned(app->slot, NULL, 0);
 
-		slot_index--;
+		app->slot_index--;
 	}
 
-	if (UNIV_LIKELY_NULL(heap)) {
-		mem_heap_free(heap);
+	if (page_is_comp(page)) {
+		rec_set_next_offs_new(app->prev_rec, PAGE_NEW_SUPREMUM);
+	} else {
+		rec_set_next_offs_old(app->prev_rec, PAGE_OLD_SUPREMUM);
 	}
 
-	log_data_len = dyn_array_get_data_size(&(mtr->log)) - log_data_len;
+	slot = page_dir_get_nth_slot(page, 1 + app->slot_index);
 
-	ut_a(log_data_len < 100 * UNIV_PAGE_SIZE);
+	page_dir_slot_set_rec(slot, page_get_supremum_rec(page));
+	page_dir_slot_set_n_owned(slot, NULL, app->count + 1);
 
-	if (UNIV_LIKELY(log_ptr != NULL)) {
-		mach_write_to_4(log_ptr, log_data_len);
+	page_dir_set_n_slots(page, NULL, 2 + app->slot_index);
+	page_header_set_ptr(page, NULL, PAGE_HEAP_TOP, app->heap_top);
+	page_dir_set_n_heap(page, NULL, PAGE_HEAP_NO_USER_LOW + app->n_recs);
+	page_header_set_field(page, NULL, PAGE_N_RECS, app->n_recs);
+
+	page_header_set_ptr(page, NULL, PAGE_LAST_INSERT, NULL);
+	page_header_set_field(page, NULL, PAGE_DIRECTION,
+							PAGE_NO_DIRECTION);
+	page_header_set_field(page, NULL, PAGE_N_DIRECTION, 0);
+}
+
+/*************************************************************//**
+Copies records from page to a newly created page, from a given record onward,
+including that record. Infimum and supremum records are not copied.
+
+IMPORTANT: The caller will have to update IBUF_BITMAP_FREE
+if this is a compressed leaf page in a secondary index.
+This has to be done either within the same mini-transaction,
+or by invoking ibuf_reset_free_bits() before mtr_commit(). */
+UNIV_INTERN
+void
+page_copy_rec_list_end_to_created_page(
+/*===================================*/
+	page_t*		new_page,	/*!< in/out: index page to copy to */
+	rec_t*		rec,		/*!< in: first record to copy */
+	dict_index_t*	index,		/*!< in: record descriptor */
+	mtr_t*		mtr)		/*!< in: mtr */
+{
+	page_append_t	app;
+	mem_heap_t*	heap		= NULL;
+	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*		offsets		= offsets_;
+	rec_offs_init(offsets_);
+
+	ut_ad(page_dir_get_n_heap(new_page) == PAGE_HEAP_NO_USER_LOW);
+	ut_ad(page_align(rec) != new_page);
+	ut_ad(page_rec_is_comp(rec) == page_is_comp(new_page));
+
+	if (page_rec_is_infimum(rec)) {
+
+		rec = page_rec_get_next(rec);
 	}
 
-	if (page_is_comp(new_page)) {
-		rec_set_next_offs_new(insert_rec, PAGE_NEW_SUPREMUM);
-	} else {
-		rec_set_next_offs_old(insert_rec, PAGE_OLD_SUPREMUM);
+	if (page_rec_is_supremum(rec)) {
+
+		return;
 	}
 
-	slot = page_dir_get_nth_slot(new_page, 1 + slot_index);
+	page_cur_append_start(&app, new_page, index, mtr);
 
-	page_dir_slot_set_rec(slot, page_get_supremum_rec(new_page));
-	page_dir_slot_set_n_owned(slot, NULL, count + 1);
+	do {
+		offsets = rec_get_offsets(rec, index, offsets,
+					  ULINT_UNDEFINED, &heap);
 
-	page_dir_set_n_slots(new_page, NULL, 2 + slot_index);
-	page_header_set_ptr(new_page, NULL, PAGE_HEAP_TOP, heap_top);
-	page_dir_set_n_heap(new_page, NULL, PAGE_HEAP_NO_USER_LOW + n_recs);
-	page_header_set_field(new_page, NULL, PAGE_N_RECS, n_recs);
+		page_cur_append_low(&app, rec_copy(app.heap_top, rec, offsets),
+				    offsets);
 
-	page_header_set_ptr(new_page, NULL, PAGE_LAST_INSERT, NULL);
-	page_header_set_field(new_page, NULL, PAGE_DIRECTION,
-							PAGE_NO_DIRECTION);
-	page_header_set_field(new_page, NULL, PAGE_N_DIRECTION, 0);
+		rec = page_rec_get_next(rec);
+	} while (!page_rec_is_supremum(rec));
 
-	/* Restore the log mode */
+	if (UNIV_LIKELY_NULL(heap)) {
+		mem_heap_free(heap);
+	}
 
-	mtr_set_log_mode(mtr, log_mode);
+	page_cur_append_end(&app);
 }
 
 /***********************************************************//**
@@ -3163,6 +3163,8 @@ err_exit:
 		page_zip_stat_per_index[index_id].decompressed_usec += time_diff;
 		mutex_exit(&page_zip_stat_per_index_mutex);
 	}
+
+	buf_LRU_stat_inc_unzip_time(time_diff);
 #endif /* !UNIV_HOTBACKUP */
 
 	/* Update the stat counter for LRU policy. */
@@ -30,8 +30,16 @@ Created 2/16/1997 Heikki Tuuri
 #endif
 
 #include "srv0srv.h"
+#include "srv0mon.h"
 #include "trx0sys.h"
 
+#include <algorithm>
+
+/** Number of extra cells allocated in the trx_ids array of a read view
+that is opened for a transaction, on top of twice the current number of
+active read-write transactions */
+#define READ_VIEW_N_TRX_IDS_MARGIN	32
+
 /*
 -------------------------------------------------------------------------------
 FACT A: Cursor read view on a secondary index sees only committed versions
@@ -191,6 +199,7 @@ read_view_create_low(
 			heap, sizeof(*view) + n * sizeof(*view->trx_ids)));
 
 	view->n_trx_ids = n;
+	view->max_trx_ids = n;
 	view->trx_ids = (trx_id_t*) &view[1];
 
 	return(view);
@@ -231,10 +240,12 @@ read_view_clone(
 	memcpy(clone, view, sz);
 
 	clone->trx_ids = (trx_id_t*) &clone[1];
+	clone->max_trx_ids = clone->n_trx_ids;
 
 	new_view = (read_view_t*) &clone->trx_ids[clone->n_trx_ids];
 	new_view->trx_ids = (trx_id_t*) &new_view[1];
 	new_view->n_trx_ids = clone->n_trx_ids + 1;
+	new_view->max_trx_ids = new_view->n_trx_ids;
 
 	ut_a(new_view->n_trx_ids == view->n_trx_ids + 1);
 
@@ -273,52 +284,70 @@ read_view_add(
 	ut_ad(read_view_list_validate());
 }
 
-/** Functor to create thew view trx_ids array. */
-struct	CreateView {
+/*********************************************************************//**
+Copies the ids of the active read-write transactions and the limits of a
+read view from trx_sys. */
+static
+void
+read_view_copy_trx_ids(
+/*===================*/
+	read_view_t*	view,		/*!< in/out: read view */
+	trx_id_t	cr_trx_id)	/*!< in: trx_id to leave out of
+					view->trx_ids, or 0 */
+{
+	const trx_id_t*	ids = trx_sys->rw_trx_ids;
+	ulint		n = trx_sys->n_rw_trx_ids;
+	const trx_id_t*	pos;
+	const trx_t*	trx;
 
-	CreateView(read_view_t*	view)
-		: m_view(view)
-	{
-		  m_n_trx = m_view->n_trx_ids;
-		  m_view->n_trx_ids = 0;
-	}
+	ut_ad(mutex_own(&trx_sys->mutex));
+	ut_ad(view->max_trx_ids >= n);
 
-	void	operator()(const trx_t* trx)
-	{
-		ut_ad(mutex_own(&trx_sys->mutex));
-		ut_ad(trx->in_rw_trx_list);
+	/* No active transaction should be visible, except cr_trx. The
+	array is sorted, so this is at most two memcpy() calls. */
 
-		/* trx->state cannot change from or to NOT_STARTED
-		while we are holding the trx_sys->mutex. It may change
-		from ACTIVE to PREPARED or COMMITTED. */
+	pos = std::lower_bound(ids, ids + n, cr_trx_id);
 
-		if (trx->id != m_view->creator_trx_id
-		    && !trx_state_eq(trx, TRX_STATE_COMMITTED_IN_MEMORY)) {
+	if (pos != ids + n && *pos == cr_trx_id) {
+		ulint	n_before = pos - ids;
 
-			ut_ad(m_n_trx > m_view->n_trx_ids);
+		memcpy(view->trx_ids, ids, n_before * sizeof(*ids));
+		memcpy(view->trx_ids + n_before, pos + 1,
+		       (n - n_before - 1) * sizeof(*ids));
 
-			m_view->trx_ids[m_view->n_trx_ids++] = trx->id;
+		view->n_trx_ids = n - 1;
+	} else {
+		memcpy(view->trx_ids, ids, n * sizeof(*ids));
 
-			/* NOTE that a transaction whose trx number is <
-			trx_sys->max_trx_id can still be active, if it is
-			in the middle of its commit! Note that when a
-			transaction starts, we initialize trx->no to
-			TRX_ID_MAX. */
+		view->n_trx_ids = n;
+	}
 
-			/* trx->no is protected by trx_sys->mutex, which
-			we are holding. It is assigned by trx_commit()
-			before lock_trx_release_locks() assigns
-			trx->state = TRX_STATE_COMMITTED_IN_MEMORY. */
+	/* No future transactions should be visible in the view */
 
-			if (m_view->low_limit_no > trx->no) {
-				m_view->low_limit_no = trx->no;
-			}
-		}
+	view->low_limit_id = trx_sys->max_trx_id;
+
+	/* NOTE that a transaction whose trx number is <
+	trx_sys->max_trx_id can still be active, if it is in the middle
+	of its commit! The serialisation list is ordered by trx->no, so
+	the smallest such number is that of its first element. */
+
+	trx = UT_LIST_GET_FIRST(trx_sys->serialisation_list);
+
+	if (trx != NULL && trx->no < view->low_limit_id) {
+		view->low_limit_no = trx->no;
+	} else {
+		view->low_limit_no = view->low_limit_id;
+	}
+
+	if (view->n_trx_ids > 0) {
+		/* The first active transaction has the smallest id: */
+		view->up_limit_id = view->trx_ids[0];
+	} else {
+		view->up_limit_id = view->low_limit_id;
 	}
 
-	read_view_t*	m_view;
-	ulint		m_n_trx;
-};
+	view->rw_trx_ids_version = trx_sys->rw_trx_ids_version;
+}
 
 /*********************************************************************//**
 Opens a read view where exactly the transactions serialized before this
@@ -330,36 +359,59 @@ read_view_open_now_low(
 /*===================*/
 	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
 					transaction, or 0 used in purge */
+	read_view_t*	view,		/*!< in: closed read view allocated
+					from heap, to be reused if possible,
+					or NULL */
 	mem_heap_t*	heap)		/*!< in: memory heap from which
 					allocated */
 {
-	read_view_t*	view;
-	ulint		n_trx = UT_LIST_GET_LEN(trx_sys->rw_trx_list);
+	ulint		n_trx = trx_sys->n_rw_trx_ids;
 
 	ut_ad(mutex_own(&trx_sys->mutex));
 
-	view = read_view_create_low(n_trx, heap);
+	if (view != NULL
+	    && view->rw_trx_ids_version == trx_sys->rw_trx_ids_version
+	    && cr_trx_id < view->low_limit_id) {
 
-	view->undo_no = 0;
-	view->type = VIEW_NORMAL;
-	view->creator_trx_id = cr_trx_id;
+		/* No read-write transaction has started or committed
+		since the view was opened: its contents are still valid.
+		Because any such event changes the version, cr_trx_id
+		is either the same as when the view was opened, or it
+		is the id of a read-only transaction, which is not in
+		the array either. A read-only transaction that writes
+		to temporary tables gets its id without changing the
+		version, though: the view must not be reused if that id
+		is at or above its low limit, or the transaction would
+		not see its own changes. */
 
-	/* No future transactions should be visible in the view */
+		ut_ad(view->type == VIEW_NORMAL);
 
-	view->low_limit_no = trx_sys->max_trx_id;
-	view->low_limit_id = view->low_limit_no;
+		MONITOR_INC(MONITOR_READ_VIEW_REUSED);
+	} else {
+		if (view == NULL || view->max_trx_ids < n_trx) {
 
-	/* No active transaction should be visible, except cr_trx */
+			if (view != NULL) {
+				/* The old view is closed: release its
+				memory before allocating a bigger one. */
 
-	ut_list_map(trx_sys->rw_trx_list, &trx_t::trx_list, CreateView(view));
+				mem_heap_empty(heap);
+			}
 
-	if (view->n_trx_ids > 0) {
-		/* The last active transaction has the smallest id: */
-		view->up_limit_id = view->trx_ids[view->n_trx_ids - 1];
-	} else {
-		view->up_limit_id = view->low_limit_id;
+			/* Leave room for more transactions, so that the
+			memory can be reused while their number grows. */
+
+			view = read_view_create_low(
+				2 * n_trx + READ_VIEW_N_TRX_IDS_MARGIN, heap);
+		}
+
+		view->undo_no = 0;
+		view->type = VIEW_NORMAL;
+
+		read_view_copy_trx_ids(view, cr_trx_id);
 	}
 
+	view->creator_trx_id = cr_trx_id;
+
 	/* Purge views are not added to the view list. */
 	if (cr_trx_id > 0) {
 		read_view_add(view);
@@ -378,14 +430,15 @@ read_view_open_now(
 /*===============*/
 	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
 					transaction, or 0 used in purge */
+	read_view_t*	view,		/*!< in: closed read view allocated
+					from heap, to be reused if possible,
+					or NULL */
 	mem_heap_t*	heap)		/*!< in: memory heap from which
 					allocated */
 {
-	read_view_t*	view;
-
 	mutex_enter(&trx_sys->mutex);
 
-	view = read_view_open_now_low(cr_trx_id, heap);
+	view = read_view_open_now_low(cr_trx_id, view, heap);
 
 	mutex_exit(&trx_sys->mutex);
 
@@ -417,7 +470,7 @@ read_view_purge_open(
 
 	if (oldest_view == NULL) {
 
-		view = read_view_open_now_low(0, heap);
+		view = read_view_open_now_low(0, NULL, heap);
 
 		mutex_exit(&trx_sys->mutex);
 
@@ -445,7 +498,7 @@ read_view_purge_open(
 
 		id = oldest_view->trx_ids[i - insert_done];
 
-		if (insert_done == 0 && creator_trx_id > id) {
+		if (insert_done == 0 && creator_trx_id < id) {
 			id = creator_trx_id;
 			insert_done = 1;
 		}
@@ -466,9 +519,9 @@ read_view_purge_open(
 	view->low_limit_id = oldest_view->low_limit_id;
 
 	if (view->n_trx_ids > 0) {
-		/* The last active transaction has the smallest id: */
+		/* The first active transaction has the smallest id: */
 
-		view->up_limit_id = view->trx_ids[view->n_trx_ids - 1];
+		view->up_limit_id = view->trx_ids[0];
 	} else {
 		view->up_limit_id = oldest_view->up_limit_id;
 	}
@@ -489,7 +542,8 @@ read_view_close_for_mysql(
 
 	read_view_remove(trx->global_read_view, false);
 
-	mem_heap_empty(trx->global_read_view_heap);
+	/* The closed view is kept in trx->cached_read_view, so that
+	the next read view of the transaction can reuse it. */
 
 	trx->read_view = NULL;
 	trx->global_read_view = NULL;
@@ -567,34 +621,20 @@ read_cursor_view_create_for_mysql(
 
 	mutex_enter(&trx_sys->mutex);
 
-	n_trx = UT_LIST_GET_LEN(trx_sys->rw_trx_list);
+	n_trx = trx_sys->n_rw_trx_ids;
 
 	curview->read_view = read_view_create_low(n_trx, curview->heap);
 
 	view = curview->read_view;
 	view->undo_no = cr_trx->undo_no;
 	view->type = VIEW_HIGH_GRANULARITY;
-	view->creator_trx_id = UINT64_UNDEFINED;
-
-	/* No future transactions should be visible in the view */
-
-	view->low_limit_no = trx_sys->max_trx_id;
-	view->low_limit_id = view->low_limit_no;
 
-	/* No active transaction should be visible */
+	/* No active transaction should be visible, not even cr_trx */
 
-	ut_list_map(trx_sys->rw_trx_list, &trx_t::trx_list, CreateView(view));
+	read_view_copy_trx_ids(view, 0);
 
 	view->creator_trx_id = cr_trx->id;
 
-	if (view->n_trx_ids > 0) {
-		/* The last active transaction has the smallest id: */
-
-		view->up_limit_id = view->trx_ids[view->n_trx_ids - 1];
-	} else {
-		view->up_limit_id = view->low_limit_id;
-	}
-
 	read_view_add(view);
 
 	mutex_exit(&trx_sys->mutex);
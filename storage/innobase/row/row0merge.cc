@@ -25,6 +25,7 @@ Completed by Sunny Bains and Marko Makela
 *******************************************************/
 
 #include "row0merge.h"
+#include "btr0bulk.h"
 #include "row0ext.h"
 #include "row0log.h"
 #include "row0ins.h"
@@ -542,7 +543,15 @@ row_merge_dup_report(
 	if (!dup->n_dup++) {
 		/* Only report the first duplicate record,
 		but count all duplicate records. */
+		if (dup->mutex) {
+			mutex_enter(dup->mutex);
+		}
+
 		innobase_fields_to_mysql(dup->table, dup->index, entry);
+
+		if (dup->mutex) {
+			mutex_exit(dup->mutex);
+		}
 	}
 }
 
@@ -1148,6 +1157,824 @@ row_merge_write_eof(
 	return(&block[0]);
 }
 
+/** Maximum number of key ranges per thread in a parallel scan of the
+clustered index. The ranges are handed out one at a time, so that a
+thread that finishes early takes over work from the others. */
+#define ROW_MERGE_PLL_RANGES_PER_THREAD	16
+
+/** A job that is split into work items and run by several threads,
+see row_merge_pll_run(). */
+struct row_merge_pll_t {
+	ib_mutex_t	mutex;		/*!< protects next, error,
+					error_key_num and the output
+					files of the job */
+	os_event_t	done;		/*!< set when the last thread
+					has finished */
+	ulint		n_running;	/*!< number of threads that are
+					still running */
+	ulint		next;		/*!< next work item to hand out */
+	ulint		n_items;	/*!< number of work items */
+	dberr_t		error;		/*!< error reported by the first
+					thread that failed, or DB_SUCCESS */
+	ulint		error_key_num;	/*!< index of the index in error */
+	void		(*func)(row_merge_pll_t*, row_merge_block_t*);
+					/*!< function run by each thread */
+	void*		arg;		/*!< job specific data */
+};
+
+/** Argument of row_merge_pll_thread() */
+struct row_merge_pll_thr_t {
+	row_merge_pll_t*	pll;	/*!< job to run */
+	row_merge_block_t*	block;	/*!< 3 buffers for the thread */
+	ulint			block_size;/*!< size of block in bytes */
+};
+
+#ifdef UNIV_PFS_MUTEX
+UNIV_INTERN mysql_pfs_key_t	row_merge_pll_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
+/*********************************************************************//**
+Initializes a parallel job. */
+static
+void
+row_merge_pll_create(
+/*=================*/
+	row_merge_pll_t*	pll,	/*!< out: job */
+	void			(*func)(row_merge_pll_t*,
+					row_merge_block_t*),
+					/*!< in: function run by each thread */
+	void*			arg,	/*!< in: job specific data */
+	ulint			n_items)/*!< in: number of work items */
+{
+	memset(pll, 0, sizeof *pll);
+
+	mutex_create(row_merge_pll_mutex_key, &pll->mutex,
+		     SYNC_ROW_MERGE_PLL);
+
+	pll->done = os_event_create();
+	pll->n_items = n_items;
+	pll->error = DB_SUCCESS;
+	pll->error_key_num = ULINT_UNDEFINED;
+	pll->func = func;
+	pll->arg = arg;
+}
+
+/*********************************************************************//**
+Frees the synchronization objects of a parallel job. */
+static
+void
+row_merge_pll_free(
+/*===============*/
+	row_merge_pll_t*	pll)	/*!< in/out: job */
+{
+	ut_ad(pll->n_running == 0);
+
+	os_event_free(pll->done);
+	mutex_free(&pll->mutex);
+}
+
+/*********************************************************************//**
+Hands out the next work item of a parallel job.
+@return work item, or ULINT_UNDEFINED if there is nothing left to do
+or the job has failed */
+static
+ulint
+row_merge_pll_next(
+/*===============*/
+	row_merge_pll_t*	pll)	/*!< in/out: job */
+{
+	ulint	item = ULINT_UNDEFINED;
+
+	mutex_enter(&pll->mutex);
+
+	if (pll->error == DB_SUCCESS && pll->next < pll->n_items) {
+		item = pll->next++;
+	}
+
+	mutex_exit(&pll->mutex);
+
+	return(item);
+}
+
+/*********************************************************************//**
+Reports an error in a parallel job. The other threads stop when they
+ask for their next work item. Only the first error is kept. */
+static
+void
+row_merge_pll_set_error(
+/*====================*/
+	row_merge_pll_t*	pll,	/*!< in/out: job */
+	dberr_t			err,	/*!< in: error code */
+	ulint			key_num)/*!< in: index of the index in
+					error, or ULINT_UNDEFINED */
+{
+	ut_ad(err != DB_SUCCESS);
+
+	mutex_enter(&pll->mutex);
+
+	if (pll->error == DB_SUCCESS) {
+		pll->error = err;
+		pll->error_key_num = key_num;
+	}
+
+	mutex_exit(&pll->mutex);
+}
+
+/*********************************************************************//**
+Called by each thread of a parallel job when it is done. The last one
+wakes up the thread waiting in row_merge_pll_run(). */
+static
+void
+row_merge_pll_exit(
+/*===============*/
+	row_merge_pll_t*	pll)	/*!< in/out: job */
+{
+	if (os_atomic_decrement_ulint(&pll->n_running, 1) == 0) {
+		os_event_set(pll->done);
+	}
+}
+
+/*********************************************************************//**
+Helper thread of a parallel job.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(row_merge_pll_thread)(
+/*=================================*/
+	void*	arg)	/*!< in: row_merge_pll_thr_t */
+{
+	row_merge_pll_thr_t*	thr = static_cast<row_merge_pll_thr_t*>(arg);
+	row_merge_pll_t*	pll = thr->pll;
+
+	pll->func(pll, thr->block);
+
+	row_merge_pll_exit(pll);
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*********************************************************************//**
+Runs a parallel job in the calling thread and in up to n_threads - 1
+helper threads, and waits until all of them have finished.
+@return	DB_SUCCESS or the first error reported by a thread */
+static __attribute__((nonnull, warn_unused_result))
+dberr_t
+row_merge_pll_run(
+/*==============*/
+	row_merge_pll_t*	pll,	/*!< in/out: job */
+	ulint			n_threads,/*!< in: number of threads */
+	row_merge_block_t*	block)	/*!< in/out: 3 buffers for the
+					calling thread */
+{
+	row_merge_pll_thr_t*	thr;
+	ulint			n;
+
+	n_threads = ut_min(n_threads, pll->n_items);
+
+	thr = static_cast<row_merge_pll_thr_t*>(
+		mem_alloc(ut_max(n_threads, 1) * sizeof *thr));
+
+	/* Every helper thread needs buffers of its own. If they
+	cannot be allocated, run the job with fewer threads. */
+	for (n = 1; n < n_threads; n++) {
+		thr[n].pll = pll;
+		thr[n].block_size = 3 * srv_sort_buf_size;
+		thr[n].block = static_cast<row_merge_block_t*>(
+			os_mem_alloc_large(&thr[n].block_size));
+
+		if (thr[n].block == NULL) {
+			break;
+		}
+	}
+
+	pll->n_running = n;
+
+	for (ulint i = 1; i < n; i++) {
+		os_thread_create(row_merge_pll_thread, &thr[i], NULL);
+	}
+
+	pll->func(pll, block);
+
+	row_merge_pll_exit(pll);
+
+	os_event_wait(pll->done);
+
+	for (ulint i = 1; i < n; i++) {
+		os_mem_free_large(thr[i].block, thr[i].block_size);
+	}
+
+	mem_free(thr);
+
+	return(pll->error);
+}
+
+/** Parallel scan of the clustered index, creating the entries of the
+secondary indexes being added to a table that is not rebuilt */
+struct row_merge_scan_t {
+	trx_t*			trx;	/*!< transaction */
+	struct TABLE*		table;	/*!< MySQL table object, for
+					reporting duplicate keys */
+	const dict_table_t*	old_table;/*!< table being scanned */
+	bool			online;	/*!< true if creating indexes
+					online */
+	dict_index_t**		index;	/*!< indexes to be created */
+	merge_file_t*		files;	/*!< temporary files; offset and
+					n_rec are protected by
+					row_merge_pll_t::mutex */
+	ulint			n_index;/*!< number of indexes to create */
+	const dtuple_t**	bounds;	/*!< n_ranges - 1 boundaries of
+					the key ranges, ascending */
+};
+
+/*********************************************************************//**
+Splits the clustered index into key ranges for a parallel scan. The
+boundaries are the keys of evenly spaced node pointers on the root
+page, or on the level below it if the root has too few of them.
+@return	number of boundaries stored in bounds[] */
+static
+ulint
+row_merge_scan_get_bounds(
+/*======================*/
+	dict_index_t*		index,	/*!< in: clustered index */
+	ulint			n_max,	/*!< in: maximum number of
+					boundaries */
+	const dtuple_t**	bounds,	/*!< out: boundaries, ascending */
+	mem_heap_t*		heap)	/*!< in: heap for bounds[] */
+{
+	mtr_t		mtr;
+	const ulint	space = dict_index_get_space(index);
+	const ulint	zip_size = dict_table_zip_size(index->table);
+	ulint*		offsets = NULL;
+	mem_heap_t*	offsets_heap = mem_heap_create(256);
+	buf_block_t**	blocks;
+	ulint		n_blocks;
+	ulint		n_recs;
+	ulint		level;
+	ulint		n_bounds = 0;
+
+	mtr_start(&mtr);
+
+	/* Block structure modifications of the tree while the
+	node pointers are being read. */
+	mtr_s_lock(dict_index_get_lock(index), &mtr);
+
+	blocks = static_cast<buf_block_t**>(
+		mem_heap_alloc(offsets_heap, sizeof *blocks));
+	blocks[0] = btr_block_get(space, zip_size,
+				  dict_index_get_page(index),
+				  RW_S_LATCH, index, &mtr);
+	n_blocks = 1;
+	n_recs = page_get_n_recs(buf_block_get_frame(blocks[0]));
+	level = btr_page_get_level(buf_block_get_frame(blocks[0]), &mtr);
+
+	if (level == 0) {
+		/* The root is the only page of the tree. */
+		goto func_exit;
+	}
+
+	/* Go down one level at a time until there are enough node
+	pointers. All the node pointers of a level can be collected in
+	key order, because the pages of the level are visited in the
+	order of the node pointers pointing to them. */
+	while (n_recs <= n_max && level > 1) {
+		buf_block_t**	children = static_cast<buf_block_t**>(
+			mem_heap_alloc(offsets_heap,
+				       n_recs * sizeof *children));
+		ulint		n_children = 0;
+		ulint		n_child_recs = 0;
+
+		for (ulint i = 0; i < n_blocks; i++) {
+			const page_t*	page = buf_block_get_frame(blocks[i]);
+			const rec_t*	rec = page_rec_get_next_const(
+				page_get_infimum_rec(page));
+
+			for (; !page_rec_is_supremum(rec);
+			     rec = page_rec_get_next_const(rec)) {
+				buf_block_t*	child;
+
+				offsets = rec_get_offsets(
+					rec, index, offsets,
+					ULINT_UNDEFINED, &offsets_heap);
+
+				child = btr_block_get(
+					space, zip_size,
+					btr_node_ptr_get_child_page_no(
+						rec, offsets),
+					RW_S_LATCH, index, &mtr);
+
+				children[n_children++] = child;
+				n_child_recs += page_get_n_recs(
+					buf_block_get_frame(child));
+			}
+		}
+
+		blocks = children;
+		n_blocks = n_children;
+		n_recs = n_child_recs;
+		level--;
+	}
+
+	/* The first node pointer of the level carries the minimum
+	record flag and no key, so it cannot be a boundary. */
+	if (n_recs > 1) {
+		const rec_t**	recs = static_cast<const rec_t**>(
+			mem_heap_alloc(offsets_heap,
+				       (n_recs - 1) * sizeof *recs));
+		ulint		n = 0;
+
+		for (ulint i = 0; i < n_blocks; i++) {
+			const page_t*	page = buf_block_get_frame(blocks[i]);
+			const rec_t*	rec = page_rec_get_next_const(
+				page_get_infimum_rec(page));
+
+			if (i == 0) {
+				rec = page_rec_get_next_const(rec);
+			}
+
+			for (; !page_rec_is_supremum(rec);
+			     rec = page_rec_get_next_const(rec)) {
+				recs[n++] = rec;
+			}
+		}
+
+		ut_ad(n == n_recs - 1);
+
+		n_bounds = ut_min(n_max, n);
+
+		for (ulint i = 0; i < n_bounds; i++) {
+			rec_t*		rec = const_cast<rec_t*>(
+				recs[i * n / n_bounds]);
+			dtuple_t*	tuple = dict_index_build_data_tuple(
+				index, rec,
+				dict_index_get_n_unique_in_tree(index), heap);
+
+			dtuple_set_info_bits(tuple, 0);
+			bounds[i] = tuple;
+		}
+	}
+
+func_exit:
+	mtr_commit(&mtr);
+	mem_heap_free(offsets_heap);
+
+	return(n_bounds);
+}
+
+/*********************************************************************//**
+Sorts a full sort buffer of a parallel clustered index scan and writes
+it to a block of the temporary file of its index. The blocks are
+reserved under the job mutex, and each of them is a sorted run of its
+own, so the threads can write in any order.
+@return	DB_SUCCESS or error code */
+static __attribute__((nonnull, warn_unused_result))
+dberr_t
+row_merge_scan_write_buf(
+/*=====================*/
+	row_merge_pll_t*	pll,	/*!< in/out: job */
+	row_merge_buf_t*	buf,	/*!< in/out: sort buffer */
+	merge_file_t*		file,	/*!< in/out: temporary file */
+	row_merge_block_t*	block)	/*!< out: buffer for writing */
+{
+	row_merge_scan_t*	scan = static_cast<row_merge_scan_t*>(
+		pll->arg);
+	ulint			offset;
+
+	if (dict_index_is_unique(buf->index)) {
+		row_merge_dup_t	dup = {
+			buf->index, scan->table, NULL, 0, &pll->mutex};
+
+		row_merge_buf_sort(buf, &dup);
+
+		if (dup.n_dup) {
+			return(DB_DUPLICATE_KEY);
+		}
+	} else {
+		row_merge_buf_sort(buf, NULL);
+	}
+
+	row_merge_buf_write(buf, file, block);
+
+	mutex_enter(&pll->mutex);
+	offset = file->offset++;
+	file->n_rec += buf->n_tuples;
+	mutex_exit(&pll->mutex);
+
+	if (!row_merge_write(file->fd, offset, block)) {
+		return(DB_TEMP_FILE_WRITE_FAILURE);
+	}
+
+	UNIV_MEM_INVALID(&block[0], srv_sort_buf_size);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************//**
+Scans one key range of the clustered index and adds the entries of
+the indexes being created to the sort buffers of the calling thread.
+Full buffers are written to the temporary files.
+@return	DB_SUCCESS or error code */
+static __attribute__((nonnull(1,4,5,6,7), warn_unused_result))
+dberr_t
+row_merge_scan_range(
+/*=================*/
+	row_merge_pll_t*	pll,	/*!< in/out: job */
+	const dtuple_t*		low,	/*!< in: first key of the range,
+					or NULL to start from the
+					beginning of the index */
+	const dtuple_t*		high,	/*!< in: first key after the
+					range, or NULL to scan to the end
+					of the index */
+	row_merge_buf_t**	merge_buf,/*!< in/out: sort buffers */
+	row_merge_block_t*	block,	/*!< out: buffer for writing */
+	mem_heap_t*		row_heap,/*!< in/out: heap for rows */
+	ulint*			err_key)/*!< out: index of the index in
+					error */
+{
+	row_merge_scan_t*	scan = static_cast<row_merge_scan_t*>(
+		pll->arg);
+	trx_t*			trx = scan->trx;
+	const dict_table_t*	old_table = scan->old_table;
+	dict_index_t*		clust_index;
+	btr_pcur_t		pcur;
+	mtr_t			mtr;
+	dberr_t			err = DB_SUCCESS;
+
+	clust_index = dict_table_get_first_index(old_table);
+
+	mtr_start(&mtr);
+
+	if (low == NULL) {
+		btr_pcur_open_at_index_side(
+			true, clust_index, BTR_SEARCH_LEAF, &pcur, true, 0,
+			&mtr);
+	} else {
+		/* Position the cursor on the last record before the
+		range, so that moving to the next record below finds
+		the first record of the range. */
+		btr_pcur_open(clust_index, low, PAGE_CUR_L, BTR_SEARCH_LEAF,
+			      &pcur, &mtr);
+	}
+
+	for (;;) {
+		const rec_t*	rec;
+		ulint*		offsets;
+		const dtuple_t*	row;
+		row_ext_t*	ext;
+		page_cur_t*	cur	= btr_pcur_get_page_cur(&pcur);
+
+		mem_heap_empty(row_heap);
+
+		page_cur_move_to_next(cur);
+
+		if (page_cur_is_after_last(cur)) {
+			ulint		next_page_no;
+			buf_block_t*	next_block;
+
+			if (UNIV_UNLIKELY(trx_is_interrupted(trx))) {
+				err = DB_INTERRUPTED;
+				break;
+			}
+
+			if (pll->error != DB_SUCCESS) {
+				/* Another thread failed. The error
+				is returned from row_merge_pll_run(). */
+				break;
+			}
+
+#ifdef DBUG_OFF
+# define dbug_run_purge	false
+#else /* DBUG_OFF */
+			bool	dbug_run_purge = false;
+#endif /* DBUG_OFF */
+			DBUG_EXECUTE_IF(
+				"ib_purge_on_create_index_page_switch",
+				dbug_run_purge = true;);
+
+			if (dbug_run_purge
+			    || rw_lock_get_waiters(
+				    dict_index_get_lock(clust_index))) {
+				/* There are waiters on the clustered
+				index tree lock, likely the purge
+				thread. Store and restore the cursor
+				position, and yield so that scanning a
+				large table will not starve other
+				threads. */
+				btr_pcur_move_to_prev_on_page(&pcur);
+				ut_ad(btr_pcur_is_on_user_rec(&pcur)
+				      || buf_block_get_page_no(
+					      btr_pcur_get_block(&pcur))
+				      == clust_index->page);
+
+				btr_pcur_store_position(&pcur, &mtr);
+				mtr_commit(&mtr);
+
+				if (dbug_run_purge) {
+					/* See the same code in
+					row_merge_read_clustered_index(). */
+					trx_purge_run();
+					os_thread_sleep(1000000);
+				}
+
+				os_thread_yield();
+
+				mtr_start(&mtr);
+				btr_pcur_restore_position(
+					BTR_SEARCH_LEAF, &pcur, &mtr);
+
+				if (!btr_pcur_move_to_next_user_rec(
+					    &pcur, &mtr)) {
+					break;
+				}
+			} else {
+				next_page_no = btr_page_get_next(
+					page_cur_get_page(cur), &mtr);
+
+				if (next_page_no == FIL_NULL) {
+					break;
+				}
+
+				next_block = page_cur_get_block(cur);
+				next_block = btr_block_get(
+					buf_block_get_space(next_block),
+					buf_block_get_zip_size(next_block),
+					next_page_no, BTR_SEARCH_LEAF,
+					clust_index, &mtr);
+
+				btr_leaf_page_release(
+					page_cur_get_block(cur),
+					BTR_SEARCH_LEAF, &mtr);
+				page_cur_set_before_first(next_block, cur);
+				page_cur_move_to_next(cur);
+
+				ut_ad(!page_cur_is_after_last(cur));
+			}
+		}
+
+		rec = page_cur_get_rec(cur);
+
+		offsets = rec_get_offsets(rec, clust_index, NULL,
+					  ULINT_UNDEFINED, &row_heap);
+
+		/* The PRIMARY KEY of a record never changes, so the
+		range check can be done on the latest version. */
+		if (high && cmp_dtuple_rec(high, rec, offsets) <= 0) {
+			break;
+		}
+
+		if (scan->online) {
+			/* Perform a REPEATABLE READ, as in
+			row_merge_read_clustered_index(). */
+			ut_ad(trx->read_view);
+
+			if (!read_view_sees_trx_id(
+				    trx->read_view,
+				    row_get_rec_trx_id(
+					    rec, clust_index, offsets))) {
+				rec_t*	old_vers;
+
+				row_vers_build_for_consistent_read(
+					rec, &mtr, clust_index, &offsets,
+					trx->read_view, &row_heap,
+					row_heap, &old_vers);
+
+				rec = old_vers;
+
+				if (!rec) {
+					continue;
+				}
+			}
+
+			if (rec_get_deleted_flag(
+				    rec, dict_table_is_comp(old_table))) {
+				continue;
+			}
+		} else if (rec_get_deleted_flag(
+				   rec, dict_table_is_comp(old_table))) {
+			continue;
+		}
+
+		ut_ad(!rec_offs_any_null_extern(rec, offsets));
+
+		row = row_build(ROW_COPY_POINTERS, clust_index,
+				rec, offsets, old_table,
+				NULL, NULL, &ext, row_heap);
+		ut_ad(row);
+
+		for (ulint i = 0; i < scan->n_index; i++) {
+			row_merge_buf_t*	buf = merge_buf[i];
+			doc_id_t		doc_id = 0;
+
+			if (row_merge_buf_add(buf, NULL, old_table, NULL,
+					      row, ext, &doc_id)) {
+				continue;
+			}
+
+			/* The buffer is full. Write it out and
+			add the row to the emptied buffer. */
+			ut_ad(buf->n_tuples);
+
+			err = row_merge_scan_write_buf(
+				pll, buf, &scan->files[i], block);
+
+			if (err != DB_SUCCESS) {
+				*err_key = i;
+				goto func_exit;
+			}
+
+			merge_buf[i] = buf = row_merge_buf_empty(buf);
+
+			if (!row_merge_buf_add(buf, NULL, old_table, NULL,
+					       row, ext, &doc_id)) {
+				/* An empty buffer should have enough
+				room for at least one record. */
+				ut_error;
+			}
+		}
+	}
+
+func_exit:
+	mtr_commit(&mtr);
+	btr_pcur_close(&pcur);
+
+	return(err);
+}
+
+/*********************************************************************//**
+Function run by each thread of a parallel clustered index scan. The
+thread scans key ranges until there are none left, and then writes
+out what remains in its sort buffers. */
+static
+void
+row_merge_scan_func(
+/*================*/
+	row_merge_pll_t*	pll,	/*!< in/out: job */
+	row_merge_block_t*	block)	/*!< in/out: buffer for writing */
+{
+	row_merge_scan_t*	scan = static_cast<row_merge_scan_t*>(
+		pll->arg);
+	row_merge_buf_t**	merge_buf;
+	mem_heap_t*		row_heap;
+	ulint			item;
+	ulint			err_key = ULINT_UNDEFINED;
+	dberr_t			err = DB_SUCCESS;
+
+	merge_buf = static_cast<row_merge_buf_t**>(
+		mem_alloc(scan->n_index * sizeof *merge_buf));
+
+	for (ulint i = 0; i < scan->n_index; i++) {
+		merge_buf[i] = row_merge_buf_create(scan->index[i]);
+	}
+
+	row_heap = mem_heap_create(sizeof(mrec_buf_t));
+
+	while ((item = row_merge_pll_next(pll)) != ULINT_UNDEFINED) {
+		err = row_merge_scan_range(
+			pll,
+			item == 0 ? NULL : scan->bounds[item - 1],
+			item == pll->n_items - 1 ? NULL : scan->bounds[item],
+			merge_buf, block, row_heap, &err_key);
+
+		if (err != DB_SUCCESS) {
+			break;
+		}
+	}
+
+	for (ulint i = 0; i < scan->n_index; i++) {
+		row_merge_buf_t*	buf = merge_buf[i];
+
+		if (err == DB_SUCCESS && buf->n_tuples) {
+			err = row_merge_scan_write_buf(
+				pll, buf, &scan->files[i], block);
+
+			if (err != DB_SUCCESS) {
+				err_key = i;
+			}
+		}
+
+		row_merge_buf_free(buf);
+	}
+
+	if (err != DB_SUCCESS) {
+		row_merge_pll_set_error(pll, err, err_key);
+	}
+
+	mem_heap_free(row_heap);
+	mem_free(merge_buf);
+}
+
+/*********************************************************************//**
+Reads the clustered index of a table in parallel and creates temporary
+files containing the entries of the secondary indexes being added.
+This is used instead of the single-threaded scan in
+row_merge_read_clustered_index() when the table is not being rebuilt
+and no FULLTEXT index is being created.
+@return	DB_SUCCESS or error code */
+static __attribute__((nonnull, warn_unused_result))
+dberr_t
+row_merge_read_clustered_index_pll(
+/*===============================*/
+	trx_t*			trx,	/*!< in: transaction */
+	struct TABLE*		table,	/*!< in/out: MySQL table object,
+					for reporting erroneous records */
+	const dict_table_t*	old_table,/*!< in: table where rows are
+					read from and indexes created */
+	bool			online,	/*!< in: true if creating indexes
+					online */
+	dict_index_t**		index,	/*!< in: indexes to be created */
+	merge_file_t*		files,	/*!< in: temporary files */
+	const ulint*		key_numbers,
+					/*!< in: MySQL key numbers to create */
+	ulint			n_index,/*!< in: number of indexes to create */
+	row_merge_block_t*	block)	/*!< in/out: file buffer */
+{
+	row_merge_scan_t	scan;
+	row_merge_pll_t		pll;
+	mem_heap_t*		heap;
+	ulint			n_ranges;
+	dberr_t			err;
+	DBUG_ENTER("row_merge_read_clustered_index_pll");
+
+	trx->op_info = "reading clustered index";
+
+	heap = mem_heap_create(1024);
+
+	scan.trx = trx;
+	scan.table = table;
+	scan.old_table = old_table;
+	scan.online = online;
+	scan.index = index;
+	scan.files = files;
+	scan.n_index = n_index;
+	scan.bounds = static_cast<const dtuple_t**>(
+		mem_heap_alloc(heap, srv_sort_pll_degree
+			       * ROW_MERGE_PLL_RANGES_PER_THREAD
+			       * sizeof *scan.bounds));
+
+	n_ranges = 1 + row_merge_scan_get_bounds(
+		dict_table_get_first_index(old_table),
+		srv_sort_pll_degree * ROW_MERGE_PLL_RANGES_PER_THREAD - 1,
+		scan.bounds, heap);
+
+	row_merge_pll_create(&pll, row_merge_scan_func, &scan, n_ranges);
+
+	err = row_merge_pll_run(&pll, srv_sort_pll_degree, block);
+
+	if (err != DB_SUCCESS) {
+		trx->error_key_num = pll.error_key_num == ULINT_UNDEFINED
+			? 0 : key_numbers[pll.error_key_num];
+	}
+
+	row_merge_pll_free(&pll);
+
+	for (ulint i = 0; err == DB_SUCCESS && i < n_index; i++) {
+		if (online) {
+			/* Note the newest transaction that modified
+			this index when the scan was completed. We
+			prevent older readers from accessing this
+			index, to ensure read consistency. */
+			trx_id_t	max_trx_id;
+
+			rw_lock_x_lock(dict_index_get_lock(index[i]));
+			ut_a(dict_index_get_online_status(index[i])
+			     == ONLINE_INDEX_CREATION);
+
+			max_trx_id = row_log_get_max_trx(index[i]);
+
+			if (max_trx_id > index[i]->trx_id) {
+				index[i]->trx_id = max_trx_id;
+			}
+
+			rw_lock_x_unlock(dict_index_get_lock(index[i]));
+		}
+
+		if (files[i].offset == 0) {
+			/* The merge sort expects at least one block,
+			holding the end-of-list marker. */
+			row_merge_buf_t*	buf = row_merge_buf_create(
+				index[i]);
+
+			row_merge_buf_write(buf, &files[i], block);
+
+			if (!row_merge_write(files[i].fd, files[i].offset++,
+					     block)) {
+				err = DB_TEMP_FILE_WRITE_FAILURE;
+				trx->error_key_num = key_numbers[i];
+			}
+
+			UNIV_MEM_INVALID(&block[0], srv_sort_buf_size);
+			row_merge_buf_free(buf);
+		}
+	}
+
+	mem_heap_free(heap);
+
+	trx->op_info = "";
+
+	DBUG_RETURN(err);
+}
+
 /********************************************************************//**
 Reads clustered index of the table and create temporary files
 containing the index entries for the indexes to be built.
@@ -1213,6 +2040,18 @@ row_merge_read_clustered_index(
 	ut_ad((old_table == new_table) == !col_map);
 	ut_ad(!add_cols || col_map);
 
+	if (srv_sort_pll_degree > 1 && old_table == new_table
+	    && fts_sort_idx == NULL) {
+		/* Only secondary indexes are being created. The rows
+		are not modified and their order does not matter, so
+		the clustered index can be scanned in parallel. */
+		ut_ad(add_autoinc == ULINT_UNDEFINED);
+
+		DBUG_RETURN(row_merge_read_clustered_index_pll(
+				    trx, table, old_table, online, index,
+				    files, key_numbers, n_index, block));
+	}
+
 	trx->op_info = "reading clustered index";
 
 #ifdef FTS_INTERNAL_DIAG_PRINT
@@ -2157,6 +2996,171 @@ row_merge(
 	return(DB_SUCCESS);
 }
 
+/** One pass of a parallel merge sort, see row_merge_pll_pass() */
+struct row_merge_merge_t {
+	trx_t*			trx;	/*!< transaction */
+	const row_merge_dup_t*	dup;	/*!< descriptor of index being
+					created */
+	const merge_file_t*	file;	/*!< input file */
+	int			fd;	/*!< output file */
+	ulint			half;	/*!< number of runs in the first
+					half of the input */
+	const ulint*		run_offset;/*!< first offset of each
+					input run */
+	const ulint*		out_offset;/*!< first offset of each
+					output run */
+	ulint			n_rec;	/*!< number of records written,
+					protected by the job mutex */
+};
+
+/*********************************************************************//**
+Function run by each thread of a parallel merge pass. Work item k
+merges input run k with input run half + k, or copies input run
+half + k when the first half has no run left to pair it with. */
+static
+void
+row_merge_merge_func(
+/*=================*/
+	row_merge_pll_t*	pll,	/*!< in/out: job */
+	row_merge_block_t*	block)	/*!< in/out: 3 buffers */
+{
+	row_merge_merge_t*	merge = static_cast<row_merge_merge_t*>(
+		pll->arg);
+	ulint			item;
+
+	while ((item = row_merge_pll_next(pll)) != ULINT_UNDEFINED) {
+		merge_file_t	of;
+		ulint		foffs0;
+		ulint		foffs1;
+		dberr_t		err = DB_SUCCESS;
+
+		if (trx_is_interrupted(merge->trx)) {
+			row_merge_pll_set_error(pll, DB_INTERRUPTED,
+						ULINT_UNDEFINED);
+			break;
+		}
+
+		of.fd = merge->fd;
+		of.offset = merge->out_offset[item];
+		of.n_rec = 0;
+
+		foffs1 = merge->run_offset[merge->half + item];
+
+		if (item < merge->half) {
+			foffs0 = merge->run_offset[item];
+
+			err = row_merge_blocks(merge->dup, merge->file,
+					       block, &foffs0, &foffs1, &of);
+		} else if (!row_merge_blocks_copy(merge->dup->index,
+						  merge->file, block,
+						  &foffs1, &of)) {
+			err = DB_CORRUPTION;
+		}
+
+		UNIV_MEM_INVALID(&block[0], 3 * srv_sort_buf_size);
+
+		if (err != DB_SUCCESS) {
+			row_merge_pll_set_error(pll, err, ULINT_UNDEFINED);
+			break;
+		}
+
+		mutex_enter(&pll->mutex);
+		merge->n_rec += of.n_rec;
+		mutex_exit(&pll->mutex);
+	}
+}
+
+/*************************************************************//**
+Merges pairs of runs in parallel. Unlike row_merge(), the runs of the
+input file need not be contiguous: each output run is written at the
+offset where the input runs it was made from would start if they were
+laid out back to back, so that the threads never write over each
+other. An output run is never longer than its input runs, but it may
+leave unused blocks behind it, and those are skipped on the next pass
+through run_offset.
+@return	DB_SUCCESS or error code */
+static __attribute__((nonnull))
+dberr_t
+row_merge_pll_pass(
+/*===============*/
+	trx_t*			trx,	/*!< in: transaction */
+	const row_merge_dup_t*	dup,	/*!< in: descriptor of
+					index being created */
+	merge_file_t*		file,	/*!< in/out: file containing
+					index entries */
+	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
+	int*			tmpfd,	/*!< in/out: temporary file handle */
+	ulint*			num_run,/*!< in/out: Number of runs remain
+					to be merged */
+	ulint*			run_offset) /*!< in/out: Array contains the
+					first offset number for each merge
+					run */
+{
+	row_merge_merge_t	merge;
+	row_merge_pll_t		pll;
+	ulint*			out_offset;
+	ulint			n_items;
+	ulint			offset	= 0;
+	dberr_t			error;
+
+	ut_ad(*num_run > 1);
+
+	merge.half = *num_run / 2;
+	n_items = *num_run - merge.half;
+
+	out_offset = static_cast<ulint*>(
+		mem_alloc(n_items * sizeof *out_offset));
+
+	for (ulint i = 0; i < n_items; i++) {
+		ulint	j = merge.half + i;
+
+		out_offset[i] = offset;
+
+		/* Add the size of the input runs of this item. */
+		offset += (j + 1 < *num_run
+			   ? run_offset[j + 1] : file->offset)
+			- run_offset[j];
+
+		if (i < merge.half) {
+			offset += run_offset[i + 1] - run_offset[i];
+		}
+	}
+
+	ut_ad(offset <= file->offset);
+
+	merge.trx = trx;
+	merge.dup = dup;
+	merge.file = file;
+	merge.fd = *tmpfd;
+	merge.run_offset = run_offset;
+	merge.out_offset = out_offset;
+	merge.n_rec = 0;
+
+	row_merge_pll_create(&pll, row_merge_merge_func, &merge, n_items);
+
+	error = row_merge_pll_run(&pll, srv_sort_pll_degree, block);
+
+	row_merge_pll_free(&pll);
+
+	if (error == DB_SUCCESS && merge.n_rec != file->n_rec) {
+		error = DB_CORRUPTION;
+	}
+
+	if (error == DB_SUCCESS) {
+		memcpy(run_offset, out_offset, n_items * sizeof *out_offset);
+		*num_run = n_items;
+
+		/* Swap file descriptors for the next pass. The output
+		file is no longer than the input file. */
+		*tmpfd = file->fd;
+		file->fd = merge.fd;
+	}
+
+	mem_free(out_offset);
+
+	return(error);
+}
+
 /*************************************************************//**
 Merge disk files.
 @return	DB_SUCCESS or error code */
@@ -2172,9 +3176,9 @@ row_merge_sort(
 	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
 	int*			tmpfd)	/*!< in/out: temporary file handle */
 {
-	const ulint	half	= file->offset / 2;
 	ulint		num_runs;
 	ulint*		run_offset;
+	bool		pll;
 	dberr_t		error	= DB_SUCCESS;
 	DBUG_ENTER("row_merge_sort");
 
@@ -2189,18 +3193,29 @@ row_merge_sort(
 	/* "run_offset" records each run's first offset number */
 	run_offset = (ulint*) mem_alloc(file->offset * sizeof(ulint));
 
-	/* This tells row_merge() where to start for the first round
-	of merge. */
-	run_offset[half] = half;
+	/* Each block of the file is a run of its own when the merge
+	starts. row_merge() only needs to know where the second half
+	starts for the first round of merge. */
+	for (ulint i = 0; i < num_runs; i++) {
+		run_offset[i] = i;
+	}
 
 	/* The file should always contain at least one byte (the end
 	of file marker).  Thus, it must be at least one block. */
 	ut_ad(file->offset > 0);
 
+	/* Merging into a UNIQUE index reports duplicates through the
+	MySQL record buffer of the table, which the threads of a
+	parallel merge would share. */
+	pll = srv_sort_pll_degree > 1 && !dict_index_is_unique(dup->index);
+
 	/* Merge the runs until we have one big run */
 	do {
-		error = row_merge(trx, dup, file, block, tmpfd,
-				  &num_runs, run_offset);
+		error = pll
+			? row_merge_pll_pass(trx, dup, file, block, tmpfd,
+					     &num_runs, run_offset)
+			: row_merge(trx, dup, file, block, tmpfd,
+				    &num_runs, run_offset);
 
 		if (error != DB_SUCCESS) {
 			break;
@@ -2279,12 +3294,19 @@ row_merge_insert_index_tuples(
 	ulint			foffs = 0;
 	ulint*			offsets;
 	mrec_buf_t*		buf;
+	btr_bulk_t*		bulk;
 	DBUG_ENTER("row_merge_insert_index_tuples");
 
 	ut_ad(!srv_read_only_mode);
 	ut_ad(!(index->type & DICT_FTS));
 	ut_ad(trx_id);
 
+	/* Build the tree bottom-up, unless the pages have to be
+	compressed, which the insert path below takes care of. */
+	bulk = btr_bulk_is_supported(index)
+		? btr_bulk_create(index, trx_id)
+		: NULL;
+
 	tuple_heap = mem_heap_create(1000);
 
 	{
@@ -2369,6 +3391,18 @@ row_merge_insert_index_tuples(
 			}
 
 			ut_ad(dtuple_validate(dtuple));
+
+			if (bulk != NULL) {
+				error = btr_bulk_insert(bulk, dtuple);
+
+				if (error != DB_SUCCESS) {
+					goto err_exit;
+				}
+
+				mem_heap_empty(tuple_heap);
+				continue;
+			}
+
 			log_free_check();
 
 			mtr_start(&mtr);
@@ -2459,6 +3493,10 @@ row_merge_insert_index_tuples(
 	}
 
 err_exit:
+	if (bulk != NULL) {
+		error = btr_bulk_finish(bulk, error);
+	}
+
 	mem_heap_free(tuple_heap);
 	mem_heap_free(ins_heap);
 	mem_heap_free(heap);
@@ -3502,6 +4540,7 @@ row_merge_build_indexes(
 			dup->table = table;
 			dup->col_map = col_map;
 			dup->n_dup = 0;
+			dup->mutex = NULL;
 
 			row_fts_psort_info_init(
 				trx, dup, new_table, opt_doc_id_size,
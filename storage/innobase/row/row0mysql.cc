@@ -55,6 +55,7 @@ Created 9/17/2000 Heikki Tuuri
 #include "rem0cmp.h"
 #include "log0log.h"
 #include "btr0sea.h"
+#include "buf0lru.h"
 #include "fil0fil.h"
 #include "ibuf0ibuf.h"
 #include "fts0fts.h"
@@ -909,6 +910,10 @@ row_prebuilt_free(
 		mem_heap_free(prebuilt->old_vers_heap);
 	}
 
+	if (prebuilt->scan_ring) {
+		buf_scan_ring_free(prebuilt->scan_ring);
+	}
+
 	if (prebuilt->fetch_cache[0] != NULL) {
 		byte*	base = prebuilt->fetch_cache[0] - 4;
 		byte*	ptr = base;
@@ -975,6 +975,8 @@ row_purge_step(
 
 		row_purge(node, purge_rec->undo_rec, thr);
 
+		++node->n_purged;
+
 		if (ib_vector_is_empty(node->undo_recs)) {
 			row_purge_end(thr);
 		} else {
@@ -56,6 +56,7 @@ Created 12/19/1997 Heikki Tuuri
 #include "row0mysql.h"
 #include "read0read.h"
 #include "buf0lru.h"
+#include "buf0rea.h"
 #include "ha_prototypes.h"
 #include "m_string.h" /* for my_sys.h */
 #include "my_sys.h" /* DEBUG_SYNC_C */
@@ -69,6 +70,10 @@ Created 12/19/1997 Heikki Tuuri
 has another parameter */
 #define SEL_PREFETCH_LIMIT	1
 
+/* Maximum number of clustered index leaf pages to read ahead at a time for
+the lookups of a secondary index scan; see innodb_clust_prefetch_pages */
+#define SEL_MAX_CLUST_PREFETCH	64
+
 /* When a select has accessed about this many pages, it returns control back
 to que_run_threads: this is to allow canceling runaway queries */
 
@@ -1215,7 +1220,7 @@ row_sel_try_search_shortcut(
 				index */
 	ibool		search_latch_locked,
 				/*!< in: whether the search holds
-				btr_search_latch */
+				btr_search_get_latch(plan->index) */
 	mtr_t*		mtr)	/*!< in: mtr */
 {
 	dict_index_t*	index;
@@ -1233,7 +1238,8 @@ row_sel_try_search_shortcut(
 	ut_ad(!plan->must_get_clust);
 #ifdef UNIV_SYNC_DEBUG
 	if (search_latch_locked) {
-		ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
+		ut_ad(rw_lock_own(btr_search_get_latch(index),
+				  RW_LOCK_SHARED));
 	}
 #endif /* UNIV_SYNC_DEBUG */
 
@@ -1327,6 +1333,9 @@ row_sel(
 	rec_t*		old_vers;
 	rec_t*		clust_rec;
 	ibool		search_latch_locked;
+	rw_lock_t*	search_latch			= NULL;
+					/*!< the adaptive hash index latch
+					if search_latch_locked */
 	ibool		consistent_read;
 
 	/* The following flag becomes TRUE when we are doing a
@@ -1404,11 +1413,24 @@ table_loop:
 	if (consistent_read && plan->unique_search && !plan->pcur_is_open
 	    && !plan->must_get_clust
 	    && !plan->table->big_rows) {
+		if (search_latch_locked
+		    && search_latch != btr_search_get_latch(plan->index)) {
+
+			/* The latch is for the adaptive hash index partition
+			of the previous table */
+
+			rw_lock_s_unlock(search_latch);
+
+			search_latch_locked = FALSE;
+		}
+
 		if (!search_latch_locked) {
-			rw_lock_s_lock(&btr_search_latch);
+			search_latch = btr_search_get_latch(plan->index);
+
+			rw_lock_s_lock(search_latch);
 
 			search_latch_locked = TRUE;
-		} else if (rw_lock_get_writer(&btr_search_latch) == RW_LOCK_WAIT_EX) {
+		} else if (rw_lock_get_writer(search_latch) == RW_LOCK_WAIT_EX) {
 
 			/* There is an x-latch request waiting: release the
 			s-latch for a moment; as an s-latch here is often
@@ -1417,8 +1439,8 @@ table_loop:
 			from acquiring an s-latch for a long time, lowering
 			performance significantly in multiprocessors. */
 
-			rw_lock_s_unlock(&btr_search_latch);
-			rw_lock_s_lock(&btr_search_latch);
+			rw_lock_s_unlock(search_latch);
+			rw_lock_s_lock(search_latch);
 		}
 
 		found_flag = row_sel_try_search_shortcut(node, plan,
@@ -1443,7 +1465,7 @@ table_loop:
 	}
 
 	if (search_latch_locked) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(search_latch);
 
 		search_latch_locked = FALSE;
 	}
@@ -2019,7 +2041,7 @@ lock_wait_or_error:
 
 func_exit:
 	if (search_latch_locked) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(search_latch);
 	}
 	if (UNIV_LIKELY_NULL(heap)) {
 		mem_heap_free(heap);
@@ -2996,6 +3018,87 @@ row_sel_build_prev_vers_for_mysql(
 	return(err);
 }
 
+/*********************************************************************//**
+Reads ahead the clustered index leaf pages of rec and the records that
+follow it on the same secondary index page, so that the clustered index
+lookups of a range scan do not have to wait for the reads one at a
+time. Nothing is read if the clustered index leaf page of rec is already
+in the buffer pool. */
+static
+void
+row_sel_prefetch_clust(
+/*===================*/
+	row_prebuilt_t*	prebuilt,	/*!< in/out: prebuilt struct in
+					the handle */
+	dict_index_t*	sec_index,	/*!< in: secondary index */
+	const rec_t*	rec)		/*!< in: record in sec_index,
+					on a latched page */
+{
+	dict_index_t*	clust_index;
+	ulint		page_nos[SEL_MAX_CLUST_PREFETCH];
+	ulint		n_pages		= 0;
+	ulint		n_recs		= 0;
+	ulint		max_pages;
+	mem_heap_t*	heap;
+	mtr_t		mtr;
+
+	clust_index = dict_table_get_first_index(sec_index->table);
+
+	max_pages = ut_min(srv_clust_prefetch_pages, SEL_MAX_CLUST_PREFETCH);
+
+	heap = mem_heap_create(256);
+
+	for (; !page_rec_is_supremum(rec) && n_pages < max_pages
+	     && n_recs < 4 * max_pages;
+	     rec = page_rec_get_next_const(rec), n_recs++) {
+
+		const dtuple_t*	ref;
+		ulint		page_no;
+
+		ref = row_build_row_ref(ROW_COPY_POINTERS, sec_index,
+					rec, heap);
+
+		mtr_start(&mtr);
+		page_no = btr_cur_get_leaf_page_no(clust_index, ref, &mtr);
+		mtr_commit(&mtr);
+
+		mem_heap_empty(heap);
+
+		if (page_no == FIL_NULL) {
+			/* The clustered index consists of the root
+			page only. */
+			n_recs = 4 * max_pages;
+			break;
+		}
+
+		if (n_recs == 0
+		    && buf_page_peek(dict_index_get_space(clust_index),
+				     page_no)) {
+			/* The clustered index pages are probably
+			cached. Check again after a while. */
+			n_recs = 4 * max_pages;
+			break;
+		}
+
+		if (n_pages == 0 || page_nos[n_pages - 1] != page_no) {
+			page_nos[n_pages++] = page_no;
+		}
+	}
+
+	mem_heap_free(heap);
+
+	prebuilt->clust_prefetch_skip = n_recs;
+
+	if (n_pages > 0) {
+		ulint	n_read = buf_read_pages_async(
+			dict_index_get_space(clust_index),
+			dict_table_zip_size(clust_index->table),
+			page_nos, n_pages);
+
+		MONITOR_INC_VALUE(MONITOR_READ_AHEAD_CLUST, n_read);
+	}
+}
+
 /*********************************************************************//**
 Retrieves the clustered index record corresponding to a record in a
 non-clustered index. Does the necessary locking. Used in the MySQL
@@ -3762,20 +3865,31 @@ row_search_for_mysql(
 	/* PHASE 0: Release a possible s-latch we are holding on the
 	adaptive hash index latch if there is someone waiting behind */
 
-	if (UNIV_UNLIKELY(rw_lock_get_writer(&btr_search_latch) != RW_LOCK_NOT_LOCKED)
-	    && trx->has_search_latch) {
+	if (trx->has_search_latch
+	    && UNIV_UNLIKELY(rw_lock_get_writer(trx->search_latch)
+			     != RW_LOCK_NOT_LOCKED)) {
 
 		/* There is an x-latch request on the adaptive hash index:
 		release the s-latch to reduce starvation and wait for
 		BTR_SEA_TIMEOUT rounds before trying to keep it again over
 		calls from MySQL */
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(trx->search_latch);
 		trx->has_search_latch = FALSE;
 
 		trx->search_latch_timeout = BTR_SEA_TIMEOUT;
 	}
 
+	if (trx->has_search_latch
+	    && trx->search_latch != btr_search_get_latch(index)) {
+
+		/* The latch that was kept over calls from MySQL is
+		for the adaptive hash index partition of another index */
+
+		rw_lock_s_unlock(trx->search_latch);
+		trx->has_search_latch = FALSE;
+	}
+
 	/* Reset the new record lock info if srv_locks_unsafe_for_binlog
 	is set or session is using a READ COMMITED isolation level. Then
 	we are able to remove the record locks set here on an individual
@@ -3791,6 +3905,7 @@ row_search_for_mysql(
 		prebuilt->n_rows_fetched = 0;
 		prebuilt->n_fetch_cached = 0;
 		prebuilt->fetch_cache_first = 0;
+		prebuilt->clust_prefetch_skip = 0;
 
 		if (prebuilt->sel_graph == NULL) {
 			/* Build a dummy select query graph */
@@ -3923,7 +4038,9 @@ row_search_for_mysql(
 
 #ifndef UNIV_SEARCH_DEBUG
 			if (!trx->has_search_latch) {
-				rw_lock_s_lock(&btr_search_latch);
+				trx->search_latch = btr_search_get_latch(
+					index);
+				rw_lock_s_lock(trx->search_latch);
 				trx->has_search_latch = TRUE;
 			}
 #endif
@@ -3995,7 +4112,7 @@ release_search_latch_if_needed:
 
 					trx->search_latch_timeout--;
 
-					rw_lock_s_unlock(&btr_search_latch);
+					rw_lock_s_unlock(trx->search_latch);
 					trx->has_search_latch = FALSE;
 				}
 
@@ -4019,10 +4136,14 @@ release_search_latch_if_needed:
 	/* PHASE 3: Open or restore index cursor position */
 
 	if (trx->has_search_latch) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(trx->search_latch);
 		trx->has_search_latch = FALSE;
 	}
 
+	/* Now that we are not holding the search latch, which evicting
+	a page may need, let a large scan keep its pages in its ring. */
+	mtr.scan_ring = prebuilt->scan_ring;
+
 	/* The state of a running trx can only be changed by the
 	thread that is currently serving the transaction. Because we
 	are that thread, we can read trx->state without holding any
@@ -4718,6 +4839,17 @@ requires_clust_rec:
 
 		mtr_has_extra_clust_latch = TRUE;
 
+		if (srv_clust_prefetch_pages && !unique_search) {
+			/* The clustered index latch of the previous
+			record has been released in next_rec. */
+
+			if (prebuilt->clust_prefetch_skip == 0) {
+				row_sel_prefetch_clust(prebuilt, index, rec);
+			}
+
+			prebuilt->clust_prefetch_skip--;
+		}
+
 		/* The following call returns 'offsets' associated with
 		'clust_rec'. Note that 'clust_rec' can be an old version
 		built for a consistent read. */
@@ -4995,6 +5127,7 @@ next_rec:
 		mtr_has_extra_clust_latch = FALSE;
 
 		mtr_start(&mtr);
+		mtr.scan_ring = prebuilt->scan_ring;
 		if (sel_restore_position_for_mysql(&same_user_rec,
 						   BTR_SEARCH_LEAF,
 						   pcur, moves_up, &mtr)) {
@@ -5060,6 +5193,7 @@ lock_table_wait:
 
 		thr->lock_state = QUE_THR_LOCK_NOLOCK;
 		mtr_start(&mtr);
+		mtr.scan_ring = prebuilt->scan_ring;
 
 		/* Table lock waited, go try to obtain table lock
 		again */
@@ -5231,9 +5365,11 @@ row_search_check_if_query_cache_permitted(
 		    && !trx->read_view) {
 
 			trx->read_view = read_view_open_now(
-				trx->id, trx->global_read_view_heap);
+				trx->id, trx->cached_read_view,
+				trx->global_read_view_heap);
 
-			trx->global_read_view = trx->read_view;
+			trx->global_read_view = trx->cached_read_view =
+				trx->read_view;
 		}
 	}
 
@@ -67,7 +67,17 @@ we could get a deadlock. Value of 0 will disable the concurrency check. */
 
 UNIV_INTERN ulong	srv_thread_concurrency	= 0;
 
-#ifndef HAVE_ATOMIC_BUILTINS
+#ifdef HAVE_ATOMIC_BUILTINS
+/** If TRUE, threads that find innodb_thread_concurrency threads inside
+InnoDB wait in a queue and are admitted as soon as a thread leaves;
+otherwise they poll, sleeping srv_thread_sleep_delay between attempts. */
+UNIV_INTERN my_bool	srv_thread_concurrency_queue = TRUE;
+
+/** Number of consecutive admissions from SRV_CONC_QUEUE_LOCKS after which
+the head of SRV_CONC_QUEUE_OTHER is admitted even if threads of
+transactions holding locks are still waiting */
+# define SRV_CONC_MAX_PRIO_GRANTS	4
+#endif /* HAVE_ATOMIC_BUILTINS */
 
 /** This mutex protects srv_conc data structures */
 static os_fast_mutex_t	srv_conc_mutex;
@@ -91,21 +101,41 @@ struct srv_conc_slot_t{
 /** Queue of threads waiting to get in */
 typedef UT_LIST_BASE_NODE_T(srv_conc_slot_t)	srv_conc_queue_t;
 
+#ifndef HAVE_ATOMIC_BUILTINS
 static srv_conc_queue_t	srv_conc_queue;
 
 /** Array of wait slots */
 static srv_conc_slot_t*	srv_conc_slots;
+#else
+/** Admission queues, served in FIFO order. Threads of transactions
+that hold record or table locks are admitted first, as other threads
+inside InnoDB may be waiting for those locks. */
+enum srv_conc_queue_id_t {
+	SRV_CONC_QUEUE_LOCKS = 0,	/*!< transactions holding locks */
+	SRV_CONC_QUEUE_OTHER,		/*!< all other transactions */
+	SRV_CONC_N_QUEUES
+};
+
+/** Threads waiting to be admitted, protected by srv_conc_mutex */
+static srv_conc_queue_t	srv_conc_queues[SRV_CONC_N_QUEUES];
+
+/** Wait slots not in use, protected by srv_conc_mutex. Slots are
+allocated when the list is empty and freed in srv_conc_free(). */
+static srv_conc_queue_t	srv_conc_free_slots;
+
+/** Number of consecutive admissions from SRV_CONC_QUEUE_LOCKS, protected
+by srv_conc_mutex */
+static ulint		srv_conc_n_prio_grants;
+#endif /* !HAVE_ATOMIC_BUILTINS */
 
 #if defined(UNIV_PFS_MUTEX)
 /* Key to register srv_conc_mutex_key with performance schema */
 UNIV_INTERN mysql_pfs_key_t	srv_conc_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
-#endif /* !HAVE_ATOMIC_BUILTINS */
-
 /** Variables tracking the active and waiting threads. */
 struct srv_conc_t {
-	char		pad[64  - (sizeof(ulint) + sizeof(lint))];
+	char		pad[64  - (sizeof(ulint) + 2 * sizeof(lint))];
 
 	/** Number of transactions that have declared_to_be_inside_innodb set.
 	It used to be a non-error for this value to drop below zero temporarily.
@@ -117,6 +147,10 @@ struct srv_conc_t {
 	/** Number of OS threads waiting in the FIFO for permission to
 	enter InnoDB */
 	volatile lint	n_waiting;
+
+	/** Number of OS threads in srv_conc_queues. Only changed while
+	holding srv_conc_mutex, but read without it. */
+	volatile lint	n_queued;
 };
 
 /* Control variables for tracking concurrency. */
@@ -128,13 +162,19 @@ void
 srv_conc_init(void)
 /*===============*/
 {
-#ifndef HAVE_ATOMIC_BUILTINS
-	ulint		i;
-
 	/* Init the server concurrency restriction data structures */
 
 	os_fast_mutex_init(srv_conc_mutex_key, &srv_conc_mutex);
 
+#ifdef HAVE_ATOMIC_BUILTINS
+	for (ulint i = 0; i < SRV_CONC_N_QUEUES; i++) {
+		UT_LIST_INIT(srv_conc_queues[i]);
+	}
+
+	UT_LIST_INIT(srv_conc_free_slots);
+#else
+	ulint		i;
+
 	UT_LIST_INIT(srv_conc_queue);
 
 	srv_conc_slots = static_cast<srv_conc_slot_t*>(
@@ -155,11 +195,21 @@ void
 srv_conc_free(void)
 /*===============*/
 {
-#ifndef HAVE_ATOMIC_BUILTINS
-	os_fast_mutex_free(&srv_conc_mutex);
+#ifdef HAVE_ATOMIC_BUILTINS
+	srv_conc_slot_t*	slot;
+
+	while ((slot = UT_LIST_GET_FIRST(srv_conc_free_slots)) != NULL) {
+
+		UT_LIST_REMOVE(srv_conc_queue, srv_conc_free_slots, slot);
+
+		os_event_free(slot->event);
+		mem_free(slot);
+	}
+#else
 	mem_free(srv_conc_slots);
 	srv_conc_slots = NULL;
-#endif /* !HAVE_ATOMIC_BUILTINS */
+#endif /* HAVE_ATOMIC_BUILTINS */
+	os_fast_mutex_free(&srv_conc_mutex);
 }
 
 #ifdef HAVE_ATOMIC_BUILTINS
@@ -176,6 +226,218 @@ srv_enter_innodb_with_tickets(
 	trx->n_tickets_to_enter_innodb = srv_n_free_tickets_to_enter;
 }
 
+/*********************************************************************//**
+Takes a seat inside InnoDB, for the calling thread or on behalf of a queued
+thread, if fewer than srv_thread_concurrency threads are inside.
+@return	TRUE if a seat was taken */
+static
+ibool
+srv_conc_reserve_seat(void)
+/*=======================*/
+{
+	for (;;) {
+		lint	n_active = srv_conc.n_active;
+
+		/* If srv_thread_concurrency was set to 0 while threads
+		were queued, let them all in. */
+		if (srv_thread_concurrency > 0
+		    && n_active >= (lint) srv_thread_concurrency) {
+
+			return(FALSE);
+		}
+
+		if (os_compare_and_swap_lint(
+			    &srv_conc.n_active, n_active, n_active + 1)) {
+
+			return(TRUE);
+		}
+	}
+}
+
+/*********************************************************************//**
+Removes the next thread to be admitted from the admission queues. The
+queue of transactions holding locks is served first, but after
+SRV_CONC_MAX_PRIO_GRANTS consecutive admissions from it the other queue
+gets a turn, so that it cannot starve. The caller must hold srv_conc_mutex.
+@return	slot of the thread, or NULL if no thread is queued */
+static
+srv_conc_slot_t*
+srv_conc_queue_remove_next(void)
+/*============================*/
+{
+	srv_conc_slot_t*	slot;
+	srv_conc_queue_t*	queue;
+
+	slot = UT_LIST_GET_FIRST(srv_conc_queues[SRV_CONC_QUEUE_LOCKS]);
+
+	if (slot != NULL
+	    && (srv_conc_n_prio_grants < SRV_CONC_MAX_PRIO_GRANTS
+		|| UT_LIST_GET_LEN(srv_conc_queues[SRV_CONC_QUEUE_OTHER])
+		   == 0)) {
+
+		queue = &srv_conc_queues[SRV_CONC_QUEUE_LOCKS];
+		++srv_conc_n_prio_grants;
+	} else {
+		queue = &srv_conc_queues[SRV_CONC_QUEUE_OTHER];
+		slot = UT_LIST_GET_FIRST(*queue);
+		srv_conc_n_prio_grants = 0;
+	}
+
+	if (slot != NULL) {
+		UT_LIST_REMOVE(srv_conc_queue, *queue, slot);
+
+		(void) os_atomic_decrement_lint(&srv_conc.n_queued, 1);
+	}
+
+	return(slot);
+}
+
+/*********************************************************************//**
+Admits queued threads for as long as there are free seats inside InnoDB.
+Each admitted thread is woken exactly once, with its seat already taken
+on its behalf. */
+static
+void
+srv_conc_admit_queued(void)
+/*=======================*/
+{
+	for (;;) {
+		srv_conc_slot_t*	slot = NULL;
+
+		os_fast_mutex_lock(&srv_conc_mutex);
+
+		if (srv_conc.n_queued > 0 && srv_conc_reserve_seat()) {
+
+			slot = srv_conc_queue_remove_next();
+			ut_a(slot != NULL);
+
+			slot->wait_ended = TRUE;
+		}
+
+		os_fast_mutex_unlock(&srv_conc_mutex);
+
+		if (slot == NULL) {
+
+			return;
+		}
+
+		/* The slot cannot be reused before the thread waiting
+		in it has been woken up by this. */
+		os_event_set(slot->event);
+	}
+}
+
+/*********************************************************************//**
+Handle the scheduling of a user thread that wants to enter InnoDB when
+srv_thread_concurrency_queue is set. A thread enters directly if there is
+a free seat and nobody is queued. Otherwise it queues itself and sleeps
+until a thread leaving InnoDB hands it a seat, see
+srv_conc_exit_innodb_with_atomics(). */
+static
+void
+srv_conc_enter_innodb_with_queue(
+/*=============================*/
+	trx_t*	trx)			/*!< in/out: transaction that wants
+					to enter InnoDB */
+{
+	srv_conc_slot_t*	slot;
+	srv_conc_queue_id_t	queue_id;
+	ib_int64_t		sig_count;
+
+	ut_a(!trx->declared_to_be_inside_innodb);
+
+	/* Do not overtake queued threads. */
+	if (srv_conc.n_queued == 0 && srv_conc_reserve_seat()) {
+
+		srv_enter_innodb_with_tickets(trx);
+
+		return;
+	}
+
+	/* Other threads may be waiting for the locks of this
+	transaction: let it in first. This is only a hint, so the lock
+	list is read without holding lock_sys->mutex. */
+	queue_id = UT_LIST_GET_FIRST(trx->lock.trx_locks) != NULL
+		? SRV_CONC_QUEUE_LOCKS : SRV_CONC_QUEUE_OTHER;
+
+	os_fast_mutex_lock(&srv_conc_mutex);
+
+	/* A thread leaving InnoDB first frees its seat and then looks at
+	n_queued, and we first increment n_queued and then look for a free
+	seat. Both are full memory barriers, so either we get the seat here
+	or the leaving thread sees n_queued > 0 and admits us once we are
+	in the queue and have released srv_conc_mutex. */
+
+	if (os_atomic_increment_lint(&srv_conc.n_queued, 1) == 1
+	    && srv_conc_reserve_seat()) {
+
+		(void) os_atomic_decrement_lint(&srv_conc.n_queued, 1);
+
+		os_fast_mutex_unlock(&srv_conc_mutex);
+
+		srv_enter_innodb_with_tickets(trx);
+
+		return;
+	}
+
+	slot = UT_LIST_GET_FIRST(srv_conc_free_slots);
+
+	if (slot != NULL) {
+		UT_LIST_REMOVE(srv_conc_queue, srv_conc_free_slots, slot);
+	} else {
+		slot = static_cast<srv_conc_slot_t*>(
+			mem_zalloc(sizeof(*slot)));
+
+		slot->event = os_event_create();
+		ut_a(slot->event);
+	}
+
+	slot->reserved = TRUE;
+	slot->wait_ended = FALSE;
+
+	UT_LIST_ADD_LAST(srv_conc_queue, srv_conc_queues[queue_id], slot);
+
+	sig_count = os_event_reset(slot->event);
+
+	(void) os_atomic_increment_lint(&srv_conc.n_waiting, 1);
+
+	os_fast_mutex_unlock(&srv_conc_mutex);
+
+	/* Release possible search system latch this thread has */
+	if (trx->has_search_latch) {
+		trx_search_latch_release_if_reserved(trx);
+	}
+
+	DEBUG_SYNC_C("srv_conc_enter_innodb_queued");
+
+	trx->op_info = "waiting in InnoDB queue";
+
+	thd_wait_begin(trx->mysql_thd, THD_WAIT_USER_LOCK);
+
+	os_event_wait_low(slot->event, sig_count);
+
+	thd_wait_end(trx->mysql_thd);
+
+	trx->op_info = "";
+
+	(void) os_atomic_decrement_lint(&srv_conc.n_waiting, 1);
+
+	os_fast_mutex_lock(&srv_conc_mutex);
+
+	ut_ad(slot->wait_ended);
+
+	slot->reserved = FALSE;
+
+	UT_LIST_ADD_FIRST(srv_conc_queue, srv_conc_free_slots, slot);
+
+	os_fast_mutex_unlock(&srv_conc_mutex);
+
+	/* NOTE that the thread which admitted this thread already
+	incremented n_active on behalf of this thread */
+
+	srv_enter_innodb_with_tickets(trx);
+}
+
 /*********************************************************************//**
 Handle the scheduling of a user thread that wants to enter InnoDB.  Setting
 srv_adaptive_max_sleep_delay > 0 switches the adaptive sleep calibration to
@@ -297,6 +559,13 @@ srv_conc_exit_innodb_with_atomics(
 	trx->declared_to_be_inside_innodb = FALSE;
 
 	(void) os_atomic_decrement_lint(&srv_conc.n_active, 1);
+
+	/* Hand the seat over to the next queued thread, if any. This is
+	done even if srv_thread_concurrency_queue has been switched off,
+	to drain the queue. */
+	if (srv_conc.n_queued > 0) {
+		srv_conc_admit_queued();
+	}
 }
 #else
 /*********************************************************************//**
@@ -508,10 +777,16 @@ srv_conc_enter_innodb(
 #endif /* UNIV_SYNC_DEBUG */
 
 #ifdef HAVE_ATOMIC_BUILTINS
-	srv_conc_enter_innodb_with_atomics(trx);
+	if (srv_thread_concurrency_queue) {
+		srv_conc_enter_innodb_with_queue(trx);
+	} else {
+		srv_conc_enter_innodb_with_atomics(trx);
+	}
 #else
 	srv_conc_enter_innodb_without_atomics(trx);
 #endif /* HAVE_ATOMIC_BUILTINS */
+
+	DEBUG_SYNC_C("srv_conc_enter_innodb_done");
 }
 
 /*********************************************************************//**
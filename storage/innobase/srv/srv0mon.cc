@@ -34,6 +34,7 @@ Created 12/9/2009 Jimmy Yang
 #include "trx0rseg.h"
 #include "lock0lock.h"
 #include "ibuf0ibuf.h"
+#include "btr0sea.h"
 #ifdef UNIV_NONINL
 #include "srv0mon.ic"
 #endif
@@ -118,6 +119,130 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_TABLELOCK_WAIT},
 
+	{"lock_deadlock_searches", "lock",
+	 "Number of times the waits-for graph was searched for deadlocks",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_DEADLOCK_SEARCH},
+
+	{"lock_deadlock_search_steps", "lock",
+	 "Number of waits-for graph edges visited by deadlock searches",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_DEADLOCK_SEARCH_STEPS},
+
+	{"lock_deadlock_search_usec", "lock",
+	 "Time spent searching for deadlocks while holding the lock"
+	 " system mutex (in microseconds)",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_DEADLOCK_SEARCH_TIME},
+
+	{"lock_wait_fcfs_le_1ms", "lock",
+	 "Number of row lock waits lasting at most 1 ms with"
+	 " innodb_lock_schedule_algorithm=fcfs",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_FCFS_LE_1MS},
+
+	{"lock_wait_fcfs_le_10ms", "lock",
+	 "Number of row lock waits lasting between 1 ms and 10 ms with"
+	 " innodb_lock_schedule_algorithm=fcfs",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_FCFS_LE_10MS},
+
+	{"lock_wait_fcfs_le_100ms", "lock",
+	 "Number of row lock waits lasting between 10 ms and 100 ms with"
+	 " innodb_lock_schedule_algorithm=fcfs",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_FCFS_LE_100MS},
+
+	{"lock_wait_fcfs_le_1s", "lock",
+	 "Number of row lock waits lasting between 100 ms and 1 s with"
+	 " innodb_lock_schedule_algorithm=fcfs",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_FCFS_LE_1S},
+
+	{"lock_wait_fcfs_le_10s", "lock",
+	 "Number of row lock waits lasting between 1 s and 10 s with"
+	 " innodb_lock_schedule_algorithm=fcfs",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_FCFS_LE_10S},
+
+	{"lock_wait_fcfs_gt_10s", "lock",
+	 "Number of row lock waits lasting longer than 10 s with"
+	 " innodb_lock_schedule_algorithm=fcfs",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_FCFS_GT_10S},
+
+	{"lock_wait_oldest_le_1ms", "lock",
+	 "Number of row lock waits lasting at most 1 ms with"
+	 " innodb_lock_schedule_algorithm=oldest",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_OLDEST_LE_1MS},
+
+	{"lock_wait_oldest_le_10ms", "lock",
+	 "Number of row lock waits lasting between 1 ms and 10 ms with"
+	 " innodb_lock_schedule_algorithm=oldest",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_OLDEST_LE_10MS},
+
+	{"lock_wait_oldest_le_100ms", "lock",
+	 "Number of row lock waits lasting between 10 ms and 100 ms with"
+	 " innodb_lock_schedule_algorithm=oldest",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_OLDEST_LE_100MS},
+
+	{"lock_wait_oldest_le_1s", "lock",
+	 "Number of row lock waits lasting between 100 ms and 1 s with"
+	 " innodb_lock_schedule_algorithm=oldest",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_OLDEST_LE_1S},
+
+	{"lock_wait_oldest_le_10s", "lock",
+	 "Number of row lock waits lasting between 1 s and 10 s with"
+	 " innodb_lock_schedule_algorithm=oldest",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_OLDEST_LE_10S},
+
+	{"lock_wait_oldest_gt_10s", "lock",
+	 "Number of row lock waits lasting longer than 10 s with"
+	 " innodb_lock_schedule_algorithm=oldest",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_OLDEST_GT_10S},
+
+	{"lock_wait_most_locks_le_1ms", "lock",
+	 "Number of row lock waits lasting at most 1 ms with"
+	 " innodb_lock_schedule_algorithm=most_locks",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_MOST_LOCKS_LE_1MS},
+
+	{"lock_wait_most_locks_le_10ms", "lock",
+	 "Number of row lock waits lasting between 1 ms and 10 ms with"
+	 " innodb_lock_schedule_algorithm=most_locks",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_MOST_LOCKS_LE_10MS},
+
+	{"lock_wait_most_locks_le_100ms", "lock",
+	 "Number of row lock waits lasting between 10 ms and 100 ms with"
+	 " innodb_lock_schedule_algorithm=most_locks",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_MOST_LOCKS_LE_100MS},
+
+	{"lock_wait_most_locks_le_1s", "lock",
+	 "Number of row lock waits lasting between 100 ms and 1 s with"
+	 " innodb_lock_schedule_algorithm=most_locks",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_MOST_LOCKS_LE_1S},
+
+	{"lock_wait_most_locks_le_10s", "lock",
+	 "Number of row lock waits lasting between 1 s and 10 s with"
+	 " innodb_lock_schedule_algorithm=most_locks",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_MOST_LOCKS_LE_10S},
+
+	{"lock_wait_most_locks_gt_10s", "lock",
+	 "Number of row lock waits lasting longer than 10 s with"
+	 " innodb_lock_schedule_algorithm=most_locks",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOCK_WAIT_MOST_LOCKS_GT_10S},
+
 	{"lock_rec_lock_requests", "lock",
 	 "Number of record locks requested",
 	 MONITOR_NONE,
@@ -235,6 +360,12 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_EXISTING | MONITOR_DEFAULT_ON),
 	 MONITOR_DEFAULT_START, MONITOR_OVLD_BUF_POOL_READ_AHEAD_EVICTED},
 
+	{"buffer_read_ahead_clust", "buffer",
+	 "Number of clustered index pages read ahead for secondary index"
+	 " scans (innodb_clust_prefetch_pages)",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_READ_AHEAD_CLUST},
+
 	{"buffer_pool_pages_total", "buffer",
 	 "Total buffer pool size in pages (innodb_buffer_pool_pages_total)",
 	 static_cast<monitor_type_t>(
@@ -367,6 +498,52 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_FLUSH_N_TO_FLUSH_REQUESTED},
 
+	{"buffer_flush_adaptive_avg_time_slot", "buffer",
+	 "Avg time (ms) spent for adaptive flushing recently per slot.",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_ADAPTIVE_AVG_TIME_SLOT},
+
+	{"buffer_LRU_batch_flush_avg_time_slot", "buffer",
+	 "Avg time (ms) spent for LRU batch flushing recently per slot.",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_BATCH_FLUSH_AVG_TIME_SLOT},
+
+	{"buffer_flush_adaptive_avg_time_thread", "buffer",
+	 "Avg time (ms) spent for adaptive flushing recently per thread.",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_ADAPTIVE_AVG_TIME_THREAD},
+
+	{"buffer_LRU_batch_flush_avg_time_thread", "buffer",
+	 "Avg time (ms) spent for LRU batch flushing recently per thread.",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_BATCH_FLUSH_AVG_TIME_THREAD},
+
+	{"buffer_flush_avg_time", "buffer",
+	 "Avg time (ms) spent for flushing recently.",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_AVG_TIME},
+
+	{"buffer_flush_avg_wait_time", "buffer",
+	 "Avg time (ms) the page cleaner coordinator waited for the"
+	 " page cleaner workers recently.",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_AVG_WAIT_TIME},
+
+	{"buffer_flush_adaptive_avg_pass", "buffer",
+	 "Number of adaptive flushes passed during the recent Avg period.",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_ADAPTIVE_AVG_PASS},
+
+	{"buffer_LRU_batch_flush_avg_pass", "buffer",
+	 "Number of LRU batch flushes passed during the recent Avg period.",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_BATCH_FLUSH_AVG_PASS},
+
+	{"buffer_flush_avg_pass", "buffer",
+	 "Number of flushes passed during the recent Avg period.",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_AVG_PASS},
+
 	{"buffer_flush_avg_page_rate", "buffer",
 	 "Average number of pages at which flushing is happening",
 	 MONITOR_NONE,
@@ -691,6 +868,11 @@ static monitor_info_t	innodb_counter_info[] =
 	 "auto-commit read-only transactions committed",
 	 MONITOR_NONE, MONITOR_DEFAULT_START, MONITOR_TRX_NL_RO_COMMIT},
 
+	{"trx_read_views_reused", "transaction", "Number of read views "
+	 "opened by reusing the previous view of the transaction, because"
+	 " no read-write transaction had started or committed since",
+	 MONITOR_NONE, MONITOR_DEFAULT_START, MONITOR_READ_VIEW_REUSED},
+
 	{"trx_commits_insert_update", "transaction",
 	 "Number of transactions committed with inserts and updates",
 	 MONITOR_NONE,
@@ -778,6 +960,37 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_DISPLAY_CURRENT,
 	 MONITOR_DEFAULT_START, MONITOR_PURGE_RESUME_COUNT},
 
+	{"purge_history_logs_drained", "purge",
+	 "Number of undo logs removed from the history list by purge",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_PURGE_HISTORY_DRAINED},
+
+	{"purge_undo_pages_read_ahead", "purge",
+	 "Number of undo log pages read ahead by purge",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_PURGE_READ_AHEAD},
+
+	{"purge_batch_tables", "purge",
+	 "Number of distinct tables in the purge batches",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_PURGE_BATCH_TABLES},
+
+	{"purge_batch_table_splits", "purge",
+	 "Number of times the undo records of a table in a purge batch"
+	 " were given to more than one purge thread",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_PURGE_BATCH_TABLE_SPLITS},
+
+	{"undo_truncate_count", "purge",
+	 "Number of times an undo tablespace was truncated",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_UNDO_TRUNCATE_COUNT},
+
+	{"undo_truncate_usec", "purge",
+	 "Time (in microseconds) spent truncating undo tablespaces",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_UNDO_TRUNCATE_MICROSECOND},
+
 	/* ========== Counters for Recovery Module ========== */
 	{"module_log", "recovery", "Recovery Module",
 	 MONITOR_MODULE,
@@ -928,6 +1141,18 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_OVLD_ADAPTIVE_HASH_SEARCH_BTREE},
 
+	{"adaptive_hash_hits", "adaptive_hash_index",
+	 "Number of hash lookups that found the record, summed over all"
+	 " Adaptive Hash Index partitions",
+	 MONITOR_EXISTING,
+	 MONITOR_DEFAULT_START, MONITOR_OVLD_ADAPTIVE_HASH_HITS},
+
+	{"adaptive_hash_misses", "adaptive_hash_index",
+	 "Number of hash lookups that failed, summed over all"
+	 " Adaptive Hash Index partitions",
+	 MONITOR_EXISTING,
+	 MONITOR_DEFAULT_START, MONITOR_OVLD_ADAPTIVE_HASH_MISSES},
+
 	{"adaptive_hash_pages_added", "adaptive_hash_index",
 	 "Number of index pages on which the Adaptive Hash Index is built",
 	 MONITOR_NONE,
@@ -1766,7 +1991,7 @@ srv_mon_process_existing_counter(
 		break;
 
 	case MONITOR_OVLD_LSN_CURRENT:
-		value = (mon_type_t) log_sys->lsn;
+		value = (mon_type_t) log_get_lsn();
 		break;
 
 	case MONITOR_OVLD_BUF_OLDEST_LSN:
@@ -1793,6 +2018,14 @@ srv_mon_process_existing_counter(
 		value = btr_cur_n_non_sea;
 		break;
 
+	case MONITOR_OVLD_ADAPTIVE_HASH_HITS:
+		value = btr_search_get_n_searches(true);
+		break;
+
+	case MONITOR_OVLD_ADAPTIVE_HASH_MISSES:
+		value = btr_search_get_n_searches(false);
+		break;
+
 	default:
 		ut_error;
 	}
@@ -83,6 +83,8 @@ UNIV_INTERN ibool	srv_error_monitor_active = FALSE;
 
 UNIV_INTERN ibool	srv_buf_dump_thread_active = FALSE;
 
+UNIV_INTERN ibool	srv_buf_resize_thread_active = FALSE;
+
 UNIV_INTERN ibool	srv_dict_stats_thread_active = FALSE;
 
 UNIV_INTERN const char*	srv_main_thread_op_info = "";
@@ -109,6 +111,13 @@ UNIV_INTERN ulint	srv_undo_tablespaces_open = 8;
 /* The number of rollback segments to use */
 UNIV_INTERN ulong	srv_undo_logs = 1;
 
+/** Whether undo tablespaces larger than srv_max_undo_log_size are
+truncated. */
+UNIV_INTERN my_bool	srv_undo_log_truncate = FALSE;
+
+/** Size in bytes above which an undo tablespace is truncated. */
+UNIV_INTERN unsigned long long	srv_max_undo_log_size;
+
 #ifdef UNIV_LOG_ARCHIVE
 UNIV_INTERN char*	srv_arch_dir	= NULL;
 #endif /* UNIV_LOG_ARCHIVE */
@@ -136,6 +145,12 @@ on duplicate key checking and foreign key checking */
 UNIV_INTERN ibool	srv_locks_unsafe_for_binlog = FALSE;
 /** Sort buffer size in index creation */
 UNIV_INTERN ulong	srv_sort_buf_size = 1048576;
+/** Number of threads that scan the clustered index and merge sort
+the entries when creating secondary indexes */
+UNIV_INTERN ulong	srv_sort_pll_degree = 4;
+/** Percentage of each B-tree page to fill when an index is built
+from sorted data */
+UNIV_INTERN ulong	srv_fill_factor = 100;
 /** Maximum modification log file size for online index creation */
 UNIV_INTERN unsigned long long	srv_online_max_size;
 
@@ -217,16 +232,30 @@ UNIV_INTERN my_bool	srv_use_sys_malloc	= TRUE;
 UNIV_INTERN ulint	srv_buf_pool_size	= ULINT_MAX;
 /* requested number of buffer pool instances */
 UNIV_INTERN ulint       srv_buf_pool_instances  = 1;
+/* size in bytes of the chunks in which the buffer pool is allocated
+and resized */
+UNIV_INTERN ulong	srv_buf_pool_chunk_size	= 128 * 1024 * 1024;
+/* whether to bind buffer pool instances and the threads serving them
+to NUMA nodes */
+UNIV_INTERN my_bool	srv_numa_aware		= FALSE;
 /* number of locks to protect buf_pool->page_hash */
 UNIV_INTERN ulong	srv_n_page_hash_locks = 16;
 /** Scan depth for LRU flush batch i.e.: number of blocks scanned*/
 UNIV_INTERN ulong	srv_LRU_scan_depth	= 1024;
+/** Maximum size of the uncompressed frames of compressed pages,
+in percent of the buffer pool size */
+UNIV_INTERN ulong	srv_unzip_LRU_max_pct	= 100;
+/** Number of pages that a large scan may keep in the buffer pool,
+0 if large scans use the LRU list like any other access */
+UNIV_INTERN ulong	srv_scan_ring_size	= 128;
 /** whether or not to flush neighbors of a block */
 UNIV_INTERN ulong	srv_flush_neighbors	= 1;
 /* previously requested size */
 UNIV_INTERN ulint	srv_buf_pool_old_size;
 /* current size in kilobytes */
 UNIV_INTERN ulint	srv_buf_pool_curr_size	= 0;
+/* maximum size of the change buffer, in percent of the buffer pool size */
+UNIV_INTERN uint	srv_change_buffer_max_size = CHANGE_BUFFER_DEFAULT_SIZE;
 /* size in bytes */
 UNIV_INTERN ulint	srv_mem_pool_size	= ULINT_MAX;
 UNIV_INTERN ulint	srv_lock_table_size	= ULINT_MAX;
@@ -243,6 +272,9 @@ UNIV_INTERN my_bool	srv_random_read_ahead	= FALSE;
 in the buffer cache and accessed sequentially for InnoDB to trigger a
 readahead request. */
 UNIV_INTERN ulong	srv_read_ahead_threshold	= 56;
+/* Maximum number of clustered index leaf pages to read ahead for the
+lookups of a secondary index range scan, or 0 to disable. */
+UNIV_INTERN ulong	srv_clust_prefetch_pages	= 0;
 
 #ifdef UNIV_LOG_ARCHIVE
 UNIV_INTERN ibool		srv_log_archive_on	= FALSE;
@@ -288,9 +320,21 @@ UNIV_INTERN ulong	srv_flushing_avg_loops		= 30;
 /* The number of purge threads to use.*/
 UNIV_INTERN ulong	srv_n_purge_threads = 1;
 
+/* The number of page cleaner threads to use, including the
+coordinator. It is capped at the number of buffer pool instances. */
+UNIV_INTERN ulong	srv_n_page_cleaners = 1;
+
+/* The number of threads that apply the redo log records to the pages
+during crash recovery. */
+UNIV_INTERN ulong	srv_n_recovery_apply_threads = 4;
+
 /* the number of pages to purge in one batch */
 UNIV_INTERN ulong	srv_purge_batch_size = 20;
 
+/* the number of purge batches after which the history list is truncated
+and the undo tablespaces are checked for truncation */
+UNIV_INTERN ulong	srv_purge_rseg_truncate_frequency = 128;
+
 /* Internal setting for "innodb_stats_method". Decides how InnoDB treats
 NULL value when collecting statistics. By default, it is set to
 SRV_STATS_NULLS_EQUAL(0), ie. all NULL value are treated equal */
@@ -316,6 +360,13 @@ UNIV_INTERN ulong	srv_force_recovery_crash;
 
 UNIV_INTERN my_bool	srv_print_all_deadlocks = FALSE;
 
+/** How deadlocks are detected, one of srv_deadlock_detect_t */
+UNIV_INTERN ulong	srv_deadlock_detect = SRV_DEADLOCK_DETECT_ON;
+
+/** Order in which waiting record locks are granted, one of
+srv_lock_schedule_t */
+UNIV_INTERN ulong	srv_lock_schedule_algorithm = SRV_LOCK_SCHEDULE_FCFS;
+
 /** Enable INFORMATION_SCHEMA.innodb_cmp_per_index */
 UNIV_INTERN my_bool	srv_cmp_per_index_enabled = FALSE;
 
@@ -347,11 +398,31 @@ batch flushing i.e.: LRU flushing and flush_list flushing. The rest
 of the pages are used for single page flushing. */
 UNIV_INTERN ulong	srv_doublewrite_batch_size	= 120;
 
+/** Number of pages in each batch of the doublewrite files. There is
+one doublewrite file per buffer pool instance holding one batch for
+LRU flushing and one for flush_list flushing. If this is 0, batch
+flushing uses the doublewrite buffer in the system tablespace. */
+UNIV_INTERN ulong	srv_doublewrite_pages		= 128;
+
+/** Whether the data files are assumed to be written a page at a time
+atomically, so that no page goes through the doublewrite buffer */
+UNIV_INTERN my_bool	srv_use_atomic_writes	= FALSE;
+
 UNIV_INTERN ulong	srv_replication_delay		= 0;
 
 /*-------------------------------------------*/
 UNIV_INTERN ulong	srv_n_spin_wait_rounds	= 30;
 UNIV_INTERN ulong	srv_spin_wait_delay	= 6;
+/** If TRUE, threads that give up spinning on a mutex or rw-lock are
+suspended on a futex word embedded in the latch, and a sync wait array
+cell is reserved only once the wait has lasted long enough to be of
+interest to the long semaphore wait diagnostics. Requires Linux. */
+UNIV_INTERN my_bool	srv_use_futex		= FALSE;
+/** If TRUE, the number of rounds a thread spins for a latch before it is
+suspended is kept per latch, between SYNC_SPIN_MIN_ROUNDS and
+SYNC_SPIN_MAX_FACTOR * srv_n_spin_wait_rounds, instead of being
+srv_n_spin_wait_rounds for every latch. See sync_spin_end(). */
+UNIV_INTERN my_bool	srv_adaptive_spin	= TRUE;
 UNIV_INTERN ibool	srv_priority_boost	= TRUE;
 
 #ifdef UNIV_DEBUG
@@ -590,6 +661,9 @@ UNIV_INTERN os_event_t	srv_error_event;
 /** Event to signal the buffer pool dump/load thread */
 UNIV_INTERN os_event_t	srv_buf_dump_event;
 
+/** Event to signal the buffer pool resize thread */
+UNIV_INTERN os_event_t	srv_buf_resize_event;
+
 /** The buffer pool dump/load file name */
 UNIV_INTERN char*	srv_buf_dump_filename;
 
@@ -598,6 +672,10 @@ and/or load it during startup. */
 UNIV_INTERN char	srv_buffer_pool_dump_at_shutdown = FALSE;
 UNIV_INTERN char	srv_buffer_pool_load_at_startup = FALSE;
 
+/** Interval in seconds between periodic dumps of the buffer pool,
+0 if the buffer pool is only dumped on request and at shutdown */
+UNIV_INTERN ulong	srv_buf_dump_interval = 0;
+
 /** Slot index in the srv_sys->sys_threads array for the purge thread. */
 static const ulint	SRV_PURGE_SLOT	= 1;
 
@@ -954,6 +1032,8 @@ srv_init(void)
 
 		srv_buf_dump_event = os_event_create();
 
+		srv_buf_resize_event = os_event_create();
+
 		UT_LIST_INIT(srv_sys->tasks);
 	}
 
@@ -1002,6 +1082,9 @@ srv_free(void)
 	if (!srv_read_only_mode) {
 		os_event_free(srv_buf_dump_event);
 		srv_buf_dump_event = NULL;
+
+		os_event_free(srv_buf_resize_event);
+		srv_buf_resize_event = NULL;
 	}
 }
 
@@ -1177,6 +1260,8 @@ srv_printf_innodb_monitor(
 	ret = lock_print_info_summary(file, nowait);
 
 	if (ret) {
+		trx_purge_print(file, time_elapsed);
+
 		if (trx_start_pos) {
 			long	t = ftell(file);
 			if (t < 0) {
@@ -1212,7 +1297,7 @@ srv_printf_innodb_monitor(
 	      "-------------------------------------\n", file);
 	ibuf_print(file);
 
-	ha_print_info(file, btr_search_sys->hash_index);
+	btr_search_print_info(file);
 
 	fprintf(file,
 		"%.2f hash searches/s, %.2f non-hash searches/s\n",
@@ -1849,6 +1934,8 @@ srv_any_background_threads_are_active(void)
 		thread_active = "srv_monitor_thread";
 	} else if (srv_buf_dump_thread_active) {
 		thread_active = "buf_dump_thread";
+	} else if (srv_buf_resize_thread_active) {
+		thread_active = "buf_resize_thread";
 	} else if (srv_dict_stats_thread_active) {
 		thread_active = "dict_stats_thread";
 	}
@@ -1856,6 +1943,7 @@ srv_any_background_threads_are_active(void)
 	os_event_set(srv_error_event);
 	os_event_set(srv_monitor_event);
 	os_event_set(srv_buf_dump_event);
+	os_event_set(srv_buf_resize_event);
 	os_event_set(lock_sys->timeout_event);
 	os_event_set(dict_stats_event);
 
@@ -2577,13 +2665,18 @@ srv_do_purge(
 
 		/* Take a snapshot of the history list before purge. */
 		if ((rseg_history_len = trx_sys->rseg_history_len) == 0) {
+
+			/* An undo tablespace can be truncated once
+			the history list has been drained. */
+			trx_purge_truncate_undo_tablespaces();
+
 			break;
 		}
 
 		n_pages_purged = trx_purge(
 			n_use_threads, srv_purge_batch_size, false);
 
-		if (!(count++ % TRX_SYS_N_RSEGS)) {
+		if (!(count++ % srv_purge_rseg_truncate_frequency)) {
 			/* Force a truncate of the history list. */
 			n_pages_purged += trx_purge(
 				1, srv_purge_batch_size, true);
@@ -2717,6 +2810,10 @@ DECLARE_THREAD(srv_purge_coordinator_thread)(
 
 	ut_ad(!srv_read_only_mode);
 	ut_a(srv_n_purge_threads >= 1);
+
+	/* Let the debug keywords of SET GLOBAL debug reach this thread,
+	which truncates the undo tablespaces. */
+	my_thread_init();
 	ut_a(trx_purge_state() == PURGE_STATE_INIT);
 	ut_a(srv_force_recovery < SRV_FORCE_NO_BACKGROUND);
 
@@ -2808,6 +2905,8 @@ DECLARE_THREAD(srv_purge_coordinator_thread)(
 		srv_release_threads(SRV_WORKER, srv_n_purge_threads - 1);
 	}
 
+	my_thread_end();
+
 	/* We count the number of threads in os_thread_exit(). A created
 	thread should always use that to exit and not use return() to exit. */
 	os_thread_exit(NULL);
@@ -139,10 +139,6 @@ static os_fast_mutex_t	srv_os_test_mutex;
 static char*	srv_monitor_file_name;
 #endif /* !UNIV_HOTBACKUP */
 
-/** Default undo tablespace size in UNIV_PAGEs count (10MB). */
-static const ulint SRV_UNDO_TABLESPACE_SIZE_IN_PAGES =
-	((1024 * 1024) * 10) / UNIV_PAGE_SIZE_DEF;
-
 /** */
 #define SRV_N_PENDING_IOS_PER_THREAD	OS_AIO_N_PENDING_IOS_PER_THREAD
 #define SRV_MAX_N_PENDING_SYNC_IOS	100
@@ -477,6 +473,19 @@ DECLARE_THREAD(io_handler_thread)(
 		os_thread_pf(os_thread_get_curr_id()));
 #endif
 
+	if (srv_numa_aware) {
+		/* Spread the data file read and write threads
+		round-robin over the NUMA nodes; the insert buffer and
+		log threads are left unbound. */
+		ulint	n_special = srv_read_only_mode ? 0 : 2;
+
+		if (segment >= n_special) {
+			os_thread_bind_to_numa_node(
+				(segment - n_special)
+				% os_numa_get_n_nodes());
+		}
+	}
+
 #ifdef UNIV_PFS_THREAD
 	pfs_register_thread(io_handler_thread_key);
 #endif /* UNIV_PFS_THREAD */
@@ -1737,6 +1746,20 @@ innobase_start_or_create_for_mysql(void)
 	srv_use_native_aio = FALSE;
 #endif /* __WIN__ */
 
+#if defined(HAVE_IB_LINUX_FUTEX) && defined(HAVE_ATOMIC_BUILTINS)
+	if (srv_use_futex) {
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Mutexes and rw_locks wait on futexes");
+	}
+#else
+	if (srv_use_futex) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"innodb_use_futex is not supported on this platform;"
+			" using the sync wait array instead.");
+		srv_use_futex = FALSE;
+	}
+#endif /* HAVE_IB_LINUX_FUTEX && HAVE_ATOMIC_BUILTINS */
+
 	if (srv_file_flush_method_str == NULL) {
 		/* These are the default options */
 
@@ -1798,10 +1821,13 @@ innobase_start_or_create_for_mysql(void)
 			    + 1 /* srv_master_thread */
 			    + 1 /* srv_purge_coordinator_thread */
 			    + 1 /* buf_dump_thread */
+			    + 1 /* buf_resize_thread */
 			    + 1 /* dict_stats_thread */
 			    + 1 /* fts_optimize_thread */
 			    + 1 /* recv_writer_thread */
-			    + 1 /* buf_flush_page_cleaner_thread */
+			    + 1 /* buf_flush_page_cleaner_coordinator */
+			    + 1 /* log_writer_thread */
+			    + 1 /* log_flusher_thread */
 			    + 1 /* trx_rollback_or_clean_all_recovered */
 			    + 128 /* added as margin, for use of
 				  InnoDB Memcached etc. */
@@ -1809,6 +1835,7 @@ innobase_start_or_create_for_mysql(void)
 			    + srv_n_read_io_threads
 			    + srv_n_write_io_threads
 			    + srv_n_purge_threads
+			    + srv_n_page_cleaners
 			    /* FTS Parallel Sort */
 			    + fts_sort_pll_degree * FTS_NUM_AUX_INDEX
 			      * max_connections;
@@ -1819,6 +1846,13 @@ innobase_start_or_create_for_mysql(void)
 		srv_buf_pool_instances = 1;
 	}
 
+	/* There is no point in having more page cleaner threads
+	than buffer pool instances: each thread flushes a whole
+	instance at a time. */
+	if (srv_n_page_cleaners > srv_buf_pool_instances) {
+		srv_n_page_cleaners = srv_buf_pool_instances;
+	}
+
 	srv_boot();
 
 	ib_logf(IB_LOG_LEVEL_INFO,
@@ -1930,6 +1964,30 @@ innobase_start_or_create_for_mysql(void)
 
 	fil_init(srv_file_per_table ? 50000 : 5000, srv_max_n_open_files);
 
+	/* Every instance is made of whole chunks, so that it can be
+	resized by adding or removing chunks. A chunk cannot be
+	bigger than an instance. */
+	if (srv_buf_pool_chunk_size * srv_buf_pool_instances
+	    > srv_buf_pool_size) {
+
+		srv_buf_pool_chunk_size = static_cast<ulong>(
+			ut_max(ut_2pow_round(srv_buf_pool_size
+					     / srv_buf_pool_instances,
+					     1024 * 1024),
+			       1024 * 1024));
+	}
+
+	if (buf_pool_size_align(srv_buf_pool_size) != srv_buf_pool_size) {
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Adjusting innodb_buffer_pool_size from %lu to %lu"
+			" bytes, a multiple of innodb_buffer_pool_chunk_size"
+			" * innodb_buffer_pool_instances",
+			(ulong) srv_buf_pool_size,
+			(ulong) buf_pool_size_align(srv_buf_pool_size));
+
+		srv_buf_pool_size = buf_pool_size_align(srv_buf_pool_size);
+	}
+
 	double	size;
 	char	unit;
 
@@ -2422,6 +2480,16 @@ files_checked:
 			return(err);
 		}
 
+		/* Complete the truncation of undo tablespaces that
+		was interrupted, before their rollback segments are
+		loaded. */
+		err = trx_purge_undo_truncate_fix_up(
+			srv_undo_tablespaces_open);
+
+		if (err != DB_SUCCESS) {
+			return(err);
+		}
+
 		ib_bh = trx_sys_init_at_db_start();
 		n_recovered_trx = UT_LIST_GET_LEN(trx_sys->rw_trx_list);
 
@@ -2702,7 +2770,22 @@ files_checked:
 	}
 
 	if (!srv_read_only_mode) {
-		os_thread_create(buf_flush_page_cleaner_thread, NULL, NULL);
+		/* From now on, the redo log is written and flushed by
+		dedicated threads instead of the threads that need it
+		on disk. */
+		os_thread_create(log_writer_thread, NULL, NULL);
+		os_thread_create(log_flusher_thread, NULL, NULL);
+
+		buf_flush_page_cleaner_init();
+
+		os_thread_create(buf_flush_page_cleaner_coordinator,
+				 NULL, NULL);
+
+		/* The coordinator flushes too, so one thread less. */
+		for (i = 1; i < srv_n_page_cleaners; ++i) {
+			os_thread_create(buf_flush_page_cleaner_worker,
+					 NULL, NULL);
+		}
 	}
 
 #ifdef UNIV_DEBUG
@@ -2849,6 +2932,9 @@ files_checked:
 		/* Create the buffer pool dump/load thread */
 		os_thread_create(buf_dump_thread, NULL, NULL);
 
+		/* Create the thread that resizes the buffer pool */
+		os_thread_create(buf_resize_thread, NULL, NULL);
+
 		/* Create the dict stats gathering thread */
 		os_thread_create(dict_stats_thread, NULL, NULL);
 
@@ -74,7 +74,18 @@ Instead, now the event that a thread wants to wait on is embedded
 in the wait object (mutex or rw_lock). We still keep the global
 wait array for the sake of diagnostics and also to avoid infinite
 wait The error_monitor thread scans the global wait array to signal
-any waiting threads who have missed the signal. */
+any waiting threads who have missed the signal.
+
+With innodb_use_futex, a thread that gives up spinning does not reserve
+a cell at all: it sleeps on a futex word embedded in the wait object,
+which is changed by the releasing thread before it wakes the sleepers.
+Only a wait that has lasted SYNC_ARRAY_FUTEX_DIAG_WAIT reserves a cell,
+so that long semaphore waits are still printed and time out, and the
+error_monitor thread can still wake a thread that missed its signal. */
+
+/** How long a thread sleeps on a futex before it reserves a wait array
+cell for the sake of diagnostics, in microseconds */
+#define SYNC_ARRAY_FUTEX_DIAG_WAIT	1000000
 
 /** A cell where an individual thread may wait suspended
 until a resource is released. The suspending is implemented
@@ -302,6 +313,25 @@ sync_cell_get_event(
 	}
 }
 
+/*******************************************************************//**
+Returns the futex word that a thread waiting for an object sleeps on.
+@return	futex word */
+static
+os_futex_t*
+sync_object_get_futex(
+/*==================*/
+	void*	object,	/*!< in: mutex or rw-lock */
+	ulint	type)	/*!< in: lock request type */
+{
+	if (type == SYNC_MUTEX) {
+		return(&((ib_mutex_t*) object)->futex);
+	} else if (type == RW_LOCK_WAIT_EX) {
+		return(&((rw_lock_t*) object)->wait_ex_futex);
+	} else { /* RW_LOCK_SHARED and RW_LOCK_EX wait on the same word */
+		return(&((rw_lock_t*) object)->futex);
+	}
+}
+
 /******************************************************************//**
 Reserves a wait array cell for waiting for an object.
 The event of the cell is reset to nonsignalled state.
@@ -358,9 +388,12 @@ sync_array_reserve_cell(
 
 			/* Make sure the event is reset and also store
 			the value of signal_count at which the event
-			was reset. */
-                        event = sync_cell_get_event(cell);
-			cell->signal_count = os_event_reset(event);
+			was reset. With futexes the cell is only used
+			for diagnostics and the object has no event. */
+			if (!srv_use_futex) {
+				event = sync_cell_get_event(cell);
+				cell->signal_count = os_event_reset(event);
+			}
 
 			cell->reservation_time = ut_time();
 
@@ -375,19 +408,18 @@ sync_array_reserve_cell(
 }
 
 /******************************************************************//**
-This function should be called when a thread starts to wait on
-a wait array cell. In the debug version this function checks
-if the wait for a semaphore will result in a deadlock, in which
-case prints info and asserts. */
-UNIV_INTERN
-void
-sync_array_wait_event(
-/*==================*/
+Marks a reserved cell as waiting. In the debug version this function
+checks if the wait for a semaphore will result in a deadlock, in which
+case prints info and asserts.
+@return	the cell */
+static
+sync_cell_t*
+sync_array_cell_start_wait(
+/*=======================*/
 	sync_array_t*	arr,	/*!< in: wait array */
 	ulint		index)	/*!< in: index of the reserved cell */
 {
 	sync_cell_t*	cell;
-	os_event_t	event;
 
 	ut_a(arr);
 
@@ -399,7 +431,6 @@ sync_array_wait_event(
 	ut_a(!cell->waiting);
 	ut_ad(os_thread_get_curr_id() == cell->thread);
 
-	event = sync_cell_get_event(cell);
 	cell->waiting = TRUE;
 
 #ifdef UNIV_SYNC_DEBUG
@@ -421,11 +452,121 @@ sync_array_wait_event(
 #endif
 	sync_array_exit(arr);
 
-	os_event_wait_low(event, cell->signal_count);
+	return(cell);
+}
+
+/******************************************************************//**
+This function should be called when a thread starts to wait on
+a wait array cell. In the debug version this function checks
+if the wait for a semaphore will result in a deadlock, in which
+case prints info and asserts. */
+UNIV_INTERN
+void
+sync_array_wait_event(
+/*==================*/
+	sync_array_t*	arr,	/*!< in: wait array */
+	ulint		index)	/*!< in: index of the reserved cell */
+{
+	sync_cell_t*	cell;
+
+	cell = sync_array_cell_start_wait(arr, index);
+
+	os_event_wait_low(sync_cell_get_event(cell), cell->signal_count);
 
 	sync_array_free_cell(arr, index);
 }
 
+/******************************************************************//**
+Prepares the calling thread to wait for a mutex or rw-lock. Without
+innodb_use_futex this reserves a wait array cell, which resets the event
+of the object; with it, the current value of the futex word of the object
+is recorded. Either way, a release of the object that happens after this
+call will not be missed by sync_array_wait(). */
+UNIV_INTERN
+void
+sync_array_prepare_wait(
+/*====================*/
+	sync_wait_t*	wait,	/*!< out: pending wait */
+	void*		object,	/*!< in: pointer to the object to wait for */
+	ulint		type,	/*!< in: lock request type */
+	const char*	file,	/*!< in: file where requested */
+	ulint		line)	/*!< in: line where requested */
+{
+	wait->object = object;
+	wait->type = type;
+	wait->file = file;
+	wait->line = line;
+
+	if (!srv_use_futex) {
+		wait->arr = sync_array_get_and_reserve_cell(
+			object, type, file, line, &wait->index);
+		return;
+	}
+
+	wait->arr = NULL;
+	wait->futex_val = *sync_object_get_futex(object, type);
+
+	/* The futex word must be read before the caller sets the
+	waiters flag and rechecks the lock word. */
+	os_rmb;
+}
+
+/******************************************************************//**
+Cancels a wait prepared with sync_array_prepare_wait(), after the caller
+acquired the object after all. */
+UNIV_INTERN
+void
+sync_array_cancel_wait(
+/*===================*/
+	sync_wait_t*	wait)	/*!< in/out: pending wait */
+{
+	if (wait->arr != NULL) {
+		sync_array_free_cell(wait->arr, wait->index);
+		wait->arr = NULL;
+	}
+}
+
+/******************************************************************//**
+Suspends the calling thread until the object of a wait prepared with
+sync_array_prepare_wait() has been signalled since the preparation. The
+caller must retry acquiring the object afterwards. */
+UNIV_INTERN
+void
+sync_array_wait(
+/*============*/
+	sync_wait_t*	wait)	/*!< in/out: pending wait */
+{
+	os_futex_t*	futex;
+
+	if (!srv_use_futex) {
+		sync_array_wait_event(wait->arr, wait->index);
+		wait->arr = NULL;
+		return;
+	}
+
+	futex = sync_object_get_futex(wait->object, wait->type);
+
+	while (os_futex_wait(futex, wait->futex_val,
+			     SYNC_ARRAY_FUTEX_DIAG_WAIT)
+	       == OS_SYNC_TIME_EXCEEDED) {
+
+		if (wait->arr != NULL) {
+			continue;
+		}
+
+		/* This is a long wait: make it visible to the error
+		monitor, SHOW ENGINE INNODB STATUS and, in the debug
+		version, the deadlock detector. */
+		wait->arr = sync_array_get_and_reserve_cell(
+			wait->object, wait->type, wait->file, wait->line,
+			&wait->index);
+
+		sync_array_cell_start_wait(wait->arr, wait->index);
+	}
+
+	sync_array_cancel_wait(wait);
+}
+
 /******************************************************************//**
 Reports info of a wait array cell. */
 static
@@ -851,7 +992,13 @@ sync_array_wake_threads_if_sema_free_low(
 
 			count++;
 
-			if (sync_arr_cell_can_wake_up(cell)) {
+			if (!sync_arr_cell_can_wake_up(cell)) {
+				/* Keep waiting */
+			} else if (srv_use_futex) {
+				os_futex_wake(sync_object_get_futex(
+					cell->wait_object,
+					cell->request_type));
+			} else {
 				os_event_t      event;
 
 				event = sync_cell_get_event(cell);
@@ -260,12 +260,20 @@ rw_lock_create_func(
 	lock->cline = (unsigned int) cline;
 
 	lock->count_os_wait = 0;
+	sync_spin_init(&lock->spin);
 	lock->last_s_file_name = "not yet reserved";
 	lock->last_x_file_name = "not yet reserved";
 	lock->last_s_line = 0;
 	lock->last_x_line = 0;
-	lock->event = os_event_create();
-	lock->wait_ex_event = os_event_create();
+	if (srv_use_futex) {
+		lock->event = NULL;
+		lock->wait_ex_event = NULL;
+	} else {
+		lock->event = os_event_create();
+		lock->wait_ex_event = os_event_create();
+	}
+	lock->futex = 0;
+	lock->wait_ex_futex = 0;
 
 	mutex_enter(&rw_lock_list_mutex);
 
@@ -300,9 +308,11 @@ rw_lock_free_func(
 	mutex = rw_lock_get_mutex(lock);
 #endif /* !INNODB_RW_LOCKS_USE_ATOMICS */
 
-	os_event_free(lock->event);
+	if (lock->event != NULL) {
+		os_event_free(lock->event);
 
-	os_event_free(lock->wait_ex_event);
+		os_event_free(lock->wait_ex_event);
+	}
 
 	ut_ad(UT_LIST_GET_PREV(list, lock) == NULL
 	      || UT_LIST_GET_PREV(list, lock)->magic_n == RW_LOCK_MAGIC_N);
@@ -365,9 +375,10 @@ rw_lock_s_lock_spin(
 	const char*	file_name, /*!< in: file name where lock requested */
 	ulint		line)	/*!< in: line where requested */
 {
-	ulint		index;	/* index of the reserved wait cell */
+	sync_wait_t	wait;	/* the wait prepared after spinning */
 	ulint		i = 0;	/* spin round count */
-	sync_array_t*	sync_arr;
+	ulint		limit;	/* spin rounds before suspending */
+	ullint		start_us;/* when the spinning began */
 	size_t		counter_index;
 
 	/* We reuse the thread id to index into the counter, cache
@@ -378,11 +389,14 @@ rw_lock_s_lock_spin(
 	ut_ad(rw_lock_validate(lock));
 
 	rw_lock_stats.rw_s_spin_wait_count.add(counter_index, 1);
+
+	limit = sync_spin_get_limit(&lock->spin);
+	start_us = srv_adaptive_spin ? ut_time_us(NULL) : 0;
 lock_loop:
 
 	/* Spin waiting for the writer field to become free */
 	os_rmb;
-	while (i < SYNC_SPIN_ROUNDS && lock->lock_word <= 0) {
+	while (i < limit && lock->lock_word <= 0) {
 		if (srv_spin_wait_delay) {
 			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
 		}
@@ -390,34 +404,34 @@ lock_loop:
 		i++;
 	}
 
-	if (i >= SYNC_SPIN_ROUNDS) {
+	if (i >= limit) {
 		os_thread_yield();
 	}
 
 	/* We try once again to obtain the lock */
 	if (TRUE == rw_lock_s_lock_low(lock, pass, file_name, line)) {
 		rw_lock_stats.rw_s_spin_round_count.add(counter_index, i);
+		sync_spin_end(&lock->spin, i, start_us, TRUE);
 
 		return; /* Success */
 	} else {
 
-		if (i < SYNC_SPIN_ROUNDS) {
+		if (i < limit) {
 			goto lock_loop;
 		}
 
 		rw_lock_stats.rw_s_spin_round_count.add(counter_index, i);
 
-		sync_arr = sync_array_get_and_reserve_cell(lock,
-							   RW_LOCK_SHARED,
-							   file_name,
-							   line, &index);
+		sync_array_prepare_wait(&wait, lock, RW_LOCK_SHARED,
+					file_name, line);
 
 		/* Set waiters before checking lock_word to ensure wake-up
 		signal is sent. This may lead to some unnecessary signals. */
 		rw_lock_set_waiter_flag(lock);
 
 		if (TRUE == rw_lock_s_lock_low(lock, pass, file_name, line)) {
-			sync_array_free_cell(sync_arr, index);
+			sync_array_cancel_wait(&wait);
+			sync_spin_end(&lock->spin, i, start_us, TRUE);
 			return; /* Success */
 		}
 
@@ -425,9 +439,13 @@ lock_loop:
 		lock->count_os_wait++;
 		rw_lock_stats.rw_s_os_wait_count.add(counter_index, 1);
 
-		sync_array_wait_event(sync_arr, index);
+		sync_spin_end(&lock->spin, i, start_us, FALSE);
+
+		sync_array_wait(&wait);
 
 		i = 0;
+		limit = sync_spin_get_limit(&lock->spin);
+		start_us = srv_adaptive_spin ? ut_time_us(NULL) : 0;
 		goto lock_loop;
 	}
 }
@@ -467,10 +485,12 @@ rw_lock_x_lock_wait(
 	const char*	file_name,/*!< in: file name where lock requested */
 	ulint		line)	/*!< in: line where requested */
 {
-	ulint		index;
+	sync_wait_t	wait;
 	ulint		i = 0;
-	sync_array_t*	sync_arr;
 	size_t		counter_index;
+	/* The readers being waited for are not timed, but the limit
+	still tells how long the latch is usually worth spinning for. */
+	ulint		limit = sync_spin_get_limit(&lock->spin);
 
 	/* We reuse the thread id to index into the counter, cache
 	it here for efficiency. */
@@ -484,7 +504,7 @@ rw_lock_x_lock_wait(
 		if (srv_spin_wait_delay) {
 			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
 		}
-		if(i < SYNC_SPIN_ROUNDS) {
+		if(i < limit) {
 			i++;
 			os_rmb;
 			continue;
@@ -493,10 +513,8 @@ rw_lock_x_lock_wait(
 		/* If there is still a reader, then go to sleep.*/
 		rw_lock_stats.rw_x_spin_round_count.add(counter_index, i);
 
-		sync_arr = sync_array_get_and_reserve_cell(lock,
-							   RW_LOCK_WAIT_EX,
-							   file_name,
-							   line, &index);
+		sync_array_prepare_wait(&wait, lock, RW_LOCK_WAIT_EX,
+					file_name, line);
 
 		i = 0;
 
@@ -515,7 +533,7 @@ rw_lock_x_lock_wait(
 					       file_name, line);
 #endif
 
-			sync_array_wait_event(sync_arr, index);
+			sync_array_wait(&wait);
 #ifdef UNIV_SYNC_DEBUG
 			rw_lock_remove_debug_info(
 				lock, pass, RW_LOCK_WAIT_EX);
@@ -523,7 +541,7 @@ rw_lock_x_lock_wait(
 			/* It is possible to wake when lock_word < 0.
 			We must pass the while-loop check to proceed.*/
 		} else {
-			sync_array_free_cell(sync_arr, index);
+			sync_array_cancel_wait(&wait);
 		}
 	}
 	rw_lock_stats.rw_x_spin_round_count.add(counter_index, i);
@@ -611,8 +629,9 @@ rw_lock_x_lock_func(
 	ulint		line)	/*!< in: line where requested */
 {
 	ulint		i;	/*!< spin round count */
-	ulint		index;	/*!< index of the reserved wait cell */
-	sync_array_t*	sync_arr;
+	ulint		limit = 0;/*!< spin rounds before suspending */
+	ullint		start_us = 0;/*!< when the spinning began */
+	sync_wait_t	wait;	/*!< the wait prepared after spinning */
 	ibool		spinning = FALSE;
 	size_t		counter_index;
 
@@ -633,12 +652,24 @@ lock_loop:
 	if (rw_lock_x_lock_low(lock, pass, file_name, line)) {
 		rw_lock_stats.rw_x_spin_round_count.add(counter_index, i);
 
+		if (spinning) {
+			sync_spin_end(&lock->spin, i, start_us, TRUE);
+
+			/* A lock passed to another thread is released
+			there, so its hold is not timed. */
+			if (!pass) {
+				sync_spin_hold_begin(&lock->spin);
+			}
+		}
+
 		return;	/* Locking succeeded */
 
 	} else {
 
 		if (!spinning) {
 			spinning = TRUE;
+			limit = sync_spin_get_limit(&lock->spin);
+			start_us = srv_adaptive_spin ? ut_time_us(NULL) : 0;
 
 			rw_lock_stats.rw_x_spin_wait_count.add(
 				counter_index, 1);
@@ -646,7 +677,7 @@ lock_loop:
 
 		/* Spin waiting for the lock_word to become free */
 		os_rmb;
-		while (i < SYNC_SPIN_ROUNDS
+		while (i < limit
 		       && lock->lock_word <= 0) {
 			if (srv_spin_wait_delay) {
 				ut_delay(ut_rnd_interval(0,
@@ -655,7 +686,7 @@ lock_loop:
 
 			i++;
 		}
-		if (i >= SYNC_SPIN_ROUNDS) {
+		if (i >= limit) {
 			os_thread_yield();
 		} else {
 			goto lock_loop;
@@ -664,15 +695,20 @@ lock_loop:
 
 	rw_lock_stats.rw_x_spin_round_count.add(counter_index, i);
 
-	sync_arr = sync_array_get_and_reserve_cell(lock, RW_LOCK_EX,
-						   file_name, line, &index);
+	sync_array_prepare_wait(&wait, lock, RW_LOCK_EX, file_name, line);
 
 	/* Waiters must be set before checking lock_word, to ensure signal
 	is sent. This could lead to a few unnecessary wake-up signals. */
 	rw_lock_set_waiter_flag(lock);
 
 	if (rw_lock_x_lock_low(lock, pass, file_name, line)) {
-		sync_array_free_cell(sync_arr, index);
+		sync_array_cancel_wait(&wait);
+		sync_spin_end(&lock->spin, i, start_us, TRUE);
+
+		if (!pass) {
+			sync_spin_hold_begin(&lock->spin);
+		}
+
 		return; /* Locking succeeded */
 	}
 
@@ -680,9 +716,13 @@ lock_loop:
 	lock->count_os_wait++;
 	rw_lock_stats.rw_x_os_wait_count.add(counter_index, 1);
 
-	sync_array_wait_event(sync_arr, index);
+	sync_spin_end(&lock->spin, i, start_us, FALSE);
+
+	sync_array_wait(&wait);
 
 	i = 0;
+	limit = sync_spin_get_limit(&lock->spin);
+	start_us = srv_adaptive_spin ? ut_time_us(NULL) : 0;
 	goto lock_loop;
 }
 
@@ -183,6 +183,14 @@ static ib_counter_t<ib_int64_t, IB_N_SLOTS>	mutex_os_wait_count;
 monitoring. */
 UNIV_INTERN ib_int64_t			mutex_exit_count;
 
+/** Weight of a new sample in the moving averages of sync_spin_t and
+sync_spin_round_ns is 1/SYNC_SPIN_AVG_WEIGHT */
+#define SYNC_SPIN_AVG_WEIGHT	8
+
+/** Moving average of how long one spin round takes, in nanoseconds.
+Updated without synchronization by sync_spin_end(). */
+static ulint	sync_spin_round_ns;
+
 /** This variable is set to TRUE when sync_init is called */
 UNIV_INTERN ibool	sync_initialized	= FALSE;
 
@@ -279,7 +287,8 @@ mutex_create_func(
 	os_fast_mutex_init(PFS_NOT_INSTRUMENTED, &mutex->os_fast_mutex);
 	mutex->lock_word = 0;
 #endif
-	mutex->event = os_event_create();
+	mutex->event = srv_use_futex ? NULL : os_event_create();
+	mutex->futex = 0;
 	mutex_set_waiters(mutex, 0);
 #ifdef UNIV_DEBUG
 	mutex->magic_n = MUTEX_MAGIC_N;
@@ -292,6 +301,7 @@ mutex_create_func(
 	mutex->cfile_name = cfile_name;
 	mutex->cline = cline;
 	mutex->count_os_wait = 0;
+	sync_spin_init(&mutex->spin);
 
 	/* Check that lock_word is aligned; this is important on Intel */
 	ut_ad(((ulint)(&(mutex->lock_word))) % 4 == 0);
@@ -361,7 +371,9 @@ mutex_free_func(
 		mutex_exit(&mutex_list_mutex);
 	}
 
-	os_event_free(mutex->event);
+	if (mutex->event != NULL) {
+		os_event_free(mutex->event);
+	}
 #ifdef UNIV_MEM_DEBUG
 func_exit:
 #endif /* UNIV_MEM_DEBUG */
@@ -463,8 +475,9 @@ mutex_set_waiters(
 
 /******************************************************************//**
 Reserves a mutex for the current thread. If the mutex is reserved, the
-function spins a preset time (controlled by SYNC_SPIN_ROUNDS), waiting
-for the mutex before suspending the thread. */
+function spins a preset time (controlled by SYNC_SPIN_ROUNDS, or by the
+adaptive limit of the mutex), waiting for the mutex before suspending the
+thread. */
 UNIV_INTERN
 void
 mutex_spin_wait(
@@ -475,8 +488,9 @@ mutex_spin_wait(
 	ulint		line)		/*!< in: line where requested */
 {
 	ulint		i;		/* spin round count */
-	ulint		index;		/* index of the reserved wait cell */
-	sync_array_t*	sync_arr;
+	ulint		limit;		/* spin rounds before suspending */
+	ullint		start_us;	/* when the spinning began */
+	sync_wait_t	wait;		/* the wait prepared after spinning */
 	size_t		counter_index;
 
 	counter_index = (size_t) os_thread_get_curr_id();
@@ -492,6 +506,8 @@ mutex_spin_wait(
 mutex_loop:
 
 	i = 0;
+	limit = sync_spin_get_limit(&mutex->spin);
+	start_us = srv_adaptive_spin ? ut_time_us(NULL) : 0;
 
 	/* Spin waiting for the lock word to become zero. Note that we do
 	not have to assume that the read access to the lock word is atomic,
@@ -501,7 +517,7 @@ mutex_loop:
 
 spin_loop:
 	os_rmb;
-	while (mutex_get_lock_word(mutex) != 0 && i < SYNC_SPIN_ROUNDS) {
+	while (mutex_get_lock_word(mutex) != 0 && i < limit) {
 		if (srv_spin_wait_delay) {
 			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
 		}
@@ -509,7 +525,7 @@ spin_loop:
 		i++;
 	}
 
-	if (i >= SYNC_SPIN_ROUNDS) {
+	if (i >= limit) {
 		os_thread_yield();
 	}
 
@@ -522,6 +538,8 @@ spin_loop:
 #ifdef UNIV_SYNC_DEBUG
 		mutex_set_debug_info(mutex, file_name, line);
 #endif
+		sync_spin_end(&mutex->spin, i, start_us, TRUE);
+		sync_spin_hold_begin(&mutex->spin);
 		return;
 	}
 
@@ -534,32 +552,34 @@ spin_loop:
 
 	i++;
 
-	if (i < SYNC_SPIN_ROUNDS) {
+	if (i < limit) {
 		goto spin_loop;
 	}
 
-	sync_arr = sync_array_get_and_reserve_cell(mutex, SYNC_MUTEX,
-						   file_name, line, &index);
+	sync_array_prepare_wait(&wait, mutex, SYNC_MUTEX, file_name, line);
 
 	/* The memory order of the array reservation and the change in the
 	waiters field is important: when we suspend a thread, we first
-	reserve the cell and then set waiters field to 1. When threads are
-	released in mutex_exit, the waiters field is first set to zero and
-	then the event is set to the signaled state. */
+	reserve the cell (or read the futex word) and then set waiters
+	field to 1. When threads are released in mutex_exit, the waiters
+	field is first set to zero and then the event is set to the
+	signaled state (or the futex word is changed). */
 
 	mutex_set_waiters(mutex, 1);
 
 	/* Try to reserve still a few times */
-	for (i = 0; i < 4; i++) {
+	for (ulint j = 0; j < 4; j++) {
 		if (ib_mutex_test_and_set(mutex) == 0) {
 			/* Succeeded! Free the reserved wait cell */
 
-			sync_array_free_cell(sync_arr, index);
+			sync_array_cancel_wait(&wait);
 
 			ut_d(mutex->thread_id = os_thread_get_curr_id());
 #ifdef UNIV_SYNC_DEBUG
 			mutex_set_debug_info(mutex, file_name, line);
 #endif
+			sync_spin_end(&mutex->spin, i, start_us, TRUE);
+			sync_spin_hold_begin(&mutex->spin);
 
 			return;
 
@@ -577,11 +597,144 @@ spin_loop:
 
 	mutex->count_os_wait++;
 
-	sync_array_wait_event(sync_arr, index);
+	sync_spin_end(&mutex->spin, i, start_us, FALSE);
+
+	sync_array_wait(&wait);
 
 	goto mutex_loop;
 }
 
+/******************************************************************//**
+Initializes the adaptive spin state of a latch. */
+UNIV_INTERN
+void
+sync_spin_init(
+/*===========*/
+	sync_spin_t*	spin)	/*!< out: adaptive spin state */
+{
+	memset(spin, 0x0, sizeof *spin);
+}
+
+/******************************************************************//**
+Gets the number of rounds a thread should spin for a latch before it
+suspends itself.
+@return	SYNC_SPIN_ROUNDS, or the adaptive limit if innodb_adaptive_spin */
+UNIV_INTERN
+ulint
+sync_spin_get_limit(
+/*================*/
+	const sync_spin_t*	spin)	/*!< in: adaptive spin state */
+{
+	if (!srv_adaptive_spin || spin->limit == 0) {
+		return(SYNC_SPIN_ROUNDS);
+	}
+
+	/* innodb_sync_spin_loops may have been lowered since the limit
+	was last adapted. */
+	return(ut_min(spin->limit, SYNC_SPIN_MAX_FACTOR * SYNC_SPIN_ROUNDS));
+}
+
+/******************************************************************//**
+Records the outcome of a spin wait for a latch and, if
+innodb_adaptive_spin, adapts the spin limit of the latch: the limit grows
+when waits succeed only near its end, decays when they succeed early and
+shrinks when the latch is typically held for longer than spinning up to
+the limit takes, as then the spinning is wasted. */
+UNIV_INTERN
+void
+sync_spin_end(
+/*==========*/
+	sync_spin_t*	spin,		/*!< in/out: adaptive spin state */
+	ulint		n_rounds,	/*!< in: rounds spun */
+	ullint		start_us,	/*!< in: ut_time_us() when the
+					spinning began, or 0 if not timed */
+	ibool		acquired)	/*!< in: TRUE if the latch was
+					acquired, FALSE if the thread
+					will be suspended */
+{
+	ulint	limit;
+	ulint	max_limit;
+	ulint	min_limit;
+
+	spin->n_waits++;
+	spin->n_rounds += n_rounds;
+
+	if (acquired) {
+		spin->n_spin_acquired++;
+	}
+
+	if (!srv_adaptive_spin || start_us == 0) {
+		return;
+	}
+
+	if (n_rounds > 0) {
+		ullint	now = ut_time_us(NULL);
+
+		/* The time a round takes depends on innodb_spin_wait_delay
+		and on the CPU, not on the latch, so one moving average is
+		kept for all latches. */
+		if (now >= start_us) {
+			ib_int64_t	round_ns = static_cast<ib_int64_t>(
+				(now - start_us) * 1000 / n_rounds);
+			ib_int64_t	avg = static_cast<ib_int64_t>(
+				sync_spin_round_ns);
+
+			sync_spin_round_ns = static_cast<ulint>(
+				avg + (round_ns - avg) / SYNC_SPIN_AVG_WEIGHT);
+		}
+	}
+
+	max_limit = SYNC_SPIN_MAX_FACTOR * SYNC_SPIN_ROUNDS;
+	min_limit = ut_min(SYNC_SPIN_MIN_ROUNDS, max_limit);
+	limit = sync_spin_get_limit(spin);
+
+	if (acquired) {
+		if (2 * n_rounds >= limit) {
+			/* The latch was released just in time; waits
+			that are a little longer would be lost to
+			suspension. */
+			limit *= 2;
+		} else if (4 * n_rounds < limit) {
+			limit -= limit / 8;
+		}
+	} else if (spin->hold_time > 2 * limit * sync_spin_round_ns) {
+		/* Spinning up to the limit covers only a fraction of a
+		typical hold: suspend sooner and leave the CPU to the
+		holder. Waits that fail although holds are short are
+		caused by queueing, not by the limit, which is kept. */
+		limit /= 2;
+	}
+
+	spin->limit = ut_max(ut_min(limit, max_limit), min_limit);
+}
+
+/******************************************************************//**
+Adds a timed hold of a latch to its moving average. */
+UNIV_INTERN
+void
+sync_spin_hold_sample(
+/*==================*/
+	sync_spin_t*	spin)	/*!< in/out: adaptive spin state */
+{
+	ullint	start = spin->hold_start;
+	ullint	now = ut_time_us(NULL);
+
+	spin->hold_start = 0;
+
+	/* The clock only has microsecond resolution, but as holds begin
+	at a random phase of it, the average of the truncated samples
+	converges to the average hold time even for shorter holds. */
+	if (now >= start) {
+		ib_int64_t	hold_ns = static_cast<ib_int64_t>(
+			(now - start) * 1000);
+		ib_int64_t	avg = static_cast<ib_int64_t>(
+			spin->hold_time);
+
+		spin->hold_time = static_cast<ulint>(
+			avg + (hold_ns - avg) / SYNC_SPIN_AVG_WEIGHT);
+	}
+}
+
 /******************************************************************//**
 Releases the threads waiting in the primary wait array for this mutex. */
 UNIV_INTERN
@@ -594,7 +747,11 @@ mutex_signal_object(
 
 	/* The memory order of resetting the waiters field and
 	signaling the object is important. See LEMMA 1 above. */
-	os_event_set(mutex->event);
+	if (srv_use_futex) {
+		os_futex_wake(&mutex->futex);
+	} else {
+		os_event_set(mutex->event);
+	}
 	sync_array_object_signalled();
 }
 
@@ -1138,6 +1295,8 @@ sync_thread_add_level(
 	case SYNC_RECV:
 	case SYNC_FTS_BG_THREADS:
 	case SYNC_WORK_QUEUE:
+	case SYNC_PAGE_CLEANER:
+	case SYNC_ROW_MERGE_PLL:
 	case SYNC_FTS_TOKENIZE:
 	case SYNC_FTS_OPTIMIZE:
 	case SYNC_FTS_CACHE:
@@ -1147,7 +1306,6 @@ sync_thread_add_level(
 	case SYNC_ANY_LATCH:
 	case SYNC_FILE_FORMAT_TAG:
 	case SYNC_DOUBLEWRITE:
-	case SYNC_SEARCH_SYS:
 	case SYNC_THREADS:
 	case SYNC_LOCK_SYS:
 	case SYNC_LOCK_WAIT_SYS:
@@ -1173,17 +1331,36 @@ sync_thread_add_level(
 		}
 		break;
 	case SYNC_TRX:
-		/* Either the thread must own the lock_sys->mutex, or
-		it is allowed to own only ONE trx->mutex. */
+		/* Either the thread must own the lock_sys->mutex or a
+		record lock shard mutex, or it is allowed to own only ONE
+		trx->mutex. */
 		if (!sync_thread_levels_g(array, level, FALSE)) {
 			ut_a(sync_thread_levels_g(array, level - 1, TRUE));
-			ut_a(sync_thread_levels_contain(array, SYNC_LOCK_SYS));
+			ut_a(sync_thread_levels_contain(array, SYNC_LOCK_SYS)
+			     || sync_thread_levels_contain(
+				     array, SYNC_LOCK_REC_SHARD));
+		}
+		break;
+	case SYNC_LOCK_REC_SHARD:
+		/* Either the thread must own the lock_sys->mutex, in
+		which case all the shard mutexes may be acquired together
+		by lock_mutex_enter(), or it is allowed to own only ONE
+		record lock shard mutex. */
+		if (sync_thread_levels_contain(array, SYNC_LOCK_SYS)) {
+			ut_a(sync_thread_levels_g(
+				     array, SYNC_LOCK_REC_SHARD - 1, TRUE));
+		} else {
+			ut_a(sync_thread_levels_g(
+				     array, SYNC_LOCK_REC_SHARD, TRUE));
 		}
 		break;
 	case SYNC_BUF_FLUSH_LIST:
 	case SYNC_BUF_POOL:
+	case SYNC_SEARCH_SYS:
 		/* We can have multiple mutexes of this type therefore we
-		can only check whether the greater than condition holds. */
+		can only check whether the greater than condition holds.
+		All the adaptive hash index partitions are x-latched
+		together when the adaptive hash index is disabled. */
 		if (!sync_thread_levels_g(array, level-1, TRUE)) {
 			fprintf(stderr,
 				"InnoDB: sync_thread_levels_g(array, %lu)"
@@ -1588,6 +1765,141 @@ sync_print_wait_info(
 		 ? rw_lock_stats.rw_x_spin_wait_count : 1));
 }
 
+/*******************************************************************//**
+Adds the statistics of a latch to an entry of a sync_latch_stats_get()
+snapshot. */
+static
+void
+sync_latch_stats_add(
+/*=================*/
+	sync_latch_stats_t*	entry,		/*!< in/out: entry, zero-filled
+						before the first latch */
+	ibool			is_rw_lock,	/*!< in: TRUE for rw_lock_t */
+	const char*		cfile_name,	/*!< in: file where created */
+	ulint			cline,		/*!< in: line where created */
+	const sync_spin_t*	spin,		/*!< in: adaptive spin state */
+	ulint			n_os_waits)	/*!< in: count_os_wait */
+{
+	entry->is_rw_lock = is_rw_lock;
+	entry->cfile_name = cfile_name;
+	entry->cline = cline;
+	entry->n_instances++;
+	entry->n_waits += spin->n_waits;
+	entry->n_rounds += spin->n_rounds;
+	entry->n_spin_acquired += spin->n_spin_acquired;
+	entry->n_os_waits += n_os_waits;
+
+	/* Summed here, divided by n_instances by the caller */
+	entry->spin_limit += sync_spin_get_limit(spin);
+	entry->hold_time += spin->hold_time;
+}
+
+/*******************************************************************//**
+Takes a snapshot of the contention statistics of the mutexes and rw-locks
+that have been waited for. The buffer block mutexes and the buffer block
+rw-locks are each combined into one entry, as in SHOW ENGINE INNODB MUTEX.
+@return	number of entries in *stats */
+UNIV_INTERN
+ulint
+sync_latch_stats_get(
+/*=================*/
+	sync_latch_stats_t**	stats)	/*!< out: array of entries,
+					to be freed with ut_free() */
+{
+	sync_latch_stats_t*	arr;
+	sync_latch_stats_t	block_mutex;
+	sync_latch_stats_t	block_lock;
+	ulint			n = 0;
+	ulint			n_alloc;
+
+	memset(&block_mutex, 0x0, sizeof block_mutex);
+	memset(&block_lock, 0x0, sizeof block_lock);
+	block_mutex.combined = block_lock.combined = TRUE;
+
+	mutex_enter(&mutex_list_mutex);
+
+	/* Room for the combined entries, which are appended last */
+	n_alloc = 2;
+
+	for (ib_mutex_t* mutex = UT_LIST_GET_FIRST(mutex_list);
+	     mutex != NULL;
+	     mutex = UT_LIST_GET_NEXT(list, mutex)) {
+
+		n_alloc += mutex->spin.n_waits > 0 || mutex->count_os_wait > 0;
+	}
+
+	arr = static_cast<sync_latch_stats_t*>(
+		ut_malloc(n_alloc * sizeof *arr));
+	memset(arr, 0x0, n_alloc * sizeof *arr);
+
+	for (ib_mutex_t* mutex = UT_LIST_GET_FIRST(mutex_list);
+	     mutex != NULL;
+	     mutex = UT_LIST_GET_NEXT(list, mutex)) {
+
+		if (mutex->spin.n_waits == 0 && mutex->count_os_wait == 0) {
+			continue;
+		}
+
+		sync_latch_stats_add(
+			buf_pool_is_block_mutex(mutex)
+			? &block_mutex : &arr[n++],
+			FALSE, mutex->cfile_name, mutex->cline,
+			&mutex->spin, mutex->count_os_wait);
+	}
+
+	mutex_exit(&mutex_list_mutex);
+
+	mutex_enter(&rw_lock_list_mutex);
+
+	n_alloc = n + 2;
+
+	for (rw_lock_t* lock = UT_LIST_GET_FIRST(rw_lock_list);
+	     lock != NULL;
+	     lock = UT_LIST_GET_NEXT(list, lock)) {
+
+		n_alloc += lock->spin.n_waits > 0 || lock->count_os_wait > 0;
+	}
+
+	arr = static_cast<sync_latch_stats_t*>(
+		ut_realloc(arr, n_alloc * sizeof *arr));
+	ut_a(arr != NULL);
+	memset(arr + n, 0x0, (n_alloc - n) * sizeof *arr);
+
+	for (rw_lock_t* lock = UT_LIST_GET_FIRST(rw_lock_list);
+	     lock != NULL;
+	     lock = UT_LIST_GET_NEXT(list, lock)) {
+
+		if (lock->spin.n_waits == 0 && lock->count_os_wait == 0) {
+			continue;
+		}
+
+		sync_latch_stats_add(
+			buf_pool_is_block_lock(lock)
+			? &block_lock : &arr[n++],
+			TRUE, lock->cfile_name, lock->cline,
+			&lock->spin, lock->count_os_wait);
+	}
+
+	mutex_exit(&rw_lock_list_mutex);
+
+	if (block_mutex.n_instances > 0) {
+		arr[n++] = block_mutex;
+	}
+
+	if (block_lock.n_instances > 0) {
+		arr[n++] = block_lock;
+	}
+
+	for (ulint i = 0; i < n; i++) {
+		arr[i].spin_limit /= arr[i].n_instances;
+		arr[i].hold_time /= arr[i].n_instances;
+	}
+
+	*stats = arr;
+
+	return(n);
+}
+
 /*******************************************************************//**
 Prints info of the sync system. */
 UNIV_INTERN
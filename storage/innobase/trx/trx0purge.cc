@@ -45,6 +45,13 @@ Created 3/26/1996 Heikki Tuuri
 #include "os0thread.h"
 #include "srv0mon.h"
 #include "mtr0log.h"
+#include "buf0rea.h"
+#include "buf0lru.h"
+#include "log0log.h"
+#include "os0file.h"
+
+#include <map>
+#include <set>
 
 /** Maximum allowable purge history length.  <=0 means 'infinite'. */
 UNIV_INTERN ulong		srv_max_purge_lag = 0;
@@ -52,6 +59,10 @@ UNIV_INTERN ulong		srv_max_purge_lag = 0;
 /** Max DML user threads delay in micro-seconds. */
 UNIV_INTERN ulong		srv_max_purge_lag_delay = 0;
 
+/** Maximum number of undo log pages to read ahead when purge moves on to
+the next undo log, or 0 to disable the read-ahead. */
+UNIV_INTERN ulong		srv_purge_read_ahead_pages = 8;
+
 /** The global data structure coordinating a purge */
 UNIV_INTERN trx_purge_t*	purge_sys = NULL;
 
@@ -133,6 +144,10 @@ trx_purge_sys_create(
 
 	purge_sys->heap = mem_heap_create(256);
 
+	purge_sys->read_ahead_page_no = FIL_NULL;
+
+	purge_sys->undo_trunc_space = ULINT_UNDEFINED;
+
 	ut_a(n_purge_threads > 0);
 
 	purge_sys->sess = sess_open();
@@ -367,6 +382,9 @@ trx_purge_free_segment(
 	mutex_exit(&trx_sys->mutex);
 #endif /* HAVE_ATOMIC_BUILTINS */
 
+	purge_sys->n_history_drained += n_removed_logs;
+	MONITOR_INC_VALUE(MONITOR_PURGE_HISTORY_DRAINED, n_removed_logs);
+
 	do {
 
 		/* Here we assume that a file segment with just the header
@@ -454,6 +472,10 @@ loop:
 		mutex_exit(&trx_sys->mutex);
 #endif /* HAVE_ATOMIC_BUILTINS */
 
+		purge_sys->n_history_drained += n_removed_logs;
+		MONITOR_INC_VALUE(MONITOR_PURGE_HISTORY_DRAINED,
+				  n_removed_logs);
+
 		flst_truncate_end(rseg_hdr + TRX_RSEG_HISTORY,
 				  log_hdr + TRX_UNDO_HISTORY_NODE,
 				  n_removed_logs, &mtr);
@@ -707,6 +729,91 @@ trx_purge_get_rseg_with_min_trx_id(
 	return(zip_size);
 }
 
+/***********************************************************************//**
+Reads ahead the header pages of the undo logs that purge will visit after
+the current one. Each rollback segment queued in purge_sys->ib_bh has the
+header of its next undo log to purge at rseg->last_page_no. The pages are
+read asynchronously, so that they are usually resident by the time
+trx_purge_read_undo_rec() gets to them. */
+static
+void
+trx_purge_read_ahead_logs(
+/*======================*/
+	trx_purge_t*	purge_sys)		/*!< in: purge instance */
+{
+	ulint		n_rsegs = 0;
+	ulint		n_read = 0;
+	trx_rseg_t*	rsegs[64];
+
+	ut_ad(srv_purge_read_ahead_pages <= UT_ARR_SIZE(rsegs));
+
+	mutex_enter(&purge_sys->bh_mutex);
+
+	/* The elements of the binary heap are not fully sorted, but
+	the ones near its root are the next to be purged. */
+
+	for (ulint i = 0;
+	     i < ib_bh_size(purge_sys->ib_bh)
+	     && n_rsegs < srv_purge_read_ahead_pages;
+	     ++i) {
+
+		rsegs[n_rsegs++] = static_cast<rseg_queue_t*>(
+			ib_bh_get(purge_sys->ib_bh, i))->rseg;
+	}
+
+	mutex_exit(&purge_sys->bh_mutex);
+
+	for (ulint i = 0; i < n_rsegs; ++i) {
+		ulint	page_no;
+
+		/* This is a dirty read: a stale page number only costs
+		a useless read. */
+		page_no = rsegs[i]->last_page_no;
+
+		if (page_no != FIL_NULL) {
+			n_read += buf_read_pages_async(
+				rsegs[i]->space, rsegs[i]->zip_size,
+				&page_no, 1);
+		}
+	}
+
+	MONITOR_INC_VALUE(MONITOR_PURGE_READ_AHEAD, n_read);
+}
+
+/***********************************************************************//**
+Reads ahead the undo page that follows the given one in the page list of
+its undo log segment, unless that was already done for this page. */
+static
+void
+trx_purge_read_ahead_page(
+/*======================*/
+	trx_purge_t*	purge_sys,		/*!< in/out: purge instance */
+	const page_t*	undo_page,		/*!< in: s-latched undo page */
+	mtr_t*		mtr)			/*!< in: mtr */
+{
+	ulint		page_no = page_get_page_no(undo_page);
+	fil_addr_t	next_addr;
+
+	if (page_no == purge_sys->read_ahead_page_no) {
+		return;
+	}
+
+	purge_sys->read_ahead_page_no = page_no;
+
+	next_addr = flst_get_next_addr(
+		undo_page + TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_NODE, mtr);
+
+	if (next_addr.page != FIL_NULL) {
+		ulint	n_read;
+
+		n_read = buf_read_pages_async(
+			purge_sys->rseg->space, purge_sys->rseg->zip_size,
+			&next_addr.page, 1);
+
+		MONITOR_INC_VALUE(MONITOR_PURGE_READ_AHEAD, n_read);
+	}
+}
+
 /***********************************************************************//**
 Position the purge sys "iterator" on the undo record to use for purging. */
 static
@@ -774,6 +881,10 @@ trx_purge_choose_next_log(void)
 	zip_size = trx_purge_get_rseg_with_min_trx_id(purge_sys);
 
 	if (purge_sys->rseg != NULL) {
+		if (srv_purge_read_ahead_pages > 0) {
+			trx_purge_read_ahead_logs(purge_sys);
+		}
+
 		trx_purge_read_undo_rec(purge_sys, zip_size);
 	} else {
 		/* There is nothing to do yet. */
@@ -829,6 +940,10 @@ trx_purge_get_next_rec(
 
 	undo_page = trx_undo_page_get_s_latched(space, zip_size, page_no, &mtr);
 
+	if (srv_purge_read_ahead_pages > 0) {
+		trx_purge_read_ahead_page(purge_sys, undo_page, &mtr);
+	}
+
 	rec = undo_page + offset;
 
 	rec2 = rec;
@@ -955,6 +1070,67 @@ trx_purge_fetch_next_rec(
 	return(trx_purge_get_next_rec(n_pages_handled, heap));
 }
 
+/*******************************************************************//**
+Counts the distinct tables in the batch that was just attached to the
+purge nodes, and how many more nodes than one each table's records were
+given to. This is checked on the node vectors themselves, so that the
+MONITOR_PURGE_BATCH_TABLE_SPLITS counter stays at zero only if the batch
+really was partitioned by table. */
+static
+void
+trx_purge_count_batch_tables(
+/*=========================*/
+	ulint		n_purge_threads,/*!< in: number of purge threads */
+	trx_purge_t*	purge_sys)	/*!< in: purge instance */
+{
+	typedef std::pair<table_id_t, const purge_node_t*> table_node_t;
+
+	std::set<table_id_t>	tables;
+	std::set<table_node_t>	table_nodes;
+	const que_thr_t*	thr;
+	ulint			i;
+
+	for (thr = UT_LIST_GET_FIRST(purge_sys->query->thrs), i = 0;
+	     thr != NULL && i < n_purge_threads;
+	     thr = UT_LIST_GET_NEXT(thrs, thr), ++i) {
+
+		const purge_node_t*	node;
+
+		node = static_cast<const purge_node_t*>(thr->child);
+
+		if (node->undo_recs == NULL) {
+			continue;
+		}
+
+		for (ulint j = 0; j < ib_vector_size(node->undo_recs); ++j) {
+			const trx_purge_rec_t*	purge_rec;
+			ulint			type;
+			ulint			cmpl_info;
+			bool			updated_extern;
+			undo_no_t		undo_no;
+			table_id_t		table_id;
+
+			purge_rec = static_cast<const trx_purge_rec_t*>(
+				ib_vector_get_const(node->undo_recs, j));
+
+			if (purge_rec->undo_rec == &trx_purge_dummy_rec) {
+				continue;
+			}
+
+			trx_undo_rec_get_pars(
+				purge_rec->undo_rec, &type, &cmpl_info,
+				&updated_extern, &undo_no, &table_id);
+
+			tables.insert(table_id);
+			table_nodes.insert(table_node_t(table_id, node));
+		}
+	}
+
+	MONITOR_INC_VALUE(MONITOR_PURGE_BATCH_TABLES, tables.size());
+	MONITOR_INC_VALUE(MONITOR_PURGE_BATCH_TABLE_SPLITS,
+			  table_nodes.size() - tables.size());
+}
+
 /*******************************************************************//**
 This function runs a purge batch.
 @return	number of undo log pages handled in the batch */
@@ -991,6 +1167,7 @@ trx_purge_attach_undo_recs(
 		ut_a(node->done);
 
 		node->done = FALSE;
+		node->n_tables = 0;
 	}
 
 	/* There should never be fewer nodes than threads, the inverse
@@ -998,7 +1175,10 @@ trx_purge_attach_undo_recs(
 	ut_a(i == n_purge_threads);
 
 	/* Fetch and parse the UNDO records. The UNDO records are added
-	to a per purge node vector. */
+	to a per purge node vector. All the records of a table go to the
+	same node, so that the purge threads do not contend for the index
+	pages of the same tables; the first record of each table picks the
+	next node in round-robin order. */
 	thr = UT_LIST_GET_FIRST(purge_sys->query->thrs);
 	ut_a(n_thrs > 0 && thr != NULL);
 
@@ -1006,18 +1186,14 @@ trx_purge_attach_undo_recs(
 
 	i = 0;
 
-	for (;;) {
-		purge_node_t*		node;
-		trx_purge_rec_t*	purge_rec;
-
-		ut_a(!thr->is_active);
+	typedef std::map<table_id_t, que_thr_t*> table_thr_map_t;
 
-		/* Get the purge node. */
-		node = (purge_node_t*) thr->child;
-		ut_a(que_node_get_type(node) == QUE_NODE_PURGE);
+	table_thr_map_t	table_thrs;
 
-		purge_rec = static_cast<trx_purge_rec_t*>(
-			mem_heap_zalloc(node->heap, sizeof(*purge_rec)));
+	for (;;) {
+		purge_node_t*		node;
+		trx_purge_rec_t		purge_rec;
+		que_thr_t*		rec_thr;
 
 		/* Track the max {trx_id, undo_no} for truncating the
 		UNDO logs once we have purged the records. */
@@ -1029,38 +1205,81 @@ trx_purge_attach_undo_recs(
 			*limit = purge_sys->iter;
 		}
 
-		/* Fetch the next record, and advance the purge_sys->iter. */
-		purge_rec->undo_rec = trx_purge_fetch_next_rec(
-			&purge_rec->roll_ptr, &n_pages_handled, node->heap);
+		/* Fetch the next record, and advance the purge_sys->iter.
+		The copy lives in purge_sys->heap, which is not emptied
+		before the next batch. */
+		purge_rec.undo_rec = trx_purge_fetch_next_rec(
+			&purge_rec.roll_ptr, &n_pages_handled,
+			purge_sys->heap);
 
-		if (purge_rec->undo_rec != NULL) {
+		if (purge_rec.undo_rec == NULL) {
+			break;
+		}
 
-			if (node->undo_recs == NULL) {
-				node->undo_recs = ib_vector_create(
-					ib_heap_allocator_create(node->heap),
-					sizeof(trx_purge_rec_t),
-					batch_size);
-			} else {
-				ut_a(!ib_vector_is_empty(node->undo_recs));
+		if (purge_rec.undo_rec == &trx_purge_dummy_rec) {
+			rec_thr = thr;
+		} else {
+			ulint		type;
+			ulint		cmpl_info;
+			bool		updated_extern;
+			undo_no_t	undo_no;
+			table_id_t	table_id;
+
+			trx_undo_rec_get_pars(
+				purge_rec.undo_rec, &type, &cmpl_info,
+				&updated_extern, &undo_no, &table_id);
+
+			std::pair<table_thr_map_t::iterator, bool>	ins
+				= table_thrs.insert(
+					table_thr_map_t::value_type(
+						table_id, thr));
+
+			rec_thr = ins.first->second;
+
+			if (ins.second) {
+				++static_cast<purge_node_t*>(
+					rec_thr->child)->n_tables;
 			}
+		}
 
-			ib_vector_push(node->undo_recs, purge_rec);
-
-			if (n_pages_handled >= batch_size) {
+		if (rec_thr == thr) {
+			/* Move on to the next node for the next table. */
+			thr = UT_LIST_GET_NEXT(thrs, thr);
 
-				break;
+			if (!(++i % n_purge_threads)) {
+				thr = UT_LIST_GET_FIRST(
+					purge_sys->query->thrs);
 			}
+
+			ut_a(thr != NULL);
+		}
+
+		ut_a(!rec_thr->is_active);
+
+		/* Get the purge node. */
+		node = (purge_node_t*) rec_thr->child;
+		ut_a(que_node_get_type(node) == QUE_NODE_PURGE);
+
+		if (node->undo_recs == NULL) {
+			node->undo_recs = ib_vector_create(
+				ib_heap_allocator_create(node->heap),
+				sizeof(trx_purge_rec_t),
+				batch_size);
 		} else {
-			break;
+			ut_a(!ib_vector_is_empty(node->undo_recs));
 		}
 
-		thr = UT_LIST_GET_NEXT(thrs, thr);
+		ib_vector_push(node->undo_recs, &purge_rec);
+
+		if (n_pages_handled >= batch_size) {
 
-		if (!(++i % n_purge_threads)) {
-			thr = UT_LIST_GET_FIRST(purge_sys->query->thrs);
+			break;
 		}
+	}
 
-		ut_a(thr != NULL);
+	if (MONITOR_IS_ON(MONITOR_PURGE_BATCH_TABLES)
+	    || MONITOR_IS_ON(MONITOR_PURGE_BATCH_TABLE_SPLITS)) {
+		trx_purge_count_batch_tables(n_purge_threads, purge_sys);
 	}
 
 	ut_ad(trx_purge_check_limit());
@@ -1155,6 +1374,460 @@ trx_purge_wait_for_workers_to_complete(
 	ut_a(srv_get_task_queue_length() == 0);
 }
 
+/*================ UNDO TABLESPACE TRUNCATION ========================*/
+
+/*******************************************************************//**
+Builds the name of the file whose existence records that an undo tablespace
+is being truncated. It lives next to the undo tablespace. */
+static
+void
+trx_purge_undo_trunc_log_name(
+/*==========================*/
+	char*	name,		/*!< out: file name */
+	ulint	len,		/*!< in: size of name in bytes */
+	ulint	space)		/*!< in: undo tablespace id */
+{
+	ut_snprintf(name, len, "%s%cundo%03lu_trunc.log",
+		    srv_undo_dir, SRV_PATH_SEPARATOR, space);
+}
+
+/*******************************************************************//**
+Creates the file that records that an undo tablespace is being truncated.
+@return	true if success */
+static
+bool
+trx_purge_undo_trunc_log_create(
+/*============================*/
+	ulint	space)		/*!< in: undo tablespace id */
+{
+	char		name[OS_FILE_MAX_PATH];
+	os_file_t	fh;
+	ibool		ret;
+
+	trx_purge_undo_trunc_log_name(name, sizeof(name), space);
+
+	fh = os_file_create(
+		innodb_file_log_key, name, OS_FILE_OVERWRITE,
+		OS_FILE_NORMAL, OS_LOG_FILE, &ret);
+
+	if (!ret) {
+		return(false);
+	}
+
+	ret = os_file_flush(fh);
+
+	os_file_close(fh);
+
+	return(ret);
+}
+
+/*******************************************************************//**
+Checks whether an undo tablespace was being truncated when the server was
+killed.
+@return	true if the truncation must be completed */
+static
+bool
+trx_purge_undo_trunc_log_exists(
+/*============================*/
+	ulint	space)		/*!< in: undo tablespace id */
+{
+	char		name[OS_FILE_MAX_PATH];
+	ibool		exists;
+	os_file_type_t	type;
+
+	trx_purge_undo_trunc_log_name(name, sizeof(name), space);
+
+	return(os_file_status(name, &exists, &type) && exists);
+}
+
+/*******************************************************************//**
+Removes the file that records that an undo tablespace is being truncated,
+once the truncated tablespace has been written to disk. */
+static
+void
+trx_purge_undo_trunc_log_delete(
+/*============================*/
+	ulint	space)		/*!< in: undo tablespace id */
+{
+	char	name[OS_FILE_MAX_PATH];
+
+	trx_purge_undo_trunc_log_name(name, sizeof(name), space);
+
+	os_file_delete_if_exists(innodb_file_log_key, name);
+}
+
+/*******************************************************************//**
+Truncates an undo tablespace to its initial size and re-creates the
+headers of the rollback segments that it hosts, with empty history lists and
+undo log slots. The mini-transaction generates no redo log: the redo log
+records of the old pages must never be applied to the new ones, and if the
+server is killed before the pages are written, the truncation is done again
+at startup, see trx_purge_undo_truncate_fix_up().
+@return	true if success */
+static
+bool
+trx_purge_undo_tablespace_reinit(
+/*=============================*/
+	ulint	space)		/*!< in: undo tablespace id */
+{
+	mtr_t		mtr;
+	trx_sysf_t*	sys_header;
+	ulint		i;
+	ulint		page_nos[TRX_SYS_N_RSEGS];
+
+	/* Find the slots of the rollback segments of the tablespace
+	before its pages are created: the trx system header must not be
+	latched while pages are allocated. Page 0 is never a rollback
+	segment header, so it marks the slots to re-create. */
+	mtr_start(&mtr);
+
+	sys_header = trx_sysf_get(&mtr);
+
+	for (i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+
+		page_nos[i] = FIL_NULL;
+
+		if (trx_sysf_rseg_get_page_no(sys_header, i, &mtr) != FIL_NULL
+		    && trx_sysf_rseg_get_space(sys_header, i, &mtr) == space) {
+
+			page_nos[i] = 0;
+		}
+	}
+
+	mtr_commit(&mtr);
+
+	if (!fil_truncate_tablespace(
+		    space, SRV_UNDO_TABLESPACE_SIZE_IN_PAGES)) {
+
+		return(false);
+	}
+
+	mtr_start(&mtr);
+
+	mtr_set_log_mode(&mtr, MTR_LOG_NO_REDO);
+
+	mtr_x_lock(fil_space_get_latch(space, NULL), &mtr);
+
+	fsp_header_init(space, SRV_UNDO_TABLESPACE_SIZE_IN_PAGES, &mtr);
+
+	mtr_commit(&mtr);
+
+	/* Create each header in its own mini-transaction, acquiring
+	the file space x-latch before the trx system header, as
+	trx_rseg_create() does. */
+	for (i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+
+		if (page_nos[i] == FIL_NULL) {
+			continue;
+		}
+
+		mtr_start(&mtr);
+
+		mtr_set_log_mode(&mtr, MTR_LOG_NO_REDO);
+
+		mtr_x_lock(fil_space_get_latch(space, NULL), &mtr);
+
+		page_nos[i] = trx_rseg_header_create(
+			space, 0, ULINT_MAX, i, &mtr);
+
+		mtr_commit(&mtr);
+
+		ut_a(page_nos[i] != FIL_NULL);
+	}
+
+	/* The rollback segment memory objects do not exist yet if we
+	are called at startup. */
+	for (i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+		trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+
+		if (rseg != NULL && page_nos[i] != FIL_NULL) {
+			ut_a(rseg->space == space);
+			trx_rseg_mem_reset(rseg, page_nos[i]);
+		}
+	}
+
+	return(true);
+}
+
+/*******************************************************************//**
+Sets or clears the flag that keeps the rollback segments of an undo
+tablespace from being assigned to new transactions.
+@return	number of rollback segments in the tablespace */
+static
+ulint
+trx_purge_undo_tablespace_set_skip(
+/*===============================*/
+	ulint	space,		/*!< in: undo tablespace id */
+	bool	skip)		/*!< in: true to stop assigning the
+				rollback segments */
+{
+	ulint	i;
+	ulint	n_rsegs = 0;
+
+	for (i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+		trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+
+		if (rseg != NULL && rseg->space == space) {
+			mutex_enter(&rseg->mutex);
+			rseg->skip_allocation = skip;
+			mutex_exit(&rseg->mutex);
+
+			++n_rsegs;
+		}
+	}
+
+	return(n_rsegs);
+}
+
+/*******************************************************************//**
+Marks the next undo tablespace, in round-robin order, that has grown beyond
+innodb_max_undo_log_size for truncation. A tablespace is marked only if
+another undo tablespace has rollback segments to which the new transactions
+can be assigned in the meantime. */
+static
+void
+trx_purge_mark_undo_for_truncate(void)
+/*==================================*/
+{
+	ulint	n_spaces = srv_undo_tablespaces_open;
+	ulint	space = ULINT_UNDEFINED;
+	ulint	i;
+
+	ut_ad(purge_sys->undo_trunc_space == ULINT_UNDEFINED);
+
+	if (!srv_undo_log_truncate || n_spaces < 2) {
+		return;
+	}
+
+	for (i = 1; i <= n_spaces; ++i) {
+		ulint	id = (purge_sys->undo_trunc_last + i) % n_spaces + 1;
+
+		if ((ib_uint64_t) fil_space_get_size(id) * UNIV_PAGE_SIZE
+		    > srv_max_undo_log_size) {
+
+			space = id;
+			break;
+		}
+	}
+
+	if (space == ULINT_UNDEFINED) {
+		return;
+	}
+
+	purge_sys->undo_trunc_last = space;
+
+	for (i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+		const trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+
+		if (rseg != NULL && rseg->space != 0 && rseg->space != space) {
+			break;
+		}
+	}
+
+	if (i == TRX_SYS_N_RSEGS) {
+		return;
+	}
+
+	if (trx_purge_undo_tablespace_set_skip(space, true) == 0) {
+		return;
+	}
+
+	purge_sys->undo_trunc_space = space;
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Undo tablespace %lu is larger than "
+		"innodb_max_undo_log_size; it will be truncated "
+		"once its undo logs have been purged", space);
+}
+
+/*******************************************************************//**
+Checks whether the rollback segments of an undo tablespace are no longer
+used: no transaction has been assigned one of them and their history lists
+have been purged and truncated.
+@return	true if the tablespace can be truncated */
+static
+bool
+trx_purge_undo_tablespace_is_free(
+/*==============================*/
+	ulint	space)		/*!< in: undo tablespace id */
+{
+	ulint	i;
+
+	for (i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+		trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+		bool		in_use;
+		mtr_t		mtr;
+
+		if (rseg == NULL || rseg->space != space) {
+			continue;
+		}
+
+		mtr_start(&mtr);
+		mutex_enter(&rseg->mutex);
+
+		in_use = rseg->trx_ref_count > 0
+			|| rseg->last_page_no != FIL_NULL;
+
+		if (!in_use) {
+			trx_rsegf_t*	rseg_hdr;
+
+			rseg_hdr = trx_rsegf_get(
+				rseg->space, rseg->zip_size, rseg->page_no,
+				&mtr);
+
+			in_use = flst_get_len(
+				rseg_hdr + TRX_RSEG_HISTORY, &mtr) > 0;
+		}
+
+		mutex_exit(&rseg->mutex);
+		mtr_commit(&mtr);
+
+		if (in_use) {
+			return(false);
+		}
+	}
+
+	/* The purge pointer must not be positioned on an undo log of the
+	tablespace. */
+	return(!purge_sys->next_stored
+	       || purge_sys->rseg == NULL
+	       || purge_sys->rseg->space != space);
+}
+
+/*******************************************************************//**
+Truncates the undo tablespace that is marked for truncation if none of its
+rollback segments is in use any more, or marks an undo tablespace that has
+grown beyond innodb_max_undo_log_size. The rollback segments of a marked
+tablespace are not assigned to new transactions. Only the purge coordinator
+calls this, after the history list has been truncated. */
+UNIV_INTERN
+void
+trx_purge_truncate_undo_tablespaces(void)
+/*=====================================*/
+{
+	ulint		space;
+	ullint		start_time;
+
+	if (srv_shutdown_state != SRV_SHUTDOWN_NONE) {
+		return;
+	}
+
+	if (purge_sys->undo_trunc_space == ULINT_UNDEFINED) {
+		trx_purge_mark_undo_for_truncate();
+	}
+
+	space = purge_sys->undo_trunc_space;
+
+	if (space == ULINT_UNDEFINED
+	    || !trx_purge_undo_tablespace_is_free(space)) {
+
+		return;
+	}
+
+	start_time = ut_time_us(NULL);
+
+	/* Write all modified pages to disk, so that no redo log record
+	of the tablespace will be applied at a later crash recovery. No
+	thread modifies the tablespace from here on. */
+	log_make_checkpoint_at(LSN_MAX, TRUE);
+
+	if (!trx_purge_undo_trunc_log_create(space)) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Cannot create the truncation log file of undo "
+			"tablespace %lu; skipping its truncation", space);
+
+		trx_purge_undo_tablespace_set_skip(space, false);
+		purge_sys->undo_trunc_space = ULINT_UNDEFINED;
+
+		return;
+	}
+
+	DBUG_EXECUTE_IF("ib_undo_trunc_before_reinit_crash",
+			DBUG_SUICIDE(););
+
+	if (!trx_purge_undo_tablespace_reinit(space)) {
+		ib_logf(IB_LOG_LEVEL_FATAL,
+			"Cannot truncate undo tablespace %lu", space);
+	}
+
+	DBUG_EXECUTE_IF("ib_undo_trunc_before_checkpoint_crash",
+			DBUG_SUICIDE(););
+
+	/* Write the new pages and the trx system header page, which
+	were modified without redo logging. */
+	log_make_checkpoint_at(LSN_MAX, TRUE);
+
+	trx_purge_undo_trunc_log_delete(space);
+
+	trx_purge_undo_tablespace_set_skip(space, false);
+	purge_sys->undo_trunc_space = ULINT_UNDEFINED;
+
+	MONITOR_INC(MONITOR_UNDO_TRUNCATE_COUNT);
+	MONITOR_INC_VALUE(MONITOR_UNDO_TRUNCATE_MICROSECOND,
+			  ut_time_us(NULL) - start_time);
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Truncated undo tablespace %lu to %lu pages",
+		space, SRV_UNDO_TABLESPACE_SIZE_IN_PAGES);
+}
+
+/*******************************************************************//**
+Completes the truncation of the undo tablespaces that were being truncated
+when the server was killed. This is called at startup after the redo log has
+been scanned and before the rollback segments are loaded into memory.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+trx_purge_undo_truncate_fix_up(
+/*===========================*/
+	ulint	n_undo_tablespaces)	/*!< in: number of open undo
+					tablespaces */
+{
+	ulint	space;
+
+	for (space = 1; space <= n_undo_tablespaces; ++space) {
+
+		if (!trx_purge_undo_trunc_log_exists(space)) {
+			continue;
+		}
+
+		if (srv_read_only_mode) {
+			ib_logf(IB_LOG_LEVEL_ERROR,
+				"Undo tablespace %lu was being truncated; "
+				"cannot complete the truncation in "
+				"read-only mode", space);
+
+			return(DB_READ_ONLY);
+		}
+
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Completing the truncation of undo tablespace %lu",
+			space);
+
+		if (!trx_purge_undo_tablespace_reinit(space)) {
+			ib_logf(IB_LOG_LEVEL_ERROR,
+				"Cannot truncate undo tablespace %lu", space);
+
+			return(DB_ERROR);
+		}
+
+		/* The redo log cannot be checkpointed before recovery
+		has completed: write the pages of the tablespace and of
+		the trx system header directly. */
+		buf_LRU_flush_or_remove_pages(
+			space, BUF_REMOVE_FLUSH_WRITE, NULL);
+		buf_LRU_flush_or_remove_pages(
+			TRX_SYS_SPACE, BUF_REMOVE_FLUSH_WRITE, NULL);
+
+		fil_flush(space);
+		fil_flush(TRX_SYS_SPACE);
+
+		trx_purge_undo_trunc_log_delete(space);
+	}
+
+	return(DB_SUCCESS);
+}
+
 /******************************************************************//**
 Remove old historical changes from the rollback segments. */
 static
@@ -1169,6 +1842,8 @@ trx_purge_truncate(void)
 	} else {
 		trx_purge_truncate_history(&purge_sys->limit, purge_sys->view);
 	}
+
+	trx_purge_truncate_undo_tablespaces();
 }
 
 /*******************************************************************//**
@@ -1294,6 +1969,51 @@ trx_purge_state(void)
 	return(state);
 }
 
+/*******************************************************************//**
+Prints the rate at which the history list is drained and, for each purge
+worker, the rate at which it purges undo log records. The counters are
+read without latching. */
+UNIV_INTERN
+void
+trx_purge_print(
+/*============*/
+	FILE*	file,		/*!< in: file where to print */
+	double	time_elapsed)	/*!< in: seconds since the last printout */
+{
+	ulint	n_drained;
+	ulint	i = 0;
+
+	if (purge_sys == NULL || purge_sys->query == NULL) {
+		return;
+	}
+
+	n_drained = purge_sys->n_history_drained;
+
+	fprintf(file,
+		"Purge history drained %.2f undo logs/s\n",
+		(n_drained - purge_sys->n_history_drained_old)
+		/ time_elapsed);
+
+	purge_sys->n_history_drained_old = n_drained;
+
+	for (que_thr_t* thr = UT_LIST_GET_FIRST(purge_sys->query->thrs);
+	     thr != NULL;
+	     thr = UT_LIST_GET_NEXT(thrs, thr), ++i) {
+
+		purge_node_t*	node = static_cast<purge_node_t*>(thr->child);
+		ulint		n_purged = node->n_purged;
+
+		fprintf(file,
+			"Purge worker %lu: %.2f undo recs/s,"
+			" %lu tables in last batch\n",
+			(ulong) i,
+			(n_purged - node->n_purged_old) / time_elapsed,
+			(ulong) node->n_tables);
+
+		node->n_purged_old = n_purged;
+	}
+}
+
 /*******************************************************************//**
 Stop purge and wait for it to stop, move to PURGE_STATE_STOP. */
 UNIV_INTERN
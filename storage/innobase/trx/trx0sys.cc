@@ -44,6 +44,8 @@ Created 3/26/1996 Heikki Tuuri
 #include "os0file.h"
 #include "read0read.h"
 
+#include <algorithm>
+
 /** The file format tag structure with id and name. */
 struct file_format_t {
 	ulint		id;		/*!< id of the file format */
@@ -592,6 +594,90 @@ trx_sys_create(void)
 	trx_sys = static_cast<trx_sys_t*>(mem_zalloc(sizeof(*trx_sys)));
 
 	mutex_create(trx_sys_mutex_key, &trx_sys->mutex, SYNC_TRX_SYS);
+
+	trx_sys->rw_trx_ids_size = TRX_SYS_RW_TRX_IDS_INIT_SIZE;
+
+	trx_sys->rw_trx_ids = static_cast<trx_id_t*>(
+		mem_alloc(trx_sys->rw_trx_ids_size * sizeof(trx_id_t)));
+
+	UT_LIST_INIT(trx_sys->serialisation_list);
+}
+
+/*****************************************************************//**
+Adds the id of a read-write transaction to trx_sys->rw_trx_ids, which
+read views are copied from. */
+UNIV_INTERN
+void
+trx_sys_rw_trx_id_insert(
+/*=====================*/
+	trx_id_t	id)	/*!< in: transaction id */
+{
+	trx_id_t*	ids;
+	ulint		n;
+	ulint		pos;
+
+	ut_ad(mutex_own(&trx_sys->mutex));
+
+	n = trx_sys->n_rw_trx_ids;
+
+	if (n == trx_sys->rw_trx_ids_size) {
+		ids = static_cast<trx_id_t*>(
+			mem_alloc(2 * n * sizeof(trx_id_t)));
+
+		memcpy(ids, trx_sys->rw_trx_ids, n * sizeof(trx_id_t));
+
+		mem_free(trx_sys->rw_trx_ids);
+
+		trx_sys->rw_trx_ids = ids;
+		trx_sys->rw_trx_ids_size = 2 * n;
+	}
+
+	ids = trx_sys->rw_trx_ids;
+
+	/* Transactions started at runtime get increasing ids, so the
+	new id normally goes at the end of the array. */
+
+	for (pos = n; pos > 0 && ids[pos - 1] > id; pos--) {
+		/* No op */
+	}
+
+	ut_ad(pos == 0 || ids[pos - 1] < id);
+
+	memmove(ids + pos + 1, ids + pos, (n - pos) * sizeof(trx_id_t));
+
+	ids[pos] = id;
+
+	trx_sys->n_rw_trx_ids++;
+	trx_sys->rw_trx_ids_version++;
+}
+
+/*****************************************************************//**
+Removes the id of a read-write transaction from trx_sys->rw_trx_ids,
+if it is there. */
+UNIV_INTERN
+void
+trx_sys_rw_trx_id_erase(
+/*====================*/
+	trx_id_t	id)	/*!< in: transaction id */
+{
+	trx_id_t*	ids = trx_sys->rw_trx_ids;
+	trx_id_t*	pos;
+	ulint		n = trx_sys->n_rw_trx_ids;
+
+	ut_ad(mutex_own(&trx_sys->mutex));
+
+	pos = std::lower_bound(ids, ids + n, id);
+
+	if (pos == ids + n || *pos != id) {
+		/* A transaction resurrected in the committed state */
+
+		return;
+	}
+
+	memmove(pos, pos + 1, (ids + n - pos - 1) * sizeof(trx_id_t));
+
+	trx_sys->n_rw_trx_ids--;
+	trx_sys->rw_trx_ids_version++;
 }
 
 /*****************************************************************//**
@@ -1230,6 +1316,11 @@ trx_sys_close(void)
 
 	mutex_exit(&trx_sys->mutex);
 
+	ut_a(trx_sys->n_rw_trx_ids == 0);
+	ut_a(UT_LIST_GET_LEN(trx_sys->serialisation_list) == 0);
+
+	mem_free(trx_sys->rw_trx_ids);
+
 	mutex_free(&trx_sys->mutex);
 
 	mem_free(trx_sys);
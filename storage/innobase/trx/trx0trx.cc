@@ -295,6 +295,26 @@ trx_free_for_background(
 	trx_free(trx);
 }
 
+/********************************************************************//**
+Removes a read-write transaction from trx_sys->rw_trx_ids and
+trx_sys->serialisation_list, so that read views opened after this
+will see its changes. */
+static
+void
+trx_erase_rw_trx_id(
+/*================*/
+	trx_t*	trx)	/*!< in/out: read-write transaction */
+{
+	ut_ad(mutex_own(&trx_sys->mutex));
+
+	trx_sys_rw_trx_id_erase(trx->id);
+
+	if (trx->in_serialisation_list) {
+		UT_LIST_REMOVE(no_list, trx_sys->serialisation_list, trx);
+		trx->in_serialisation_list = false;
+	}
+}
+
 /********************************************************************//**
 At shutdown, frees a transaction object that is in the PREPARED state. */
 UNIV_INTERN
@@ -314,6 +334,8 @@ trx_free_prepared(
 
 	ut_a(!trx->read_only);
 
+	trx_erase_rw_trx_id(trx);
+
 	UT_LIST_REMOVE(trx_list, trx_sys->rw_trx_list, trx);
 	ut_d(trx->in_rw_trx_list = FALSE);
 
@@ -509,6 +531,10 @@ trx_resurrect_insert(
 
 	trx = trx_allocate_for_background();
 
+	/* This is single-threaded startup code, the rseg->mutex is
+	not needed. */
+	++rseg->trx_ref_count;
+
 	trx->rseg = rseg;
 	trx->xid = undo->xid;
 	trx->id = undo->trx_id;
@@ -630,6 +656,14 @@ trx_resurrect_update(
 	trx_undo_t*	undo,	/*!< in/out: update UNDO record */
 	trx_rseg_t*	rseg)	/*!< in/out: rollback segment */
 {
+	/* The transaction may already have been resurrected from its
+	insert undo log in the same rollback segment. */
+	if (trx->rseg == NULL) {
+		++rseg->trx_ref_count;
+	}
+
+	ut_ad(trx->rseg == NULL || trx->rseg == rseg);
+
 	trx->rseg = rseg;
 	trx->xid = undo->xid;
 	trx->id = undo->trx_id;
@@ -745,6 +779,23 @@ trx_lists_init_at_db_start(void)
 			trx_resurrect_table_locks(trx, undo);
 		}
 	}
+
+	/* Read views must not see the changes of the resurrected
+	transactions that are not committed. The rw_trx_list is in
+	descending order of trx->id. */
+
+	mutex_enter(&trx_sys->mutex);
+
+	for (trx_t* trx = UT_LIST_GET_LAST(trx_sys->rw_trx_list);
+	     trx != NULL;
+	     trx = UT_LIST_GET_PREV(trx_list, trx)) {
+
+		if (!trx_state_eq(trx, TRX_STATE_COMMITTED_IN_MEMORY)) {
+			trx_sys_rw_trx_id_insert(trx->id);
+		}
+	}
+
+	mutex_exit(&trx_sys->mutex);
 }
 
 /******************************************************************//**
@@ -783,20 +834,59 @@ trx_assign_rseg_low(
 
 	/* Skip the system tablespace if we have more than one tablespace
 	defined for rollback segments. We want all UNDO records to be in
-	the non-system tablespaces. */
+	the non-system tablespaces. Skip also the rollback segments of an
+	undo tablespace that is to be truncated; purge marks one only if
+	another undo tablespace has rollback segments. */
 
-	do {
+	for (;;) {
 		rseg = trx_sys->rseg_array[i];
 		ut_a(rseg == NULL || i == rseg->id);
 
 		i = (rseg == NULL) ? 0 : i + 1;
 
-	} while (rseg == NULL
-		 || (rseg->space == 0
-		     && n_tablespaces > 0
-		     && trx_sys->rseg_array[1] != NULL));
+		if (rseg == NULL
+		    || (rseg->space == 0
+			&& n_tablespaces > 0
+			&& trx_sys->rseg_array[1] != NULL)) {
+
+			continue;
+		}
 
-	return(rseg);
+		mutex_enter(&rseg->mutex);
+
+		if (!rseg->skip_allocation) {
+			++rseg->trx_ref_count;
+
+			mutex_exit(&rseg->mutex);
+
+			return(rseg);
+		}
+
+		mutex_exit(&rseg->mutex);
+	}
+}
+
+/****************************************************************//**
+Releases the rollback segment of a transaction that has committed or
+has been cleaned up, so that its undo tablespace can be truncated. */
+static
+void
+trx_release_rseg(
+/*=============*/
+	trx_t*	trx)		/*!< in/out: transaction */
+{
+	trx_rseg_t*	rseg = trx->rseg;
+
+	if (rseg != NULL) {
+		mutex_enter(&rseg->mutex);
+
+		ut_ad(rseg->trx_ref_count > 0);
+		--rseg->trx_ref_count;
+
+		mutex_exit(&rseg->mutex);
+
+		trx->rseg = NULL;
+	}
 }
 
 /****************************************************************//**
@@ -893,6 +983,8 @@ trx_start_low(
 		ut_ad(!trx_is_autocommit_non_locking(trx));
 		UT_LIST_ADD_FIRST(trx_list, trx_sys->rw_trx_list, trx);
 		ut_d(trx->in_rw_trx_list = TRUE);
+
+		trx_sys_rw_trx_id_insert(trx->id);
 #ifdef UNIV_DEBUG
 		if (trx->id > trx_sys->rw_max_trx_id) {
 			trx_sys->rw_max_trx_id = trx->id;
@@ -927,6 +1019,12 @@ trx_serialisation_number_get(
 
 	trx->no = trx_sys_get_new_trx_id();
 
+	/* The trx->no are assigned in ascending order. */
+
+	ut_ad(!trx->in_serialisation_list);
+	UT_LIST_ADD_LAST(no_list, trx_sys->serialisation_list, trx);
+	trx->in_serialisation_list = true;
+
 	/* If the rollack segment is not empty then the
 	new trx_t::no can't be less than any trx_t::no
 	already in the rollback segment. User threads only
@@ -1202,6 +1300,8 @@ trx_commit_in_memory(
 			ut_d(trx->in_ro_trx_list = FALSE);
 			MONITOR_INC(MONITOR_TRX_RO_COMMIT);
 		} else {
+			trx_erase_rw_trx_id(trx);
+
 			UT_LIST_REMOVE(trx_list, trx_sys->rw_trx_list, trx);
 			ut_d(trx->in_rw_trx_list = FALSE);
 			MONITOR_INC(MONITOR_TRX_RW_COMMIT);
@@ -1224,12 +1324,10 @@ trx_commit_in_memory(
 		mutex_exit(&trx_sys->mutex);
 	}
 
-	if (trx->global_read_view != NULL) {
+	/* The closed view is kept in trx->cached_read_view, to be
+	reused by the next trx_assign_read_view(). */
 
-		mem_heap_empty(trx->global_read_view_heap);
-
-		trx->global_read_view = NULL;
-	}
+	trx->global_read_view = NULL;
 
 	trx->read_view = NULL;
 
@@ -1293,7 +1391,7 @@ trx_commit_in_memory(
 	trx_named_savept_t*	savep = UT_LIST_GET_FIRST(trx->trx_savepoints);
 	trx_roll_savepoints_free(trx, savep);
 
-	trx->rseg = NULL;
+	trx_release_rseg(trx);
 	trx->undo_no = 0;
 	trx->last_sql_stat_start.least_undo_no = 0;
 
@@ -1434,7 +1532,7 @@ trx_cleanup_at_db_startup(
 		trx_undo_insert_cleanup(trx);
 	}
 
-	trx->rseg = NULL;
+	trx_release_rseg(trx);
 	trx->undo_no = 0;
 	trx->last_sql_stat_start.least_undo_no = 0;
 
@@ -1442,6 +1540,8 @@ trx_cleanup_at_db_startup(
 
 	ut_a(!trx->read_only);
 
+	trx_erase_rw_trx_id(trx);
+
 	UT_LIST_REMOVE(trx_list, trx_sys->rw_trx_list, trx);
 
 	assert_trx_in_rw_list(trx);
@@ -1479,9 +1579,11 @@ trx_assign_read_view(
 	if (!trx->read_view) {
 
 		trx->read_view = read_view_open_now(
-			trx->id, trx->global_read_view_heap);
+			trx->id, trx->cached_read_view,
+			trx->global_read_view_heap);
 
-		trx->global_read_view = trx->read_view;
+		trx->global_read_view = trx->cached_read_view =
+			trx->read_view;
 	}
 
 	return(trx->read_view);
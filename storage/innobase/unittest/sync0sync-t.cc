@@ -0,0 +1,241 @@
+/*****************************************************************************
+
+Copyright (c) 2014, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file unittest/sync0sync-t.cc
+Contention microbenchmark for ib_mutex_t and rw_lock_t, comparing threads
+that wait through the sync wait array with threads that wait on futexes
+(innodb_use_futex). Besides the timings and the adaptive spin limits the
+latches end up with, which are only reported, the test checks that no
+update made under a latch is lost.
+*******************************************************/
+
+#include "univ.i"
+#include "os0sync.h"
+#include "os0thread.h"
+#include "srv0srv.h"
+#include "sync0rw.h"
+#include "sync0sync.h"
+#include "ut0mem.h"
+#include "ut0ut.h"
+
+#include <tap.h>
+
+/** Number of threads competing for the latch */
+#define BENCH_N_THREADS		16
+/** Number of latch acquisitions per thread */
+#define BENCH_N_ROUNDS		10000
+/** Every BENCH_X_INTERVAL'th acquisition of the rw-lock is exclusive */
+#define BENCH_X_INTERVAL	8
+
+/** State shared by the benchmark threads */
+struct bench_t {
+	ib_mutex_t	mutex;		/*!< latch of the mutex benchmark */
+	rw_lock_t	lock;		/*!< latch of the rw-lock benchmark */
+	ulint		counter1;	/*!< incremented under the latch */
+	ulint		counter2;	/*!< incremented under the latch,
+					always equal to counter1 there */
+	ulint		n_torn;		/*!< number of times an s-latch
+					holder saw counter1 != counter2 */
+	ulint		n_running;	/*!< number of threads running */
+	os_event_t	done;		/*!< set by the last thread */
+};
+
+static bench_t	bench;
+
+/*********************************************************************//**
+Updates the counters protected by the latch being benchmarked. */
+static
+void
+bench_update(void)
+/*==============*/
+{
+	bench.counter1++;
+	ut_delay(2);
+	bench.counter2++;
+}
+
+/*********************************************************************//**
+Notes that a benchmark thread has finished, and exits it. */
+static
+void
+bench_thread_exit(void)
+/*===================*/
+{
+	if (os_atomic_decrement_ulint(&bench.n_running, 1) == 0) {
+		os_event_set(bench.done);
+	}
+
+	os_thread_exit(NULL);
+}
+
+/*********************************************************************//**
+Benchmark thread for ib_mutex_t.
+@return	a dummy parameter */
+extern "C"
+os_thread_ret_t
+DECLARE_THREAD(bench_mutex_thread)(
+/*===============================*/
+	void*	arg __attribute__((unused)))
+{
+	for (ulint i = 0; i < BENCH_N_ROUNDS; i++) {
+		mutex_enter(&bench.mutex);
+		bench_update();
+		mutex_exit(&bench.mutex);
+
+		ut_delay(ut_rnd_interval(0, 10));
+	}
+
+	bench_thread_exit();
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*********************************************************************//**
+Benchmark thread for rw_lock_t.
+@return	a dummy parameter */
+extern "C"
+os_thread_ret_t
+DECLARE_THREAD(bench_rw_lock_thread)(
+/*=================================*/
+	void*	arg __attribute__((unused)))
+{
+	for (ulint i = 0; i < BENCH_N_ROUNDS; i++) {
+		if (i % BENCH_X_INTERVAL == 0) {
+			rw_lock_x_lock(&bench.lock);
+			bench_update();
+			rw_lock_x_unlock(&bench.lock);
+		} else {
+			rw_lock_s_lock(&bench.lock);
+			if (bench.counter1 != bench.counter2) {
+				os_atomic_increment_ulint(&bench.n_torn, 1);
+			}
+			ut_delay(2);
+			rw_lock_s_unlock(&bench.lock);
+		}
+
+		ut_delay(ut_rnd_interval(0, 10));
+	}
+
+	bench_thread_exit();
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*********************************************************************//**
+Runs one benchmark with the given wait implementation and reports it. */
+static
+void
+bench_run(
+/*======*/
+	my_bool		use_futex,	/*!< in: value of srv_use_futex */
+	ibool		rw_lock)	/*!< in: TRUE to benchmark rw_lock_t,
+					FALSE for ib_mutex_t */
+{
+	const char*	name = rw_lock ? "rw_lock_t" : "ib_mutex_t";
+	const char*	impl = use_futex ? "futex" : "sync array";
+	ulint		n_updates;
+	ullint		start;
+	ulint		os_waits;
+	ulint		spin_limit;
+
+	/* The wait implementation is chosen when the latch is created. */
+	srv_use_futex = use_futex;
+
+	if (rw_lock) {
+		rw_lock_create(PFS_NOT_INSTRUMENTED, &bench.lock,
+			       SYNC_NO_ORDER_CHECK);
+		n_updates = BENCH_N_THREADS
+			* ((BENCH_N_ROUNDS + BENCH_X_INTERVAL - 1)
+			   / BENCH_X_INTERVAL);
+	} else {
+		mutex_create(PFS_NOT_INSTRUMENTED, &bench.mutex,
+			     SYNC_NO_ORDER_CHECK);
+		n_updates = BENCH_N_THREADS * BENCH_N_ROUNDS;
+	}
+
+	bench.counter1 = bench.counter2 = bench.n_torn = 0;
+	bench.n_running = BENCH_N_THREADS;
+	os_event_reset(bench.done);
+
+	start = ut_time_us(NULL);
+
+	for (ulint i = 0; i < BENCH_N_THREADS; i++) {
+		os_thread_create(rw_lock
+				 ? bench_rw_lock_thread
+				 : bench_mutex_thread, NULL, NULL);
+	}
+
+	os_event_wait(bench.done);
+
+	start = ut_time_us(NULL) - start;
+
+	if (rw_lock) {
+		os_waits = bench.lock.count_os_wait;
+		spin_limit = sync_spin_get_limit(&bench.lock.spin);
+		rw_lock_free(&bench.lock);
+	} else {
+		os_waits = bench.mutex.count_os_wait;
+		spin_limit = sync_spin_get_limit(&bench.mutex.spin);
+		mutex_free(&bench.mutex);
+	}
+
+	diag("%s, %s: %lu threads, %.3f s, %lu OS waits, spin limit %lu",
+	     name, impl, (ulong) BENCH_N_THREADS, start / 1000000.0,
+	     (ulong) os_waits, (ulong) spin_limit);
+
+	ok(bench.counter1 == n_updates && bench.counter2 == n_updates
+	   && bench.n_torn == 0,
+	   "%s, %s: no lost updates", name, impl);
+}
+
+int main(int, char**)
+{
+	plan(4);
+	MY_INIT("sync0sync-t");
+
+	srv_max_n_threads = 2 * BENCH_N_THREADS + 10;
+
+	ut_mem_init();
+	os_sync_init();
+	sync_init();
+
+	bench.done = os_event_create();
+
+	bench_run(FALSE, FALSE);
+	bench_run(FALSE, TRUE);
+
+#if defined(HAVE_IB_LINUX_FUTEX) && defined(HAVE_ATOMIC_BUILTINS)
+	bench_run(TRUE, FALSE);
+	bench_run(TRUE, TRUE);
+#else
+	skip(2, "futexes are not supported on this platform");
+#endif /* HAVE_IB_LINUX_FUTEX && HAVE_ATOMIC_BUILTINS */
+
+	srv_use_futex = FALSE;
+
+	os_event_free(bench.done);
+
+	sync_close();
+	os_sync_free();
+	ut_free_all_mem();
+
+	my_end(0);
+
+	return(exit_status());
+}